@@ -0,0 +1,93 @@
+/* hyscan-control-proxy-plan.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Очередь образов сигналов, ожидающих применения в #HyScanControlProxy. */
+
+#include "hyscan-control-proxy-plan.h"
+
+/* Функция освобождает память занятую структурой HyScanControlProxyPlan. */
+void
+hyscan_control_proxy_plan_free (gpointer data)
+{
+  HyScanControlProxyPlan *plan = data;
+
+  g_clear_object (&plan->image);
+  g_clear_object (&plan->conv);
+
+  g_slice_free (HyScanControlProxyPlan, plan);
+}
+
+/* Функция добавляет образ сигнала в очередь, упорядоченную по времени начала
+ * действия. Ещё не применённые сигналы с тем же или более поздним временем
+ * отменяются. Из сигналов, начинающихся не позже времени последних
+ * обработанных данных last_time, в очереди остаётся только последний, так
+ * как только он может быть применён к следующим данным. */
+void
+hyscan_control_proxy_plan_push (GQueue                 *plans,
+                                HyScanControlProxyPlan *plan,
+                                gint64                  last_time)
+{
+  HyScanControlProxyPlan *last;
+  HyScanControlProxyPlan *next;
+
+  while (((last = g_queue_peek_tail (plans)) != NULL) && (last->time >= plan->time))
+    hyscan_control_proxy_plan_free (g_queue_pop_tail (plans));
+
+  g_queue_push_tail (plans, plan);
+
+  while (((next = g_queue_peek_nth (plans, 1)) != NULL) && (next->time <= last_time))
+    hyscan_control_proxy_plan_free (g_queue_pop_head (plans));
+}
+
+/* Функция выбирает образ сигнала для данных с меткой времени time. Из
+ * очереди извлекаются все сигналы, начавшие действовать не позже time, и
+ * возвращается последний из них. Если таких сигналов нет, функция
+ * возвращает NULL. */
+HyScanControlProxyPlan *
+hyscan_control_proxy_plan_select (GQueue *plans,
+                                  gint64  time)
+{
+  HyScanControlProxyPlan *plan = NULL;
+  HyScanControlProxyPlan *next;
+
+  while (((next = g_queue_peek_head (plans)) != NULL) && (time >= next->time))
+    {
+      if (plan != NULL)
+        hyscan_control_proxy_plan_free (plan);
+
+      plan = g_queue_pop_head (plans);
+    }
+
+  return plan;
+}
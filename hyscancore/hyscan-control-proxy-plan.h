@@ -0,0 +1,68 @@
+/* hyscan-control-proxy-plan.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_CONTROL_PROXY_PLAN_H__
+#define __HYSCAN_CONTROL_PROXY_PLAN_H__
+
+#include <hyscan-buffer.h>
+#include <hyscan-convolution.h>
+
+G_BEGIN_DECLS
+
+typedef struct _HyScanControlProxyPlan HyScanControlProxyPlan;
+
+/* Образ сигнала, ожидающий применения. */
+struct _HyScanControlProxyPlan
+{
+  gint64                       time;             /* Время начала действия сигнала. */
+  HyScanBuffer                *image;            /* Образ сигнала или NULL. */
+  HyScanConvolution           *conv;             /* Подготовленный объект свёртки или NULL. */
+};
+
+G_GNUC_INTERNAL
+void           hyscan_control_proxy_plan_free                  (gpointer                   data);
+
+G_GNUC_INTERNAL
+void           hyscan_control_proxy_plan_push                  (GQueue                    *plans,
+                                                                HyScanControlProxyPlan    *plan,
+                                                                gint64                     last_time);
+
+G_GNUC_INTERNAL
+HyScanControlProxyPlan *
+               hyscan_control_proxy_plan_select                (GQueue                    *plans,
+                                                                gint64                     time);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_CONTROL_PROXY_PLAN_H__ */
@@ -0,0 +1,346 @@
+/* hyscan-control-proxy-reduce.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Функции объединения отсчётов и строк при прореживании данных и выбора
+ * коэффициента автоматического прореживания в #HyScanControlProxy. */
+
+#include "hyscan-control-proxy-reduce.h"
+
+#include <string.h>
+#include <math.h>
+
+#define AUTO_SCALE_LOAD_HIGH   0.75              /* Загрузка, при которой прореживание увеличивается. */
+#define AUTO_SCALE_LOAD_LOW    0.35              /* Загрузка, при которой прореживание уменьшается. */
+#define AUTO_SCALE_DROP_HIGH   0.02              /* Доля потерянных строк, при которой прореживание увеличивается. */
+#define AUTO_SCALE_CALM        3                 /* Число интервалов низкой нагрузки до уменьшения прореживания. */
+
+/* Функция вычисляет амплитуду комплексных данных с прореживанием по точкам.
+ *
+ * Все функции объединения данных обрабатывают отсчёты во внешнем цикле по
+ * номеру отсчёта в группе, а во внутреннем цикле по выходным точкам. Такие
+ * циклы не содержат зависимостей между итерациями и ветвлений, что позволяет
+ * компилятору векторизовать их. Для максимального и среднеквадратичного
+ * значений используется квадрат амплитуды, а корень вычисляется только
+ * один раз для выходной точки. */
+void
+hyscan_control_proxy_reduce_complex (const HyScanComplexFloat *input,
+                                     gfloat                   *amplitude,
+                                     guint32                   n_points,
+                                     guint                     scale,
+                                     HyScanControlProxyReduce  reduce)
+{
+  gfloat a_scale = 1.0f / scale;
+  guint32 i, k;
+
+  switch (reduce)
+    {
+    case HYSCAN_CONTROL_PROXY_REDUCE_SKIP:
+      for (i = 0; i < n_points; i++)
+        {
+          const HyScanComplexFloat *point = &input[i * scale];
+          amplitude[i] = point->re * point->re + point->im * point->im;
+        }
+      for (i = 0; i < n_points; i++)
+        amplitude[i] = sqrtf (amplitude[i]);
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_MEAN:
+      memset (amplitude, 0, n_points * sizeof (gfloat));
+      for (k = 0; k < scale; k++)
+        {
+          for (i = 0; i < n_points; i++)
+            {
+              const HyScanComplexFloat *point = &input[i * scale + k];
+              amplitude[i] += sqrtf (point->re * point->re + point->im * point->im);
+            }
+        }
+      for (i = 0; i < n_points; i++)
+        amplitude[i] *= a_scale;
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_MAX:
+      memset (amplitude, 0, n_points * sizeof (gfloat));
+      for (k = 0; k < scale; k++)
+        {
+          for (i = 0; i < n_points; i++)
+            {
+              const HyScanComplexFloat *point = &input[i * scale + k];
+              gfloat power = point->re * point->re + point->im * point->im;
+              amplitude[i] = (power > amplitude[i]) ? power : amplitude[i];
+            }
+        }
+      for (i = 0; i < n_points; i++)
+        amplitude[i] = sqrtf (amplitude[i]);
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_RMS:
+      memset (amplitude, 0, n_points * sizeof (gfloat));
+      for (k = 0; k < scale; k++)
+        {
+          for (i = 0; i < n_points; i++)
+            {
+              const HyScanComplexFloat *point = &input[i * scale + k];
+              amplitude[i] += point->re * point->re + point->im * point->im;
+            }
+        }
+      for (i = 0; i < n_points; i++)
+        amplitude[i] = sqrtf (amplitude[i] * a_scale);
+      break;
+    }
+}
+
+/* Функция выполняет прореживание амплитудных данных по точкам. */
+void
+hyscan_control_proxy_reduce_amplitude (const gfloat             *input,
+                                       gfloat                   *amplitude,
+                                       guint32                   n_points,
+                                       guint                     scale,
+                                       HyScanControlProxyReduce  reduce)
+{
+  gfloat a_scale = 1.0f / scale;
+  guint32 i, k;
+
+  switch (reduce)
+    {
+    case HYSCAN_CONTROL_PROXY_REDUCE_SKIP:
+      for (i = 0; i < n_points; i++)
+        amplitude[i] = input[i * scale];
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_MEAN:
+      memset (amplitude, 0, n_points * sizeof (gfloat));
+      for (k = 0; k < scale; k++)
+        {
+          for (i = 0; i < n_points; i++)
+            amplitude[i] += input[i * scale + k];
+        }
+      for (i = 0; i < n_points; i++)
+        amplitude[i] *= a_scale;
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_MAX:
+      for (i = 0; i < n_points; i++)
+        amplitude[i] = input[i * scale];
+      for (k = 1; k < scale; k++)
+        {
+          for (i = 0; i < n_points; i++)
+            {
+              gfloat value = input[i * scale + k];
+              amplitude[i] = (value > amplitude[i]) ? value : amplitude[i];
+            }
+        }
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_RMS:
+      memset (amplitude, 0, n_points * sizeof (gfloat));
+      for (k = 0; k < scale; k++)
+        {
+          for (i = 0; i < n_points; i++)
+            {
+              gfloat value = input[i * scale + k];
+              amplitude[i] += value * value;
+            }
+        }
+      for (i = 0; i < n_points; i++)
+        amplitude[i] = sqrtf (amplitude[i] * a_scale);
+      break;
+    }
+}
+
+/* Функция вычисляет амплитуду и разность фаз между каналами вперёдсмотрящего
+ * локатора с прореживанием по дальности и квантованием по углу.
+ *
+ * Разность фаз определяется по взаимному спектру каналов, так же как это
+ * делает HyScanInter2DOA. Выходные данные формируются в виде одного
+ * комплексного отсчёта на точку, модуль которого равен среднему
+ * геометрическому модулей исходных отсчётов, а аргумент равен квантованной
+ * разности фаз. Расчёт углов и интенсивностей по таким данным даёт те же
+ * значения, что и по исходным данным. При объединении отсчётов
+ * по среднему и среднеквадратичному значению разность фаз определяется
+ * по сумме взаимного спектра, а при выборе максимума и прореживании без
+ * объединения по выбранному отсчёту. */
+void
+hyscan_control_proxy_reduce_doa (const HyScanComplexFloat *data1,
+                                 const HyScanComplexFloat *data2,
+                                 HyScanComplexFloat       *cross,
+                                 HyScanComplexFloat       *output,
+                                 guint32                   n_points,
+                                 guint                     scale,
+                                 guint                     n_bins,
+                                 HyScanControlProxyReduce  reduce)
+{
+  gfloat phase_step = 2.0 * G_PI / n_bins;
+  gfloat a_scale = 1.0f / scale;
+  guint32 n_input = n_points * scale;
+  guint32 i, k;
+
+  /* Взаимный спектр каналов. */
+  for (i = 0; i < n_input; i++)
+    {
+      cross[i].re = data2[i].re * data1[i].re + data2[i].im * data1[i].im;
+      cross[i].im = data2[i].im * data1[i].re - data2[i].re * data1[i].im;
+    }
+
+  for (i = 0; i < n_points; i++)
+    {
+      const HyScanComplexFloat *group = &cross[i * scale];
+      gfloat amplitude = 0.0f;
+      gfloat phase;
+      gfloat re = 0.0f;
+      gfloat im = 0.0f;
+
+      if (reduce == HYSCAN_CONTROL_PROXY_REDUCE_SKIP)
+        {
+          re = group[0].re;
+          im = group[0].im;
+          amplitude = sqrtf (sqrtf (re * re + im * im));
+        }
+
+      else if (reduce == HYSCAN_CONTROL_PROXY_REDUCE_MAX)
+        {
+          gfloat max_power = -1.0f;
+
+          for (k = 0; k < scale; k++)
+            {
+              gfloat power = group[k].re * group[k].re + group[k].im * group[k].im;
+
+              if (power > max_power)
+                {
+                  max_power = power;
+                  re = group[k].re;
+                  im = group[k].im;
+                }
+            }
+
+          amplitude = sqrtf (sqrtf (max_power));
+        }
+
+      else
+        {
+          for (k = 0; k < scale; k++)
+            {
+              gfloat value = sqrtf (group[k].re * group[k].re + group[k].im * group[k].im);
+
+              re += group[k].re;
+              im += group[k].im;
+
+              if (reduce == HYSCAN_CONTROL_PROXY_REDUCE_MEAN)
+                amplitude += sqrtf (value);
+              else
+                amplitude += value;
+            }
+
+          if (reduce == HYSCAN_CONTROL_PROXY_REDUCE_MEAN)
+            amplitude *= a_scale;
+          else
+            amplitude = sqrtf (amplitude * a_scale);
+        }
+
+      /* Квантование по углу. */
+      phase = atan2f (im, re);
+      phase = phase_step * rintf (phase / phase_step);
+
+      output[i].re = amplitude * cosf (phase);
+      output[i].im = amplitude * sinf (phase);
+    }
+}
+
+/* Функция добавляет строку к объединяемым строкам. Для среднеквадратичного
+ * значения накапливается сумма квадратов амплитуд. */
+void
+hyscan_control_proxy_merge_line (gfloat                   *merged,
+                                 const gfloat             *amplitude,
+                                 guint32                   n_points,
+                                 HyScanControlProxyReduce  reduce)
+{
+  guint32 i;
+
+  switch (reduce)
+    {
+    case HYSCAN_CONTROL_PROXY_REDUCE_SKIP:
+      memcpy (merged, amplitude, n_points * sizeof (gfloat));
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_MEAN:
+      for (i = 0; i < n_points; i++)
+        merged[i] += amplitude[i];
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_MAX:
+      for (i = 0; i < n_points; i++)
+        merged[i] = (amplitude[i] > merged[i]) ? amplitude[i] : merged[i];
+      break;
+
+    case HYSCAN_CONTROL_PROXY_REDUCE_RMS:
+      for (i = 0; i < n_points; i++)
+        merged[i] += amplitude[i] * amplitude[i];
+      break;
+    }
+}
+
+/* Функция определяет новый коэффициент прореживания по строкам по нагрузке
+ * на интервале оценки. При высокой нагрузке или большой доле потерянных
+ * строк прореживание увеличивается вдвое, но не более max_scale. При низкой
+ * нагрузке без потерь в течение AUTO_SCALE_CALM интервалов подряд
+ * прореживание уменьшается на единицу, но не менее min_scale. Разные пороги
+ * увеличения и уменьшения исключают колебания коэффициента. Число
+ * интервалов с низкой нагрузкой хранится в calm. */
+guint
+hyscan_control_proxy_scale_update (guint    scale,
+                                   guint    min_scale,
+                                   guint    max_scale,
+                                   gdouble  load,
+                                   gdouble  drop_ratio,
+                                   guint   *calm)
+{
+  if ((drop_ratio > AUTO_SCALE_DROP_HIGH) || (load > AUTO_SCALE_LOAD_HIGH))
+    {
+      *calm = 0;
+      return MIN (2 * scale, max_scale);
+    }
+
+  if ((drop_ratio > 0.0) || (load >= AUTO_SCALE_LOAD_LOW))
+    {
+      *calm = 0;
+      return scale;
+    }
+
+  *calm += 1;
+  if (*calm < AUTO_SCALE_CALM)
+    return scale;
+
+  *calm = 0;
+
+  return MAX (scale - 1, min_scale);
+}
@@ -0,0 +1,83 @@
+/* hyscan-control-proxy-reduce.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_CONTROL_PROXY_REDUCE_H__
+#define __HYSCAN_CONTROL_PROXY_REDUCE_H__
+
+#include <hyscan-types.h>
+#include "hyscan-control-proxy.h"
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL
+void           hyscan_control_proxy_reduce_complex             (const HyScanComplexFloat  *input,
+                                                                gfloat                    *amplitude,
+                                                                guint32                    n_points,
+                                                                guint                      scale,
+                                                                HyScanControlProxyReduce   reduce);
+
+G_GNUC_INTERNAL
+void           hyscan_control_proxy_reduce_amplitude           (const gfloat              *input,
+                                                                gfloat                    *amplitude,
+                                                                guint32                    n_points,
+                                                                guint                      scale,
+                                                                HyScanControlProxyReduce   reduce);
+
+G_GNUC_INTERNAL
+void           hyscan_control_proxy_reduce_doa                 (const HyScanComplexFloat  *data1,
+                                                                const HyScanComplexFloat  *data2,
+                                                                HyScanComplexFloat        *cross,
+                                                                HyScanComplexFloat        *output,
+                                                                guint32                    n_points,
+                                                                guint                      scale,
+                                                                guint                      n_bins,
+                                                                HyScanControlProxyReduce   reduce);
+
+G_GNUC_INTERNAL
+void           hyscan_control_proxy_merge_line                 (gfloat                    *merged,
+                                                                const gfloat              *amplitude,
+                                                                guint32                    n_points,
+                                                                HyScanControlProxyReduce   reduce);
+
+G_GNUC_INTERNAL
+guint          hyscan_control_proxy_scale_update               (guint                      scale,
+                                                                guint                      min_scale,
+                                                                guint                      max_scale,
+                                                                gdouble                    load,
+                                                                gdouble                    drop_ratio,
+                                                                guint                     *calm);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_CONTROL_PROXY_REDUCE_H__ */
@@ -49,8 +49,12 @@
  * который будут отправляться все запросы.
  *
  * Управление прореживанием данных осуществляется с помощью функции
- * #hyscan_control_proxy_set_scale. Тип выходных данных задаётся функцией
- * #hyscan_control_proxy_set_data_type.
+ * #hyscan_control_proxy_set_scale. Функция #hyscan_control_proxy_set_auto_scale
+ * включает автоматическое увеличение прореживания по строкам при высокой
+ * нагрузке. Действующие коэффициенты прореживания доступны в ветке
+ * статистики. Способ объединения отсчётов и строк при
+ * прореживании задаётся функцией #hyscan_control_proxy_set_reduce. Тип
+ * выходных данных задаётся функцией #hyscan_control_proxy_set_data_type.
  *
  * Список источников гидролокационных данных можно получить с помощью функции
  * #hyscan_control_proxy_sources_list, список датчиков
@@ -64,9 +68,26 @@
  * Управлять включением и отключением пересылки данных (и соответственно их
  * обработкой) можно с помощью функций #hyscan_control_proxy_sensor_set_sender
  * и #hyscan_control_proxy_source_set_sender.
+ *
+ * Для вперёдсмотрящего локатора класс объединяет строки первого и второго
+ * каналов с одинаковыми метками времени, вычисляет разность фаз между
+ * каналами и амплитуду, выполняет прореживание по дальности и квантование
+ * по углу. Результат передаётся одним потоком комплексных отсчётов в первом
+ * канале, модуль которых равен амплитуде, а аргумент разности фаз. Второй
+ * канал содержит только параметры антенны. Такие данные обрабатываются
+ * #HyScanForwardLookData, а их объём значительно меньше исходных. Шаг
+ * квантования по углу задаётся функцией #hyscan_control_proxy_set_angle_scale.
+ *
+ * Обработанные строки могут дополнительно записываться в кольцевой буфер
+ * #HyScanShmRing в разделяемой памяти, из которого их без копирования
+ * считывают процессы отображения на том же компьютере. Буфер задаётся
+ * функцией #hyscan_control_proxy_set_shm_ring.
  */
 
 #include "hyscan-control-proxy.h"
+#include "hyscan-control-proxy-reduce.h"
+#include "hyscan-control-proxy-plan.h"
+#include "hyscan-shm-ring.h"
 
 #include <hyscan-convolution.h>
 #include <hyscan-data-schema-builder.h>
@@ -79,6 +100,7 @@
 #include <hyscan-sonar-driver.h>
 
 #include <glib/gi18n-lib.h>
+#include <string.h>
 #include <math.h>
 
 #define AQ_MAX_SCALE           32                /* Максимальный коэффициент прореживания. */
@@ -87,16 +109,26 @@
 #define LOG_MSG_SZ             750               /* Максимальная длина сообщения. */
 #define LOG_BUF_SZ             16                /* Размер буфера сообщений. */
 #define AQ_BUF_SZ              4                 /* Размер буфера акустических данных. */
+#define FL_ANGLE_BINS          512               /* Число интервалов квантования разности фаз. */
+
+#define AUTO_SCALE_PERIOD      G_TIME_SPAN_SECOND /* Интервал оценки нагрузки. */
 
 #define PROXY_DATA_TYPES       "data-types"      /* ENUM идентификатор типов экспортируемых данных. */
+#define PROXY_REDUCE_TYPES     "reduce-types"    /* ENUM идентификатор способов объединения данных. */
 
 #define PROXY_DATA_TYPE        "data-type"       /* Параметр типа экспортируемых данных. */
 #define PROXY_LINE_SCALE       "line-scale"      /* Параметр прореживания строк. */
 #define PROXY_POINT_SCALE      "point-scale"     /* Параметр прореживания точек. */
+#define PROXY_LINE_REDUCE      "line-reduce"     /* Параметр способа объединения строк. */
+#define PROXY_POINT_REDUCE     "point-reduce"    /* Параметр способа объединения точек. */
+#define PROXY_ANGLE_SCALE      "angle-scale"     /* Параметр прореживания по углу. */
+#define PROXY_AUTO_SCALE       "auto-scale"      /* Параметр автоматического прореживания строк. */
 
 #define PROXY_STAT             "stat"            /* Ветка статистики. */
 #define PROXY_STAT_TOTAL       "stat/total"      /* Ветка статистики принятых данных. */
 #define PROXY_STAT_DROPPED     "stat/dropped"    /* Ветка статистики отброшенных данных. */
+#define PROXY_STAT_LINE_SCALE  "stat/line-scale" /* Ветка действующего прореживания строк. */
+#define PROXY_STAT_POINT_SCALE "stat/point-scale" /* Ветка действующего прореживания точек. */
 
 #define PROXY_PARAM_NAME(...)  hyscan_param_name_constructor (key_id, \
                                  (guint)sizeof (key_id), "params", __VA_ARGS__)
@@ -114,6 +146,7 @@ enum
 typedef enum
 {
   HYSCAN_CONTROL_PROXY_EMPTY,                   /* Буфер пуст. */
+  HYSCAN_CONTROL_PROXY_PAIRING,                 /* Ожидание данных второго канала. */
   HYSCAN_CONTROL_PROXY_PROCESS                  /* Данные в процессе обработки. */
 } HyScanControlProxyStatus;
 
@@ -128,9 +161,9 @@ typedef struct
 
 typedef struct
 {
-  gint64                       time;             /* Время начала действия сигнала. */
-  HyScanBuffer                *image;            /* Образ сигнала для свёртки. */
-  HyScanConvolution           *conv;             /* Объект свёртки данных. */
+  GQueue                       plans;            /* Очередь ожидающих образов сигналов. */
+  HyScanConvolution           *conv;             /* Текущий объект свёртки данных. */
+  gint64                       time;             /* Метка времени последних обработанных данных. */
   GMutex                       lock;             /* Блокировка. */
 } HyScanControlProxySignal;
 
@@ -139,6 +172,7 @@ typedef struct
   HyScanControlProxyStatus     status;           /* Статус буфера данных. */
   gint64                       time;             /* Метка времени данных. */
   HyScanBuffer                *data;             /* Данные. */
+  HyScanBuffer                *data2;            /* Данные второго канала. */
 } HyScanControlProxyData;
 
 typedef struct
@@ -147,18 +181,40 @@ typedef struct
   gchar                       *description;      /* Описание источника данных. */
   gchar                       *actuator;         /* Название привода. */
   HyScanAcousticDataInfo       info;             /* Параметры акустических данных. */
+  HyScanAcousticDataInfo       info2;            /* Параметры данных второго канала. */
   gboolean                     send_info;        /* Признак отправки параметров в начале галса. */
   HyScanControlProxyData       data[AQ_BUF_SZ];  /* Буферы обработки акустических данных. */
   HyScanBuffer                *import;           /* Временный буфер акустических данных. */
   HyScanControlProxySignal     signal;           /* Образ сигнала для свёртки. */
+  HyScanControlProxySignal     signal2;          /* Образ сигнала второго канала. */
   gboolean                     send;             /* Признак принудительной отправки текущих данных. */
   gint64                       new_data_type;    /* Установленный тип экспортируемых данных. */
   gint64                       cur_data_type;    /* Текущий тип экспортируемых данных. */
   gint64                       new_line_scale;   /* Установленное прореживание по строкам. */
-  gint64                       cur_line_scale;   /* Текущее прореживание по строкам. */
+  gint64                       cur_line_scale;   /* Текущее прореживание по строкам для статистики. */
+  gint                         line_scale;       /* Действующее прореживание по строкам. */
   gint64                       new_point_scale;  /* Установленное масштабирование по точкам. */
   gint64                       cur_point_scale;  /* Текущее масштабирование по точкам. */
+  gint64                       new_line_reduce;  /* Установленный способ объединения строк. */
+  gint64                       cur_line_reduce;  /* Текущий способ объединения строк. */
+  gint64                       new_point_reduce; /* Установленный способ объединения точек. */
+  gint64                       cur_point_reduce; /* Текущий способ объединения точек. */
+  gint64                       new_angle_scale;  /* Установленное прореживание по углу. */
+  gint64                       cur_angle_scale;  /* Текущее прореживание по углу. */
+  gboolean                     new_auto_scale;   /* Установленный признак автоматического прореживания. */
+  gboolean                     cur_auto_scale;   /* Текущий признак автоматического прореживания. */
+  gint64                       min_line_scale;   /* Минимальное прореживание строк в автоматическом режиме. */
+  gint64                       auto_time;        /* Время начала интервала оценки нагрузки. */
+  gint64                       auto_received;    /* Число принятых строк на начало интервала. */
+  gint64                       auto_dropped;     /* Число отброшенных строк на начало интервала. */
+  gint64                       auto_process;     /* Время обработки строк в интервале, мкс. */
+  guint                        auto_calm;        /* Число интервалов подряд с низкой нагрузкой. */
   guint                        line_counter;     /* Счётчик прореживания строк. */
+  HyScanBuffer                *merge;            /* Буфер объединения строк. */
+  guint                        merge_lines;      /* Число объединённых строк. */
+  gint64                       merge_time;       /* Метка времени последней объединённой строки. */
+  gint64                       last_time;        /* Метка времени последней строки первого канала. */
+  gint64                       orphan_time;      /* Метка времени строки второго канала без пары. */
   gint64                       received;         /* Число принятых строк. */
   gint64                       dropped;          /* Число отброшенных строк из-за переполнения. */
 } HyScanControlProxyAcoustic;
@@ -192,11 +248,15 @@ struct _HyScanControlProxyPrivate
   HyScanControlProxyLog        logs[LOG_BUF_SZ]; /* Буферы сообщений. */
 
   gboolean                     shutdown;         /* Признак завершения работы. */
+  gboolean                     wakeup;           /* Признак наличия данных для отправки. */
   gboolean                     started;          /* Признак рабочего режима. */
 
   GThread                     *sender;           /* Поток отправки данных. */
   GMutex                       lock;             /* Блокировка. */
   GCond                        cond;             /* Сигнализатор обработки. */
+
+  HyScanShmRing               *ring;             /* Буфер экспорта в разделяемую память. */
+  GMutex                       ring_lock;        /* Блокировка доступа к буферу экспорта. */
 };
 
 static void      hyscan_control_proxy_param_interface_init     (HyScanParamInterface    *iface);
@@ -218,6 +278,8 @@ static HyScanDataSchema *
 
 static void      hyscan_control_proxy_disconnect               (HyScanControlProxy      *proxy);
 
+static void      hyscan_control_proxy_wakeup                   (HyScanControlProxy      *proxy);
+
 static void      hyscan_control_proxy_source_free              (gpointer                 data);
 static void      hyscan_control_proxy_sensor_free              (gpointer                 data);
 
@@ -256,6 +318,41 @@ static void      hyscan_control_proxy_sensor_data              (HyScanControlPro
                                                                 gint64                   time,
                                                                 HyScanBuffer            *data);
 
+static void      hyscan_control_proxy_send_acoustic            (HyScanControlProxy      *proxy,
+                                                                HyScanSourceType         source,
+                                                                HyScanControlProxyAcoustic *buffer,
+                                                                gint64                   time,
+                                                                HyScanBuffer            *amplitude,
+                                                                HyScanBuffer            *export);
+
+static void      hyscan_control_proxy_ring_write               (HyScanControlProxy      *proxy,
+                                                                HyScanSourceType         source,
+                                                                guint                    channel,
+                                                                gint64                   time,
+                                                                gdouble                  data_rate,
+                                                                HyScanBuffer            *data);
+static void      hyscan_control_proxy_send_forward_look        (HyScanControlProxy      *proxy,
+                                                                HyScanControlProxyAcoustic *buffer,
+                                                                gint64                   time,
+                                                                HyScanBuffer            *data,
+                                                                HyScanBuffer            *export);
+
+static HyScanConvolution *
+                 hyscan_control_proxy_plan_conv                (HyScanBuffer            *image);
+
+static void      hyscan_control_proxy_prepare_signal           (HyScanControlProxySignal *signal);
+
+static gboolean  hyscan_control_proxy_update_signal            (HyScanControlProxySignal *signal,
+                                                                gint64                   time);
+
+static void      hyscan_control_proxy_auto_scale               (HyScanControlProxyAcoustic *buffer,
+                                                                gint64                   process_time);
+
+static void      hyscan_control_proxy_merge_flush              (HyScanControlProxy      *proxy,
+                                                                HyScanSourceType         source,
+                                                                HyScanControlProxyAcoustic *buffer,
+                                                                HyScanBuffer            *export);
+
 static gpointer  hyscan_control_proxy_sender                   (gpointer                 user_data);
 
 G_DEFINE_TYPE_WITH_CODE (HyScanControlProxy, hyscan_control_proxy, G_TYPE_OBJECT,
@@ -333,12 +430,11 @@ hyscan_control_proxy_object_constructed (GObject *object)
   guint32 n_sources;
   guint32 i, j;
 
-  /* Блокируем мьютекс, так как он используется только в g_cond_wait_until,
-   * который разблокирует его при вызове и заблокирует при получении сигнала.
-   * Сам мьютекс нам не нужен, он нужен только для g_cond_wait_until. */
+  /* Мьютекс защищает признак wakeup, по которому поток отправки
+   * пробуждается при поступлении новых данных. */
   g_cond_init (&priv->cond);
   g_mutex_init (&priv->lock);
-  g_mutex_lock (&priv->lock);
+  g_mutex_init (&priv->ring_lock);
 
   /* Обязательно должен быть указан объект управления устройством. */
   if (priv->control == NULL)
@@ -380,15 +476,28 @@ hyscan_control_proxy_object_constructed (GObject *object)
           const gchar *source_id = hyscan_source_get_id_by_type (sources[i]);
 
           g_mutex_init (&buffer->signal.lock);
+          g_mutex_init (&buffer->signal2.lock);
           buffer->send_info = TRUE;
           buffer->new_data_type = HYSCAN_DATA_AMPLITUDE_INT16LE;
           buffer->new_line_scale = 1;
           buffer->new_point_scale = 1;
-          buffer->signal.image = hyscan_buffer_new ();
+          buffer->new_line_reduce = HYSCAN_CONTROL_PROXY_REDUCE_SKIP;
+          buffer->new_point_reduce = HYSCAN_CONTROL_PROXY_REDUCE_MEAN;
+          buffer->new_angle_scale = 1;
+          buffer->last_time = -1;
+          buffer->orphan_time = -1;
+          g_queue_init (&buffer->signal.plans);
+          g_queue_init (&buffer->signal2.plans);
           buffer->signal.conv = hyscan_convolution_new ();
+          buffer->signal2.conv = hyscan_convolution_new ();
           buffer->import = hyscan_buffer_new ();
+          buffer->merge = hyscan_buffer_new ();
           for (j = 0; j < AQ_BUF_SZ; j++)
-            buffer->data[j].data = hyscan_buffer_new ();
+            {
+              buffer->data[j].data = hyscan_buffer_new ();
+              if (sources[i] == HYSCAN_SOURCE_FORWARD_LOOK)
+                buffer->data[j].data2 = hyscan_buffer_new ();
+            }
 
           g_hash_table_insert (priv->sources, GINT_TO_POINTER (sources[i]), buffer);
 
@@ -401,11 +510,32 @@ hyscan_control_proxy_object_constructed (GObject *object)
           PROXY_PARAM_NAME (priv->dev_id, source_id, PROXY_POINT_SCALE, NULL);
           hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->new_point_scale);
 
+          PROXY_PARAM_NAME (priv->dev_id, source_id, PROXY_LINE_REDUCE, NULL);
+          hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->new_line_reduce);
+
+          PROXY_PARAM_NAME (priv->dev_id, source_id, PROXY_POINT_REDUCE, NULL);
+          hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->new_point_reduce);
+
+          if (sources[i] == HYSCAN_SOURCE_FORWARD_LOOK)
+            {
+              PROXY_PARAM_NAME (priv->dev_id, source_id, PROXY_ANGLE_SCALE, NULL);
+              hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->new_angle_scale);
+            }
+
+          PROXY_PARAM_NAME (priv->dev_id, source_id, PROXY_AUTO_SCALE, NULL);
+          hyscan_param_controller_add_boolean (proxy_config, key_id, &buffer->new_auto_scale);
+
           PROXY_SYSTEM_NAME (priv->dev_id, PROXY_STAT_TOTAL, source_id, NULL);
           hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->received);
 
           PROXY_SYSTEM_NAME (priv->dev_id, PROXY_STAT_DROPPED, source_id, NULL);
           hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->dropped);
+
+          PROXY_SYSTEM_NAME (priv->dev_id, PROXY_STAT_LINE_SCALE, source_id, NULL);
+          hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->cur_line_scale);
+
+          PROXY_SYSTEM_NAME (priv->dev_id, PROXY_STAT_POINT_SCALE, source_id, NULL);
+          hyscan_param_controller_add_integer (proxy_config, key_id, &buffer->cur_point_scale);
         }
     }
 
@@ -465,11 +595,12 @@ hyscan_control_proxy_object_finalize (GObject *object)
   g_clear_pointer (&priv->sources, g_hash_table_unref);
   g_clear_pointer (&priv->sensors, g_hash_table_unref);
 
-  /* Не забываем разблокировать мьютекс перед его удалением, см. constructed. */
-  g_mutex_unlock (&priv->lock);
   g_mutex_clear (&priv->lock);
   g_cond_clear (&priv->cond);
 
+  g_clear_object (&priv->ring);
+  g_mutex_clear (&priv->ring_lock);
+
   G_OBJECT_CLASS (hyscan_control_proxy_parent_class)->finalize (object);
 }
 
@@ -509,6 +640,20 @@ hyscan_control_proxy_create_schema (HyScanControl *control,
                                                 HYSCAN_DATA_AMPLITUDE_FLOAT32LE,
                                                 "Float 32bit LE", _("Float 32bit LE"), NULL);
 
+  hyscan_data_schema_builder_enum_create       (builder, PROXY_REDUCE_TYPES);
+  hyscan_data_schema_builder_enum_value_create (builder, PROXY_REDUCE_TYPES,
+                                                HYSCAN_CONTROL_PROXY_REDUCE_SKIP,
+                                                "Skip", _("Skip"), NULL);
+  hyscan_data_schema_builder_enum_value_create (builder, PROXY_REDUCE_TYPES,
+                                                HYSCAN_CONTROL_PROXY_REDUCE_MEAN,
+                                                "Mean", _("Mean"), NULL);
+  hyscan_data_schema_builder_enum_value_create (builder, PROXY_REDUCE_TYPES,
+                                                HYSCAN_CONTROL_PROXY_REDUCE_MAX,
+                                                "Maximum", _("Maximum"), NULL);
+  hyscan_data_schema_builder_enum_value_create (builder, PROXY_REDUCE_TYPES,
+                                                HYSCAN_CONTROL_PROXY_REDUCE_RMS,
+                                                "RMS", _("RMS"), NULL);
+
   PROXY_PARAM_NAME (dev_id, NULL);
   hyscan_data_schema_builder_node_set_name (builder, key_id, _("Proxy"), dev_id);
 
@@ -524,6 +669,12 @@ hyscan_control_proxy_create_schema (HyScanControl *control,
   PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_DROPPED, NULL);
   hyscan_data_schema_builder_node_set_name (builder, key_id, _("Dropped"), NULL);
 
+  PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_LINE_SCALE, NULL);
+  hyscan_data_schema_builder_node_set_name (builder, key_id, _("Line scale"), NULL);
+
+  PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_POINT_SCALE, NULL);
+  hyscan_data_schema_builder_node_set_name (builder, key_id, _("Point scale"), NULL);
+
   sources = hyscan_control_sources_list (control, &n_sources);
   if (sources != NULL)
     {
@@ -548,6 +699,26 @@ hyscan_control_proxy_create_schema (HyScanControl *control,
           hyscan_data_schema_builder_key_integer_create (builder, key_id, _("Point scale"), NULL, 1);
           hyscan_data_schema_builder_key_integer_range  (builder, key_id, 1, AQ_MAX_SCALE, 1);
 
+          PROXY_PARAM_NAME (dev_id, source_id, PROXY_LINE_REDUCE, NULL);
+          hyscan_data_schema_builder_key_enum_create (builder, key_id, _("Line reduce"), NULL,
+                                                      PROXY_REDUCE_TYPES,
+                                                      HYSCAN_CONTROL_PROXY_REDUCE_SKIP);
+
+          PROXY_PARAM_NAME (dev_id, source_id, PROXY_POINT_REDUCE, NULL);
+          hyscan_data_schema_builder_key_enum_create (builder, key_id, _("Point reduce"), NULL,
+                                                      PROXY_REDUCE_TYPES,
+                                                      HYSCAN_CONTROL_PROXY_REDUCE_MEAN);
+
+          if (sources[i] == HYSCAN_SOURCE_FORWARD_LOOK)
+            {
+              PROXY_PARAM_NAME (dev_id, source_id, PROXY_ANGLE_SCALE, NULL);
+              hyscan_data_schema_builder_key_integer_create (builder, key_id, _("Angle scale"), NULL, 1);
+              hyscan_data_schema_builder_key_integer_range  (builder, key_id, 1, AQ_MAX_SCALE, 1);
+            }
+
+          PROXY_PARAM_NAME (dev_id, source_id, PROXY_AUTO_SCALE, NULL);
+          hyscan_data_schema_builder_key_boolean_create (builder, key_id, _("Auto scale"), NULL, FALSE);
+
           PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_TOTAL, source_id, NULL);
           hyscan_data_schema_builder_key_integer_create (builder, key_id, source_name, NULL, 0);
           hyscan_data_schema_builder_key_set_access (builder, key_id, HYSCAN_DATA_SCHEMA_ACCESS_READ);
@@ -555,6 +726,14 @@ hyscan_control_proxy_create_schema (HyScanControl *control,
           PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_DROPPED, source_id, NULL);
           hyscan_data_schema_builder_key_integer_create (builder, key_id, source_name, NULL, 0);
           hyscan_data_schema_builder_key_set_access (builder, key_id, HYSCAN_DATA_SCHEMA_ACCESS_READ);
+
+          PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_LINE_SCALE, source_id, NULL);
+          hyscan_data_schema_builder_key_integer_create (builder, key_id, source_name, NULL, 1);
+          hyscan_data_schema_builder_key_set_access (builder, key_id, HYSCAN_DATA_SCHEMA_ACCESS_READ);
+
+          PROXY_SYSTEM_NAME (dev_id, PROXY_STAT_POINT_SCALE, source_id, NULL);
+          hyscan_data_schema_builder_key_integer_create (builder, key_id, source_name, NULL, 1);
+          hyscan_data_schema_builder_key_set_access (builder, key_id, HYSCAN_DATA_SCHEMA_ACCESS_READ);
         }
     }
 
@@ -590,11 +769,24 @@ hyscan_control_proxy_disconnect (HyScanControlProxy *proxy)
   HyScanControlProxyPrivate *priv = proxy->priv;
 
   g_atomic_int_set (&priv->shutdown, TRUE);
+  hyscan_control_proxy_wakeup (proxy);
   g_clear_pointer (&priv->sender, g_thread_join);
 
   g_signal_handlers_disconnect_by_data (priv->device, proxy);
 }
 
+/* Функция пробуждает поток отправки данных. */
+static void
+hyscan_control_proxy_wakeup (HyScanControlProxy *proxy)
+{
+  HyScanControlProxyPrivate *priv = proxy->priv;
+
+  g_mutex_lock (&priv->lock);
+  priv->wakeup = TRUE;
+  g_cond_signal (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+}
+
 /* Функция освобождает память занятую структурой HyScanControlProxySource. */
 static void
 hyscan_control_proxy_source_free (gpointer data)
@@ -603,11 +795,20 @@ hyscan_control_proxy_source_free (gpointer data)
   guint i;
 
   for (i = 0; i < AQ_BUF_SZ; i++)
-    g_object_unref (buffer->data[i].data);
-  g_object_unref (buffer->signal.image);
+    {
+      g_object_unref (buffer->data[i].data);
+      g_clear_object (&buffer->data[i].data2);
+    }
+  while (!g_queue_is_empty (&buffer->signal.plans))
+    hyscan_control_proxy_plan_free (g_queue_pop_head (&buffer->signal.plans));
+  while (!g_queue_is_empty (&buffer->signal2.plans))
+    hyscan_control_proxy_plan_free (g_queue_pop_head (&buffer->signal2.plans));
   g_object_unref (buffer->signal.conv);
+  g_object_unref (buffer->signal2.conv);
   g_object_unref (buffer->import);
+  g_object_unref (buffer->merge);
   g_mutex_clear (&buffer->signal.lock);
+  g_mutex_clear (&buffer->signal2.lock);
   g_free (buffer->description);
   g_free (buffer->actuator);
 
@@ -665,7 +866,7 @@ hyscan_control_proxy_device_log (HyScanControlProxy *proxy,
   g_snprintf (log->src, LOG_SRC_SZ, "%s", source);
   g_snprintf (log->msg, LOG_MSG_SZ, "%s", message);
 
-  g_cond_signal (&priv->cond);
+  hyscan_control_proxy_wakeup (proxy);
 }
 
 /* Функция запоминает параметры акустичсеких данных. */
@@ -680,13 +881,21 @@ hyscan_control_proxy_sonar_source_info (HyScanControlProxy     *proxy,
   HyScanControlProxyPrivate *priv = proxy->priv;
   HyScanControlProxyAcoustic *buffer;
 
-  if (channel != 1)
+  if ((channel != 1) && ((source != HYSCAN_SOURCE_FORWARD_LOOK) || (channel != 2)))
     return;
 
   buffer = g_hash_table_lookup (priv->sources, GINT_TO_POINTER (source));
   if (buffer == NULL)
     return;
 
+  /* Для второго канала вперёдсмотрящего локатора запоминаем
+   * только параметры данных. */
+  if (channel == 2)
+    {
+      buffer->info2 = *info;
+      return;
+    }
+
   g_free (buffer->description);
   g_free (buffer->actuator);
 
@@ -705,27 +914,40 @@ hyscan_control_proxy_sonar_signal (HyScanControlProxy *proxy,
 {
   HyScanControlProxyPrivate *priv = proxy->priv;
   HyScanControlProxyAcoustic *buffer;
+  HyScanControlProxySignal *signal;
+  HyScanControlProxyPlan *plan;
 
-  if (channel != 1)
+  if ((channel != 1) && ((source != HYSCAN_SOURCE_FORWARD_LOOK) || (channel != 2)))
     return;
 
   buffer = g_hash_table_lookup (priv->sources, GINT_TO_POINTER (source));
   if (buffer == NULL)
     return;
 
-  /* Запоминаем новый образ сигнала. */
-  g_mutex_lock (&buffer->signal.lock);
+  signal = (channel == 1) ? &buffer->signal : &buffer->signal2;
+
+  /* Здесь только копируем образ сигнала. Объект свёртки подготавливается
+   * в потоке отправки, чтобы не задерживать поток драйвера. */
+  plan = g_slice_new0 (HyScanControlProxyPlan);
+  plan->time = time;
 
-  buffer->signal.time = time;
   if (image != NULL)
-    hyscan_buffer_copy (buffer->signal.image, image);
-  else
-    hyscan_buffer_set_complex_float (buffer->signal.image, NULL, 0);
+    {
+      plan->image = hyscan_buffer_new ();
+      if (!hyscan_buffer_import (plan->image, image))
+        g_clear_object (&plan->image);
+    }
 
-  g_mutex_unlock (&buffer->signal.lock);
+  /* Ставим образ в очередь, он заменит текущий при обработке первой
+   * строки с меткой времени не меньше времени начала действия сигнала. */
+  g_mutex_lock (&signal->lock);
+  hyscan_control_proxy_plan_push (&signal->plans, plan, signal->time);
+  g_mutex_unlock (&signal->lock);
 
   /* Отправляем на обработку данные накапливаемые сейчас. */
   g_atomic_int_set (&buffer->send, TRUE);
+
+  hyscan_control_proxy_wakeup (proxy);
 }
 
 /* Функция запоминает акустические данные. */
@@ -741,18 +963,63 @@ hyscan_control_proxy_sonar_acoustic_data (HyScanControlProxy     *proxy,
   HyScanControlProxyData *acoustic = NULL;
   HyScanControlProxyAcoustic *buffer;
   HyScanDiscretizationType discretization;
+  gboolean forward_look;
   guint32 i;
 
-  if (source == HYSCAN_SOURCE_FORWARD_LOOK)
+  forward_look = (source == HYSCAN_SOURCE_FORWARD_LOOK);
+
+  if (noise)
     return;
 
-  if ((channel != 1) || noise)
+  if ((channel != 1) && (!forward_look || (channel != 2)))
     return;
 
   buffer = g_hash_table_lookup (priv->sources, GINT_TO_POINTER (source));
   if ((buffer == NULL) || (!g_atomic_int_get (&buffer->enable)))
     return;
 
+  /* Данные второго канала вперёдсмотрящего локатора дополняют
+   * строку первого канала с такой же меткой времени. */
+  if (channel == 2)
+    {
+      if (buffer->info2.data_type != hyscan_buffer_get_data_type (data))
+        return;
+
+      for (i = 0; i < AQ_BUF_SZ; i++)
+        {
+          acoustic = &buffer->data[i];
+
+          if ((g_atomic_int_get (&acoustic->status) != HYSCAN_CONTROL_PROXY_PAIRING) ||
+              (acoustic->time != time))
+            {
+              continue;
+            }
+
+          if (!hyscan_buffer_import (acoustic->data2, data))
+            {
+              g_atomic_int_set (&acoustic->status, HYSCAN_CONTROL_PROXY_EMPTY);
+              return;
+            }
+
+          g_atomic_int_set (&acoustic->status, HYSCAN_CONTROL_PROXY_PROCESS);
+          hyscan_control_proxy_wakeup (proxy);
+
+          return;
+        }
+
+      /* Строка первого канала с такой меткой времени ещё не принята. Пара
+       * потеряна, строка первого канала будет отброшена сразу при приёме.
+       * Строки первого канала, пропущенные при прореживании или отброшенные
+       * ранее, уже учтены. */
+      if (time > buffer->last_time)
+        {
+          buffer->orphan_time = time;
+          buffer->dropped += 1;
+        }
+
+      return;
+    }
+
   if (buffer->info.data_type != hyscan_buffer_get_data_type (data))
     return;
 
@@ -763,10 +1030,43 @@ hyscan_control_proxy_sonar_acoustic_data (HyScanControlProxy     *proxy,
       return;
     }
 
+  /* Вперёдсмотрящий локатор обрабатывается только для комплексных данных. */
+  if (forward_look)
+    {
+      if (discretization != HYSCAN_DISCRETIZATION_COMPLEX)
+        return;
+
+      buffer->last_time = time;
+
+      /* Данные второго канала пришли раньше и уже учтены как потерянные. */
+      if (time == buffer->orphan_time)
+        {
+          buffer->received += 1;
+          return;
+        }
+
+      /* Строки, для которых не пришли данные второго канала, отбрасываем. */
+      for (i = 0; i < AQ_BUF_SZ; i++)
+        {
+          if (g_atomic_int_compare_and_exchange (&buffer->data[i].status,
+                                                 HYSCAN_CONTROL_PROXY_PAIRING,
+                                                 HYSCAN_CONTROL_PROXY_EMPTY))
+            {
+              buffer->dropped += 1;
+            }
+        }
+    }
+
   buffer->received += 1;
   buffer->line_counter += 1;
-  if (buffer->line_counter < buffer->cur_line_scale)
-    return;
+
+  /* При объединении строк на обработку передаются все строки. Строки
+   * вперёдсмотрящего локатора не объединяются. */
+  if ((forward_look || (buffer->cur_line_reduce == HYSCAN_CONTROL_PROXY_REDUCE_SKIP)) &&
+      (buffer->line_counter < (guint)g_atomic_int_get (&buffer->line_scale)))
+    {
+      return;
+    }
 
   /* Ищем пустой буфер. */
   for (i = 0; i < AQ_BUF_SZ; i++)
@@ -794,9 +1094,16 @@ hyscan_control_proxy_sonar_acoustic_data (HyScanControlProxy     *proxy,
   buffer->line_counter = 0;
   acoustic->time = time;
 
+  /* Строка вперёдсмотрящего локатора ожидает данные второго канала. */
+  if (forward_look)
+    {
+      g_atomic_int_set (&acoustic->status, HYSCAN_CONTROL_PROXY_PAIRING);
+      return;
+    }
+
   /* Сигнализируем об обработке. */
   g_atomic_int_set (&acoustic->status, HYSCAN_CONTROL_PROXY_PROCESS);
-  g_cond_signal (&priv->cond);
+  hyscan_control_proxy_wakeup (proxy);
 }
 
 /* Функция запоминает данные датчиков. */
@@ -827,7 +1134,314 @@ hyscan_control_proxy_sensor_data (HyScanControlProxy *proxy,
   hyscan_buffer_copy (buffer->data, data);
   g_atomic_int_set (&buffer->status, HYSCAN_CONTROL_PROXY_PROCESS);
 
-  g_cond_signal (&priv->cond);
+  hyscan_control_proxy_wakeup (proxy);
+}
+
+/* Функция отправляет обработанную строку акустических данных. */
+static void
+hyscan_control_proxy_send_acoustic (HyScanControlProxy         *proxy,
+                                    HyScanSourceType            source,
+                                    HyScanControlProxyAcoustic *buffer,
+                                    gint64                      time,
+                                    HyScanBuffer               *amplitude,
+                                    HyScanBuffer               *export)
+{
+  HyScanControlProxyPrivate *priv = proxy->priv;
+  HyScanAcousticDataInfo info;
+
+  /* Отправляем данные только в рабочем режиме. */
+  if (!g_atomic_int_get (&priv->started))
+    return;
+
+  if (!hyscan_buffer_export (amplitude, export, buffer->cur_data_type))
+    return;
+
+  info = buffer->info;
+  info.data_rate /= buffer->cur_point_scale;
+  info.data_type = buffer->cur_data_type;
+
+  if (buffer->send_info)
+    {
+      hyscan_sonar_driver_send_source_info (proxy, source, 1,
+                                            buffer->description,
+                                            buffer->actuator,
+                                            &info);
+
+      buffer->send_info = FALSE;
+    }
+
+  hyscan_sonar_driver_send_acoustic_data (proxy, source, 1, FALSE, time, export);
+  hyscan_control_proxy_ring_write (proxy, source, 1, time, info.data_rate, export);
+}
+
+/* Функция записывает обработанную строку в буфер разделяемой памяти. */
+static void
+hyscan_control_proxy_ring_write (HyScanControlProxy *proxy,
+                                 HyScanSourceType    source,
+                                 guint               channel,
+                                 gint64              time,
+                                 gdouble             data_rate,
+                                 HyScanBuffer       *data)
+{
+  HyScanControlProxyPrivate *priv = proxy->priv;
+
+  if (g_atomic_pointer_get (&priv->ring) == NULL)
+    return;
+
+  g_mutex_lock (&priv->ring_lock);
+
+  if (priv->ring != NULL)
+    hyscan_shm_ring_write (priv->ring, source, channel, time, data_rate, data);
+
+  g_mutex_unlock (&priv->ring_lock);
+}
+
+/* Функция отправляет обработанные данные вперёдсмотрящего локатора.
+ *
+ * Данные передаются одним потоком в первом канале. Модуль каждого отсчёта
+ * равен амплитуде, а аргумент равен разности фаз между каналами. Второй
+ * канал содержит только параметры антенны, необходимые для расчёта углов.
+ * Для него указывается амплитудный тип данных, который служит признаком
+ * сокращённого потока для #HyScanForwardLookData. Чтобы канал с этими
+ * параметрами был создан при записи, для него передаётся пустой образ
+ * сигнала. Для экономии полосы пропускания, при выборе выходных данных
+ * с разрядностью не более 16 бит, данные передаются в виде комплексных
+ * чисел половинной точности. */
+static void
+hyscan_control_proxy_send_forward_look (HyScanControlProxy         *proxy,
+                                        HyScanControlProxyAcoustic *buffer,
+                                        gint64                      time,
+                                        HyScanBuffer               *data,
+                                        HyScanBuffer               *export)
+{
+  HyScanControlProxyPrivate *priv = proxy->priv;
+  HyScanAcousticDataInfo info1;
+  HyScanAcousticDataInfo info2;
+  HyScanDataType data_type;
+
+  /* Отправляем данные только в рабочем режиме. */
+  if (!g_atomic_int_get (&priv->started))
+    return;
+
+  switch (buffer->cur_data_type)
+    {
+    case HYSCAN_DATA_AMPLITUDE_INT8:
+    case HYSCAN_DATA_AMPLITUDE_INT16LE:
+    case HYSCAN_DATA_AMPLITUDE_FLOAT16LE:
+      data_type = HYSCAN_DATA_COMPLEX_FLOAT16LE;
+      break;
+
+    default:
+      data_type = HYSCAN_DATA_COMPLEX_FLOAT32LE;
+      break;
+    }
+
+  info1 = buffer->info;
+  info1.data_rate /= buffer->cur_point_scale;
+  info1.data_type = data_type;
+
+  info2 = buffer->info2;
+  info2.data_rate /= buffer->cur_point_scale;
+  info2.data_type = HYSCAN_DATA_AMPLITUDE_FLOAT32LE;
+
+  if (buffer->send_info)
+    {
+      hyscan_sonar_driver_send_source_info (proxy, HYSCAN_SOURCE_FORWARD_LOOK, 1,
+                                            buffer->description,
+                                            buffer->actuator,
+                                            &info1);
+
+      hyscan_sonar_driver_send_source_info (proxy, HYSCAN_SOURCE_FORWARD_LOOK, 2,
+                                            buffer->description,
+                                            buffer->actuator,
+                                            &info2);
+
+      hyscan_sonar_driver_send_signal (proxy, HYSCAN_SOURCE_FORWARD_LOOK, 2, time, NULL);
+
+      buffer->send_info = FALSE;
+    }
+
+  if (!hyscan_buffer_export (data, export, data_type))
+    return;
+
+  hyscan_sonar_driver_send_acoustic_data (proxy, HYSCAN_SOURCE_FORWARD_LOOK, 1,
+                                          FALSE, time, export);
+  hyscan_control_proxy_ring_write (proxy, HYSCAN_SOURCE_FORWARD_LOOK, 1,
+                                   time, info1.data_rate, export);
+}
+
+/* Функция создаёт объект свёртки для образа сигнала. */
+static HyScanConvolution *
+hyscan_control_proxy_plan_conv (HyScanBuffer *image)
+{
+  HyScanConvolution *conv = hyscan_convolution_new ();
+  HyScanComplexFloat *points = NULL;
+  guint32 n_points = 0;
+
+  if (image != NULL)
+    points = hyscan_buffer_get_complex_float (image, &n_points);
+  if ((points != NULL) && (n_points > 1))
+    hyscan_convolution_set_image_td (conv, 0, points, n_points);
+
+  return conv;
+}
+
+/* Функция подготавливает объекты свёртки для ожидающих образов сигналов.
+ * Вызывается в потоке отправки при отсутствии данных для обработки, чтобы
+ * к моменту смены сигнала объект свёртки был готов. Подготовка выполняется
+ * без блокировки, поэтому образ может быть отменён за это время. */
+static void
+hyscan_control_proxy_prepare_signal (HyScanControlProxySignal *signal)
+{
+  while (TRUE)
+    {
+      HyScanControlProxyPlan *plan = NULL;
+      HyScanConvolution *conv;
+      HyScanBuffer *image;
+      GList *link;
+
+      g_mutex_lock (&signal->lock);
+      for (link = signal->plans.head; link != NULL; link = link->next)
+        {
+          plan = link->data;
+          if (plan->conv == NULL)
+            break;
+        }
+      image = (link != NULL) && (plan->image != NULL) ? g_object_ref (plan->image) : NULL;
+      g_mutex_unlock (&signal->lock);
+
+      if (link == NULL)
+        return;
+
+      conv = hyscan_control_proxy_plan_conv (image);
+
+      /* Пока создавался объект свёртки, образ мог быть отменён. */
+      g_mutex_lock (&signal->lock);
+      if ((g_queue_find (&signal->plans, plan) != NULL) &&
+          (plan->image == image) && (plan->conv == NULL))
+        {
+          plan->conv = conv;
+          conv = NULL;
+        }
+      g_mutex_unlock (&signal->lock);
+
+      g_clear_object (&conv);
+      g_clear_object (&image);
+    }
+}
+
+/* Функция заменяет объект свёртки, если сигнал изменился до момента времени
+ * обрабатываемых данных. Если таких сигналов несколько, используется
+ * последний из них. Объект свёртки, не подготовленный заранее, создаётся
+ * здесь. */
+static gboolean
+hyscan_control_proxy_update_signal (HyScanControlProxySignal *signal,
+                                    gint64                    time)
+{
+  HyScanControlProxyPlan *plan;
+
+  g_mutex_lock (&signal->lock);
+  plan = hyscan_control_proxy_plan_select (&signal->plans, time);
+  signal->time = time;
+  g_mutex_unlock (&signal->lock);
+
+  if (plan == NULL)
+    return FALSE;
+
+  /* Меняем текущий объект свёртки. */
+  g_object_unref (signal->conv);
+  if (plan->conv != NULL)
+    {
+      signal->conv = plan->conv;
+      plan->conv = NULL;
+    }
+  else
+    {
+      signal->conv = hyscan_control_proxy_plan_conv (plan->image);
+    }
+
+  hyscan_control_proxy_plan_free (plan);
+
+  return TRUE;
+}
+
+/* Функция корректирует прореживание по строкам в автоматическом режиме.
+ *
+ * Оценка нагрузки производится на интервале AUTO_SCALE_PERIOD по доле
+ * строк, отброшенных из-за переполнения буферов, и по доле времени,
+ * затраченного на обработку и отправку строк. Новое значение коэффициента
+ * определяется функцией hyscan_control_proxy_scale_update. Прореживание
+ * по точкам не изменяется, так как оно определяет частоту дискретизации
+ * данных, которая не может меняться в пределах галса.
+ *
+ * Коэффициент читается в потоке приёма данных, поэтому изменяется
+ * атомарно. Значение для ветки статистики обновляется отдельно. */
+static void
+hyscan_control_proxy_auto_scale (HyScanControlProxyAcoustic *buffer,
+                                 gint64                      process_time)
+{
+  gint64 current_time = g_get_monotonic_time ();
+  gint64 received, dropped, period;
+  gdouble drop_ratio, load;
+  guint scale;
+
+  buffer->auto_process += process_time;
+
+  period = current_time - buffer->auto_time;
+  if (period < AUTO_SCALE_PERIOD)
+    return;
+
+  received = buffer->received - buffer->auto_received;
+  dropped = buffer->dropped - buffer->auto_dropped;
+  drop_ratio = (received > 0) ? (gdouble)dropped / received : 0.0;
+  load = (gdouble)buffer->auto_process / period;
+
+  scale = hyscan_control_proxy_scale_update (g_atomic_int_get (&buffer->line_scale),
+                                             buffer->min_line_scale, AQ_MAX_SCALE,
+                                             load, drop_ratio, &buffer->auto_calm);
+
+  g_atomic_int_set (&buffer->line_scale, scale);
+  buffer->cur_line_scale = scale;
+
+  buffer->auto_time = current_time;
+  buffer->auto_received = buffer->received;
+  buffer->auto_dropped = buffer->dropped;
+  buffer->auto_process = 0;
+}
+
+/* Функция завершает объединение строк и отправляет результат. */
+static void
+hyscan_control_proxy_merge_flush (HyScanControlProxy         *proxy,
+                                  HyScanSourceType            source,
+                                  HyScanControlProxyAcoustic *buffer,
+                                  HyScanBuffer               *export)
+{
+  gfloat *merged;
+  gfloat l_scale;
+  guint32 n_points = 0;
+  guint32 i;
+
+  if (buffer->merge_lines == 0)
+    return;
+
+  merged = hyscan_buffer_get_float (buffer->merge, &n_points);
+  l_scale = 1.0f / buffer->merge_lines;
+
+  if (buffer->cur_line_reduce == HYSCAN_CONTROL_PROXY_REDUCE_MEAN)
+    {
+      for (i = 0; i < n_points; i++)
+        merged[i] *= l_scale;
+    }
+  else if (buffer->cur_line_reduce == HYSCAN_CONTROL_PROXY_REDUCE_RMS)
+    {
+      for (i = 0; i < n_points; i++)
+        merged[i] = sqrtf (merged[i] * l_scale);
+    }
+
+  hyscan_control_proxy_send_acoustic (proxy, source, buffer,
+                                      buffer->merge_time, buffer->merge, export);
+
+  buffer->merge_lines = 0;
 }
 
 /* Поток отправки данных. */
@@ -837,24 +1451,35 @@ hyscan_control_proxy_sender (gpointer user_data)
   HyScanControlProxy *proxy = user_data;
   HyScanControlProxyPrivate *priv = proxy->priv;
 
-  HyScanBuffer *ibuffer;
   HyScanBuffer *abuffer;
   HyScanBuffer *sbuffer;
+  HyScanBuffer *xbuffer;
+  HyScanBuffer *fbuffer;
+
+  gboolean busy = FALSE;
 
-  ibuffer = hyscan_buffer_new ();
   abuffer = hyscan_buffer_new ();
   sbuffer = hyscan_buffer_new ();
+  xbuffer = hyscan_buffer_new ();
+  fbuffer = hyscan_buffer_new ();
 
   while (TRUE)
     {
       GHashTableIter iter;
       gpointer key, value;
 
-      gint64 wait_time;
+      /* Ожидаем события или завершения работы. Если на предыдущем проходе
+       * были обработаны данные, сразу проверяем наличие следующих. */
+      if (!busy)
+        {
+          g_mutex_lock (&priv->lock);
+          while (!priv->wakeup && !g_atomic_int_get (&priv->shutdown))
+            g_cond_wait (&priv->cond, &priv->lock);
+          priv->wakeup = FALSE;
+          g_mutex_unlock (&priv->lock);
+        }
 
-      /* Ожидаем события или завершения работы. */
-      wait_time = g_get_monotonic_time () + 100 * G_TIME_SPAN_MILLISECOND;
-      g_cond_wait_until (&priv->cond, &priv->lock, wait_time);
+      busy = FALSE;
 
       /* Завершаем работу. */
       if (g_atomic_int_get (&priv->shutdown))
@@ -915,9 +1540,9 @@ hyscan_control_proxy_sender (gpointer user_data)
 
           HyScanDiscretizationType discretization;
           HyScanControlProxyData *acoustic = NULL;
-          gboolean update_signal = FALSE;
           gboolean send_data = FALSE;
-          gdouble a_scale;
+          gint64 process_time;
+          guint32 a_points = 0;
           guint p_scale;
           guint i;
 
@@ -931,73 +1556,84 @@ hyscan_control_proxy_sender (gpointer user_data)
                 }
             }
 
-          /* Нет данных для обработки. */
+          /* Нет данных для обработки, подготавливаем новые сигналы. */
           if (acoustic == NULL)
-            continue;
-
-          /* Проверяем необходимость изменения образа сигнала. */
-          g_mutex_lock (&buffer->signal.lock);
-
-          if ((buffer->signal.time >= 0) && (acoustic->time >= buffer->signal.time))
             {
-              update_signal = hyscan_buffer_import (ibuffer, buffer->signal.image);
-
-              buffer->signal.time = -1;
+              hyscan_control_proxy_prepare_signal (&buffer->signal);
+              hyscan_control_proxy_prepare_signal (&buffer->signal2);
+              continue;
             }
 
-          g_mutex_unlock (&buffer->signal.lock);
+          busy = TRUE;
+          process_time = g_get_monotonic_time ();
 
-          /* Обновляем текущий образ сигнала. */
-          if (update_signal)
-            {
-              HyScanComplexFloat *image = NULL;
-              guint32 n_points = 0;
-
-              image = hyscan_buffer_get_complex_float (ibuffer, &n_points);
-              if ((image != NULL) && (n_points > 1))
-                hyscan_convolution_set_image_td (buffer->signal.conv, 0, image, n_points);
-              else
-                hyscan_convolution_set_image_td (buffer->signal.conv, 0, NULL, 0);
-            }
+          /* Строки, принятые с предыдущим сигналом, не объединяем с новыми. */
+          if (hyscan_control_proxy_update_signal (&buffer->signal, acoustic->time))
+            hyscan_control_proxy_merge_flush (proxy, source, buffer, sbuffer);
 
           /* Обработка данных. */
           discretization = hyscan_discretization_get_type_by_data (buffer->info.data_type);
 
           /* Коэффициент масштабирования по дальности. */
           p_scale = buffer->cur_point_scale;
-          a_scale = 1.0 / p_scale;
 
-          if (discretization == HYSCAN_DISCRETIZATION_COMPLEX)
+          /* Данные вперёдсмотрящего локатора. */
+          if (source == HYSCAN_SOURCE_FORWARD_LOOK)
+            {
+              HyScanComplexFloat *original1 = NULL;
+              HyScanComplexFloat *original2 = NULL;
+              HyScanComplexFloat *output = NULL;
+              HyScanComplexFloat *cross = NULL;
+              guint32 o_points1 = 0;
+              guint32 o_points2 = 0;
+              guint32 o_points;
+
+              hyscan_control_proxy_update_signal (&buffer->signal2, acoustic->time);
+
+              original1 = hyscan_buffer_get_complex_float (acoustic->data, &o_points1);
+              original2 = hyscan_buffer_get_complex_float (acoustic->data2, &o_points2);
+
+              o_points = MIN (o_points1, o_points2);
+              a_points = o_points / p_scale;
+
+              if ((original1 != NULL) && (original2 != NULL) && (a_points > 0))
+                {
+                  hyscan_convolution_convolve (buffer->signal.conv, 0, original1, o_points1, 10.0);
+                  hyscan_convolution_convolve (buffer->signal2.conv, 0, original2, o_points2, 10.0);
+
+                  hyscan_buffer_set_complex_float (xbuffer, NULL, a_points * p_scale);
+                  hyscan_buffer_set_complex_float (fbuffer, NULL, a_points);
+                  cross = hyscan_buffer_get_complex_float (xbuffer, &o_points);
+                  output = hyscan_buffer_get_complex_float (fbuffer, &a_points);
+
+                  hyscan_control_proxy_reduce_doa (original1, original2, cross,
+                                                   output, a_points, p_scale,
+                                                   FL_ANGLE_BINS / buffer->cur_angle_scale,
+                                                   buffer->cur_point_reduce);
+
+                  hyscan_control_proxy_send_forward_look (proxy, buffer, acoustic->time,
+                                                          fbuffer, sbuffer);
+                }
+            }
+
+          else if (discretization == HYSCAN_DISCRETIZATION_COMPLEX)
             {
               HyScanComplexFloat *original = NULL;
               gfloat *amplitude = NULL;
               guint32 o_points = 0;
-              guint32 a_points = 0;
-              guint32 i, j, k;
 
               original = hyscan_buffer_get_complex_float (acoustic->data, &o_points);
               hyscan_convolution_convolve (buffer->signal.conv, 0, original, o_points, 10.0);
 
-              /* Вычисление амплитуды с усреднением. */
+              /* Вычисление амплитуды с прореживанием. */
               a_points = o_points / p_scale;
               hyscan_buffer_set_float (abuffer, NULL, a_points);
               amplitude = hyscan_buffer_get_float (abuffer, &a_points);
 
-              for (i = 0, j = 0; (i < o_points) && (j < a_points); j++)
-                {
-                  amplitude[j] = 0.0;
-
-                  for (k = 0; (i < o_points) && (k < p_scale); i++, k++)
-                    {
-                      gfloat re = original[i].re;
-                      gfloat im = original[i].im;
-                      amplitude[j] += sqrtf (re * re + im * im);
-                    }
-
-                  amplitude[j] *= a_scale;
-                }
+              hyscan_control_proxy_reduce_complex (original, amplitude, a_points,
+                                                   p_scale, buffer->cur_point_reduce);
 
-              send_data = TRUE;
+              send_data = (a_points > 0);
             }
 
           else if (discretization == HYSCAN_DISCRETIZATION_AMPLITUDE)
@@ -1005,58 +1641,74 @@ hyscan_control_proxy_sender (gpointer user_data)
               gfloat *original = NULL;
               gfloat *amplitude = NULL;
               guint32 o_points = 0;
-              guint32 a_points = 0;
-              guint32 i, j, k;
 
-              /* Усреднение амплитуды. */
+              /* Прореживание амплитуды. */
               original = hyscan_buffer_get_float (acoustic->data, &o_points);
               a_points = o_points / p_scale;
               hyscan_buffer_set_float (abuffer, NULL, a_points);
               amplitude = hyscan_buffer_get_float (abuffer, &a_points);
 
-              for (i = 0, j = 0; (i < o_points) && (j < a_points); j++)
-                {
-                  amplitude[j] = 0.0;
-
-                  for (k = 0; (i < o_points) && (k < p_scale); i++, k++)
-                    amplitude[j] += original[i];
+              hyscan_control_proxy_reduce_amplitude (original, amplitude, a_points,
+                                                     p_scale, buffer->cur_point_reduce);
 
-                  amplitude[j] *= a_scale;
-                }
+              send_data = (a_points > 0);
+            }
 
-              send_data = TRUE;
+          /* Отправляем строку без объединения. */
+          if (send_data && (buffer->cur_line_reduce == HYSCAN_CONTROL_PROXY_REDUCE_SKIP))
+            {
+              hyscan_control_proxy_send_acoustic (proxy, source, buffer,
+                                                  acoustic->time, abuffer, sbuffer);
             }
 
-          /* Отправляем данные только в рабочем режиме. */
-          if (send_data && g_atomic_int_get (&priv->started) &&
-              hyscan_buffer_export (abuffer, sbuffer, buffer->cur_data_type))
+          /* Объединяем строки. */
+          else if (send_data)
             {
-              HyScanAcousticDataInfo info = buffer->info;
+              gfloat *amplitude;
+              gfloat *merged;
+              guint32 m_points = 0;
 
-              info.data_rate /= p_scale;
-              info.data_type = buffer->cur_data_type;
+              amplitude = hyscan_buffer_get_float (abuffer, &a_points);
+              merged = hyscan_buffer_get_float (buffer->merge, &m_points);
 
-              if (buffer->send_info)
-                {
-                  hyscan_sonar_driver_send_source_info (proxy, source, 1,
-                                                        buffer->description,
-                                                        buffer->actuator,
-                                                        &info);
+              /* Строки разной длины не объединяем. */
+              if (m_points != a_points)
+                hyscan_control_proxy_merge_flush (proxy, source, buffer, sbuffer);
 
-                  buffer->send_info = FALSE;
+              if (buffer->merge_lines == 0)
+                {
+                  hyscan_buffer_set_float (buffer->merge, NULL, a_points);
+                  merged = hyscan_buffer_get_float (buffer->merge, &m_points);
+                  memset (merged, 0, m_points * sizeof (gfloat));
                 }
 
-              hyscan_sonar_driver_send_acoustic_data (proxy, source, 1, FALSE,
-                                                      acoustic->time, sbuffer);
+              hyscan_control_proxy_merge_line (merged, amplitude, m_points,
+                                               buffer->cur_line_reduce);
+
+              buffer->merge_lines += 1;
+              buffer->merge_time = acoustic->time;
+
+              if (buffer->merge_lines >= (guint)g_atomic_int_get (&buffer->line_scale))
+                hyscan_control_proxy_merge_flush (proxy, source, buffer, sbuffer);
+            }
+
+          /* Корректируем прореживание по нагрузке. При объединении строк
+           * обрабатываются все принятые строки, поэтому автоматическое
+           * прореживание для этого режима не включается. */
+          if (buffer->cur_auto_scale)
+            {
+              process_time = g_get_monotonic_time () - process_time;
+              hyscan_control_proxy_auto_scale (buffer, process_time);
             }
 
           g_atomic_int_set (&acoustic->status, HYSCAN_CONTROL_PROXY_EMPTY);
         }
     }
 
-  g_object_unref (ibuffer);
   g_object_unref (abuffer);
   g_object_unref (sbuffer);
+  g_object_unref (xbuffer);
+  g_object_unref (fbuffer);
 
   return NULL;
 }
@@ -1311,7 +1963,20 @@ hyscan_control_proxy_sonar_start (HyScanSonar           *sonar,
 
           buffer->cur_data_type = buffer->new_data_type;
           buffer->cur_line_scale = buffer->new_line_scale;
+          g_atomic_int_set (&buffer->line_scale, buffer->new_line_scale);
           buffer->cur_point_scale = buffer->new_point_scale;
+          buffer->cur_line_reduce = buffer->new_line_reduce;
+          buffer->cur_point_reduce = buffer->new_point_reduce;
+          buffer->cur_angle_scale = buffer->new_angle_scale;
+          buffer->cur_auto_scale = buffer->new_auto_scale &&
+                                   ((GPOINTER_TO_INT (key) == HYSCAN_SOURCE_FORWARD_LOOK) ||
+                                    (buffer->new_line_reduce == HYSCAN_CONTROL_PROXY_REDUCE_SKIP));
+          buffer->min_line_scale = buffer->new_line_scale;
+          buffer->auto_time = g_get_monotonic_time ();
+          buffer->auto_received = buffer->received;
+          buffer->auto_dropped = buffer->dropped;
+          buffer->auto_process = 0;
+          buffer->auto_calm = 0;
         }
     }
 
@@ -1366,12 +2031,17 @@ hyscan_control_proxy_sonar_stop (HyScanSonar *sonar)
 
           for (i = 0; i < AQ_BUF_SZ; i++)
             {
+              /* Строки, не дождавшиеся второго канала, освобождаем сразу. */
+              g_atomic_int_compare_and_exchange (&buffer->data[i].status,
+                                                 HYSCAN_CONTROL_PROXY_PAIRING,
+                                                 HYSCAN_CONTROL_PROXY_EMPTY);
+
               if (g_atomic_int_get (&buffer->data[i].status) != HYSCAN_CONTROL_PROXY_EMPTY)
                 goto wait_for_empty;
             }
 
           buffer->line_counter = 0;
-          buffer->signal.time = -1;
+          buffer->merge_lines = 0;
           buffer->send_info = TRUE;
         }
 
@@ -1522,6 +2192,135 @@ hyscan_control_proxy_set_scale (HyScanControlProxy *proxy,
   buffer->new_point_scale = point_scale;
 }
 
+/**
+ * hyscan_control_proxy_set_reduce:
+ * @proxy: указатель на #HyScanControlProxy
+ * @source: источник гидролокационных данных
+ * @line_reduce: способ объединения строк
+ * @point_reduce: способ объединения точек в строке
+ *
+ * Функция задаёт способы объединения данных при прореживании. По умолчанию
+ * строки прореживаются без объединения, а точки усредняются. Если задать
+ * способ объединения строк отличный от #HYSCAN_CONTROL_PROXY_REDUCE_SKIP,
+ * строки не пропускаются, а объединяются в группы по числу строк, заданному
+ * коэффициентом прореживания. Новые значения применяются после остановки
+ * и запуска устройства.
+ */
+void
+hyscan_control_proxy_set_reduce (HyScanControlProxy       *proxy,
+                                 HyScanSourceType          source,
+                                 HyScanControlProxyReduce  line_reduce,
+                                 HyScanControlProxyReduce  point_reduce)
+{
+  HyScanControlProxyAcoustic *buffer;
+
+  g_return_if_fail (HYSCAN_IS_CONTROL_PROXY (proxy));
+
+  line_reduce = CLAMP (line_reduce, HYSCAN_CONTROL_PROXY_REDUCE_SKIP, HYSCAN_CONTROL_PROXY_REDUCE_RMS);
+  point_reduce = CLAMP (point_reduce, HYSCAN_CONTROL_PROXY_REDUCE_SKIP, HYSCAN_CONTROL_PROXY_REDUCE_RMS);
+
+  buffer = g_hash_table_lookup (proxy->priv->sources, GINT_TO_POINTER (source));
+  if (buffer == NULL)
+    return;
+
+  buffer->new_line_reduce = line_reduce;
+  buffer->new_point_reduce = point_reduce;
+}
+
+/**
+ * hyscan_control_proxy_set_angle_scale:
+ * @proxy: указатель на #HyScanControlProxy
+ * @source: источник гидролокационных данных
+ * @angle_scale: коэффициент прореживания по углу
+ *
+ * Функция задаёт коэффициент прореживания данных вперёдсмотрящего локатора
+ * по углу. Разность фаз между каналами квантуется с шагом 2 * Pi * angle_scale / 512.
+ * Для остальных источников данных функция не имеет эффекта. Новый коэффициент
+ * применяется после остановки и запуска устройства.
+ */
+void
+hyscan_control_proxy_set_angle_scale (HyScanControlProxy *proxy,
+                                      HyScanSourceType    source,
+                                      guint               angle_scale)
+{
+  HyScanControlProxyAcoustic *buffer;
+
+  g_return_if_fail (HYSCAN_IS_CONTROL_PROXY (proxy));
+
+  if (source != HYSCAN_SOURCE_FORWARD_LOOK)
+    return;
+
+  angle_scale = CLAMP (angle_scale, 1, AQ_MAX_SCALE);
+
+  buffer = g_hash_table_lookup (proxy->priv->sources, GINT_TO_POINTER (source));
+  if (buffer == NULL)
+    return;
+
+  buffer->new_angle_scale = angle_scale;
+}
+
+/**
+ * hyscan_control_proxy_set_auto_scale:
+ * @proxy: указатель на #HyScanControlProxy
+ * @source: источник гидролокационных данных
+ * @enable: признак автоматического прореживания
+ *
+ * Функция включает или выключает автоматическое прореживание по строкам.
+ * В автоматическом режиме коэффициент прореживания по строкам изменяется
+ * в зависимости от доли потерянных строк и времени их обработки, в пределах
+ * от значения, заданного функцией #hyscan_control_proxy_set_scale, до
+ * максимально допустимого. Действующий коэффициент публикуется в ветке
+ * статистики. Новое значение применяется после остановки и запуска
+ * устройства.
+ *
+ * Автоматическое прореживание действует только при прореживании строк без
+ * объединения. При объединении строк обрабатываются все принятые строки и
+ * увеличение коэффициента не снижает нагрузку, поэтому в этом режиме
+ * коэффициент остаётся равным заданному.
+ */
+void
+hyscan_control_proxy_set_auto_scale (HyScanControlProxy *proxy,
+                                     HyScanSourceType    source,
+                                     gboolean            enable)
+{
+  HyScanControlProxyAcoustic *buffer;
+
+  g_return_if_fail (HYSCAN_IS_CONTROL_PROXY (proxy));
+
+  buffer = g_hash_table_lookup (proxy->priv->sources, GINT_TO_POINTER (source));
+  if (buffer == NULL)
+    return;
+
+  buffer->new_auto_scale = enable;
+}
+
+/**
+ * hyscan_control_proxy_set_shm_ring:
+ * @proxy: указатель на #HyScanControlProxy
+ * @ring: (nullable): кольцевой буфер #HyScanShmRing или NULL
+ *
+ * Функция задаёт кольцевой буфер в разделяемой памяти, в который, помимо
+ * отправки через #HyScanSonarDriver, записываются все обработанные строки
+ * гидролокационных данных. Буфер должен быть создан функцией
+ * #hyscan_shm_ring_create. Для отключения экспорта необходимо передать NULL.
+ */
+void
+hyscan_control_proxy_set_shm_ring (HyScanControlProxy *proxy,
+                                   HyScanShmRing      *ring)
+{
+  HyScanControlProxyPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_CONTROL_PROXY (proxy));
+  g_return_if_fail ((ring == NULL) || HYSCAN_IS_SHM_RING (ring));
+
+  priv = proxy->priv;
+
+  g_mutex_lock (&priv->ring_lock);
+  g_clear_object (&priv->ring);
+  priv->ring = (ring != NULL) ? g_object_ref (ring) : NULL;
+  g_mutex_unlock (&priv->ring_lock);
+}
+
 /**
  * hyscan_control_proxy_set_data_type:
  * @proxy: указатель на #HyScanControlProxy
@@ -36,6 +36,7 @@
 #define __HYSCAN_CONTROL_PROXY_H__
 
 #include <hyscan-control.h>
+#include <hyscan-shm-ring.h>
 
 G_BEGIN_DECLS
 
@@ -46,6 +47,23 @@ G_BEGIN_DECLS
 #define HYSCAN_IS_CONTROL_PROXY_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_CONTROL_PROXY))
 #define HYSCAN_CONTROL_PROXY_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_CONTROL_PROXY, HyScanControlProxyClass))
 
+/**
+ * HyScanControlProxyReduce:
+ * @HYSCAN_CONTROL_PROXY_REDUCE_SKIP: прореживание без объединения отсчётов
+ * @HYSCAN_CONTROL_PROXY_REDUCE_MEAN: среднее значение амплитуды
+ * @HYSCAN_CONTROL_PROXY_REDUCE_MAX: максимальное значение амплитуды
+ * @HYSCAN_CONTROL_PROXY_REDUCE_RMS: среднеквадратичное значение амплитуды
+ *
+ * Способ объединения отсчётов и строк при прореживании данных.
+ */
+typedef enum
+{
+  HYSCAN_CONTROL_PROXY_REDUCE_SKIP,
+  HYSCAN_CONTROL_PROXY_REDUCE_MEAN,
+  HYSCAN_CONTROL_PROXY_REDUCE_MAX,
+  HYSCAN_CONTROL_PROXY_REDUCE_RMS
+} HyScanControlProxyReduce;
+
 typedef struct _HyScanControlProxy HyScanControlProxy;
 typedef struct _HyScanControlProxyPrivate HyScanControlProxyPrivate;
 typedef struct _HyScanControlProxyClass HyScanControlProxyClass;
@@ -75,6 +93,26 @@ void                               hyscan_control_proxy_set_scale         (HySca
                                                                            guint                           line_scale,
                                                                            guint                           point_scale);
 
+HYSCAN_API
+void                               hyscan_control_proxy_set_reduce        (HyScanControlProxy             *proxy,
+                                                                           HyScanSourceType                source,
+                                                                           HyScanControlProxyReduce        line_reduce,
+                                                                           HyScanControlProxyReduce        point_reduce);
+
+HYSCAN_API
+void                               hyscan_control_proxy_set_auto_scale    (HyScanControlProxy             *proxy,
+                                                                           HyScanSourceType                source,
+                                                                           gboolean                        enable);
+
+HYSCAN_API
+void                               hyscan_control_proxy_set_angle_scale   (HyScanControlProxy             *proxy,
+                                                                           HyScanSourceType                source,
+                                                                           guint                           angle_scale);
+
+HYSCAN_API
+void                               hyscan_control_proxy_set_shm_ring      (HyScanControlProxy             *proxy,
+                                                                           HyScanShmRing                  *ring);
+
 HYSCAN_API
 void                               hyscan_control_proxy_set_data_type     (HyScanControlProxy             *proxy,
                                                                            HyScanSourceType                source,
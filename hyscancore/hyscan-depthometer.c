@@ -43,6 +43,31 @@
  * не знает о конкретных источниках данных. Однако он занимается определением глубины не для
  * индекса, а для произвольного времени.
  *
+ * Глубина определяется как среднее значение по окну из нескольких записей
+ * слева и справа от запрошенного момента времени. Класс хранит последнее
+ * окно значений и их сумму, поэтому при последовательных запросах с
+ * возрастающим временем окно сдвигается: из источника считываются только
+ * новые записи, а сумма обновляется без повторного суммирования. Для
+ * упорядоченного по возрастанию массива моментов времени предназначена
+ * функция #hyscan_depthometer_get_many.
+ *
+ * Вместо среднего можно использовать устойчивые к выбросам фильтры
+ * #HyScanDepthometerFilter: медиану окна или фильтр Хампеля, заменяющий на
+ * медиану значения, отклоняющиеся от неё более чем на три оценки
+ * стандартного отклонения по медиане абсолютных отклонений (MAD). Для этих
+ * фильтров значения окна дополнительно хранятся упорядоченными, массив
+ * обновляется при сдвиге окна вставкой и удалением с двоичным поиском.
+ *
+ * Для отображения галса целиком удобнее заранее рассчитать профиль глубины
+ * #HyScanDepthProfile функцией #hyscan_depthometer_get_profile. Глубина
+ * зависит только от того, между какими записями находится запрошенный
+ * момент времени, поэтому профиль хранит для каждой записи значение в момент
+ * записи и значение на интервале до следующей записи. Расчёт выполняется за
+ * один проход скользящего окна, а при появлении новых записей пересчитываются
+ * только последние значения. Запрос к профилю - это двоичный поиск по
+ * массиву в памяти. Профиль не изменяется после создания, поэтому может
+ * одновременно использоваться из нескольких потоков.
+ *
  * Класс не является потокобезопасным. Для работы из разных потоков следует
  * создавать как объект HyScanDepthometer, так и интерфейс HyScanNavData.
  */
@@ -51,6 +76,11 @@
 #include <math.h>
 #include <string.h>
 
+#define WINDOW_SUM_REFRESH     1024          /* Число сдвигов окна между пересчётами суммы. */
+#define HAMPEL_THRESHOLD       3.0           /* Порог фильтра Хампеля в стандартных отклонениях. */
+#define MAD_TO_SIGMA           1.4826        /* Отношение СКО к MAD для нормального распределения. */
+#define N_EXTRAS               3             /* Число дополнительных значений окна. */
+
 enum
 {
   PROP_O,
@@ -66,12 +96,43 @@ struct _HyScanDepthometerPrivate
   gint          key_length;       /* Длина ключа. */
   HyScanBuffer *cache_buffer;     /* Буфер данных кэша. */
 
-  guint32      *indexes;          /* Массив индексов. */
+  gdouble      *values;           /* Массив значений. */
   gint          real_size;        /* Размер массива. */
   gint          size;             /* Количество точек для аппроксимации. */
+  HyScanDepthometerFilter filter; /* Тип фильтра. */
+
+  gdouble      *window;           /* Кольцевой буфер значений окна. */
+  guint32       window_head;      /* Положение первого значения в буфере. */
+  guint32       window_first;     /* Индекс первого значения окна. */
+  guint32       window_count;     /* Число значений в окне. */
+  gdouble       window_sum;       /* Сумма значений окна. */
+  guint32       window_source;    /* Первый индекс источника при заполнении окна. */
+  guint         window_updates;   /* Число сдвигов окна с последнего пересчёта суммы. */
+  gdouble      *sorted;           /* Упорядоченные значения окна. */
 
   gint64        valid;            /* Окно валидности в мкс. */
   gint64        half_valid;       /* Половина окна валидности. */
+
+  HyScanDepthProfile *profile;    /* Профиль глубины. */
+};
+
+/* Профиль глубины. Не изменяется после создания. */
+struct _HyScanDepthProfile
+{
+  volatile gint           ref_count;     /* Счётчик ссылок. */
+
+  gint64                  valid;         /* Окно валидности. */
+  gint64                  half_valid;    /* Половина окна валидности. */
+  gint                    size;          /* Размер фильтра. */
+  HyScanDepthometerFilter filter;        /* Тип фильтра. */
+
+  guint32                 first;         /* Первый индекс источника. */
+  guint32                 mod_count;     /* Счётчик изменений источника. */
+
+  guint32                 n_points;      /* Число записей. */
+  gint64                 *times;         /* Метки времени записей. */
+  gdouble                *exact;         /* Глубина в момент записи. */
+  gdouble                *between;       /* Глубина до следующей записи. */
 };
 
 static void    hyscan_depthometer_set_property             (GObject               *object,
@@ -85,8 +146,45 @@ static gint64  hyscan_depthometer_time_round               (gint64
                                                             gint64                 half);
 static void    hyscan_depthometer_update_cache_key         (HyScanDepthometer     *depthometer,
                                                             gint64                 time);
+static gdouble hyscan_depthometer_window_value             (HyScanDepthometerPrivate *priv,
+                                                            guint32                index);
+static gboolean hyscan_depthometer_window_move             (HyScanDepthometerPrivate *priv,
+                                                            guint32                source_first,
+                                                            guint32                first,
+                                                            guint32                last);
+static void    hyscan_depthometer_sorted_insert            (HyScanDepthometerPrivate *priv,
+                                                            gdouble                value);
+static void    hyscan_depthometer_sorted_remove            (HyScanDepthometerPrivate *priv,
+                                                            gdouble                value);
+static gdouble hyscan_depthometer_kth                      (HyScanDepthometerPrivate *priv,
+                                                            const gdouble         *extras,
+                                                            const gint            *counts,
+                                                            gint                   k);
+static gdouble hyscan_depthometer_hampel                   (HyScanDepthometerPrivate *priv,
+                                                            const gdouble         *extras,
+                                                            const gint            *counts);
+static gboolean hyscan_depthometer_filter                  (HyScanDepthometerPrivate *priv,
+                                                            guint32                first,
+                                                            guint32                last,
+                                                            guint32                lindex,
+                                                            guint32                rindex,
+                                                            gdouble               *depth);
+static HyScanDepthProfile *
+               hyscan_depthometer_profile_new              (HyScanDepthometerPrivate *priv,
+                                                            guint32                first,
+                                                            guint32                n_points,
+                                                            guint32                mod_count);
+static gboolean hyscan_depthometer_profile_valid           (HyScanDepthometerPrivate *priv,
+                                                            HyScanDepthProfile    *profile);
+static gboolean hyscan_depthometer_compute                 (HyScanDepthometerPrivate *priv,
+                                                            gint64                 time,
+                                                            gdouble               *depth,
+                                                            gint64                *ltime,
+                                                            gint64                *rtime);
 
 G_DEFINE_TYPE_WITH_PRIVATE (HyScanDepthometer, hyscan_depthometer, G_TYPE_OBJECT);
+G_DEFINE_BOXED_TYPE (HyScanDepthProfile, hyscan_depth_profile,
+                     hyscan_depth_profile_ref, hyscan_depth_profile_unref);
 
 static void
 hyscan_depthometer_class_init (HyScanDepthometerClass *klass)
@@ -144,7 +242,9 @@ hyscan_depthometer_object_constructed (GObject *object)
   priv->half_valid = priv->valid / 2;
   priv->size = 2;
   priv->real_size = 2;
-  priv->indexes = g_malloc0 (2 * priv->size * sizeof (guint32));
+  priv->values = g_malloc0 (priv->size * sizeof (gdouble));
+  priv->window = g_malloc0 (priv->size * sizeof (gdouble));
+  priv->sorted = g_malloc0 (priv->size * sizeof (gdouble));
 
   priv->cache_buffer = hyscan_buffer_new ();
 }
@@ -159,7 +259,11 @@ hyscan_depthometer_object_finalize (GObject *object)
   g_clear_object (&priv->source);
   g_clear_object (&priv->cache);
 
-  g_free (priv->indexes);
+  g_free (priv->values);
+  g_free (priv->window);
+  g_free (priv->sorted);
+
+  g_clear_pointer (&priv->profile, hyscan_depth_profile_unref);
 
   g_free (priv->key);
 
@@ -178,13 +282,13 @@ hyscan_depthometer_update_cache_key (HyScanDepthometer *meter,
 
   if (priv->key == NULL)
     {
-      priv->key = g_strdup_printf ("depthometer.%s.%i.%"G_GINT64_FORMAT".%"G_GINT64_FORMAT,
-                                    token, G_MAXINT, G_MAXINT64, G_MAXINT64);
+      priv->key = g_strdup_printf ("depthometer.%s.%i.%i.%"G_GINT64_FORMAT".%"G_GINT64_FORMAT,
+                                    token, G_MAXINT, G_MAXINT, G_MAXINT64, G_MAXINT64);
       priv->key_length = strlen (priv->key);
     }
 
-  g_snprintf (priv->key, priv->key_length, "depthometer.%s.%i.%"G_GINT64_FORMAT".%"G_GINT64_FORMAT,
-              token, priv->size, priv->valid, time);
+  g_snprintf (priv->key, priv->key_length, "depthometer.%s.%i.%i.%"G_GINT64_FORMAT".%"G_GINT64_FORMAT,
+              token, priv->size, priv->filter, priv->valid, time);
 }
 
 /* Функция выравнивания времени по окну валидности. */
@@ -203,6 +307,362 @@ hyscan_depthometer_time_round (gint64 time,
   return out;
 }
 
+/* Функция возвращает значение окна для индекса источника. */
+static inline gdouble
+hyscan_depthometer_window_value (HyScanDepthometerPrivate *priv,
+                                 guint32                   index)
+{
+  return priv->window[(priv->window_head + index - priv->window_first) % priv->real_size];
+}
+
+/* Функция сдвигает окно так, чтобы оно содержало индексы от first до last.
+ * Если новое окно продолжает текущее, считываются только новые значения,
+ * иначе окно заполняется заново. */
+static gboolean
+hyscan_depthometer_window_move (HyScanDepthometerPrivate *priv,
+                                guint32                   source_first,
+                                guint32                   first,
+                                guint32                   last)
+{
+  guint32 end = priv->window_first + priv->window_count;
+  guint32 i, n_read;
+
+  if ((priv->window_count == 0) || (priv->window_source != source_first) ||
+      (first < priv->window_first) || (first > end) || (last + 1 < end))
+    {
+      priv->window_head = 0;
+      priv->window_first = first;
+      priv->window_count = 0;
+      priv->window_sum = 0.0;
+      priv->window_source = source_first;
+      priv->window_updates = 0;
+      end = first;
+    }
+
+  /* Убираем значения слева. */
+  for (; priv->window_first < first; priv->window_first++, priv->window_count--)
+    {
+      priv->window_sum -= priv->window[priv->window_head];
+      if (priv->filter != HYSCAN_DEPTHOMETER_FILTER_MEAN)
+        hyscan_depthometer_sorted_remove (priv, priv->window[priv->window_head]);
+
+      priv->window_head = (priv->window_head + 1) % priv->real_size;
+    }
+
+  if (end > last)
+    return TRUE;
+
+  /* Считываем новые значения справа одним запросом. */
+  n_read = last - end + 1;
+  if (!hyscan_nav_data_get_values (priv->source, end, last, NULL, priv->values))
+    {
+      priv->window_count = 0;
+      return FALSE;
+    }
+
+  for (i = 0; i < n_read; i++, priv->window_count++)
+    {
+      if (priv->filter != HYSCAN_DEPTHOMETER_FILTER_MEAN)
+        hyscan_depthometer_sorted_insert (priv, priv->values[i]);
+
+      priv->window[(priv->window_head + priv->window_count) % priv->real_size] = priv->values[i];
+      priv->window_sum += priv->values[i];
+    }
+
+  /* Периодически пересчитываем сумму, чтобы не накапливалась ошибка. */
+  if (++priv->window_updates >= WINDOW_SUM_REFRESH)
+    {
+      priv->window_sum = 0.0;
+      for (i = 0; i < priv->window_count; i++)
+        priv->window_sum += priv->window[(priv->window_head + i) % priv->real_size];
+
+      priv->window_updates = 0;
+    }
+
+  return TRUE;
+}
+
+/* Функция вставляет значение в упорядоченный массив окна. Массив содержит
+ * window_count значений. */
+static void
+hyscan_depthometer_sorted_insert (HyScanDepthometerPrivate *priv,
+                                  gdouble                   value)
+{
+  guint32 l = 0, r = priv->window_count;
+
+  while (l < r)
+    {
+      guint32 m = l + (r - l) / 2;
+
+      if (priv->sorted[m] < value)
+        l = m + 1;
+      else
+        r = m;
+    }
+
+  memmove (priv->sorted + l + 1, priv->sorted + l, (priv->window_count - l) * sizeof (gdouble));
+  priv->sorted[l] = value;
+}
+
+/* Функция удаляет значение из упорядоченного массива окна. Массив содержит
+ * window_count значений. */
+static void
+hyscan_depthometer_sorted_remove (HyScanDepthometerPrivate *priv,
+                                  gdouble                   value)
+{
+  guint32 l = 0, r = priv->window_count;
+
+  while (l < r)
+    {
+      guint32 m = l + (r - l) / 2;
+
+      if (priv->sorted[m] < value)
+        l = m + 1;
+      else
+        r = m;
+    }
+
+  if (l < priv->window_count)
+    memmove (priv->sorted + l, priv->sorted + l + 1, (priv->window_count - l - 1) * sizeof (gdouble));
+}
+
+/* Функция возвращает k-е по возрастанию значение из объединения окна и
+ * дополнительных значений extras, взятых counts раз. Дополнительные значения
+ * должны быть упорядочены по возрастанию. */
+static gdouble
+hyscan_depthometer_kth (HyScanDepthometerPrivate *priv,
+                        const gdouble            *extras,
+                        const gint               *counts,
+                        gint                      k)
+{
+  gint before = 0;
+  gint i;
+
+  for (i = 0; i < N_EXTRAS; i++)
+    {
+      guint32 l = 0, r = priv->window_count;
+
+      if (counts[i] == 0)
+        continue;
+
+      /* Число значений окна, меньших дополнительного значения. */
+      while (l < r)
+        {
+          guint32 m = l + (r - l) / 2;
+
+          if (priv->sorted[m] < extras[i])
+            l = m + 1;
+          else
+            r = m;
+        }
+
+      if (k < (gint) l + before)
+        return priv->sorted[k - before];
+
+      if (k < (gint) l + before + counts[i])
+        return extras[i];
+
+      before += counts[i];
+    }
+
+  return priv->sorted[k - before];
+}
+
+/* Функция вычисляет среднее значение окна после фильтра Хампеля: значения,
+ * отклоняющиеся от медианы более чем на HAMPEL_THRESHOLD оценок СКО,
+ * заменяются медианой. */
+static gdouble
+hyscan_depthometer_hampel (HyScanDepthometerPrivate *priv,
+                           const gdouble            *extras,
+                           const gint               *counts)
+{
+  gdouble *values = priv->values;
+  gint size = priv->size;
+  gint half = size / 2;
+  gdouble median, mad, threshold, sum;
+  gdouble deviation = 0.0, prev_deviation = 0.0;
+  gint i, j, k, n;
+
+  /* Объединяем окно и дополнительные значения в упорядоченный массив. */
+  for (i = 0, j = 0, n = 0; n < size; )
+    {
+      if ((j < N_EXTRAS) && (counts[j] == 0))
+        {
+          j++;
+        }
+      else if ((j < N_EXTRAS) && ((i >= (gint) priv->window_count) || (extras[j] <= priv->sorted[i])))
+        {
+          for (k = 0; k < counts[j]; k++)
+            values[n++] = extras[j];
+          j++;
+        }
+      else
+        {
+          values[n++] = priv->sorted[i++];
+        }
+    }
+
+  median = 0.5 * (values[half - 1] + values[half]);
+
+  /* Медиана абсолютных отклонений: отклонения слева и справа от медианы
+   * возрастают, поэтому их можно перебирать слиянием. */
+  for (i = half - 1, j = half, k = 0; k <= half; k++)
+    {
+      prev_deviation = deviation;
+
+      if ((j >= size) || ((i >= 0) && (median - values[i] <= values[j] - median)))
+        deviation = median - values[i--];
+      else
+        deviation = values[j++] - median;
+    }
+
+  mad = 0.5 * (prev_deviation + deviation);
+  threshold = HAMPEL_THRESHOLD * MAD_TO_SIGMA * mad;
+
+  for (i = 0, sum = 0.0; i < size; i++)
+    sum += (fabs (values[i] - median) <= threshold) ? values[i] : median;
+
+  return sum / size;
+}
+
+/* Функция вычисляет глубину по окну вокруг индексов lindex и rindex. */
+static gboolean
+hyscan_depthometer_filter (HyScanDepthometerPrivate *priv,
+                           guint32                   first,
+                           guint32                   last,
+                           guint32                   lindex,
+                           guint32                   rindex,
+                           gdouble                  *depth)
+{
+  guint32 lfirst, rlast;
+  gdouble extras[N_EXTRAS];
+  gint counts[N_EXTRAS];
+  gint i, size, half;
+  gdouble sum;
+
+  /* Если нужно, реаллоцируем память под массивы значений. */
+  size = priv->size;
+  half = size / 2;
+  if (size != priv->real_size)
+    {
+      priv->values = g_realloc (priv->values, size * sizeof (gdouble));
+      priv->window = g_realloc (priv->window, size * sizeof (gdouble));
+      priv->sorted = g_realloc (priv->sorted, size * sizeof (gdouble));
+      priv->real_size = size;
+      priv->window_count = 0;
+    }
+
+  /* Окно из half индексов слева и справа от искомого момента времени. */
+  lfirst = (lindex - first >= (guint32) half - 1) ? lindex - (half - 1) : first;
+  rlast = (last - rindex >= (guint32) half - 1) ? rindex + (half - 1) : last;
+
+  if (!hyscan_depthometer_window_move (priv, first, lfirst, rlast))
+    return FALSE;
+
+  /* Индексы за границами данных заменяются крайними, при точном
+   * совпадении времени центральное значение учитывается дважды. */
+  extras[0] = hyscan_depthometer_window_value (priv, lfirst);
+  counts[0] = half - (gint) (lindex - lfirst + 1);
+  extras[1] = hyscan_depthometer_window_value (priv, rlast);
+  counts[1] = half - (gint) (rlast - rindex + 1);
+  extras[2] = hyscan_depthometer_window_value (priv, lindex);
+  counts[2] = (lindex == rindex) ? 1 : 0;
+
+  if (priv->filter == HYSCAN_DEPTHOMETER_FILTER_MEAN)
+    {
+      for (i = 0, sum = priv->window_sum; i < N_EXTRAS; i++)
+        sum += counts[i] * extras[i];
+
+      *depth = sum / size;
+      return TRUE;
+    }
+
+  /* Упорядочиваем дополнительные значения. */
+  for (i = 1; i < N_EXTRAS; i++)
+    {
+      gint j;
+
+      for (j = i; (j > 0) && (extras[j - 1] > extras[j]); j--)
+        {
+          gdouble value = extras[j];
+          gint count = counts[j];
+
+          extras[j] = extras[j - 1];
+          counts[j] = counts[j - 1];
+          extras[j - 1] = value;
+          counts[j - 1] = count;
+        }
+    }
+
+  if (priv->filter == HYSCAN_DEPTHOMETER_FILTER_MEDIAN)
+    {
+      *depth = 0.5 * (hyscan_depthometer_kth (priv, extras, counts, half - 1) +
+                      hyscan_depthometer_kth (priv, extras, counts, half));
+    }
+  else
+    {
+      *depth = hyscan_depthometer_hampel (priv, extras, counts);
+    }
+
+  return TRUE;
+}
+
+/* Функция создаёт пустой профиль для текущих параметров. */
+static HyScanDepthProfile *
+hyscan_depthometer_profile_new (HyScanDepthometerPrivate *priv,
+                                guint32                   first,
+                                guint32                   n_points,
+                                guint32                   mod_count)
+{
+  HyScanDepthProfile *profile = g_slice_new (HyScanDepthProfile);
+
+  profile->ref_count = 1;
+  profile->valid = priv->valid;
+  profile->half_valid = priv->half_valid;
+  profile->size = priv->size;
+  profile->filter = priv->filter;
+  profile->first = first;
+  profile->mod_count = mod_count;
+  profile->n_points = n_points;
+  profile->times = g_new (gint64, n_points);
+  profile->exact = g_new (gdouble, n_points);
+  profile->between = g_new (gdouble, n_points);
+
+  return profile;
+}
+
+/* Функция проверяет, что профиль рассчитан с текущими параметрами. */
+static gboolean
+hyscan_depthometer_profile_valid (HyScanDepthometerPrivate *priv,
+                                  HyScanDepthProfile       *profile)
+{
+  return (profile != NULL) &&
+         (profile->valid == priv->valid) &&
+         (profile->size == priv->size) &&
+         (profile->filter == priv->filter);
+}
+
+/* Функция вычисляет глубину для выровненного момента времени. */
+static gboolean
+hyscan_depthometer_compute (HyScanDepthometerPrivate *priv,
+                            gint64                    time,
+                            gdouble                  *depth,
+                            gint64                   *ltime,
+                            gint64                   *rtime)
+{
+  guint32 first, last;
+  guint32 lindex, rindex;
+
+  /* Определяем диапазон данных для запрошенной временной метки. */
+  if (!hyscan_nav_data_get_range (priv->source, &first, &last))
+    return FALSE;
+
+  if (hyscan_nav_data_find_data (priv->source, time, &lindex, &rindex, ltime, rtime) != HYSCAN_DB_FIND_OK)
+    return FALSE;
+
+  return hyscan_depthometer_filter (priv, first, last, lindex, rindex, depth);
+}
+
 /**
  * hyscan_depthometer_new:
  * @ndata: интерфейс #HyScanNavData
@@ -273,6 +733,29 @@ hyscan_depthometer_set_filter_size (HyScanDepthometer *meter,
   return TRUE;
 }
 
+/**
+ * hyscan_depthometer_set_filter:
+ * @depthometer: #HyScanDepthometer
+ * @filter: тип фильтра
+ *
+ * Функция задаёт фильтр, применяемый к окну из hyscan_depthometer_set_filter_size()
+ * значений. По умолчанию используется среднее арифметическое.
+ */
+void
+hyscan_depthometer_set_filter (HyScanDepthometer       *meter,
+                               HyScanDepthometerFilter  filter)
+{
+  g_return_if_fail (HYSCAN_IS_DEPTHOMETER (meter));
+  g_return_if_fail (filter <= HYSCAN_DEPTHOMETER_FILTER_HAMPEL);
+
+  if (meter->priv->filter == filter)
+    return;
+
+  /* Упорядоченный массив окна ведётся только для медианных фильтров. */
+  meter->priv->filter = filter;
+  meter->priv->window_count = 0;
+}
+
 /**
  * hyscan_depthometer_set_validity_time:
  * @depthometer: #HyScanDepthometer
@@ -317,11 +800,6 @@ hyscan_depthometer_get (HyScanDepthometer *meter,
                         gint64             time)
 {
   HyScanDepthometerPrivate *priv;
-  HyScanDBFindStatus found = HYSCAN_DB_FIND_FAIL;
-  guint32 first, last;
-  guint32 lindex, rindex;
-  gint64 ltime, rtime;
-  gint i, size, half;
   gdouble retval = 0;
   guint32 retval_size = sizeof (retval);
 
@@ -333,7 +811,6 @@ hyscan_depthometer_get (HyScanDepthometer *meter,
 
   /* Для начала преобразовываем запрошенное время. */
   time = hyscan_depthometer_time_round (time, priv->valid, priv->half_valid);
-  size = priv->size;
 
   /* Сначала ищем уже посчитанное значение в кэше. */
   if (priv->cache != NULL)
@@ -345,44 +822,17 @@ hyscan_depthometer_get (HyScanDepthometer *meter,
           return retval;
     }
 
-  /* Если не нашли, вычисляем. */
-  /* Если нужно, реаллоцируем память под массивы индексов и значений. */
-  size = priv->size;
-  half = size / 2;
-  if (size != priv->real_size)
+  /* Если есть актуальный профиль, берём значение из него. */
+  if (hyscan_depthometer_profile_valid (priv, priv->profile) &&
+      (priv->profile->mod_count == hyscan_nav_data_get_mod_count (priv->source)))
     {
-      priv->indexes = g_realloc (priv->indexes, size * sizeof (guint32));
-      priv->real_size = size;
+      return hyscan_depth_profile_get (priv->profile, time);
     }
 
-  /* Определяем диапазон данных для запрошенной временной метки. */
-  if (hyscan_nav_data_get_range (priv->source, &first, &last))
-    found = hyscan_nav_data_find_data (priv->source, time, &lindex, &rindex, &ltime, &rtime);
-  else
-    found = HYSCAN_DB_FIND_FAIL;
-
-  /* Если не получилось найти, возвращаем 0. */
-  if (found != HYSCAN_DB_FIND_OK)
+  /* Если не нашли, вычисляем. */
+  if (!hyscan_depthometer_compute (priv, time, &retval, NULL, NULL))
     return -1.0;
 
-  /* Заполняем массив индексами. */
-  for (i = 0; i < half; i++)
-    {
-      priv->indexes[half - 1 - i] = MAX (lindex - i, first);
-      priv->indexes[half + i] = MIN (rindex + i, last);
-    }
-
-  /* Получаем глубину для каждого индекса.*/
-  for (i = 0; i < size; i++)
-    {
-      gdouble current = 0;
-      hyscan_nav_data_get (priv->source, priv->indexes[i], NULL, &current);
-      retval += current;
-    }
-
-  /* Сейчас используется среднее арифметическое. */
-  retval /= size;
-
   /* Кладем получившееся значение в кэш. */
   if (priv->cache != NULL)
     {
@@ -393,6 +843,64 @@ hyscan_depthometer_get (HyScanDepthometer *meter,
   return retval;
 }
 
+/**
+ * hyscan_depthometer_get_many:
+ * @depthometer: #HyScanDepthometer
+ * @times: (array length=n_times): моменты времени
+ * @n_times: число моментов времени
+ * @depths: (out) (array length=n_times): массив для значений глубины
+ *
+ * Функция определяет глубину для массива моментов времени. Для моментов
+ * времени, для которых глубину определить не удалось, записывается -1.0.
+ *
+ * Функция рассчитана на упорядоченные по возрастанию моменты времени,
+ * например, времена строк водопада. Соседние моменты времени, попадающие
+ * между одними и теми же записями, не требуют повторных вычислений, а окно
+ * фильтра сдвигается с чтением только новых записей. Кэш при этом не
+ * используется.
+ *
+ * Returns: число определённых значений глубины.
+ */
+guint
+hyscan_depthometer_get_many (HyScanDepthometer *meter,
+                             const gint64      *times,
+                             guint              n_times,
+                             gdouble           *depths)
+{
+  HyScanDepthometerPrivate *priv;
+  gboolean segment = FALSE;
+  gint64 ltime = 0, rtime = 0;
+  gdouble depth = -1.0;
+  guint n_found = 0;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_DEPTHOMETER (meter), 0);
+  g_return_val_if_fail (n_times == 0 || (times != NULL && depths != NULL), 0);
+  priv = meter->priv;
+
+  for (i = 0; i < n_times; i++)
+    {
+      gint64 time;
+
+      if (priv->source == NULL)
+        {
+          depths[i] = -1.0;
+          continue;
+        }
+
+      time = hyscan_depthometer_time_round (times[i], priv->valid, priv->half_valid);
+
+      /* Между двумя записями окно фильтра, а значит и глубина, не меняется. */
+      if (!segment || (time <= ltime) || (time >= rtime))
+        segment = hyscan_depthometer_compute (priv, time, &depth, &ltime, &rtime);
+
+      depths[i] = segment ? depth : -1.0;
+      n_found += segment ? 1 : 0;
+    }
+
+  return n_found;
+}
+
 /**
  * hyscan_depthometer_check:
  * @depthometer: #HyScanDepthometer
@@ -433,3 +941,163 @@ hyscan_depthometer_check (HyScanDepthometer *meter,
 
   return -1.0;
 }
+
+/**
+ * hyscan_depthometer_get_profile:
+ * @depthometer: #HyScanDepthometer
+ *
+ * Функция рассчитывает профиль глубины для всего галса с текущими
+ * параметрами фильтра и окна валидности. Если профиль уже рассчитан, а в
+ * источнике появились новые записи, пересчитываются только значения,
+ * зависящие от них. После расчёта функция #hyscan_depthometer_get также
+ * использует профиль, пока данные в источнике не изменятся.
+ *
+ * Returns: (transfer full) (nullable): профиль глубины или NULL.
+ * Для удаления hyscan_depth_profile_unref().
+ */
+HyScanDepthProfile *
+hyscan_depthometer_get_profile (HyScanDepthometer *meter)
+{
+  HyScanDepthometerPrivate *priv;
+  HyScanDepthProfile *old, *profile;
+  guint32 mod_count;
+  guint32 first, last;
+  guint32 from = 0;
+  guint32 k, n;
+
+  g_return_val_if_fail (HYSCAN_IS_DEPTHOMETER (meter), NULL);
+  priv = meter->priv;
+
+  if (priv->source == NULL)
+    return NULL;
+
+  old = hyscan_depthometer_profile_valid (priv, priv->profile) ? priv->profile : NULL;
+  mod_count = hyscan_nav_data_get_mod_count (priv->source);
+  if ((old != NULL) && (old->mod_count == mod_count))
+    return hyscan_depth_profile_ref (old);
+
+  if (!hyscan_nav_data_get_range (priv->source, &first, &last))
+    return NULL;
+
+  n = last - first + 1;
+  profile = hyscan_depthometer_profile_new (priv, first, n, mod_count);
+
+  /* Значения вдали от конца старого профиля не зависят от новых записей:
+   * правый край их окна не меняется. */
+  if ((old != NULL) && (old->first == first) && (old->n_points <= n))
+    {
+      guint32 keep = priv->size / 2 + 1;
+
+      from = (old->n_points > keep) ? old->n_points - keep : 0;
+
+      memcpy (profile->times, old->times, from * sizeof (gint64));
+      memcpy (profile->exact, old->exact, from * sizeof (gdouble));
+      memcpy (profile->between, old->between, from * sizeof (gdouble));
+    }
+
+  if (!hyscan_nav_data_get_values (priv->source, first + from, last, profile->times + from, NULL))
+    {
+      hyscan_depth_profile_unref (profile);
+      return NULL;
+    }
+
+  /* Один проход окна по записям. */
+  for (k = from; k < n; k++)
+    {
+      if (!hyscan_depthometer_filter (priv, first, last, first + k, first + k, &profile->exact[k]))
+        profile->exact[k] = -1.0;
+
+      if ((k + 1 == n) ||
+          !hyscan_depthometer_filter (priv, first, last, first + k, first + k + 1, &profile->between[k]))
+        {
+          profile->between[k] = -1.0;
+        }
+    }
+
+  g_clear_pointer (&priv->profile, hyscan_depth_profile_unref);
+  priv->profile = profile;
+
+  return hyscan_depth_profile_ref (profile);
+}
+
+/**
+ * hyscan_depth_profile_ref:
+ * @profile: профиль глубины
+ *
+ * Функция увеличивает счётчик ссылок на профиль.
+ *
+ * Returns: (transfer full): профиль глубины.
+ */
+HyScanDepthProfile *
+hyscan_depth_profile_ref (HyScanDepthProfile *profile)
+{
+  g_return_val_if_fail (profile != NULL, NULL);
+
+  g_atomic_int_inc (&profile->ref_count);
+
+  return profile;
+}
+
+/**
+ * hyscan_depth_profile_unref:
+ * @profile: профиль глубины
+ *
+ * Функция уменьшает счётчик ссылок на профиль и удаляет его, если ссылок
+ * не осталось.
+ */
+void
+hyscan_depth_profile_unref (HyScanDepthProfile *profile)
+{
+  g_return_if_fail (profile != NULL);
+
+  if (!g_atomic_int_dec_and_test (&profile->ref_count))
+    return;
+
+  g_free (profile->times);
+  g_free (profile->exact);
+  g_free (profile->between);
+
+  g_slice_free (HyScanDepthProfile, profile);
+}
+
+/**
+ * hyscan_depth_profile_get:
+ * @profile: профиль глубины
+ * @time: время
+ *
+ * Функция возвращает глубину из профиля. Время выравнивается по окну
+ * валидности так же, как в #hyscan_depthometer_get. Функцию можно вызывать
+ * одновременно из нескольких потоков.
+ *
+ * Returns: глубина в запрошенный момент времени или -1.0 в случае ошибки.
+ */
+gdouble
+hyscan_depth_profile_get (HyScanDepthProfile *profile,
+                          gint64              time)
+{
+  const gint64 *times;
+  guint32 l, r;
+
+  g_return_val_if_fail (profile != NULL, -1.0);
+
+  times = profile->times;
+  time = hyscan_depthometer_time_round (time, profile->valid, profile->half_valid);
+
+  if ((profile->n_points == 0) || (time < times[0]) || (time > times[profile->n_points - 1]))
+    return -1.0;
+
+  /* Двоичный поиск: times[l] <= time < times[r]. */
+  l = 0;
+  r = profile->n_points;
+  while (r - l > 1)
+    {
+      guint32 m = l + (r - l) / 2;
+
+      if (times[m] <= time)
+        l = m;
+      else
+        r = m;
+    }
+
+  return (times[l] == time) ? profile->exact[l] : profile->between[l];
+}
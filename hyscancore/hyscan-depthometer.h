@@ -39,6 +39,21 @@
 
 G_BEGIN_DECLS
 
+/**
+ * HyScanDepthometerFilter:
+ * @HYSCAN_DEPTHOMETER_FILTER_MEAN: среднее арифметическое
+ * @HYSCAN_DEPTHOMETER_FILTER_MEDIAN: медиана
+ * @HYSCAN_DEPTHOMETER_FILTER_HAMPEL: среднее после фильтра Хампеля
+ *
+ * Фильтр значений глубины в окне.
+ */
+typedef enum
+{
+  HYSCAN_DEPTHOMETER_FILTER_MEAN,
+  HYSCAN_DEPTHOMETER_FILTER_MEDIAN,
+  HYSCAN_DEPTHOMETER_FILTER_HAMPEL
+} HyScanDepthometerFilter;
+
 #define HYSCAN_TYPE_DEPTHOMETER             (hyscan_depthometer_get_type ())
 #define HYSCAN_DEPTHOMETER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DEPTHOMETER, HyScanDepthometer))
 #define HYSCAN_IS_DEPTHOMETER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DEPTHOMETER))
@@ -46,6 +61,9 @@ G_BEGIN_DECLS
 #define HYSCAN_IS_DEPTHOMETER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DEPTHOMETER))
 #define HYSCAN_DEPTHOMETER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DEPTHOMETER, HyScanDepthometerClass))
 
+#define HYSCAN_TYPE_DEPTH_PROFILE           (hyscan_depth_profile_get_type ())
+
+typedef struct _HyScanDepthProfile HyScanDepthProfile;
 typedef struct _HyScanDepthometer HyScanDepthometer;
 typedef struct _HyScanDepthometerPrivate HyScanDepthometerPrivate;
 typedef struct _HyScanDepthometerClass HyScanDepthometerClass;
@@ -76,6 +94,10 @@ HYSCAN_API
 gboolean                hyscan_depthometer_set_filter_size     (HyScanDepthometer      *depthometer,
                                                                 guint                   size);
 
+HYSCAN_API
+void                    hyscan_depthometer_set_filter          (HyScanDepthometer      *depthometer,
+                                                                HyScanDepthometerFilter filter);
+
 HYSCAN_API
 void                    hyscan_depthometer_set_validity_time     (HyScanDepthometer    *depthometer,
                                                                   gint64                microseconds);
@@ -84,9 +106,30 @@ HYSCAN_API
 gdouble                 hyscan_depthometer_get                 (HyScanDepthometer      *depthometer,
                                                                 gint64                  time);
 HYSCAN_API
+guint                   hyscan_depthometer_get_many            (HyScanDepthometer      *depthometer,
+                                                                const gint64           *times,
+                                                                guint                   n_times,
+                                                                gdouble                *depths);
+HYSCAN_API
 gdouble                 hyscan_depthometer_check               (HyScanDepthometer      *depthometer,
                                                                 gint64                  time);
 
+HYSCAN_API
+HyScanDepthProfile     *hyscan_depthometer_get_profile         (HyScanDepthometer      *depthometer);
+
+HYSCAN_API
+GType                   hyscan_depth_profile_get_type          (void);
+
+HYSCAN_API
+HyScanDepthProfile     *hyscan_depth_profile_ref               (HyScanDepthProfile     *profile);
+
+HYSCAN_API
+void                    hyscan_depth_profile_unref             (HyScanDepthProfile     *profile);
+
+HYSCAN_API
+gdouble                 hyscan_depth_profile_get               (HyScanDepthProfile     *profile,
+                                                                gint64                  time);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_DEPTHOMETER_H__ */
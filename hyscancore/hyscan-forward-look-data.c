@@ -69,12 +69,27 @@
  * Для точной обработки данных необходимо установить скорость звука в воде,
  * для этих целей используется функция
  * #hyscan_forward_look_data_set_sound_velocity. По умолчанию используется
- * значение 1500 м/с.
+ * значение 1500 м/с. Данные хранятся в кэше в виде, не зависящем от скорости
+ * звука, поэтому её изменение не приводит к повторной обработке данных.
  *
  * Для чтения и обработки данных используются функции
  * #hyscan_forward_look_data_get_size_time и
  * #hyscan_forward_look_data_get_doa_values.
  *
+ * Кроме пары каналов с исходными данными класс обрабатывает сокращённый
+ * поток, формируемый #HyScanControlProxy. В нём первый канал содержит
+ * комплексные отсчёты, модуль которых равен амплитуде, а аргумент равен
+ * разности фаз между каналами. Второй канал содержит только параметры
+ * антенны и имеет амплитудный тип данных, что служит признаком такого
+ * потока.
+ *
+ * Функция #hyscan_forward_look_data_process_range выполняет обработку
+ * диапазона строк параллельно в нескольких потоках и помещает результаты
+ * в кэш. Каждый поток использует собственные объекты чтения акустических
+ * данных и расчёта углов. Её удобно использовать перед просмотром или
+ * перемоткой галса, после чего #hyscan_forward_look_data_get_doa будет
+ * возвращать данные из кэша.
+ *
  * HyScanForwardLookData не поддерживает работу в многопоточном режиме.
  * Рекомендуется создавать свой экземпляр объекта обработки данных в каждом
  * потоке и использовать единый кэш данных.
@@ -88,9 +103,11 @@
 #include <string.h>
 #include <math.h>
 
-#define CACHE_HEADER_MAGIC     0x8a09be31      /* Идентификатор заголовка кэша. */
+#define CACHE_HEADER_MAGIC     0x8a09be32      /* Идентификатор заголовка кэша. */
 #define DEFAULT_SOUND_VELOCITY 1500.0          /* Скорость звука по умолчанию. */
 #define SOUND_VELOCITY_SCALE   100.0           /* Коэфициент перевода скорости звука в integer. */
+#define MAX_WORKERS            16              /* Максимальное число потоков обработки. */
+#define PAIR_MISSING           G_MAXUINT32     /* Признак отсутствия парной строки. */
 
 enum
 {
@@ -101,7 +118,10 @@ enum
   PROP_TRACK_NAME
 };
 
-/* Структруа заголовка кэша. */
+/* Структруа заголовка кэша. Данные в кэше хранятся в виде, не зависящем
+ * от скорости звука: для каждой точки сохраняется угол, нормированный на
+ * угол сектора обзора, и интенсивность. Дальность определяется индексом
+ * точки. */
 typedef struct
 {
   guint32                      magic;          /* Идентификатор заголовка. */
@@ -109,14 +129,43 @@ typedef struct
   gint64                       time;           /* Метка времени. */
 } HyScanForwardLookDataCacheHeader;
 
+/* Контекст обработки данных. */
+typedef struct
+{
+  HyScanAcousticData  *channel1;               /* Данные канала 1. */
+  HyScanAcousticData  *channel2;               /* Данные канала 2. */
+  HyScanInter2DOA     *doa;                    /* Объект расчёта данных. */
+  HyScanBuffer        *doa_buffer;             /* Буфер данных. */
+  HyScanBuffer        *frame_buffer;           /* Буфер данных, не зависящих от скорости звука. */
+  HyScanBuffer        *module_buffer;          /* Буфер модулей отсчётов сокращённого потока. */
+  HyScanBuffer        *cache_buffer;           /* Буфер заголовка кэша данных. */
+  GString             *cache_key;              /* Ключ кэширования. */
+} HyScanForwardLookDataWorker;
+
+/* Задание на обработку диапазона строк. */
+typedef struct
+{
+  HyScanForwardLookDataPrivate *priv;          /* Объект обработки. */
+  HyScanForwardLookDataWorker  *worker;        /* Контекст обработки потока. */
+  gint                         *next;          /* Смещение следующей строки для обработки. */
+  guint32                       first;         /* Первый индекс диапазона. */
+  guint32                       n_lines;       /* Число строк в диапазоне. */
+  gint                         *n_done;        /* Число обработанных строк. */
+} HyScanForwardLookDataJob;
+
 struct _HyScanForwardLookDataPrivate
 {
   HyScanDB            *db;                     /* Интерфейс базы данных. */
   gchar               *project_name;           /* Название проекта. */
   gchar               *track_name;             /* Название галса. */
 
-  HyScanInter2DOA     *doa;                    /* Объект расчёта данных. */
+  HyScanInter2DOA     *doa;                    /* Объект расчёта сектора обзора. */
+  HyScanInter2DOA     *ref_doa;                /* Объект расчёта данных при опорной скорости звука. */
+  gdouble              ref_alpha;              /* Сектор обзора при опорной скорости звука. */
   HyScanBuffer        *doa_buffer;             /* Буфер данных. */
+  HyScanBuffer        *frame_buffer;           /* Буфер данных, не зависящих от скорости звука. */
+  HyScanBuffer        *module_buffer;          /* Буфер модулей отсчётов сокращённого потока. */
+  gboolean             reduced;                /* Признак сокращённого потока данных. */
   gdouble              signal_frequency;       /* Рабочая частота, Гц. */
   gdouble              antenna_base;           /* Расстояние между антеннами, м. */
   gdouble              data_rate;              /* Частота дискретизации. */
@@ -129,6 +178,18 @@ struct _HyScanForwardLookDataPrivate
   HyScanBuffer        *cache_buffer;           /* Буфер заголовка кэша данных. */
   gchar               *cache_token;            /* Основа ключа кэширования. */
   GString             *cache_key;              /* Ключ кэширования. */
+
+  HyScanForwardLookDataWorker **workers;       /* Контексты потоков обработки. */
+  guint                n_workers;              /* Число потоков обработки. */
+  GThreadPool         *pool;                   /* Пул потоков обработки. */
+  GMutex               jobs_lock;              /* Блокировка счётчика заданий. */
+  GCond                jobs_cond;              /* Сигнализатор завершения заданий. */
+  guint                n_jobs;                 /* Число выполняющихся заданий пула. */
+
+  GArray              *pairs;                  /* Индексы парных строк второго канала. */
+  guint32              pairs_first;            /* Индекс первой строки в таблице пар. */
+  guint32              pairs_next;             /* Следующий индекс второго канала для поиска пары. */
+  guint32              pairs_mod_count;        /* Номер изменения данных таблицы пар. */
 };
 
 static void    hyscan_forward_look_data_set_property           (GObject                       *object,
@@ -139,8 +200,42 @@ static void    hyscan_forward_look_data_object_constructed     (GObject
 static void    hyscan_forward_look_data_object_finalize        (GObject                       *object);
 
 static void    hyscan_forward_look_data_update_cache_key       (HyScanForwardLookDataPrivate  *priv,
+                                                                GString                       *cache_key,
+                                                                guint32                        index);
+
+static gboolean
+               hyscan_forward_look_data_cache_get              (HyScanForwardLookDataPrivate  *priv,
+                                                                HyScanForwardLookDataWorker   *worker,
+                                                                guint32                        index,
+                                                                guint32                       *n_points,
+                                                                gint64                        *time);
+
+static gboolean
+               hyscan_forward_look_data_compute                (HyScanForwardLookDataPrivate  *priv,
+                                                                HyScanForwardLookDataWorker   *worker,
+                                                                guint32                        index,
+                                                                guint32                       *n_points,
+                                                                gint64                        *time);
+
+static const HyScanDOA *
+               hyscan_forward_look_data_expand                 (HyScanForwardLookDataPrivate  *priv,
+                                                                HyScanForwardLookDataWorker   *worker);
+
+static void    hyscan_forward_look_data_update_pairs           (HyScanForwardLookDataPrivate  *priv);
+
+static guint32 hyscan_forward_look_data_get_pair               (HyScanForwardLookDataPrivate  *priv,
                                                                 guint32                        index);
 
+static HyScanForwardLookDataWorker *
+               hyscan_forward_look_data_worker_new             (HyScanForwardLookDataPrivate  *priv);
+
+static void    hyscan_forward_look_data_worker_free            (HyScanForwardLookDataWorker   *worker);
+
+static void    hyscan_forward_look_data_worker_process         (HyScanForwardLookDataJob      *job);
+
+static void    hyscan_forward_look_data_worker_job             (gpointer                       data,
+                                                                gpointer                       user_data);
+
 G_DEFINE_TYPE_WITH_PRIVATE (HyScanForwardLookData, hyscan_forward_look_data, G_TYPE_OBJECT)
 
 static void
@@ -174,6 +269,9 @@ static void
 hyscan_forward_look_data_init (HyScanForwardLookData *data)
 {
   data->priv = hyscan_forward_look_data_get_instance_private (data);
+
+  g_mutex_init (&data->priv->jobs_lock);
+  g_cond_init (&data->priv->jobs_cond);
 }
 
 static void
@@ -268,7 +366,14 @@ hyscan_forward_look_data_object_constructed (GObject *object)
     }
 
   priv->doa = hyscan_inter2_doa_new ();
+  priv->ref_doa = hyscan_inter2_doa_new ();
   priv->doa_buffer = hyscan_buffer_new ();
+  priv->frame_buffer = hyscan_buffer_new ();
+  priv->module_buffer = hyscan_buffer_new ();
+
+  /* Данные второго канала в сокращённом потоке отсутствуют. */
+  priv->reduced = (hyscan_discretization_get_type_by_data (channel_info2.data_type) ==
+                   HYSCAN_DISCRETIZATION_AMPLITUDE);
 
   /* Параметры обработки. */
   priv->signal_frequency = channel_info1.signal_frequency;
@@ -277,6 +382,9 @@ hyscan_forward_look_data_object_constructed (GObject *object)
   priv->sound_velocity = SOUND_VELOCITY_SCALE * DEFAULT_SOUND_VELOCITY;
   hyscan_inter2_doa_configure (priv->doa, priv->signal_frequency, priv->antenna_base,
                                priv->data_rate, DEFAULT_SOUND_VELOCITY);
+  hyscan_inter2_doa_configure (priv->ref_doa, priv->signal_frequency, priv->antenna_base,
+                               priv->data_rate, DEFAULT_SOUND_VELOCITY);
+  priv->ref_alpha = hyscan_inter2_doa_get_alpha (priv->ref_doa);
 
   /* Ключ кэширования. */
   priv->cache_key = g_string_new (NULL);
@@ -286,6 +394,11 @@ hyscan_forward_look_data_object_constructed (GObject *object)
   priv->cache_token = g_strdup_printf ("FORWARDLOOK.%s.%s.%s",
                                        db_uri, priv->project_name, priv->track_name);
   g_free (db_uri);
+
+  /* Таблица парных строк. */
+  priv->pairs = g_array_new (FALSE, FALSE, sizeof (guint32));
+  priv->pairs_mod_count = hyscan_acoustic_data_get_mod_count (priv->channel1) +
+                          hyscan_acoustic_data_get_mod_count (priv->channel2) - 1;
 }
 
 static void
@@ -293,13 +406,29 @@ hyscan_forward_look_data_object_finalize (GObject *object)
 {
   HyScanForwardLookData *data = HYSCAN_FORWARD_LOOK_DATA (object);
   HyScanForwardLookDataPrivate *priv = data->priv;
+  guint i;
+
+  if (priv->pool != NULL)
+    g_thread_pool_free (priv->pool, FALSE, TRUE);
+
+  g_mutex_clear (&priv->jobs_lock);
+  g_cond_clear (&priv->jobs_cond);
+
+  for (i = 0; i < priv->n_workers; i++)
+    hyscan_forward_look_data_worker_free (priv->workers[i]);
+  g_free (priv->workers);
+
+  g_clear_pointer (&priv->pairs, g_array_unref);
 
   g_clear_object (&priv->db);
   g_clear_object (&priv->channel1);
   g_clear_object (&priv->channel2);
 
   g_clear_object (&priv->doa);
+  g_clear_object (&priv->ref_doa);
   g_clear_object (&priv->doa_buffer);
+  g_clear_object (&priv->frame_buffer);
+  g_clear_object (&priv->module_buffer);
 
   if (priv->cache_key != NULL)
     g_string_free (priv->cache_key, TRUE);
@@ -316,10 +445,385 @@ hyscan_forward_look_data_object_finalize (GObject *object)
 /* Функция обновляет ключ кэширования данных. */
 static void
 hyscan_forward_look_data_update_cache_key (HyScanForwardLookDataPrivate *priv,
+                                           GString                      *cache_key,
                                            guint32                       index)
 {
-  g_string_printf (priv->cache_key, "%s.%u.%u",
-                   priv->cache_token, priv->sound_velocity, index);
+  g_string_printf (cache_key, "%s.%u", priv->cache_token, index);
+}
+
+/* Функция ищет обработанные данные в кэше и помещает их в буфер
+ * frame_buffer. */
+static gboolean
+hyscan_forward_look_data_cache_get (HyScanForwardLookDataPrivate *priv,
+                                    HyScanForwardLookDataWorker  *worker,
+                                    guint32                       index,
+                                    guint32                      *n_points,
+                                    gint64                       *time)
+{
+  HyScanForwardLookDataCacheHeader header;
+  guint32 cached_n_points;
+
+  if (priv->cache == NULL)
+    return FALSE;
+
+  /* Ключ кэширования. */
+  hyscan_forward_look_data_update_cache_key (priv, worker->cache_key, index);
+
+  /* Ищем данные в кэше. */
+  hyscan_buffer_wrap (worker->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+  if (!hyscan_cache_get2 (priv->cache, worker->cache_key->str, NULL,
+                          sizeof (header), worker->cache_buffer, worker->frame_buffer))
+    {
+      return FALSE;
+    }
+
+  cached_n_points  = hyscan_buffer_get_data_size (worker->frame_buffer);
+  cached_n_points /= 2 * sizeof (gfloat);
+
+  /* Верификация данных. */
+  if ((header.magic != CACHE_HEADER_MAGIC) ||
+      (header.n_points != cached_n_points))
+    {
+      return FALSE;
+    }
+
+  (time != NULL) ? *time = header.time : 0;
+  *n_points = cached_n_points;
+
+  return TRUE;
+}
+
+/* Функция пересчитывает данные из буфера frame_buffer в массив целей для
+ * текущей скорости звука. Угол прихода пропорционален разности фаз между
+ * каналами с коэффициентом, равным углу сектора обзора, а дальность -
+ * индексу точки, поэтому пересчёт сводится к двум умножениям. */
+static const HyScanDOA *
+hyscan_forward_look_data_expand (HyScanForwardLookDataPrivate *priv,
+                                 HyScanForwardLookDataWorker  *worker)
+{
+  const gfloat *frame;
+  HyScanDOA *doa;
+  gfloat alpha;
+  gfloat range_step;
+  guint32 n_points;
+  guint32 i;
+
+  frame = hyscan_buffer_get (worker->frame_buffer, NULL, &n_points);
+  n_points /= 2 * sizeof (gfloat);
+
+  hyscan_buffer_set_doa (worker->doa_buffer, NULL, n_points);
+  doa = hyscan_buffer_get_doa (worker->doa_buffer, &n_points);
+  if ((frame == NULL) || (doa == NULL))
+    return NULL;
+
+  alpha = hyscan_inter2_doa_get_alpha (priv->doa);
+  range_step = (priv->sound_velocity / SOUND_VELOCITY_SCALE) / (2.0 * priv->data_rate);
+
+  for (i = 0; i < n_points; i++)
+    {
+      doa[i].angle = frame[2 * i] * alpha;
+      doa[i].distance = i * range_step;
+      doa[i].amplitude = frame[2 * i + 1];
+    }
+
+  return doa;
+}
+
+/* Функция дополняет таблицу парных строк второго канала для строк первого
+ * канала. Строки обоих каналов упорядочены по времени, поэтому пары
+ * находятся одним проходом по новым строкам без поиска в базе данных.
+ * Строки первого канала, для которых парная строка ещё может появиться,
+ * в таблицу не заносятся до следующего изменения данных. */
+static void
+hyscan_forward_look_data_update_pairs (HyScanForwardLookDataPrivate *priv)
+{
+  guint32 mod_count;
+  guint32 first1, last1;
+  guint32 first2, last2;
+  guint32 n_points2 = 0;
+  gint64 time2 = -1;
+  guint32 index1;
+  guint32 index2;
+
+  /* В сокращённом потоке строки не объединяются в пары. */
+  if (priv->reduced)
+    return;
+
+  mod_count = hyscan_acoustic_data_get_mod_count (priv->channel1) +
+              hyscan_acoustic_data_get_mod_count (priv->channel2);
+  if (mod_count == priv->pairs_mod_count)
+    return;
+
+  if (!hyscan_acoustic_data_get_range (priv->channel1, &first1, &last1) ||
+      !hyscan_acoustic_data_get_range (priv->channel2, &first2, &last2))
+    {
+      return;
+    }
+
+  /* Начальные строки удалены, строим таблицу заново. */
+  if ((priv->pairs->len == 0) || (priv->pairs_first != first1))
+    {
+      g_array_set_size (priv->pairs, 0);
+      priv->pairs_first = first1;
+      priv->pairs_next = first2;
+    }
+
+  index2 = MAX (priv->pairs_next, first2);
+
+  for (index1 = priv->pairs_first + priv->pairs->len; index1 <= last1; index1++)
+    {
+      guint32 n_points1;
+      guint32 pair = PAIR_MISSING;
+      gint64 time1;
+
+      if (!hyscan_acoustic_data_get_size_time (priv->channel1, index1, &n_points1, &time1))
+        break;
+
+      /* Пропускаем строки второго канала без пары. */
+      while (index2 <= last2)
+        {
+          if ((time2 < 0) &&
+              !hyscan_acoustic_data_get_size_time (priv->channel2, index2, &n_points2, &time2))
+            {
+              break;
+            }
+
+          if (time2 >= time1)
+            break;
+
+          index2 += 1;
+          time2 = -1;
+        }
+
+      /* Парная строка ещё не записана. */
+      if ((index2 > last2) || (time2 < 0))
+        break;
+
+      if (time2 == time1)
+        {
+          if (n_points1 != n_points2)
+            {
+              g_warning ("HyScanForwardLookData: data size mismatch in '%s.%s' for index %d",
+                         priv->project_name, priv->track_name, index1);
+            }
+
+          pair = index2;
+          index2 += 1;
+          time2 = -1;
+        }
+      else
+        {
+          g_warning ("HyScanForwardLookData: no channel 2 data in '%s.%s' for index %d",
+                     priv->project_name, priv->track_name, index1);
+        }
+
+      g_array_append_val (priv->pairs, pair);
+    }
+
+  priv->pairs_next = index2;
+  priv->pairs_mod_count = mod_count;
+}
+
+/* Функция возвращает индекс парной строки второго канала из таблицы пар. */
+static guint32
+hyscan_forward_look_data_get_pair (HyScanForwardLookDataPrivate *priv,
+                                   guint32                       index)
+{
+  if ((index < priv->pairs_first) || (index - priv->pairs_first >= priv->pairs->len))
+    return PAIR_MISSING;
+
+  return g_array_index (priv->pairs, guint32, index - priv->pairs_first);
+}
+
+/* Функция выполняет обработку строки при опорной скорости звука, помещает
+ * результат в буфер frame_buffer и сохраняет его в кэше. Ключ кэширования
+ * должен быть предварительно сформирован функцией
+ * hyscan_forward_look_data_update_cache_key, а таблица пар обновлена
+ * функцией hyscan_forward_look_data_update_pairs. */
+static gboolean
+hyscan_forward_look_data_compute (HyScanForwardLookDataPrivate *priv,
+                                  HyScanForwardLookDataWorker  *worker,
+                                  guint32                       index,
+                                  guint32                      *n_points,
+                                  gint64                       *time)
+{
+  const HyScanComplexFloat *data1;
+  const HyScanComplexFloat *data2;
+  HyScanComplexFloat *module;
+  HyScanDOA *doa;
+  gfloat *frame;
+  gfloat scale;
+
+  guint32 n_points1, n_points2;
+  guint32 index1, index2;
+  gint64 time1;
+  guint32 i;
+
+  /* Сокращённый поток. Расчёт выполняется для пары из модулей отсчётов
+   * и самих отсчётов, разность фаз которых равна аргументу отсчёта. */
+  if (priv->reduced)
+    {
+      data2 = hyscan_acoustic_data_get_complex (worker->channel1, index, &n_points2, &time1);
+      if (data2 == NULL)
+        return FALSE;
+
+      hyscan_buffer_set_complex_float (worker->module_buffer, NULL, n_points2);
+      module = hyscan_buffer_get_complex_float (worker->module_buffer, &n_points1);
+      for (i = 0; i < n_points1; i++)
+        {
+          module[i].re = sqrtf (data2[i].re * data2[i].re + data2[i].im * data2[i].im);
+          module[i].im = 0.0f;
+        }
+
+      data1 = module;
+    }
+
+  /* Пара исходных каналов. */
+  else
+    {
+      /* Парная строка для указанного индекса. */
+      index1 = index;
+      index2 = hyscan_forward_look_data_get_pair (priv, index1);
+      if (index2 == PAIR_MISSING)
+        return FALSE;
+
+      /* Считываем данные первого канала. */
+      data1 = hyscan_acoustic_data_get_complex (worker->channel1, index1, &n_points1, &time1);
+      if (data1 == NULL)
+        return FALSE;
+
+      /* Считываем данные второго канала. */
+      data2 = hyscan_acoustic_data_get_complex (worker->channel2, index2, &n_points2, NULL);
+      if (data2 == NULL)
+        return FALSE;
+    }
+
+  /* Корректируем размер буфера данных. */
+  *n_points = n_points1 = n_points2 = MIN (n_points1, n_points2);
+  hyscan_buffer_set_doa (worker->doa_buffer, NULL, n_points1);
+  doa = hyscan_buffer_get_doa (worker->doa_buffer, &n_points1);
+
+  /* Расчитываем углы прихода и интенсивности. */
+  hyscan_inter2_doa_get (worker->doa, doa, data1, data2, n_points1);
+
+  /* Переводим данные в вид, не зависящий от скорости звука. */
+  hyscan_buffer_set_float (worker->frame_buffer, NULL, 2 * n_points1);
+  frame = hyscan_buffer_get_float (worker->frame_buffer, &n_points2);
+
+  scale = 1.0 / priv->ref_alpha;
+  for (i = 0; i < n_points1; i++)
+    {
+      frame[2 * i] = doa[i].angle * scale;
+      frame[2 * i + 1] = doa[i].amplitude;
+    }
+
+  /* Сохраняем данные в кэше. */
+  if (priv->cache != NULL)
+    {
+      HyScanForwardLookDataCacheHeader header;
+
+      header.magic = CACHE_HEADER_MAGIC;
+      header.n_points = n_points1;
+      header.time = time1;
+      hyscan_buffer_wrap (worker->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+
+      hyscan_cache_set2 (priv->cache, worker->cache_key->str, NULL, worker->cache_buffer, worker->frame_buffer);
+    }
+
+  (time != NULL) ? *time = time1 : 0;
+
+  return TRUE;
+}
+
+/* Функция создаёт контекст потока обработки. */
+static HyScanForwardLookDataWorker *
+hyscan_forward_look_data_worker_new (HyScanForwardLookDataPrivate *priv)
+{
+  HyScanForwardLookDataWorker *worker;
+
+  worker = g_slice_new0 (HyScanForwardLookDataWorker);
+
+  worker->channel1 = hyscan_acoustic_data_new (priv->db, NULL,
+                                               priv->project_name, priv->track_name,
+                                               HYSCAN_SOURCE_FORWARD_LOOK, 1, FALSE);
+  worker->channel2 = hyscan_acoustic_data_new (priv->db, NULL,
+                                               priv->project_name, priv->track_name,
+                                               HYSCAN_SOURCE_FORWARD_LOOK, 2, FALSE);
+  if ((worker->channel1 == NULL) || (worker->channel2 == NULL))
+    {
+      hyscan_forward_look_data_worker_free (worker);
+      return NULL;
+    }
+
+  /* Обработка выполняется при опорной скорости звука. */
+  worker->doa = hyscan_inter2_doa_new ();
+  hyscan_inter2_doa_configure (worker->doa, priv->signal_frequency, priv->antenna_base,
+                               priv->data_rate, DEFAULT_SOUND_VELOCITY);
+
+  worker->doa_buffer = hyscan_buffer_new ();
+  worker->frame_buffer = hyscan_buffer_new ();
+  worker->module_buffer = hyscan_buffer_new ();
+  worker->cache_buffer = hyscan_buffer_new ();
+  worker->cache_key = g_string_new (NULL);
+
+  return worker;
+}
+
+/* Функция освобождает контекст потока обработки. */
+static void
+hyscan_forward_look_data_worker_free (HyScanForwardLookDataWorker *worker)
+{
+  g_clear_object (&worker->channel1);
+  g_clear_object (&worker->channel2);
+  g_clear_object (&worker->doa);
+  g_clear_object (&worker->doa_buffer);
+  g_clear_object (&worker->frame_buffer);
+  g_clear_object (&worker->module_buffer);
+  g_clear_object (&worker->cache_buffer);
+  if (worker->cache_key != NULL)
+    g_string_free (worker->cache_key, TRUE);
+
+  g_slice_free (HyScanForwardLookDataWorker, worker);
+}
+
+/* Функция обрабатывает строки диапазона. Потоки поочерёдно забирают строки
+ * из общего счётчика, поэтому нагрузка распределяется равномерно. */
+static void
+hyscan_forward_look_data_worker_process (HyScanForwardLookDataJob *job)
+{
+  HyScanForwardLookDataPrivate *priv = job->priv;
+  HyScanForwardLookDataWorker *worker = job->worker;
+
+  while (TRUE)
+    {
+      guint32 offset = (guint32)g_atomic_int_add (job->next, 1);
+      guint32 index = job->first + offset;
+      guint32 n_points;
+
+      if (offset >= job->n_lines)
+        break;
+
+      if (hyscan_forward_look_data_cache_get (priv, worker, index, &n_points, NULL) ||
+          hyscan_forward_look_data_compute (priv, worker, index, &n_points, NULL))
+        {
+          g_atomic_int_inc (job->n_done);
+        }
+    }
+}
+
+/* Задание пула потоков обработки. */
+static void
+hyscan_forward_look_data_worker_job (gpointer data,
+                                     gpointer user_data)
+{
+  HyScanForwardLookDataPrivate *priv = user_data;
+
+  hyscan_forward_look_data_worker_process (data);
+
+  g_mutex_lock (&priv->jobs_lock);
+  if (--priv->n_jobs == 0)
+    g_cond_signal (&priv->jobs_cond);
+  g_mutex_unlock (&priv->jobs_lock);
 }
 
 /**
@@ -658,14 +1162,7 @@ hyscan_forward_look_data_get_doa (HyScanForwardLookData *data,
 
 {
   HyScanForwardLookDataPrivate *priv;
-  HyScanDBFindStatus find_status;
-  const HyScanComplexFloat *data1;
-  const HyScanComplexFloat *data2;
-  HyScanDOA *doa;
-
-  guint32 n_points1, n_points2;
-  guint32 index1, index2;
-  gint64 time1, time2;
+  HyScanForwardLookDataWorker worker;
 
   g_return_val_if_fail (HYSCAN_IS_FORWARD_LOOK_DATA (data), NULL);
 
@@ -674,80 +1171,121 @@ hyscan_forward_look_data_get_doa (HyScanForwardLookData *data,
   if (priv->channel1 == NULL)
     return NULL;
 
-  /* Ищем данные в кэше. */
-  if (priv->cache != NULL)
+  /* Собственный контекст обработки объекта. */
+  worker.channel1 = priv->channel1;
+  worker.channel2 = priv->channel2;
+  worker.doa = priv->ref_doa;
+  worker.doa_buffer = priv->doa_buffer;
+  worker.frame_buffer = priv->frame_buffer;
+  worker.module_buffer = priv->module_buffer;
+  worker.cache_buffer = priv->cache_buffer;
+  worker.cache_key = priv->cache_key;
+
+  /* Ищем данные в кэше или обрабатываем их. */
+  if (!hyscan_forward_look_data_cache_get (priv, &worker, index, n_points, time))
     {
-      HyScanForwardLookDataCacheHeader header;
+      hyscan_forward_look_data_update_pairs (priv);
 
-      /* Ключ кэширования. */
-      hyscan_forward_look_data_update_cache_key (priv, index);
+      if (!hyscan_forward_look_data_compute (priv, &worker, index, n_points, time))
+        return NULL;
+    }
 
-      /* Ищем данные в кэше. */
-      hyscan_buffer_wrap (priv->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
-      if (hyscan_cache_get2 (priv->cache, priv->cache_key->str, NULL,
-                             sizeof (header), priv->cache_buffer, priv->doa_buffer))
-        {
-          guint32 cached_n_points;
+  /* Пересчитываем данные для текущей скорости звука. */
+  return hyscan_forward_look_data_expand (priv, &worker);
+}
 
-          cached_n_points  = hyscan_buffer_get_data_size (priv->doa_buffer);
-          cached_n_points /= sizeof (HyScanDOA);
+/**
+ * hyscan_forward_look_data_process_range:
+ * @data: указатель на #HyScanForwardLookData
+ * @first_index: начальный индекс данныx
+ * @last_index: конечный индекс данныx
+ *
+ * Функция выполняет обработку строк в диапазоне индексов [first_index,
+ * last_index] и сохраняет результаты в кэше. Обработка выполняется
+ * параллельно, число потоков определяется числом процессоров. Строки,
+ * уже находящиеся в кэше, повторно не обрабатываются. Функция блокирует
+ * выполнение до завершения обработки всего диапазона.
+ *
+ * Функция имеет смысл только при использовании кэша.
+ *
+ * Returns: Число строк диапазона, данные которых находятся в кэше.
+ */
+guint32
+hyscan_forward_look_data_process_range (HyScanForwardLookData *data,
+                                        guint32                first_index,
+                                        guint32                last_index)
+{
+  HyScanForwardLookDataPrivate *priv;
+  HyScanForwardLookDataJob jobs[MAX_WORKERS];
+  gint n_done = 0;
+  gint next = 0;
+  guint32 n_lines;
+  guint i;
 
-          /* Верификация данных. */
-          if ((header.magic == CACHE_HEADER_MAGIC) &&
-              (header.n_points == cached_n_points))
-            {
-              (time != NULL) ? *time = header.time : 0;
-              *n_points = cached_n_points;
+  g_return_val_if_fail (HYSCAN_IS_FORWARD_LOOK_DATA (data), 0);
 
-              return hyscan_buffer_get (priv->doa_buffer, NULL, &cached_n_points);
-            }
-        }
-    }
+  priv = data->priv;
 
-  /* Считываем данные первого канала. */
-  index1 = index;
-  data1 = hyscan_acoustic_data_get_complex (priv->channel1, index1, &n_points1, &time1);
-  if (data1 == NULL)
-    return NULL;
+  if ((priv->channel1 == NULL) || (priv->cache == NULL) || (first_index > last_index))
+    return 0;
 
-  /* Ищем парную строку для указанного индекса. */
-  find_status = hyscan_acoustic_data_find_data (priv->channel2, time1, &index2, NULL, &time2, NULL);
-  if ((find_status != HYSCAN_DB_FIND_OK) || (time1 != time2))
-    return NULL;
+  /* Контексты и потоки обработки создаются один раз и используются повторно. */
+  if (priv->workers == NULL)
+    {
+      guint n_workers = CLAMP (g_get_num_processors (), 1, MAX_WORKERS);
 
-  /* Считываем данные второго канала. */
-  data2 = hyscan_acoustic_data_get_complex (priv->channel2, index2, &n_points2, NULL);
-  if (data2 == NULL)
-    return NULL;
+      priv->workers = g_new0 (HyScanForwardLookDataWorker *, n_workers);
+      for (i = 0; i < n_workers; i++)
+        {
+          priv->workers[priv->n_workers] = hyscan_forward_look_data_worker_new (priv);
+          if (priv->workers[priv->n_workers] != NULL)
+            priv->n_workers += 1;
+        }
 
-  if (n_points1 != n_points2)
-    {
-      g_warning ("HyScanForwardLookData: data size mismatch in '%s.%s' for index %d",
-                 priv->project_name, priv->track_name, index);
+      /* Первый контекст обрабатывается в вызывающем потоке. */
+      if (priv->n_workers > 1)
+        {
+          priv->pool = g_thread_pool_new (hyscan_forward_look_data_worker_job, priv,
+                                          priv->n_workers - 1, TRUE, NULL);
+        }
     }
 
-  /* Корректируем размер буфера данных. */
-  *n_points = n_points1 = n_points2 = MIN (n_points1, n_points2);
-  hyscan_buffer_set_doa (priv->doa_buffer, NULL, n_points1);
-  doa = hyscan_buffer_get_doa (priv->doa_buffer, &n_points1);
+  if (priv->n_workers == 0)
+    return 0;
 
-  /* Расчитываем углы прихода и интенсивности. */
-  hyscan_inter2_doa_get (priv->doa, doa, data1, data2, n_points1);
+  /* Потоки обработки используют таблицу пар только для чтения. */
+  hyscan_forward_look_data_update_pairs (priv);
 
-  /* Сохраняем данные в кэше. */
-  if (priv->cache != NULL)
+  n_lines = last_index - first_index + 1;
+  n_lines = (n_lines == 0) ? G_MAXUINT32 : n_lines;
+
+  for (i = 0; i < priv->n_workers; i++)
     {
-      HyScanForwardLookDataCacheHeader header;
+      jobs[i].priv = priv;
+      jobs[i].worker = priv->workers[i];
+      jobs[i].next = &next;
+      jobs[i].first = first_index;
+      jobs[i].n_lines = n_lines;
+      jobs[i].n_done = &n_done;
+    }
 
-      header.magic = CACHE_HEADER_MAGIC;
-      header.n_points = n_points1;
-      header.time = time1;
-      hyscan_buffer_wrap (priv->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+  /* Первый контекст обрабатывается в вызывающем потоке, остальные в пуле. */
+  if (priv->pool != NULL)
+    {
+      g_mutex_lock (&priv->jobs_lock);
+      priv->n_jobs = priv->n_workers - 1;
+      g_mutex_unlock (&priv->jobs_lock);
 
-      hyscan_cache_set2 (priv->cache, priv->cache_key->str, NULL, priv->cache_buffer, priv->doa_buffer);
+      for (i = 1; i < priv->n_workers; i++)
+        g_thread_pool_push (priv->pool, &jobs[i], NULL);
     }
 
-  (time != NULL) ? *time = time1 : 0;
+  hyscan_forward_look_data_worker_process (&jobs[0]);
 
-  return doa;
+  g_mutex_lock (&priv->jobs_lock);
+  while (priv->n_jobs > 0)
+    g_cond_wait (&priv->jobs_cond, &priv->jobs_lock);
+  g_mutex_unlock (&priv->jobs_lock);
+
+  return n_done;
 }
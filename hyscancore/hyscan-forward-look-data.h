@@ -123,6 +123,11 @@ const HyScanDOA               *hyscan_forward_look_data_get_doa            (HySc
                                                                             guint32               *n_points,
                                                                             gint64                *time);
 
+HYSCAN_API
+guint32                        hyscan_forward_look_data_process_range      (HyScanForwardLookData *data,
+                                                                            guint32                first_index,
+                                                                            guint32                last_index);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_FORWARD_LOOK_DATA_H__ */
@@ -11,8 +11,14 @@
 #include "hyscan-forward-look-player.h"
 #include "hyscan-core-marshallers.h"
 
+#include <string.h>
+#include <math.h>
+
 #define DEFAULT_FPS   30
 #define DEFAULT_DELAY 100000
+#define MAX_AVERAGE   256
+#define MAX_PREFETCH  64
+#define MIN_PREFETCH  4
 
 enum
 {
@@ -25,6 +31,7 @@ typedef enum
 {
   HYSCAN_FORWARD_LOOK_PLAYER_STOP,
   HYSCAN_FORWARD_LOOK_PLAYER_START,
+  HYSCAN_FORWARD_LOOK_PLAYER_RESTART,
   HYSCAN_FORWARD_LOOK_PLAYER_PLAY,
   HYSCAN_FORWARD_LOOK_PLAYER_PAUSE,
   HYSCAN_FORWARD_LOOK_PLAYER_REAL_TIME
@@ -41,13 +48,73 @@ typedef struct
   gdouble                      sound_velocity;         /* Скорость звука, м/с. */
   gboolean                     sound_velocity_changed; /* Признак изменения скорости звука. */
 
+  HyScanForwardLookPlayerAverage average;             /* Режим усреднения данных. */
+  guint                        n_average;              /* Число усредняемых зондирований. */
+  gboolean                     average_changed;        /* Признак изменения режима усреднения. */
+
   guint32                      index;                  /* Индекс обрабатывамых данных. */
   gboolean                     index_changed;          /* Признак изменения индекса обрабатываемых данных. */
 } HyScanForwardLookPlayerState;
 
+/* Строка данных, подготовленная заранее. */
+typedef struct
+{
+  guint32                      index;                  /* Индекс строки. */
+  gint64                       time;                   /* Метка времени строки. */
+  guint                        generation;             /* Поколение параметров обработки. */
+  gboolean                     valid;                  /* Признак наличия данных. */
+  HyScanBuffer                *doa;                    /* Массив целей. */
+} HyScanForwardLookPlayerSlot;
+
+/* Упреждающее чтение данных. */
+typedef struct
+{
+  guint                        generation;             /* Поколение параметров обработки. */
+
+  gboolean                     active;                 /* Признак работы упреждающего чтения. */
+  guint32                      index;                  /* Текущий индекс воспроизведения. */
+  gint                         direction;              /* Направление воспроизведения. */
+  guint                        depth;                  /* Глубина упреждения. */
+
+  HyScanForwardLookPlayerSlot  slots[MAX_PREFETCH];    /* Кольцо подготовленных строк. */
+  HyScanBuffer                *buffer;                 /* Буфер выданной строки. */
+
+  GThread                     *thread;                 /* Поток упреждающего чтения. */
+  GMutex                       lock;                   /* Блокировка. */
+  GCond                        cond;                   /* Сигнализатор изменения параметров. */
+} HyScanForwardLookPlayerPrefetch;
+
+/* Копия зондирования для накопителя. */
+typedef struct
+{
+  guint32                      index;                  /* Индекс строки. */
+  gint64                       time;                   /* Метка времени строки. */
+  guint32                      n_points;               /* Число точек данных. */
+  gfloat                      *values;                 /* Интенсивность, взвешенный угол и дальность. */
+} HyScanForwardLookPlayerFrame;
+
+/* Накопитель усреднения данных. */
+typedef struct
+{
+  HyScanForwardLookPlayerAverage type;                 /* Режим усреднения. */
+  guint                        size;                   /* Число усредняемых зондирований. */
+
+  GQueue                       frames;                 /* Зондирования в окне усреднения по возрастанию индекса. */
+  guint32                      index;                  /* Индекс последнего учтённого зондирования. */
+  gboolean                     valid;                  /* Признак наличия данных в накопителе. */
+
+  gdouble                     *amplitude;              /* Накопленная интенсивность. */
+  gdouble                     *angle;                  /* Накопленный угол, взвешенный интенсивностью. */
+  gdouble                     *weight;                 /* Накопленный вес зондирований, содержащих точку. */
+  guint32                      n_sums;                 /* Размер накопителей. */
+
+  HyScanBuffer                *buffer;                 /* Буфер усреднённых данных. */
+} HyScanForwardLookPlayerAverager;
+
 typedef struct
 {
   HyScanForwardLookData       *data;                   /* Объект обработки данных. */
+  GMutex                       process_lock;           /* Блокировка объекта обработки данных. */
 
   guint32                      first_index;            /* Первый индекс данных. */
   guint32                      last_index;             /* Последний индекс данных. */
@@ -62,6 +129,10 @@ typedef struct
   HyScanAntennaOffset          offset;                 /* Смещение приёмной антенны. */
   gdouble                      alpha;                  /* Максимальный/минимальный угол по азимуту, рад. */
 
+  HyScanForwardLookPlayerAverager averager;            /* Накопитель усреднения данных. */
+  HyScanForwardLookPlayerPrefetch prefetch;            /* Упреждающее чтение данных. */
+  HyScanForwardLookPlayerStats stats;                  /* Статистика воспроизведения. */
+
   GMutex                       lock;                   /* Блокировка данных. */
 } HyScanForwardLookPlayerData;
 
@@ -93,11 +164,51 @@ static void      hyscan_forward_look_player_open_data          (HyScanForwardLoo
 static void      hyscan_forward_look_player_check_range        (HyScanForwardLookPlayerState  *state,
                                                                 HyScanForwardLookPlayerData   *data);
 
+static HyScanForwardLookPlayerFrame *
+                 hyscan_forward_look_player_frame_new          (HyScanForwardLookPlayerData   *data,
+                                                                guint32                        index);
+static void      hyscan_forward_look_player_frame_free         (gpointer                       data);
+
+static void      hyscan_forward_look_player_average_reset      (HyScanForwardLookPlayerAverager *averager);
+static void      hyscan_forward_look_player_average_grow       (HyScanForwardLookPlayerAverager *averager,
+                                                                guint32                        n_points);
+static void      hyscan_forward_look_player_average_add        (HyScanForwardLookPlayerAverager *averager,
+                                                                HyScanForwardLookPlayerFrame  *frame,
+                                                                gdouble                        sign);
+static void      hyscan_forward_look_player_average_push       (HyScanForwardLookPlayerData   *data,
+                                                                HyScanForwardLookPlayerFrame  *current,
+                                                                guint32                        index,
+                                                                gboolean                       tail);
+static void      hyscan_forward_look_player_average_boxcar     (HyScanForwardLookPlayerData   *data,
+                                                                HyScanForwardLookPlayerFrame  *current);
+static void      hyscan_forward_look_player_average_exp        (HyScanForwardLookPlayerData   *data,
+                                                                HyScanForwardLookPlayerFrame  *current);
+
+static gboolean  hyscan_forward_look_player_prefetch_ready     (HyScanForwardLookPlayerData   *data,
+                                                                guint32                        index);
+static void      hyscan_forward_look_player_prefetch_update    (HyScanForwardLookPlayerData   *data,
+                                                                gboolean                       active,
+                                                                guint32                        index,
+                                                                gint                           direction,
+                                                                guint                          depth);
+static const HyScanDOA *
+                 hyscan_forward_look_player_fetch              (HyScanForwardLookPlayerData   *data,
+                                                                guint32                        index,
+                                                                guint32                       *n_points,
+                                                                gint64                        *time);
+
+static const HyScanDOA *
+                 hyscan_forward_look_player_get_doa            (HyScanForwardLookPlayerData   *data,
+                                                                guint32                        index,
+                                                                guint32                       *n_points,
+                                                                gint64                        *time);
+
 static gint64    hyscan_forward_look_player_play_index         (HyScanForwardLookPlayerData   *data,
                                                                 gint64                         time,
                                                                 gboolean                       reverse);
 
 static gpointer  hyscan_forward_look_player_processor          (gpointer                       data);
+static gpointer  hyscan_forward_look_player_prefetcher         (gpointer                       data);
 static gboolean  hyscan_forward_look_player_signaller          (gpointer                       data);
 
 static guint     hyscan_forward_look_player_signals[SIGNAL_LAST] = { 0 };
@@ -136,15 +247,29 @@ hyscan_forward_look_player_object_constructed (GObject *object)
 {
   HyScanForwardLookPlayer *player = HYSCAN_FORWARD_LOOK_PLAYER (object);
   HyScanForwardLookPlayerPrivate *priv = player->priv;
+  guint i;
 
   g_mutex_init (&priv->ctl_lock);
   g_mutex_init (&priv->data.lock);
+  g_mutex_init (&priv->data.process_lock);
 
   priv->mode = HYSCAN_FORWARD_LOOK_PLAYER_STOP;
   priv->speed = 1.0;
   priv->delay = G_USEC_PER_SEC / DEFAULT_FPS;
 
+  g_queue_init (&priv->data.averager.frames);
+  priv->data.averager.type = HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_NONE;
+  priv->data.averager.size = 1;
+  priv->data.averager.buffer = hyscan_buffer_new ();
+
+  g_mutex_init (&priv->data.prefetch.lock);
+  g_cond_init (&priv->data.prefetch.cond);
+  priv->data.prefetch.buffer = hyscan_buffer_new ();
+  for (i = 0; i < MAX_PREFETCH; i++)
+    priv->data.prefetch.slots[i].doa = hyscan_buffer_new ();
+
   priv->processor = g_thread_new ("fl-processor", hyscan_forward_look_player_processor, priv);
+  priv->data.prefetch.thread = g_thread_new ("fl-prefetcher", hyscan_forward_look_player_prefetcher, priv);
 
   g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, priv->delay / 1000,
                       hyscan_forward_look_player_signaller, player, NULL);
@@ -155,13 +280,32 @@ hyscan_forward_look_player_object_finalize (GObject *object)
 {
   HyScanForwardLookPlayer *player = HYSCAN_FORWARD_LOOK_PLAYER (object);
   HyScanForwardLookPlayerPrivate *priv = player->priv;
+  guint i;
 
   g_source_remove_by_user_data (player);
 
   g_atomic_int_set (&priv->shutdown, 1);
   g_clear_pointer (&priv->processor, g_thread_join);
 
+  g_mutex_lock (&priv->data.prefetch.lock);
+  g_cond_signal (&priv->data.prefetch.cond);
+  g_mutex_unlock (&priv->data.prefetch.lock);
+  g_clear_pointer (&priv->data.prefetch.thread, g_thread_join);
+
+  for (i = 0; i < MAX_PREFETCH; i++)
+    g_object_unref (priv->data.prefetch.slots[i].doa);
+  g_object_unref (priv->data.prefetch.buffer);
+  g_cond_clear (&priv->data.prefetch.cond);
+  g_mutex_clear (&priv->data.prefetch.lock);
+
+  hyscan_forward_look_player_average_reset (&priv->data.averager);
+  g_free (priv->data.averager.amplitude);
+  g_free (priv->data.averager.angle);
+  g_free (priv->data.averager.weight);
+  g_object_unref (priv->data.averager.buffer);
+
   g_mutex_clear (&priv->data.lock);
+  g_mutex_clear (&priv->data.process_lock);
   g_mutex_clear (&priv->ctl_lock);
 
   G_OBJECT_CLASS (hyscan_forward_look_player_parent_class)->finalize (object);
@@ -205,6 +349,16 @@ hyscan_forward_look_player_sync_state (HyScanForwardLookPlayerState *new_state,
       new_state->sound_velocity_changed = FALSE;
     }
 
+  /* Новый режим усреднения данных. */
+  if (new_state->average_changed)
+    {
+      cur_state->average = new_state->average;
+      cur_state->n_average = new_state->n_average;
+      cur_state->average_changed = TRUE;
+
+      new_state->average_changed = FALSE;
+    }
+
   /* Принудительная обработка строки с указанным индексом. */
   if (new_state->index_changed)
     {
@@ -216,7 +370,8 @@ hyscan_forward_look_player_sync_state (HyScanForwardLookPlayerState *new_state,
 }
 
 /* Функция открывает галс на обработку и устанавливает параметры
- * кэширования и скорости звука. */
+ * кэширования и скорости звука. Объект обработки данных используется
+ * также потоком упреждающего чтения, поэтому изменяется под блокировкой. */
 static void
 hyscan_forward_look_player_open_data (HyScanForwardLookPlayerState *state,
                                       HyScanForwardLookPlayerData  *data)
@@ -225,8 +380,10 @@ hyscan_forward_look_player_open_data (HyScanForwardLookPlayerState *state,
   if (state->track_changed)
     {
       /* Закрываем предыдущий галс, открываем новый. */
+      g_mutex_lock (&data->process_lock);
       g_clear_object (&data->data);
       data->data = hyscan_forward_look_data_new (state->db, state->cache, state->project_name, state->track_name);
+      g_mutex_unlock (&data->process_lock);
     }
 
   /* Устанавливаем скорость звука. */
@@ -234,11 +391,35 @@ hyscan_forward_look_player_open_data (HyScanForwardLookPlayerState *state,
     {
       if (state->sound_velocity_changed || state->track_changed)
         {
+          HyScanForwardLookPlayerPrefetch *prefetch = &data->prefetch;
+
+          g_mutex_lock (&data->process_lock);
           hyscan_forward_look_data_set_sound_velocity (data->data, state->sound_velocity);
+          g_mutex_unlock (&data->process_lock);
+
+          /* Строки, подготовленные заранее, больше не используются. */
+          g_mutex_lock (&prefetch->lock);
+          prefetch->generation += 1;
+          prefetch->active = FALSE;
+          g_cond_signal (&prefetch->cond);
+          g_mutex_unlock (&prefetch->lock);
+
+          hyscan_forward_look_player_average_reset (&data->averager);
           state->sound_velocity_changed = FALSE;
+          state->index_changed = TRUE;
         }
     }
 
+  /* Устанавливаем режим усреднения данных. */
+  if (state->average_changed)
+    {
+      hyscan_forward_look_player_average_reset (&data->averager);
+      data->averager.type = state->average;
+      data->averager.size = state->n_average;
+      state->average_changed = FALSE;
+      state->index_changed = TRUE;
+    }
+
   /* Обнуляем текущий буфер массива целей и индексов данных. */
   if (state->track_changed)
     {
@@ -246,10 +427,14 @@ hyscan_forward_look_player_open_data (HyScanForwardLookPlayerState *state,
 
       if (data->data != NULL)
         {
+          g_mutex_lock (&data->process_lock);
           data->offset = hyscan_forward_look_data_get_offset (data->data);
           data->alpha = hyscan_forward_look_data_get_alpha (data->data);
+          g_mutex_unlock (&data->process_lock);
         }
 
+      hyscan_forward_look_player_average_reset (&data->averager);
+
       data->doa = NULL;
       data->n_points = 0;
       data->doa_time = 0;
@@ -279,7 +464,9 @@ hyscan_forward_look_player_check_range (HyScanForwardLookPlayerState *state,
   guint32 last_index = 0;
 
   /* Текущий диапазон данных. */
+  g_mutex_lock (&data->process_lock);
   hyscan_forward_look_data_get_range (data->data, &first_index, &last_index);
+  g_mutex_unlock (&data->process_lock);
 
   g_mutex_lock (&data->lock);
 
@@ -294,6 +481,410 @@ hyscan_forward_look_player_check_range (HyScanForwardLookPlayerState *state,
   g_mutex_unlock (&data->lock);
 }
 
+/* Функция освобождает память, занятую копией зондирования. */
+static void
+hyscan_forward_look_player_frame_free (gpointer data)
+{
+  HyScanForwardLookPlayerFrame *frame = data;
+
+  g_free (frame->values);
+  g_slice_free (HyScanForwardLookPlayerFrame, frame);
+}
+
+/* Функция создаёт копию зондирования с указанным индексом. Если данных
+ * нет, создаётся пустое зондирование. */
+static HyScanForwardLookPlayerFrame *
+hyscan_forward_look_player_frame_new (HyScanForwardLookPlayerData *data,
+                                      guint32                      index)
+{
+  HyScanForwardLookPlayerFrame *frame;
+  const HyScanDOA *doa;
+  guint32 n_points;
+  gint64 time;
+  guint32 i;
+
+  frame = g_slice_new0 (HyScanForwardLookPlayerFrame);
+  frame->index = index;
+
+  doa = hyscan_forward_look_player_fetch (data, index, &n_points, &time);
+  if ((doa == NULL) || (n_points == 0))
+    return frame;
+
+  frame->time = time;
+  frame->n_points = n_points;
+  frame->values = g_new (gfloat, 3 * n_points);
+
+  for (i = 0; i < n_points; i++)
+    {
+      frame->values[3 * i] = doa[i].amplitude;
+      frame->values[3 * i + 1] = doa[i].amplitude * doa[i].angle;
+      frame->values[3 * i + 2] = doa[i].distance;
+    }
+
+  return frame;
+}
+
+/* Функция очищает накопитель усреднения. */
+static void
+hyscan_forward_look_player_average_reset (HyScanForwardLookPlayerAverager *averager)
+{
+  g_queue_foreach (&averager->frames, (GFunc) hyscan_forward_look_player_frame_free, NULL);
+  g_queue_clear (&averager->frames);
+
+  if (averager->n_sums > 0)
+    {
+      memset (averager->amplitude, 0, averager->n_sums * sizeof (gdouble));
+      memset (averager->angle, 0, averager->n_sums * sizeof (gdouble));
+      memset (averager->weight, 0, averager->n_sums * sizeof (gdouble));
+    }
+
+  averager->valid = FALSE;
+}
+
+/* Функция увеличивает размер накопителей. */
+static void
+hyscan_forward_look_player_average_grow (HyScanForwardLookPlayerAverager *averager,
+                                         guint32                          n_points)
+{
+  if (n_points <= averager->n_sums)
+    return;
+
+  averager->amplitude = g_renew (gdouble, averager->amplitude, n_points);
+  averager->angle = g_renew (gdouble, averager->angle, n_points);
+  averager->weight = g_renew (gdouble, averager->weight, n_points);
+
+  memset (averager->amplitude + averager->n_sums, 0, (n_points - averager->n_sums) * sizeof (gdouble));
+  memset (averager->angle + averager->n_sums, 0, (n_points - averager->n_sums) * sizeof (gdouble));
+  memset (averager->weight + averager->n_sums, 0, (n_points - averager->n_sums) * sizeof (gdouble));
+
+  averager->n_sums = n_points;
+}
+
+/* Функция добавляет зондирование в накопитель (sign = 1.0) или исключает
+ * его из накопителя (sign = -1.0). Зондирования могут иметь разное число
+ * точек, поэтому для каждой точки учитывается число содержащих её зондирований. */
+static void
+hyscan_forward_look_player_average_add (HyScanForwardLookPlayerAverager *averager,
+                                        HyScanForwardLookPlayerFrame    *frame,
+                                        gdouble                          sign)
+{
+  gdouble *amplitude;
+  gdouble *angle;
+  gdouble *weight;
+  guint32 i;
+
+  if (frame->n_points == 0)
+    return;
+
+  hyscan_forward_look_player_average_grow (averager, frame->n_points);
+
+  amplitude = averager->amplitude;
+  angle = averager->angle;
+  weight = averager->weight;
+  for (i = 0; i < frame->n_points; i++)
+    {
+      amplitude[i] += sign * frame->values[3 * i];
+      angle[i] += sign * frame->values[3 * i + 1];
+      weight[i] += sign;
+    }
+}
+
+/* Функция добавляет в начало или конец окна усреднения зондирование
+ * с указанным индексом. Зондирование current используется без повторного чтения. */
+static void
+hyscan_forward_look_player_average_push (HyScanForwardLookPlayerData  *data,
+                                         HyScanForwardLookPlayerFrame *current,
+                                         guint32                       index,
+                                         gboolean                      tail)
+{
+  HyScanForwardLookPlayerAverager *averager = &data->averager;
+  HyScanForwardLookPlayerFrame *frame;
+
+  if (index == current->index)
+    frame = current;
+  else
+    frame = hyscan_forward_look_player_frame_new (data, index);
+
+  hyscan_forward_look_player_average_add (averager, frame, 1.0);
+
+  if (tail)
+    g_queue_push_tail (&averager->frames, frame);
+  else
+    g_queue_push_head (&averager->frames, frame);
+}
+
+/* Функция сдвигает окно скользящего среднего так, чтобы оно заканчивалось
+ * на текущем зондировании. При переходе к соседней строке в накопитель
+ * добавляется одно зондирование и исключается одно, при переходе на
+ * большое расстояние окно заполняется заново. */
+static void
+hyscan_forward_look_player_average_boxcar (HyScanForwardLookPlayerData  *data,
+                                           HyScanForwardLookPlayerFrame *current)
+{
+  HyScanForwardLookPlayerAverager *averager = &data->averager;
+  HyScanForwardLookPlayerFrame *head, *tail;
+  guint32 first, last;
+  guint32 index;
+
+  last = current->index;
+  if (last >= data->first_index + averager->size - 1)
+    first = last - averager->size + 1;
+  else
+    first = data->first_index;
+
+  head = g_queue_peek_head (&averager->frames);
+  tail = g_queue_peek_tail (&averager->frames);
+
+  /* Окна не пересекаются - заполняем окно заново. */
+  if ((head != NULL) && ((head->index > last) || (tail->index < first)))
+    {
+      hyscan_forward_look_player_average_reset (averager);
+      head = tail = NULL;
+    }
+
+  /* Исключаем зондирования, вышедшие за пределы окна. */
+  while ((head != NULL) && (head->index < first))
+    {
+      g_queue_pop_head (&averager->frames);
+      hyscan_forward_look_player_average_add (averager, head, -1.0);
+      hyscan_forward_look_player_frame_free (head);
+      head = g_queue_peek_head (&averager->frames);
+    }
+
+  while ((tail != NULL) && (tail->index > last))
+    {
+      g_queue_pop_tail (&averager->frames);
+      hyscan_forward_look_player_average_add (averager, tail, -1.0);
+      hyscan_forward_look_player_frame_free (tail);
+      tail = g_queue_peek_tail (&averager->frames);
+    }
+
+  /* Окно опустело - обнуляем накопители для исключения ошибок округления. */
+  if (g_queue_is_empty (&averager->frames))
+    {
+      hyscan_forward_look_player_average_reset (averager);
+
+      for (index = first; index <= last; index++)
+        hyscan_forward_look_player_average_push (data, current, index, TRUE);
+
+      return;
+    }
+
+  /* Добавляем недостающие зондирования. */
+  head = g_queue_peek_head (&averager->frames);
+  tail = g_queue_peek_tail (&averager->frames);
+
+  for (index = tail->index + 1; index <= last; index++)
+    hyscan_forward_look_player_average_push (data, current, index, TRUE);
+
+  for (index = head->index; index > first; index--)
+    hyscan_forward_look_player_average_push (data, current, index - 1, FALSE);
+
+  /* Текущее зондирование уже было в окне. */
+  if (current->index == tail->index)
+    hyscan_forward_look_player_frame_free (current);
+}
+
+/* Функция обновляет экспоненциальное среднее. */
+static void
+hyscan_forward_look_player_average_exp (HyScanForwardLookPlayerData  *data,
+                                        HyScanForwardLookPlayerFrame *current)
+{
+  HyScanForwardLookPlayerAverager *averager = &data->averager;
+  gdouble *amplitude;
+  gdouble *angle;
+  gdouble *weights;
+  gdouble weight;
+  guint32 distance;
+  guint32 i;
+
+  distance = (current->index > averager->index) ? current->index - averager->index :
+                                                  averager->index - current->index;
+
+  /* Накопитель пуст или переход на большое расстояние. */
+  if (!averager->valid || (distance > averager->size))
+    {
+      hyscan_forward_look_player_average_reset (averager);
+      hyscan_forward_look_player_average_add (averager, current, 1.0);
+    }
+
+  /* Добавляем новое зондирование. */
+  else if (distance > 0)
+    {
+      hyscan_forward_look_player_average_grow (averager, current->n_points);
+
+      weight = 2.0 / (averager->size + 1.0);
+      amplitude = averager->amplitude;
+      angle = averager->angle;
+      weights = averager->weight;
+
+      for (i = 0; i < averager->n_sums; i++)
+        {
+          amplitude[i] *= (1.0 - weight);
+          angle[i] *= (1.0 - weight);
+          weights[i] *= (1.0 - weight);
+        }
+
+      for (i = 0; i < current->n_points; i++)
+        {
+          amplitude[i] += weight * current->values[3 * i];
+          angle[i] += weight * current->values[3 * i + 1];
+          weights[i] += weight;
+        }
+    }
+
+  averager->index = current->index;
+  averager->valid = TRUE;
+
+  hyscan_forward_look_player_frame_free (current);
+}
+
+/* Функция проверяет, подготовлена ли строка с указанным индексом заранее. */
+static gboolean
+hyscan_forward_look_player_prefetch_ready (HyScanForwardLookPlayerData *data,
+                                           guint32                      index)
+{
+  HyScanForwardLookPlayerPrefetch *prefetch = &data->prefetch;
+  HyScanForwardLookPlayerSlot *slot;
+  gboolean ready;
+
+  g_mutex_lock (&prefetch->lock);
+
+  slot = &prefetch->slots[index % MAX_PREFETCH];
+  ready = slot->valid && (slot->index == index) && (slot->generation == prefetch->generation);
+
+  g_mutex_unlock (&prefetch->lock);
+
+  return ready;
+}
+
+/* Функция задаёт текущую позицию и направление воспроизведения для потока
+ * упреждающего чтения. */
+static void
+hyscan_forward_look_player_prefetch_update (HyScanForwardLookPlayerData *data,
+                                            gboolean                     active,
+                                            guint32                      index,
+                                            gint                         direction,
+                                            guint                        depth)
+{
+  HyScanForwardLookPlayerPrefetch *prefetch = &data->prefetch;
+
+  g_mutex_lock (&prefetch->lock);
+
+  if ((prefetch->active != active) || (prefetch->index != index) ||
+      (prefetch->direction != direction) || (prefetch->depth != depth))
+    {
+      prefetch->active = active;
+      prefetch->index = index;
+      prefetch->direction = direction;
+      prefetch->depth = depth;
+
+      g_cond_signal (&prefetch->cond);
+    }
+
+  g_mutex_unlock (&prefetch->lock);
+}
+
+/* Функция считывает данные для указанного индекса. Если строка была
+ * подготовлена заранее, она забирается из кольца без обработки. Иначе
+ * строка обрабатывается и копируется в буфер выданной строки, так как
+ * данные объекта обработки может изменить поток упреждающего чтения. */
+static const HyScanDOA *
+hyscan_forward_look_player_fetch (HyScanForwardLookPlayerData *data,
+                                  guint32                      index,
+                                  guint32                     *n_points,
+                                  gint64                      *time)
+{
+  HyScanForwardLookPlayerPrefetch *prefetch = &data->prefetch;
+  HyScanForwardLookPlayerSlot *slot;
+  gboolean ready;
+
+  g_mutex_lock (&prefetch->lock);
+
+  slot = &prefetch->slots[index % MAX_PREFETCH];
+  ready = slot->valid && (slot->index == index) && (slot->generation == prefetch->generation);
+  if (ready)
+    {
+      HyScanBuffer *buffer = prefetch->buffer;
+
+      prefetch->buffer = slot->doa;
+      slot->doa = buffer;
+      slot->valid = FALSE;
+
+      (time != NULL) ? *time = slot->time : 0;
+    }
+
+  g_mutex_unlock (&prefetch->lock);
+
+  if (!ready)
+    {
+      const HyScanDOA *doa;
+
+      g_mutex_lock (&data->process_lock);
+      doa = hyscan_forward_look_data_get_doa (data->data, index, n_points, time);
+      if (doa != NULL)
+        hyscan_buffer_set_doa (prefetch->buffer, (HyScanDOA *)doa, *n_points);
+      g_mutex_unlock (&data->process_lock);
+
+      if (doa == NULL)
+        return NULL;
+    }
+
+  return hyscan_buffer_get_doa (prefetch->buffer, n_points);
+}
+
+/* Функция считывает данные для указанного индекса с учётом режима усреднения. */
+static const HyScanDOA *
+hyscan_forward_look_player_get_doa (HyScanForwardLookPlayerData *data,
+                                    guint32                      index,
+                                    guint32                     *n_points,
+                                    gint64                      *time)
+{
+  HyScanForwardLookPlayerAverager *averager = &data->averager;
+  HyScanForwardLookPlayerFrame *current;
+  HyScanDOA *doa;
+  guint32 i;
+
+  if ((averager->type == HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_NONE) || (averager->size < 2))
+    return hyscan_forward_look_player_fetch (data, index, n_points, time);
+
+  /* Текущее зондирование. */
+  current = hyscan_forward_look_player_frame_new (data, index);
+  if (current->n_points == 0)
+    {
+      hyscan_forward_look_player_frame_free (current);
+      return NULL;
+    }
+
+  /* Размер выходных данных и дальность определяются текущим зондированием. */
+  *n_points = current->n_points;
+  *time = current->time;
+
+  hyscan_buffer_set_doa (averager->buffer, NULL, *n_points);
+  doa = hyscan_buffer_get_doa (averager->buffer, n_points);
+  for (i = 0; i < *n_points; i++)
+    doa[i].distance = current->values[3 * i + 2];
+
+  /* Обновляем накопитель. Зондирование current передаётся ему во владение. */
+  if (averager->type == HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_BOXCAR)
+    hyscan_forward_look_player_average_boxcar (data, current);
+  else
+    hyscan_forward_look_player_average_exp (data, current);
+
+  /* Усреднённые значения. Каждая точка нормируется на суммарный вес
+   * зондирований, в которых она присутствует. */
+  for (i = 0; i < *n_points; i++)
+    {
+      gdouble amplitude = averager->amplitude[i];
+      gdouble weight = averager->weight[i];
+
+      doa[i].amplitude = (weight > 0.0) ? amplitude / weight : 0.0;
+      doa[i].angle = (amplitude > 0.0) ? averager->angle[i] / amplitude : 0.0;
+    }
+
+  return doa;
+}
+
 /* Функция ищет индекс данных для отображения в текущий момент времени. */
 static gint64
 hyscan_forward_look_player_play_index (HyScanForwardLookPlayerData *data,
@@ -304,7 +895,9 @@ hyscan_forward_look_player_play_index (HyScanForwardLookPlayerData *data,
   guint32 lindex, rindex;
 
   /* Ищем индекс для текущего времени проигрывания. */
+  g_mutex_lock (&data->process_lock);
   status = hyscan_forward_look_data_find_data (data->data, time, &lindex, &rindex, NULL, NULL);
+  g_mutex_unlock (&data->process_lock);
   if (status == HYSCAN_DB_FIND_OK)
     return reverse ? rindex : lindex;
   else if (status == HYSCAN_DB_FIND_LESS)
@@ -322,6 +915,9 @@ hyscan_forward_look_player_processor (gpointer user_data)
   HyScanForwardLookPlayerPrivate *priv = user_data;
 
   gint64 start_time = 0;
+  gint64 last_index = -1;
+  gdouble advance = 0.0;
+  guint depth = 0;
 
   GTimer *delay_timer = g_timer_new ();
   GTimer *play_timer = g_timer_new ();
@@ -346,8 +942,11 @@ hyscan_forward_look_player_processor (gpointer user_data)
       delay = priv->delay;
 
       /* Запуск воспроизведения. */
-      if (priv->mode == HYSCAN_FORWARD_LOOK_PLAYER_START)
-        priv->mode = HYSCAN_FORWARD_LOOK_PLAYER_PLAY;
+      if ((priv->mode == HYSCAN_FORWARD_LOOK_PLAYER_START) ||
+          (priv->mode == HYSCAN_FORWARD_LOOK_PLAYER_RESTART))
+        {
+          priv->mode = HYSCAN_FORWARD_LOOK_PLAYER_PLAY;
+        }
 
       g_mutex_unlock (&priv->ctl_lock);
 
@@ -357,6 +956,7 @@ hyscan_forward_look_player_processor (gpointer user_data)
       /* Нет галса для обработки или режим остановки. */
       if ((priv->data.data == NULL) || (mode == HYSCAN_FORWARD_LOOK_PLAYER_STOP))
         {
+          hyscan_forward_look_player_prefetch_update (&priv->data, FALSE, 0, 0, 0);
           g_usleep (DEFAULT_DELAY);
 
           continue;
@@ -365,11 +965,24 @@ hyscan_forward_look_player_processor (gpointer user_data)
       /* Проверяем диапазон данных. */
       hyscan_forward_look_player_check_range (&priv->cur_state, &priv->data);
 
-      /* Запуск воспроизведения. */
-      if (mode == HYSCAN_FORWARD_LOOK_PLAYER_START)
+      /* Запуск воспроизведения или его продолжение с новой позиции. Переход
+       * на новую позицию не считается пропуском строк, а статистика
+       * сбрасывается только при запуске воспроизведения. */
+      if ((mode == HYSCAN_FORWARD_LOOK_PLAYER_START) ||
+          (mode == HYSCAN_FORWARD_LOOK_PLAYER_RESTART))
         {
           g_timer_start (play_timer);
           priv->cur_state.index_changed = TRUE;
+
+          if (mode == HYSCAN_FORWARD_LOOK_PLAYER_START)
+            {
+              g_mutex_lock (&priv->data.lock);
+              memset (&priv->data.stats, 0, sizeof (priv->data.stats));
+              g_mutex_unlock (&priv->data.lock);
+            }
+
+          last_index = -1;
+          advance = 0.0;
         }
 
       /* Режим воспроизведения. */
@@ -385,6 +998,10 @@ hyscan_forward_look_player_processor (gpointer user_data)
           cur_index = hyscan_forward_look_player_play_index (&priv->data, cur_time,
                                                                    (speed > 0.0) ? FALSE : TRUE);
 
+          /* Среднее смещение индекса за период - для выбора глубины упреждения. */
+          if (cur_index >= 0)
+            advance = 0.9 * advance + 0.1 * ABS (cur_index - (gint64) priv->cur_state.index);
+
           if ((cur_index >= 0) && (cur_index != priv->cur_state.index))
             {
               priv->cur_state.index = cur_index;
@@ -414,19 +1031,53 @@ hyscan_forward_look_player_processor (gpointer user_data)
           priv->cur_state.index_changed = TRUE;
         }
 
+      /* Упреждающее чтение строк в направлении воспроизведения. */
+      if (mode == HYSCAN_FORWARD_LOOK_PLAYER_PLAY)
+        {
+          depth = MIN_PREFETCH * ceil (advance);
+          depth = CLAMP (depth, MIN_PREFETCH, MAX_PREFETCH - 1);
+          hyscan_forward_look_player_prefetch_update (&priv->data, TRUE, priv->cur_state.index,
+                                                      (speed > 0.0) ? 1 : -1, depth);
+        }
+      else
+        {
+          hyscan_forward_look_player_prefetch_update (&priv->data, FALSE, 0, 0, 0);
+        }
+
       /* Запрашиваем данные для текущего индекса. */
       if ((priv->cur_state.index_changed) && (!priv->data.doa_changed))
         {
           const HyScanDOA *doa;
           guint32 n_points;
           gint64 doa_time;
+          gboolean late = FALSE;
+
+          if (mode == HYSCAN_FORWARD_LOOK_PLAYER_PLAY)
+            late = !hyscan_forward_look_player_prefetch_ready (&priv->data, priv->cur_state.index);
 
-          doa = hyscan_forward_look_data_get_doa (priv->data.data, priv->cur_state.index,
-                                                  &n_points, &doa_time);
+          doa = hyscan_forward_look_player_get_doa (&priv->data, priv->cur_state.index,
+                                                    &n_points, &doa_time);
           if (doa != NULL)
             {
               g_mutex_lock (&priv->data.lock);
 
+              /* Статистика воспроизведения. */
+              if (mode == HYSCAN_FORWARD_LOOK_PLAYER_PLAY)
+                {
+                  if (last_index >= 0)
+                    {
+                      gint64 skip = ABS ((gint64)priv->cur_state.index - last_index);
+
+                      priv->data.stats.n_skipped += (skip > 1) ? skip - 1 : 0;
+                    }
+
+                  priv->data.stats.n_frames += 1;
+                  priv->data.stats.n_late += late ? 1 : 0;
+                  priv->data.stats.prefetch_depth = depth;
+                }
+
+              last_index = priv->cur_state.index;
+
               priv->data.doa = doa;
               priv->data.n_points = n_points;
               priv->data.doa_index = priv->cur_state.index;
@@ -434,8 +1085,11 @@ hyscan_forward_look_player_processor (gpointer user_data)
               priv->data.doa_changed = TRUE;
               priv->cur_state.index_changed = FALSE;
 
-              if (mode == HYSCAN_FORWARD_LOOK_PLAYER_START)
-                start_time = doa_time;
+              if ((mode == HYSCAN_FORWARD_LOOK_PLAYER_START) ||
+                  (mode == HYSCAN_FORWARD_LOOK_PLAYER_RESTART))
+                {
+                  start_time = doa_time;
+                }
 
               g_mutex_unlock (&priv->data.lock);
             }
@@ -447,7 +1101,9 @@ hyscan_forward_look_player_processor (gpointer user_data)
         g_usleep (delay);
     }
 
+  g_mutex_lock (&priv->data.process_lock);
   g_clear_object  (&priv->data.data);
+  g_mutex_unlock (&priv->data.process_lock);
 
   g_clear_object  (&priv->cur_state.db);
   g_clear_pointer (&priv->cur_state.project_name, g_free);
@@ -461,6 +1117,96 @@ hyscan_forward_look_player_processor (gpointer user_data)
   return NULL;
 }
 
+/* Поток упреждающего чтения данных. Поток обрабатывает строки, следующие
+ * за текущей в направлении воспроизведения, и помещает их в кольцо. Для
+ * обработки используется объект HyScanForwardLookData проигрывателя, поэтому
+ * его потоки обработки и кэш не дублируются. */
+static gpointer
+hyscan_forward_look_player_prefetcher (gpointer user_data)
+{
+  HyScanForwardLookPlayerPrivate *priv = user_data;
+  HyScanForwardLookPlayerPrefetch *prefetch = &priv->data.prefetch;
+
+  HyScanBuffer *buffer = hyscan_buffer_new ();
+
+  g_mutex_lock (&prefetch->lock);
+
+  while (!g_atomic_int_get (&priv->shutdown))
+    {
+      HyScanForwardLookPlayerSlot *slot;
+      const HyScanDOA *doa = NULL;
+      guint generation = prefetch->generation;
+      guint32 n_points;
+      gint64 time;
+      gint64 index = -1;
+      guint k;
+
+      /* Ищем ближайшую строку, которая ещё не подготовлена. */
+      for (k = 1; prefetch->active && (k <= prefetch->depth); k++)
+        {
+          gint64 next = (gint64)prefetch->index + prefetch->direction * (gint64)k;
+
+          if ((next < 0) || (next > G_MAXUINT32))
+            break;
+
+          slot = &prefetch->slots[next % MAX_PREFETCH];
+          if (slot->valid && (slot->index == next) && (slot->generation == generation))
+            continue;
+
+          index = next;
+          break;
+        }
+
+      /* Нет работы - ждём изменения позиции воспроизведения. */
+      if (index < 0)
+        {
+          g_cond_wait_until (&prefetch->cond, &prefetch->lock,
+                             g_get_monotonic_time () + DEFAULT_DELAY);
+          continue;
+        }
+
+      g_mutex_unlock (&prefetch->lock);
+
+      g_mutex_lock (&priv->data.process_lock);
+      if (priv->data.data != NULL)
+        doa = hyscan_forward_look_data_get_doa (priv->data.data, index, &n_points, &time);
+      if (doa != NULL)
+        hyscan_buffer_set_doa (buffer, (HyScanDOA *)doa, n_points);
+      g_mutex_unlock (&priv->data.process_lock);
+
+      g_mutex_lock (&prefetch->lock);
+
+      /* Данные ещё не записаны - ждём их появления. */
+      if (doa == NULL)
+        {
+          g_cond_wait_until (&prefetch->cond, &prefetch->lock,
+                             g_get_monotonic_time () + DEFAULT_DELAY);
+          continue;
+        }
+
+      /* Помещаем строку в кольцо, если параметры обработки не изменились. */
+      if (generation == prefetch->generation)
+        {
+          HyScanBuffer *swap;
+
+          slot = &prefetch->slots[index % MAX_PREFETCH];
+          swap = slot->doa;
+          slot->doa = buffer;
+          slot->index = index;
+          slot->time = time;
+          slot->generation = generation;
+          slot->valid = TRUE;
+          buffer = swap;
+        }
+    }
+
+  g_mutex_unlock (&prefetch->lock);
+
+  g_object_unref (buffer);
+
+  return NULL;
+}
+
 /* Функция сигнализации об изменении данных. */
 static gboolean
 hyscan_forward_look_player_signaller (gpointer user_data)
@@ -560,6 +1306,27 @@ hyscan_forward_look_player_set_sv (HyScanForwardLookPlayer *player,
   g_mutex_unlock (&priv->ctl_lock);
 }
 
+/* Функция задаёт режим усреднения данных по нескольким зондированиям. */
+void
+hyscan_forward_look_player_set_average (HyScanForwardLookPlayer        *player,
+                                        HyScanForwardLookPlayerAverage  average,
+                                        guint                           n_pings)
+{
+  HyScanForwardLookPlayerPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_FORWARD_LOOK_PLAYER (player));
+
+  priv = player->priv;
+
+  g_mutex_lock (&priv->ctl_lock);
+
+  priv->new_state.average = average;
+  priv->new_state.n_average = CLAMP (n_pings, 1, MAX_AVERAGE);
+  priv->new_state.average_changed = TRUE;
+
+  g_mutex_unlock (&priv->ctl_lock);
+}
+
 /* Функция открывает галс для обработки и воспроизведения. */
 void
 hyscan_forward_look_player_open (HyScanForwardLookPlayer *player,
@@ -674,6 +1441,25 @@ hyscan_forward_look_player_stop (HyScanForwardLookPlayer *player)
   g_mutex_unlock (&priv->ctl_lock);
 }
 
+/* Функция возвращает статистику воспроизведения. */
+void
+hyscan_forward_look_player_get_stats (HyScanForwardLookPlayer      *player,
+                                      HyScanForwardLookPlayerStats *stats)
+{
+  HyScanForwardLookPlayerPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_FORWARD_LOOK_PLAYER (player));
+  g_return_if_fail (stats != NULL);
+
+  priv = player->priv;
+
+  g_mutex_lock (&priv->data.lock);
+
+  *stats = priv->data.stats;
+
+  g_mutex_unlock (&priv->data.lock);
+}
+
 /* Функция перемещает текущую позицию воспроизведения в указанное место. */
 void
 hyscan_forward_look_player_seek (HyScanForwardLookPlayer *player,
@@ -688,7 +1474,7 @@ hyscan_forward_look_player_seek (HyScanForwardLookPlayer *player,
   g_mutex_lock (&priv->ctl_lock);
 
   if (priv->mode == HYSCAN_FORWARD_LOOK_PLAYER_PLAY)
-    priv->mode = HYSCAN_FORWARD_LOOK_PLAYER_START;
+    priv->mode = HYSCAN_FORWARD_LOOK_PLAYER_RESTART;
 
   priv->new_state.index = index;
   priv->new_state.index_changed = TRUE;
@@ -30,6 +30,9 @@
  * Для корректной обработки данных необходимо точное указание скорости звука, для
  * этого предназначена функция #hyscan_forward_look_player_set_sv.
  *
+ * Усреднение данных по нескольким зондированиям включается функцией
+ * #hyscan_forward_look_player_set_average.
+ *
  * Открытие и закрытие галсов производится функциями #hyscan_forward_look_player_open
  * и #hyscan_forward_look_player_close соответственно.
  *
@@ -39,6 +42,12 @@
  * #hyscan_forward_look_player_play, #hyscan_forward_look_player_pause,
  * #hyscan_forward_look_player_stop и #hyscan_forward_look_player_seek.
  *
+ * Во время воспроизведения отдельный поток заранее обрабатывает строки,
+ * следующие за текущей в направлении воспроизведения. Глубина упреждения
+ * подстраивается под скорость воспроизведения. Статистику пропущенных и
+ * не подготовленных заранее строк можно получить функцией
+ * #hyscan_forward_look_player_get_stats.
+ *
  * При готовности данных отправлются сигналы:
  *
  * - "range" - при изменении диапазона индексов строк данных;
@@ -84,6 +93,14 @@
 
 G_BEGIN_DECLS
 
+/** \brief Режимы усреднения данных по нескольким зондированиям. */
+typedef enum
+{
+  HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_NONE,     /**< Без усреднения. */
+  HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_BOXCAR,   /**< Скользящее среднее по N последним зондированиям. */
+  HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_EXP       /**< Экспоненциальное среднее с весом 2 / (N + 1). */
+} HyScanForwardLookPlayerAverage;
+
 /** \brief Информация о текущем зондировании вперёд смотрящего локатора. */
 typedef struct
 {
@@ -93,6 +110,15 @@ typedef struct
   gdouble              distance;               /**< Максимальная дистанция обзора, м. */
 } HyScanForwardLookPlayerInfo;
 
+/** \brief Статистика воспроизведения данных. */
+typedef struct
+{
+  guint                n_frames;               /**< Число отображённых строк. */
+  guint                n_skipped;              /**< Число пропущенных строк. */
+  guint                n_late;                 /**< Число строк, не подготовленных заранее. */
+  guint                prefetch_depth;         /**< Текущая глубина упреждающего чтения. */
+} HyScanForwardLookPlayerStats;
+
 #define HYSCAN_TYPE_FORWARD_LOOK_PLAYER             (hyscan_forward_look_player_get_type ())
 #define HYSCAN_FORWARD_LOOK_PLAYER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_FORWARD_LOOK_PLAYER, HyScanForwardLookPlayer))
 #define HYSCAN_IS_FORWARD_LOOK_PLAYER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_FORWARD_LOOK_PLAYER))
@@ -158,6 +184,29 @@ HYSCAN_API
 void                           hyscan_forward_look_player_set_sv       (HyScanForwardLookPlayer       *player,
                                                                         gdouble                        sound_velocity);
 
+/**
+ *
+ * Функция задаёт режим усреднения данных по нескольким зондированиям для
+ * подавления спекл-шума. Интенсивность целей усредняется по зондированиям,
+ * а угол прихода - с весом, равным интенсивности. Накопитель обновляется
+ * инкрементально: при переходе к соседней строке в него добавляется новое
+ * зондирование и исключается самое старое, поэтому стоимость обработки
+ * не зависит от числа усредняемых зондирований. Если зондирования имеют
+ * разную дальность, каждая точка усредняется только по зондированиям,
+ * в которых она присутствует.
+ *
+ * \param player указатель на объект \link HyScanForwardLookPlayer \endlink;
+ * \param average режим усреднения \link HyScanForwardLookPlayerAverage \endlink;
+ * \param n_pings число усредняемых зондирований от 1 до 256.
+ *
+ * \return Нет.
+ *
+ */
+HYSCAN_API
+void                           hyscan_forward_look_player_set_average  (HyScanForwardLookPlayer       *player,
+                                                                        HyScanForwardLookPlayerAverage average,
+                                                                        guint                          n_pings);
+
 /**
  *
  * Функция открывает галс для обработки и воспроизведения. При этом
@@ -246,6 +295,23 @@ void                           hyscan_forward_look_player_pause        (HyScanFo
 HYSCAN_API
 void                           hyscan_forward_look_player_stop         (HyScanForwardLookPlayer       *player);
 
+/**
+ *
+ * Функция возвращает статистику воспроизведения с момента его запуска.
+ * Пропущенными считаются строки, которые не были отображены из-за высокой
+ * скорости воспроизведения, а не подготовленными заранее - строки, которые
+ * пришлось обрабатывать синхронно в момент отображения.
+ *
+ * \param player указатель на объект \link HyScanForwardLookPlayer \endlink;
+ * \param stats указатель на структуру \link HyScanForwardLookPlayerStats \endlink.
+ *
+ * \return Нет.
+ *
+ */
+HYSCAN_API
+void                           hyscan_forward_look_player_get_stats    (HyScanForwardLookPlayer       *player,
+                                                                        HyScanForwardLookPlayerStats  *stats);
+
 /**
  *
  * Функция перемещает текущую позицию воспроизведения в указанное место.
@@ -0,0 +1,526 @@
+/* hyscan-forward-look-raster.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-forward-look-raster
+ * @Short_description: класс формирования изображения вперёдсмотрящего локатора
+ * @Title: HyScanForwardLookRaster
+ *
+ * Класс HyScanForwardLookRaster формирует растровое изображение сектора
+ * обзора вперёдсмотрящего локатора по массиву целей #HyScanDOA. Изображение
+ * представляет собой массив интенсивностей размером width * height. Вершина
+ * сектора находится в центре нижней строки изображения, первая строка
+ * соответствует максимальной дальности.
+ *
+ * Для каждой геометрии обзора, определяемой углом сектора обзора, частотой
+ * дискретизации, скоростью звука, числом точек и размером изображения,
+ * класс заранее рассчитывает таблицы дальностей в пикселях и синусов и
+ * косинусов квантованных углов. Формирование кадра сводится к выборке из
+ * таблиц без тригонометрических вычислений. Таблицы нескольких последних
+ * геометрий хранятся в объекте, что позволяет переключаться между ними без
+ * повторного расчёта.
+ *
+ * Размер изображения задаётся при создании объекта функцией
+ * #hyscan_forward_look_raster_new и может быть изменён функцией
+ * #hyscan_forward_look_raster_set_size. Масштаб изображения подбирается так,
+ * чтобы сектор обзора целиком помещался в изображение, размер пикселя можно
+ * узнать функцией #hyscan_forward_look_raster_get_pixel_size.
+ *
+ * Параметры обзора задаются функцией #hyscan_forward_look_raster_set_geometry.
+ *
+ * Функция #hyscan_forward_look_raster_set_persistence включает режим
+ * послесвечения, в котором изображение предыдущих кадров затухает с заданным
+ * коэффициентом, а не стирается. Сбросить накопленное изображение можно
+ * функцией #hyscan_forward_look_raster_reset.
+ *
+ * Кадр формируется функцией #hyscan_forward_look_raster_render.
+ *
+ * HyScanForwardLookRaster не поддерживает работу в многопоточном режиме.
+ */
+
+#include "hyscan-forward-look-raster.h"
+
+#include <string.h>
+#include <math.h>
+
+#define N_GEOMETRIES           4               /* Число хранимых геометрий обзора. */
+#define MIN_ANGLE_BINS         64              /* Минимальное число интервалов квантования угла. */
+#define MAX_ANGLE_BINS         8192            /* Максимальное число интервалов квантования угла. */
+#define MIN_SIZE               2               /* Минимальный размер изображения. */
+
+/* Геометрия обзора и таблицы пересчёта координат. */
+typedef struct
+{
+  gdouble                      alpha;          /* Угол сектора обзора, рад. */
+  gdouble                      data_rate;      /* Частота дискретизации, Гц. */
+  gdouble                      sound_velocity; /* Скорость звука, м/с. */
+  guint32                      n_points;       /* Число точек в строке. */
+  guint                        width;          /* Ширина изображения. */
+  guint                        height;         /* Высота изображения. */
+
+  gfloat                       sector;         /* Угол сектора, используемый в таблицах, рад. */
+  gdouble                      pixel_size;     /* Размер пикселя, м. */
+  gfloat                       cx;             /* Столбец вершины сектора. */
+  gfloat                       cy;             /* Строка вершины сектора. */
+  gfloat                       angle_scale;    /* Коэффициент пересчёта угла в индекс. */
+  guint                        n_angles;       /* Число интервалов квантования угла. */
+  gfloat                      *ranges;         /* Дальности точек, пикселей. */
+  gfloat                      *sins;           /* Синусы квантованных углов. */
+  gfloat                      *coss;           /* Косинусы квантованных углов. */
+} HyScanForwardLookRasterGeometry;
+
+struct _HyScanForwardLookRasterPrivate
+{
+  guint                        width;          /* Ширина изображения. */
+  guint                        height;         /* Высота изображения. */
+  gfloat                      *image;          /* Изображение. */
+  gfloat                       persistence;    /* Коэффициент послесвечения. */
+
+  gdouble                      alpha;          /* Угол сектора обзора, рад. */
+  gdouble                      data_rate;      /* Частота дискретизации, Гц. */
+  gdouble                      sound_velocity; /* Скорость звука, м/с. */
+
+  HyScanForwardLookRasterGeometry *geometries[N_GEOMETRIES]; /* Геометрии, от последней использованной. */
+  HyScanForwardLookRasterGeometry *current;    /* Геометрия текущего изображения. */
+
+  guint32                     *pixels;         /* Индексы пикселей точек кадра. */
+  guint32                      n_pixels;       /* Размер массива индексов. */
+};
+
+static void            hyscan_forward_look_raster_object_finalize  (GObject                          *object);
+
+static HyScanForwardLookRasterGeometry *
+                       hyscan_forward_look_raster_geometry_new     (HyScanForwardLookRasterPrivate   *priv,
+                                                                    guint32                           n_points);
+static void            hyscan_forward_look_raster_geometry_free    (HyScanForwardLookRasterGeometry  *geometry);
+
+static HyScanForwardLookRasterGeometry *
+                       hyscan_forward_look_raster_geometry_get     (HyScanForwardLookRasterPrivate   *priv,
+                                                                    guint32                           n_points);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanForwardLookRaster, hyscan_forward_look_raster, G_TYPE_OBJECT)
+
+static void
+hyscan_forward_look_raster_class_init (HyScanForwardLookRasterClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_forward_look_raster_object_finalize;
+}
+
+static void
+hyscan_forward_look_raster_init (HyScanForwardLookRaster *raster)
+{
+  raster->priv = hyscan_forward_look_raster_get_instance_private (raster);
+}
+
+static void
+hyscan_forward_look_raster_object_finalize (GObject *object)
+{
+  HyScanForwardLookRaster *raster = HYSCAN_FORWARD_LOOK_RASTER (object);
+  HyScanForwardLookRasterPrivate *priv = raster->priv;
+  guint i;
+
+  for (i = 0; i < N_GEOMETRIES; i++)
+    {
+      if (priv->geometries[i] != NULL)
+        hyscan_forward_look_raster_geometry_free (priv->geometries[i]);
+    }
+
+  g_free (priv->image);
+  g_free (priv->pixels);
+
+  G_OBJECT_CLASS (hyscan_forward_look_raster_parent_class)->finalize (object);
+}
+
+/* Функция рассчитывает таблицы пересчёта координат для текущих параметров. */
+static HyScanForwardLookRasterGeometry *
+hyscan_forward_look_raster_geometry_new (HyScanForwardLookRasterPrivate *priv,
+                                         guint32                         n_points)
+{
+  HyScanForwardLookRasterGeometry *geometry;
+  gdouble range_step;
+  gdouble max_range;
+  gdouble half_width;
+  gdouble alpha;
+  guint i;
+
+  geometry = g_slice_new0 (HyScanForwardLookRasterGeometry);
+
+  geometry->alpha = priv->alpha;
+  geometry->data_rate = priv->data_rate;
+  geometry->sound_velocity = priv->sound_velocity;
+  geometry->n_points = n_points;
+  geometry->width = priv->width;
+  geometry->height = priv->height;
+
+  /* Размер пикселя выбирается так, чтобы сектор обзора целиком
+   * помещался в изображение. */
+  alpha = CLAMP (priv->alpha, 0.0, G_PI / 2.0);
+  geometry->sector = alpha;
+  range_step = priv->sound_velocity / (2.0 * priv->data_rate);
+  max_range = range_step * MAX (n_points, 2);
+  half_width = max_range * sin (alpha);
+
+  geometry->pixel_size = MAX (2.0 * half_width / (priv->width - 1),
+                              max_range / (priv->height - 1));
+  geometry->cx = (priv->width - 1) / 2.0;
+  geometry->cy = priv->height - 1;
+
+  /* Шаг квантования угла соответствует примерно половине пикселя
+   * на максимальной дальности. */
+  geometry->n_angles = 2.0 * (2.0 * alpha * max_range / geometry->pixel_size) + 1;
+  geometry->n_angles = CLAMP (geometry->n_angles, MIN_ANGLE_BINS, MAX_ANGLE_BINS);
+  geometry->angle_scale = (alpha > 0.0) ? (geometry->n_angles - 1) / (2.0 * alpha) : 0.0;
+
+  geometry->ranges = g_new (gfloat, n_points);
+  for (i = 0; i < n_points; i++)
+    geometry->ranges[i] = i * range_step / geometry->pixel_size;
+
+  geometry->sins = g_new (gfloat, geometry->n_angles);
+  geometry->coss = g_new (gfloat, geometry->n_angles);
+  for (i = 0; i < geometry->n_angles; i++)
+    {
+      gdouble angle = -alpha + 2.0 * alpha * i / (geometry->n_angles - 1);
+
+      geometry->sins[i] = sin (angle);
+      geometry->coss[i] = cos (angle);
+    }
+
+  return geometry;
+}
+
+/* Функция освобождает таблицы пересчёта координат. */
+static void
+hyscan_forward_look_raster_geometry_free (HyScanForwardLookRasterGeometry *geometry)
+{
+  g_free (geometry->ranges);
+  g_free (geometry->sins);
+  g_free (geometry->coss);
+
+  g_slice_free (HyScanForwardLookRasterGeometry, geometry);
+}
+
+/* Функция возвращает таблицы пересчёта координат для текущих параметров.
+ * Таблицы ищутся среди ранее рассчитанных, при отсутствии - рассчитываются
+ * и замещают наиболее давно использованные. */
+static HyScanForwardLookRasterGeometry *
+hyscan_forward_look_raster_geometry_get (HyScanForwardLookRasterPrivate *priv,
+                                         guint32                         n_points)
+{
+  HyScanForwardLookRasterGeometry *geometry = NULL;
+  guint i;
+
+  for (i = 0; i < N_GEOMETRIES; i++)
+    {
+      HyScanForwardLookRasterGeometry *cur = priv->geometries[i];
+
+      if ((cur != NULL) &&
+          (cur->n_points == n_points) &&
+          (cur->width == priv->width) &&
+          (cur->height == priv->height) &&
+          (cur->alpha == priv->alpha) &&
+          (cur->data_rate == priv->data_rate) &&
+          (cur->sound_velocity == priv->sound_velocity))
+        {
+          geometry = cur;
+          break;
+        }
+    }
+
+  if (geometry == NULL)
+    {
+      i = N_GEOMETRIES - 1;
+      if (priv->geometries[i] != NULL)
+        hyscan_forward_look_raster_geometry_free (priv->geometries[i]);
+
+      geometry = hyscan_forward_look_raster_geometry_new (priv, n_points);
+    }
+
+  /* Перемещаем геометрию в начало списка. */
+  for (; i > 0; i--)
+    priv->geometries[i] = priv->geometries[i - 1];
+  priv->geometries[0] = geometry;
+
+  return geometry;
+}
+
+/**
+ * hyscan_forward_look_raster_new:
+ * @width: ширина изображения
+ * @height: высота изображения
+ *
+ * Функция создаёт новый объект #HyScanForwardLookRaster.
+ *
+ * Returns: #HyScanForwardLookRaster. Для удаления #g_object_unref.
+ */
+HyScanForwardLookRaster *
+hyscan_forward_look_raster_new (guint width,
+                                guint height)
+{
+  HyScanForwardLookRaster *raster;
+
+  raster = g_object_new (HYSCAN_TYPE_FORWARD_LOOK_RASTER, NULL);
+  hyscan_forward_look_raster_set_size (raster, width, height);
+
+  return raster;
+}
+
+/**
+ * hyscan_forward_look_raster_set_size:
+ * @raster: указатель на #HyScanForwardLookRaster
+ * @width: ширина изображения
+ * @height: высота изображения
+ *
+ * Функция задаёт размер изображения. При изменении размера накопленное
+ * изображение сбрасывается.
+ */
+void
+hyscan_forward_look_raster_set_size (HyScanForwardLookRaster *raster,
+                                     guint                    width,
+                                     guint                    height)
+{
+  HyScanForwardLookRasterPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_FORWARD_LOOK_RASTER (raster));
+
+  priv = raster->priv;
+
+  width = MAX (width, MIN_SIZE);
+  height = MAX (height, MIN_SIZE);
+
+  if ((priv->width == width) && (priv->height == height))
+    return;
+
+  priv->width = width;
+  priv->height = height;
+
+  g_free (priv->image);
+  priv->image = g_new0 (gfloat, width * height);
+  priv->current = NULL;
+}
+
+/**
+ * hyscan_forward_look_raster_set_persistence:
+ * @raster: указатель на #HyScanForwardLookRaster
+ * @persistence: коэффициент послесвечения
+ *
+ * Функция задаёт коэффициент послесвечения в пределах от 0 до 1. Перед
+ * формированием каждого кадра интенсивность предыдущего изображения
+ * умножается на этот коэффициент, после чего в каждый пиксель записывается
+ * максимальное из старого и нового значений. Значение 0 отключает
+ * послесвечение.
+ */
+void
+hyscan_forward_look_raster_set_persistence (HyScanForwardLookRaster *raster,
+                                            gdouble                  persistence)
+{
+  g_return_if_fail (HYSCAN_IS_FORWARD_LOOK_RASTER (raster));
+
+  raster->priv->persistence = CLAMP (persistence, 0.0, 1.0);
+}
+
+/**
+ * hyscan_forward_look_raster_set_geometry:
+ * @raster: указатель на #HyScanForwardLookRaster
+ * @alpha: угол сектора обзора, рад
+ * @data_rate: частота дискретизации данных, Гц
+ * @sound_velocity: скорость звука, м/с
+ *
+ * Функция задаёт параметры обзора. Угол сектора обзора можно узнать с
+ * помощью функции #hyscan_forward_look_data_get_alpha.
+ */
+void
+hyscan_forward_look_raster_set_geometry (HyScanForwardLookRaster *raster,
+                                         gdouble                  alpha,
+                                         gdouble                  data_rate,
+                                         gdouble                  sound_velocity)
+{
+  HyScanForwardLookRasterPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_FORWARD_LOOK_RASTER (raster));
+
+  if ((alpha <= 0.0) || (data_rate <= 0.0) || (sound_velocity <= 0.0))
+    return;
+
+  priv = raster->priv;
+
+  priv->alpha = alpha;
+  priv->data_rate = data_rate;
+  priv->sound_velocity = sound_velocity;
+}
+
+/**
+ * hyscan_forward_look_raster_reset:
+ * @raster: указатель на #HyScanForwardLookRaster
+ *
+ * Функция сбрасывает накопленное изображение.
+ */
+void
+hyscan_forward_look_raster_reset (HyScanForwardLookRaster *raster)
+{
+  HyScanForwardLookRasterPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_FORWARD_LOOK_RASTER (raster));
+
+  priv = raster->priv;
+
+  memset (priv->image, 0, priv->width * priv->height * sizeof (gfloat));
+}
+
+/**
+ * hyscan_forward_look_raster_get_pixel_size:
+ * @raster: указатель на #HyScanForwardLookRaster
+ *
+ * Функция возвращает размер пикселя последнего сформированного кадра.
+ *
+ * Returns: Размер пикселя, м, или 0, если кадр не формировался.
+ */
+gdouble
+hyscan_forward_look_raster_get_pixel_size (HyScanForwardLookRaster *raster)
+{
+  g_return_val_if_fail (HYSCAN_IS_FORWARD_LOOK_RASTER (raster), 0.0);
+
+  return (raster->priv->current != NULL) ? raster->priv->current->pixel_size : 0.0;
+}
+
+/**
+ * hyscan_forward_look_raster_render:
+ * @raster: указатель на #HyScanForwardLookRaster
+ * @doa: (array length=n_points): массив целей
+ * @n_points: число целей
+ * @width: (out) (nullable): ширина изображения
+ * @height: (out) (nullable): высота изображения
+ *
+ * Функция формирует изображение кадра. Если в пиксель попадает несколько
+ * целей, используется максимальная интенсивность.
+ *
+ * Функция возвращает указатель на внутренний буфер, данные в котором
+ * действительны до следующего вызова функций HyScanForwardLookRaster.
+ *
+ * Returns: (nullable) (transfer none): Изображение размером width * height
+ *          или NULL, если не заданы параметры обзора.
+ */
+const gfloat *
+hyscan_forward_look_raster_render (HyScanForwardLookRaster *raster,
+                                   const HyScanDOA         *doa,
+                                   guint32                  n_points,
+                                   guint                   *width,
+                                   guint                   *height)
+{
+  HyScanForwardLookRasterPrivate *priv;
+  HyScanForwardLookRasterGeometry *geometry;
+  gfloat *image;
+  guint32 *pixels;
+  guint32 n_image;
+  gint max_angle;
+  gfloat max_x;
+  gfloat max_y;
+  guint32 i;
+
+  g_return_val_if_fail (HYSCAN_IS_FORWARD_LOOK_RASTER (raster), NULL);
+
+  priv = raster->priv;
+
+  if (priv->data_rate <= 0.0)
+    return NULL;
+
+  (width != NULL) ? *width = priv->width : 0;
+  (height != NULL) ? *height = priv->height : 0;
+
+  image = priv->image;
+  n_image = priv->width * priv->height;
+
+  /* При смене геометрии координаты пикселей меняются, поэтому
+   * накопленное изображение сбрасывается. */
+  geometry = hyscan_forward_look_raster_geometry_get (priv, n_points);
+  if ((geometry != priv->current) || (priv->persistence == 0.0))
+    {
+      memset (image, 0, n_image * sizeof (gfloat));
+    }
+  else
+    {
+      gfloat persistence = priv->persistence;
+
+      for (i = 0; i < n_image; i++)
+        image[i] *= persistence;
+    }
+
+  priv->current = geometry;
+
+  if ((doa == NULL) || (n_points == 0))
+    return image;
+
+  if (priv->n_pixels < n_points)
+    {
+      g_free (priv->pixels);
+      priv->pixels = g_new (guint32, n_points);
+      priv->n_pixels = n_points;
+    }
+  pixels = priv->pixels;
+
+  /* Расчёт индексов пикселей. Цикл не содержит ветвлений и
+   * тригонометрических функций, что позволяет компилятору его
+   * векторизовать. */
+  max_angle = geometry->n_angles - 1;
+  max_x = priv->width - 1;
+  max_y = priv->height - 1;
+
+  for (i = 0; i < n_points; i++)
+    {
+      gint angle;
+      gfloat x, y;
+
+      angle = (doa[i].angle + geometry->sector) * geometry->angle_scale + 0.5f;
+      angle = CLAMP (angle, 0, max_angle);
+
+      x = geometry->cx + geometry->ranges[i] * geometry->sins[angle] + 0.5f;
+      y = geometry->cy - geometry->ranges[i] * geometry->coss[angle] + 0.5f;
+      x = CLAMP (x, 0.0f, max_x);
+      y = CLAMP (y, 0.0f, max_y);
+
+      pixels[i] = (guint32)y * priv->width + (guint32)x;
+    }
+
+  /* Перенос интенсивностей в изображение. */
+  for (i = 0; i < n_points; i++)
+    {
+      gfloat amplitude = doa[i].amplitude;
+
+      if (image[pixels[i]] < amplitude)
+        image[pixels[i]] = amplitude;
+    }
+
+  return image;
+}
@@ -0,0 +1,103 @@
+/* hyscan-forward-look-raster.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_FORWARD_LOOK_RASTER_H__
+#define __HYSCAN_FORWARD_LOOK_RASTER_H__
+
+#include <hyscan-api.h>
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_FORWARD_LOOK_RASTER             (hyscan_forward_look_raster_get_type ())
+#define HYSCAN_FORWARD_LOOK_RASTER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_FORWARD_LOOK_RASTER, HyScanForwardLookRaster))
+#define HYSCAN_IS_FORWARD_LOOK_RASTER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_FORWARD_LOOK_RASTER))
+#define HYSCAN_FORWARD_LOOK_RASTER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_FORWARD_LOOK_RASTER, HyScanForwardLookRasterClass))
+#define HYSCAN_IS_FORWARD_LOOK_RASTER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_FORWARD_LOOK_RASTER))
+#define HYSCAN_FORWARD_LOOK_RASTER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_FORWARD_LOOK_RASTER, HyScanForwardLookRasterClass))
+
+typedef struct _HyScanForwardLookRaster HyScanForwardLookRaster;
+typedef struct _HyScanForwardLookRasterPrivate HyScanForwardLookRasterPrivate;
+typedef struct _HyScanForwardLookRasterClass HyScanForwardLookRasterClass;
+
+struct _HyScanForwardLookRaster
+{
+  GObject parent_instance;
+
+  HyScanForwardLookRasterPrivate *priv;
+};
+
+struct _HyScanForwardLookRasterClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                          hyscan_forward_look_raster_get_type         (void);
+
+HYSCAN_API
+HyScanForwardLookRaster *      hyscan_forward_look_raster_new              (guint                    width,
+                                                                            guint                    height);
+
+HYSCAN_API
+void                           hyscan_forward_look_raster_set_size         (HyScanForwardLookRaster *raster,
+                                                                            guint                    width,
+                                                                            guint                    height);
+
+HYSCAN_API
+void                           hyscan_forward_look_raster_set_persistence  (HyScanForwardLookRaster *raster,
+                                                                            gdouble                  persistence);
+
+HYSCAN_API
+void                           hyscan_forward_look_raster_set_geometry     (HyScanForwardLookRaster *raster,
+                                                                            gdouble                  alpha,
+                                                                            gdouble                  data_rate,
+                                                                            gdouble                  sound_velocity);
+
+HYSCAN_API
+void                           hyscan_forward_look_raster_reset            (HyScanForwardLookRaster *raster);
+
+HYSCAN_API
+gdouble                        hyscan_forward_look_raster_get_pixel_size   (HyScanForwardLookRaster *raster);
+
+HYSCAN_API
+const gfloat *                 hyscan_forward_look_raster_render           (HyScanForwardLookRaster *raster,
+                                                                            const HyScanDOA         *doa,
+                                                                            guint32                  n_points,
+                                                                            guint                   *width,
+                                                                            guint                   *height);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_FORWARD_LOOK_RASTER_H__ */
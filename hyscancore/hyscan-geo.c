@@ -11,6 +11,11 @@
 #define MAX_ABS_CALC_LAT  180.0 /*G_PI*/
 #define EPS 1.0e-6
 
+#define LOCAL_N_COEFS     10          /* Число коэффициентов полинома второго порядка от трёх переменных. */
+#define LOCAL_ANGLE_STEP  1.0e-3      /* Шаг по широте и долготе при вычислении коэффициентов, радианы. */
+#define LOCAL_LINEAR_STEP 1000.0      /* Шаг по топоцентрическим X и Y при вычислении коэффициентов, метры. */
+#define LOCAL_HEIGHT_STEP 100.0       /* Шаг по высоте при вычислении коэффициентов, метры. */
+
 #define LON_OUT_OF_RANGE(x) (fabs(x)>MAX_ABS_INPUT_LON)
 #define LAT_OUT_OF_RANGE(x) (fabs(x)>MAX_ABS_INPUT_LAT)
 
@@ -50,9 +55,30 @@ struct HyScanGeoPrivate
 
   HyScanGeoEllipsoidParam  sphere_params;
 
+  /* Локальная проекция второго порядка: коэффициенты полиномов от
+   * (dB, dL, H) для X, Y, Z и от (X, Y, Z) для dB, dL, H. */
+  gdouble                  local_fwd[3][LOCAL_N_COEFS];
+  gdouble                  local_inv[3][LOCAL_N_COEFS];
+  gint                     fast_local;
+
   gint                     initialized;
 };
 
+/* Преобразование Гельмерта с заранее вычисленными параметрами. */
+struct _HyScanGeoTransform
+{
+  volatile gint            ref_count;
+
+  HyScanGeoEllipsoidParam  el_in;            /* Эллипсоид входной СК. */
+  HyScanGeoEllipsoidParam  el_out;           /* Эллипсоид выходной СК. */
+  gdouble                  matrix[3][3];     /* Матрица поворота с учетом масштаба. */
+  gdouble                  shift[3];         /* Линейный сдвиг. */
+};
+
+/* Кэш преобразований между стандартными СК. */
+#define N_CS_TYPES 6
+static volatile gsize hyscan_geo_transforms[N_CS_TYPES][N_CS_TYPES];
+
 static void             hyscan_geo_constructed          (GObject  *object);
 static void             hyscan_geo_finalize             (GObject  *object);
 
@@ -68,10 +94,44 @@ static void             hyscan_geo_topo2ecef            (HyScanGeo            *g
 static void             hyscan_geo_ecef2topo            (HyScanGeo            *geo,
                                                          HyScanGeoCartesian3D *dst,
                                                          HyScanGeoCartesian3D  src);
+static void             hyscan_geo_geo2topo_point       (HyScanGeo            *geo,
+                                                         HyScanGeoCartesian3D *dst_topo,
+                                                         HyScanGeoGeodetic     src_geod);
+static void             hyscan_geo_topo2geo_point       (HyScanGeo            *geo,
+                                                         HyScanGeoGeodetic    *dst_geod,
+                                                         HyScanGeoCartesian3D  src_topo);
+static gboolean         hyscan_geo_topoXY2geo_point     (HyScanGeo            *geo,
+                                                         HyScanGeoGeodetic    *dst_geod,
+                                                         HyScanGeoCartesian2D  src_topoXY,
+                                                         gdouble               h_geodetic,
+                                                         guint                 num_of_iter);
+
+static void             hyscan_geo_local_exact          (HyScanGeo            *geo,
+                                                         gboolean              inverse,
+                                                         const gdouble        *var,
+                                                         gdouble              *out);
+static void             hyscan_geo_local_init           (HyScanGeo            *geo,
+                                                         gboolean              inverse,
+                                                         gdouble               coefs[3][LOCAL_N_COEFS]);
+static inline gdouble   hyscan_geo_local_poly           (const gdouble        *c,
+                                                         gdouble               u,
+                                                         gdouble               v,
+                                                         gdouble               w);
+
+static void             hyscan_geo_transform_setup      (HyScanGeoTransform      *transform,
+                                                         HyScanGeoEllipsoidParam  el_params_in,
+                                                         HyScanGeoEllipsoidParam  el_params_out,
+                                                         HyScanGeoDatumParam      datum_param);
+static inline void      hyscan_geo_transform_apply      (const HyScanGeoTransform *transform,
+                                                         HyScanGeoGeodetic       *dst,
+                                                         HyScanGeoGeodetic        src);
+static gint             hyscan_geo_cs_index             (HyScanGeoCSType          cs_type);
 
 static HyScanGeoEllipsoidType hyscan_geo_get_ellipse_by_cs (HyScanGeoCSType cs_type);
 
 G_DEFINE_TYPE_WITH_PRIVATE (HyScanGeo, hyscan_geo, G_TYPE_OBJECT);
+G_DEFINE_BOXED_TYPE (HyScanGeoTransform, hyscan_geo_transform,
+                     hyscan_geo_transform_ref, hyscan_geo_transform_unref);
 
 static void
 hyscan_geo_class_init (HyScanGeoClass *klass)
@@ -200,12 +260,25 @@ hyscan_geo_set_origin_user (HyScanGeo              *geo,
   priv->N0 = ell_params.a / sqrt (1.0 - priv->N0_e * priv->sinB0);
   priv->N0_e = priv->N0 * priv->N0_e;
 
+  /* Коэффициенты локальной проекции. */
+  hyscan_geo_local_init (geo, FALSE, priv->local_fwd);
+  hyscan_geo_local_init (geo, TRUE, priv->local_inv);
+
   /* Устанавливаем флаг готовности. */
   g_atomic_int_set (&(geo->priv->initialized), 1);
 
   return TRUE;
 }
 
+void
+hyscan_geo_set_fast_local (HyScanGeo *geo,
+                           gboolean   fast_local)
+{
+  g_return_if_fail (HYSCAN_IS_GEO (geo));
+
+  g_atomic_int_set (&(geo->priv->fast_local), fast_local ? 1 : 0);
+}
+
 gboolean
 hyscan_geo_ready (HyScanGeo *geo,
                   gboolean   uninit)
@@ -307,6 +380,12 @@ hyscan_geo_topo2ecef (HyScanGeo            *geo,
 /*
  * Пересчет геоцентрических координат в геодезические
  *
+ * Используется замкнутая формула Vermeille (H. Vermeille, Direct transformation
+ * from geocentric coordinates to geodetic coordinates, Journal of Geodesy, 2002)
+ * без итераций. Формула применима для всех точек вне сферы радиусом около
+ * 43 км вокруг центра эллипсоида. Для высот от -11 км до +50 км погрешность
+ * пересчета в геодезические координаты и обратно менее 1e-8 м.
+ *
  * \param *dst - геодезические координаты на выходе
  * \param src - геоцентрические координаты на входе
  * \param params - параметры эллипсоида, должны соответствовать геодезическим координатам src,
@@ -317,61 +396,226 @@ hyscan_geo_ecef2geo (HyScanGeoGeodetic      *dst,
                      HyScanGeoCartesian3D    src,
                      HyScanGeoEllipsoidParam params)
 {
-  gdouble a, f, b, c, e_2, e_12, e_12xb, z, lat, lon, h, sin_lat, cos_lat, N, t, p;
-  gint i;
-  a = params.a; /* Большая полуось. */
-  f = params.f; /* Полярное сжатие. */
-  b = params.b; /* Малая полуось. */
-  c = params.c;
+  gdouble a2, e_2, e_4, p, p2, q, r, s, t, u, v, w, k, D, DZ;
+
   e_2 = params.e2; /* ellipticity squared. */
-  e_12 = params.e12;
-  e_12xb = e_12 * b;
-  z = src.z ;
+  e_4 = e_2 * e_2;
+  a2 = params.a * params.a;
 
   p = hypot (src.x, src.y);
   if (p < EPS) /* p > 0 a priori. */
     {
       dst->lat = G_PI_2 * hyscan_geo_sign_gdouble (src.z);
       dst->lon = 0.0;
-      dst->h = fabs (z) - b;
+      dst->h = fabs (src.z) - params.b;
+      return;
+    }
+
+  p2 = p * p / a2;
+  q = (1.0 - e_2) / a2 * src.z * src.z;
+  r = (p2 + q - e_4) / 6.0;
+  s = e_4 * p2 * q / (4.0 * r * r * r);
+  t = cbrt (1.0 + s + sqrt (s * (2.0 + s)));
+  u = r * (1.0 + t + 1.0 / t);
+  v = sqrt (u * u + e_4 * q);
+  w = e_2 * (u + v - q) / (2.0 * v);
+  k = sqrt (u + v + w * w) - w;
+  D = k * p / (k + e_2);
+  DZ = hypot (D, src.z);
+
+  dst->lat = 2.0 * atan2 (src.z, D + DZ);
+  dst->lon = atan2 (src.y, src.x);
+  dst->h = (k + e_2 - 1.0) / k * DZ;
+}
+
+/* Точный пересчет для вычисления коэффициентов локальной проекции.
+ * Прямой: (dB, dL, H) -> (X, Y, Z), обратный: (X, Y, Z) -> (dB, dL, H). */
+static void
+hyscan_geo_local_exact (HyScanGeo     *geo,
+                        gboolean       inverse,
+                        const gdouble *var,
+                        gdouble       *out)
+{
+  HyScanGeoPrivate *priv = geo->priv;
+  HyScanGeoCartesian3D ecef;
+
+  if (!inverse)
+    {
+      HyScanGeoGeodetic src;
+
+      src.lat = priv->B0 + var[0];
+      src.lon = priv->L0 + var[1];
+      src.h = var[2];
+
+      hyscan_geo_geo2ecef (&ecef, src, priv->sphere_params);
+      hyscan_geo_ecef2topo (geo, &ecef, ecef);
+
+      out[0] = ecef.x;
+      out[1] = ecef.y;
+      out[2] = ecef.z;
     }
   else
     {
-      t = src.z / p * (1.0 + e_12xb / hypot (p, z));
-      for (i = 0; i < 2; ++i)
-        {
-          t = t * (1.0 - f);
-          lat = atan (t);
-          cos_lat = cos (lat);
-          sin_lat = sin (lat);
-          t = (z + e_12xb * sin_lat*sin_lat*sin_lat) / (p - e_2 * a * cos_lat*cos_lat*cos_lat);
-        }
-      lon = atan2 (src.y, src.x);
-      lat = atan (t);
-      sin_lat = sin (lat);
-      cos_lat = cos (lat);
-      N = c / sqrt (1.0 + e_12 * cos_lat * cos_lat);
-      if (fabs (t) < 1.0)
+      HyScanGeoCartesian3D src;
+      HyScanGeoGeodetic dst;
+
+      src.x = var[0];
+      src.y = var[1];
+      src.z = var[2];
+
+      hyscan_geo_topo2ecef (geo, &ecef, src);
+      hyscan_geo_ecef2geo (&dst, ecef, priv->sphere_params);
+
+      out[0] = dst.lat - priv->B0;
+      out[1] = remainder (dst.lon - priv->L0, 2.0 * G_PI);
+      out[2] = dst.h;
+    }
+}
+
+/* Функция вычисляет коэффициенты полинома второго порядка, приближающего
+ * прямой или обратный пересчет в окрестности начала координат. Производные
+ * берутся центральными разностями от точного пересчета. Порядок
+ * коэффициентов: 1, u, v, w, u^2, uv, v^2, uw, vw, w^2. */
+static void
+hyscan_geo_local_init (HyScanGeo *geo,
+                       gboolean   inverse,
+                       gdouble    coefs[3][LOCAL_N_COEFS])
+{
+  /* Индексы квадратов и смешанных произведений переменных. */
+  static const gint square[3] = { 4, 6, 9 };
+  static const gint mixed[3][3] = { { 0, 5, 7 }, { 5, 0, 8 }, { 7, 8, 0 } };
+
+  gdouble step[3];
+  gdouble var[3] = { 0.0, 0.0, 0.0 };
+  gdouble f0[3], fp[3], fm[3], fpp[3], fpm[3], fmp[3], fmm[3];
+  gint i, j, k;
+
+  step[0] = step[1] = inverse ? LOCAL_LINEAR_STEP : LOCAL_ANGLE_STEP;
+  step[2] = LOCAL_HEIGHT_STEP;
+
+  hyscan_geo_local_exact (geo, inverse, var, f0);
+  for (k = 0; k < 3; k++)
+    coefs[k][0] = f0[k];
+
+  for (i = 0; i < 3; i++)
+    {
+      var[i] = step[i];
+      hyscan_geo_local_exact (geo, inverse, var, fp);
+      var[i] = -step[i];
+      hyscan_geo_local_exact (geo, inverse, var, fm);
+      var[i] = 0.0;
+
+      for (k = 0; k < 3; k++)
         {
-          h = p / cos_lat - N;
+          coefs[k][1 + i] = (fp[k] - fm[k]) / (2.0 * step[i]);
+          coefs[k][square[i]] = (fp[k] - 2.0 * f0[k] + fm[k]) / (2.0 * step[i] * step[i]);
         }
-      else
+    }
+
+  for (i = 0; i < 3; i++)
+    {
+      for (j = i + 1; j < 3; j++)
         {
-          h = z / sin_lat - N * (1.0 - e_2);
+          var[i] = step[i];  var[j] = step[j];
+          hyscan_geo_local_exact (geo, inverse, var, fpp);
+          var[i] = step[i];  var[j] = -step[j];
+          hyscan_geo_local_exact (geo, inverse, var, fpm);
+          var[i] = -step[i]; var[j] = step[j];
+          hyscan_geo_local_exact (geo, inverse, var, fmp);
+          var[i] = -step[i]; var[j] = -step[j];
+          hyscan_geo_local_exact (geo, inverse, var, fmm);
+          var[i] = var[j] = 0.0;
+
+          for (k = 0; k < 3; k++)
+            coefs[k][mixed[i][j]] = (fpp[k] - fpm[k] - fmp[k] + fmm[k]) / (4.0 * step[i] * step[j]);
         }
-      dst->lat = hyscan_geo_fit_lat_in_range(lat);
-      dst->lon = hyscan_geo_fit_lon_in_range(lon);
-      dst->h = h;
     }
 }
 
+/* Вычисление полинома второго порядка локальной проекции. */
+static inline gdouble
+hyscan_geo_local_poly (const gdouble *c,
+                       gdouble        u,
+                       gdouble        v,
+                       gdouble        w)
+{
+  return c[0] + c[1] * u + c[2] * v + c[3] * w +
+         u * (c[4] * u + c[5] * v + c[7] * w) +
+         v * (c[6] * v + c[8] * w) +
+         c[9] * w * w;
+}
+
+/* Пересчет геодезических координат (в градусах) в топоцентрические без проверок. */
+static void
+hyscan_geo_geo2topo_point (HyScanGeo            *geo,
+                           HyScanGeoCartesian3D *dst_topo,
+                           HyScanGeoGeodetic     src_geod)
+{
+  HyScanGeoPrivate *priv = geo->priv;
+  HyScanGeoGeodetic src_rad;
+
+  src_rad.lat = DEG2RAD (src_geod.lat);
+  src_rad.lon = DEG2RAD (src_geod.lon);
+  src_rad.h = src_geod.h;
+
+  /* Локальная проекция. */
+  if (g_atomic_int_get (&(priv->fast_local)))
+    {
+      gdouble dB = src_rad.lat - priv->B0;
+      gdouble dL = remainder (src_rad.lon - priv->L0, 2.0 * G_PI);
+
+      dst_topo->x = hyscan_geo_local_poly (priv->local_fwd[0], dB, dL, src_rad.h);
+      dst_topo->y = hyscan_geo_local_poly (priv->local_fwd[1], dB, dL, src_rad.h);
+      dst_topo->z = hyscan_geo_local_poly (priv->local_fwd[2], dB, dL, src_rad.h);
+      return;
+    }
+
+  /* Преобразовываем геодезические в ECEF. */
+  hyscan_geo_geo2ecef (dst_topo, src_rad, priv->sphere_params);
+
+  /* Преобразовываем ECEF в топоцентрические. */
+  hyscan_geo_ecef2topo (geo, dst_topo, *dst_topo);
+}
+
+/* Пересчет топоцентрических координат в геодезические (в градусах) без проверок. */
+static void
+hyscan_geo_topo2geo_point (HyScanGeo            *geo,
+                           HyScanGeoGeodetic    *dst_geod,
+                           HyScanGeoCartesian3D  src_topo)
+{
+  HyScanGeoPrivate *priv = geo->priv;
+  HyScanGeoGeodetic dst_rad;
+
+  /* Локальная проекция. */
+  if (g_atomic_int_get (&(priv->fast_local)))
+    {
+      dst_rad.lat = priv->B0 + hyscan_geo_local_poly (priv->local_inv[0], src_topo.x, src_topo.y, src_topo.z);
+      dst_rad.lon = priv->L0 + hyscan_geo_local_poly (priv->local_inv[1], src_topo.x, src_topo.y, src_topo.z);
+      dst_rad.h = hyscan_geo_local_poly (priv->local_inv[2], src_topo.x, src_topo.y, src_topo.z);
+
+      dst_geod->lat = RAD2DEG (dst_rad.lat);
+      dst_geod->lon = hyscan_geo_fit_lon_in_range (RAD2DEG (dst_rad.lon));
+      dst_geod->h = dst_rad.h;
+      return;
+    }
+
+  /* Преобразовываем топоцентрические в ECEF. */
+  hyscan_geo_topo2ecef (geo, &src_topo, src_topo);
+
+  /* Преобразовываем ECEF в геодезические. */
+  hyscan_geo_ecef2geo (&dst_rad, src_topo, priv->sphere_params);
+
+  dst_geod->lat = RAD2DEG (dst_rad.lat);
+  dst_geod->lon = RAD2DEG (dst_rad.lon);
+  dst_geod->h = dst_rad.h;
+}
+
 gboolean
 hyscan_geo_geo2topo (HyScanGeo            *geo,
                      HyScanGeoCartesian3D *dst_topo,
                      HyScanGeoGeodetic     src_geod)
 {
   HyScanGeoPrivate *priv;
-  HyScanGeoGeodetic src_rad;
 
   g_return_val_if_fail (HYSCAN_IS_GEO (geo), FALSE);
   priv = geo->priv;
@@ -384,15 +628,7 @@ hyscan_geo_geo2topo (HyScanGeo            *geo,
   if (LAT_OUT_OF_RANGE(src_geod.lat) || LON_OUT_OF_RANGE(src_geod.lon))
     return FALSE;
 
-  src_rad.lat = DEG2RAD (src_geod.lat);
-  src_rad.lon = DEG2RAD (src_geod.lon);
-  src_rad.h = src_geod.h;
-
-  /* Преобразовываем геодезические в ECEF. */
-  hyscan_geo_geo2ecef (dst_topo, src_rad, geo->priv->sphere_params);
-
-  /* Преобразовываем ECEF в топоцентрические. */
-  hyscan_geo_ecef2topo (geo, dst_topo, *dst_topo);
+  hyscan_geo_geo2topo_point (geo, dst_topo, src_geod);
 
   return TRUE;
 }
@@ -403,7 +639,6 @@ hyscan_geo_topo2geo (HyScanGeo           *geo,
                      HyScanGeoCartesian3D src_topo)
 {
   HyScanGeoPrivate *priv;
-  HyScanGeoGeodetic dst_rad;
 
   g_return_val_if_fail (HYSCAN_IS_GEO (geo), FALSE);
   priv = geo->priv;
@@ -412,15 +647,7 @@ hyscan_geo_topo2geo (HyScanGeo           *geo,
   if (g_atomic_int_get (&(priv->initialized)) == 0)
     return FALSE;
 
-  /* Преобразовываем топоцентрические в ECEF. */
-  hyscan_geo_topo2ecef (geo, &src_topo, src_topo);
-
-  /* Преобразовываем ECEF в геодезические. */
-  hyscan_geo_ecef2geo (&dst_rad, src_topo, geo->priv->sphere_params);
-
-  dst_geod->lat = RAD2DEG (dst_rad.lat);
-  dst_geod->lon = RAD2DEG (dst_rad.lon);
-  dst_geod->h = dst_rad.h;
+  hyscan_geo_topo2geo_point (geo, dst_geod, src_topo);
 
   return TRUE;
 }
@@ -431,7 +658,6 @@ hyscan_geo_geo2topoXY (HyScanGeo            *geo,
                        HyScanGeoGeodetic     src_geod)
 {
   HyScanGeoPrivate *priv;
-  HyScanGeoGeodetic src_rad;
   HyScanGeoCartesian3D dst_topo;
 
   g_return_val_if_fail (HYSCAN_IS_GEO (geo), FALSE);
@@ -445,15 +671,7 @@ hyscan_geo_geo2topoXY (HyScanGeo            *geo,
   if (LAT_OUT_OF_RANGE(src_geod.lat) || LON_OUT_OF_RANGE(src_geod.lon))
     return FALSE;
 
-  src_rad.lat = DEG2RAD (src_geod.lat);
-  src_rad.lon = DEG2RAD (src_geod.lon);
-  src_rad.h = src_geod.h;
-
-  /* Преобразовываем геодезические в ECEF. */
-  hyscan_geo_geo2ecef (&dst_topo, src_rad, geo->priv->sphere_params);
-
-  /* Преобразовываем ECEF в топоцентрические. */
-  hyscan_geo_ecef2topo (geo, &dst_topo, dst_topo);
+  hyscan_geo_geo2topo_point (geo, &dst_topo, src_geod);
 
   dst_topoXY->x = dst_topo.x;
   dst_topoXY->y = dst_topo.y;
@@ -473,6 +691,21 @@ hyscan_geo_topoXY2geo (HyScanGeo           *geo,
   g_return_val_if_fail (HYSCAN_IS_GEO (geo), FALSE);
   priv = geo->priv;
 
+  /* Убеждаемся, что эллипсоид и начальная точка заданы. */
+  if (g_atomic_int_get (&(priv->initialized)) == 0)
+    return FALSE;
+
+  return hyscan_geo_topoXY2geo_point (geo, dst_geod, src_topoXY, h_geodetic, num_of_iter);
+}
+
+/* Пересчет топоцентрических координат X, Y в геодезические без проверки готовности. */
+static gboolean
+hyscan_geo_topoXY2geo_point (HyScanGeo           *geo,
+                             HyScanGeoGeodetic   *dst_geod,
+                             HyScanGeoCartesian2D src_topoXY,
+                             gdouble              h_geodetic,
+                             guint                num_of_iter)
+{
   HyScanGeoGeodetic dst_rad;
 
   gdouble earth_radius = 6371000; /* Радиус Земли в метрах. */
@@ -480,10 +713,6 @@ hyscan_geo_topoXY2geo (HyScanGeo           *geo,
   HyScanGeoCartesian3D topoXYZ;
   guint i;
 
-  /* Убеждаемся, что эллипсоид и начальная точка заданы. */
-  if (g_atomic_int_get (&(priv->initialized)) == 0)
-    return FALSE;
-
   x_orig = src_topoXY.x;
   y_orig = src_topoXY.y;
 
@@ -497,8 +726,25 @@ hyscan_geo_topoXY2geo (HyScanGeo           *geo,
   topoXYZ.y = y_orig;
   topoXYZ.z = Ht;
 
+  /* В локальной проекции высота Z уточняется одним шагом по полиномам,
+   * итерации не нужны. */
+  if (g_atomic_int_get (&(geo->priv->fast_local)))
+    {
+      HyScanGeoPrivate *priv = geo->priv;
+      gdouble dB, dL;
+
+      dB = hyscan_geo_local_poly (priv->local_inv[0], x_orig, y_orig, Ht);
+      dL = hyscan_geo_local_poly (priv->local_inv[1], x_orig, y_orig, Ht);
+      topoXYZ.z = hyscan_geo_local_poly (priv->local_fwd[2], dB, dL, h_geodetic);
+
+      hyscan_geo_topo2geo_point (geo, dst_geod, topoXYZ);
+      dst_geod->h = h_geodetic;
+
+      return TRUE;
+    }
+
   /* Первая итерация. */
-  hyscan_geo_topo2geo (geo, &dst_rad, topoXYZ);
+  hyscan_geo_topo2geo_point (geo, &dst_rad, topoXYZ);
 
   /* Если требуется, делаем дополнительные итерации */
   for (i = 0; i < num_of_iter; ++i)
@@ -507,14 +753,14 @@ hyscan_geo_topoXY2geo (HyScanGeo           *geo,
       dst_rad.h = h_geodetic;
 
       /* Переводим в топоцентрические. */
-      hyscan_geo_geo2topo (geo, &topoXYZ, dst_rad);
+      hyscan_geo_geo2topo_point (geo, &topoXYZ, dst_rad);
 
       // Combine new topocentric Z and original X,Y coords
       topoXYZ.x = x_orig;
       topoXYZ.y = y_orig;
 
       // Преобразовываем old topocentric coords with new z coordinate
-      hyscan_geo_topo2geo (geo, &dst_rad, topoXYZ);
+      hyscan_geo_topo2geo_point (geo, &dst_rad, topoXYZ);
     }
 
   dst_geod->lat = dst_rad.lat;
@@ -524,6 +770,289 @@ hyscan_geo_topoXY2geo (HyScanGeo           *geo,
   return TRUE;
 }
 
+/* Пакетный пересчет геодезических координат в топоцентрические. */
+guint
+hyscan_geo_geo2topo_array (HyScanGeo     *geo,
+                           const gdouble *lat,
+                           const gdouble *lon,
+                           const gdouble *h,
+                           gdouble       *x,
+                           gdouble       *y,
+                           gdouble       *z,
+                           guint          n_points)
+{
+  HyScanGeoPrivate *priv;
+  gdouble a, e, e2;
+  gdouble A1, A2, A3, B1, B2, B3, C1, C2, C3, N0, N0_e;
+  guint n_converted = 0;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_GEO (geo), 0);
+  g_return_val_if_fail (n_points == 0 || (lat != NULL && lon != NULL), 0);
+  g_return_val_if_fail (n_points == 0 || (x != NULL && y != NULL && z != NULL), 0);
+  priv = geo->priv;
+
+  /* Убеждаемся, что эллипсоид и начальная точка заданы. */
+  if (g_atomic_int_get (&(priv->initialized)) == 0)
+    return 0;
+
+  /* Локальная проекция. */
+  if (g_atomic_int_get (&(priv->fast_local)))
+    {
+      for (i = 0; i < n_points; i++)
+        {
+          HyScanGeoGeodetic src;
+          HyScanGeoCartesian3D dst;
+
+          if (LAT_OUT_OF_RANGE(lat[i]) || LON_OUT_OF_RANGE(lon[i]))
+            {
+              x[i] = y[i] = z[i] = NAN;
+              continue;
+            }
+
+          src.lat = lat[i];
+          src.lon = lon[i];
+          src.h = (h != NULL) ? h[i] : 0.0;
+          hyscan_geo_geo2topo_point (geo, &dst, src);
+
+          x[i] = dst.x;
+          y[i] = dst.y;
+          z[i] = dst.z;
+          n_converted++;
+        }
+
+      return n_converted;
+    }
+
+  /* Параметры в локальных переменных, чтобы компилятор не перечитывал их
+   * из памяти после каждой записи в выходные массивы. */
+  a = priv->sphere_params.a;
+  e = priv->sphere_params.e;
+  e2 = priv->sphere_params.e2;
+  A1 = priv->A1; A2 = priv->A2; A3 = priv->A3;
+  B1 = priv->B1; B2 = priv->B2; B3 = priv->B3;
+  C1 = priv->C1; C2 = priv->C2; C3 = priv->C3;
+  N0 = priv->N0;
+  N0_e = priv->N0_e;
+
+  for (i = 0; i < n_points; i++)
+    {
+      gdouble sinb, cosb, sinl, cosl, H, N, r, x_c, y_c, z_c;
+
+      if (LAT_OUT_OF_RANGE(lat[i]) || LON_OUT_OF_RANGE(lon[i]))
+        {
+          x[i] = y[i] = z[i] = NAN;
+          continue;
+        }
+
+      sinb = sin (DEG2RAD (lat[i]));
+      cosb = cos (DEG2RAD (lat[i]));
+      sinl = sin (DEG2RAD (lon[i]));
+      cosl = cos (DEG2RAD (lon[i]));
+      H = (h != NULL) ? h[i] : 0.0;
+
+      /* Геодезические в ECEF, см. hyscan_geo_geo2ecef. */
+      N = e * sinb;
+      N = a / sqrt (1.0 - N * N);
+      r = (N + H) * cosb;
+      x_c = r * cosl;
+      y_c = r * sinl;
+      z_c = (N * (1.0 - e2) + H) * sinb;
+
+      /* ECEF в топоцентрические, см. hyscan_geo_ecef2topo. */
+      z_c = z_c + N0_e;
+      x[i] = A1 * x_c + B1 * y_c + C1 * z_c;
+      y[i] = A2 * x_c + B2 * y_c + C2 * z_c;
+      z[i] = A3 * x_c + B3 * y_c + C3 * z_c - N0;
+
+      n_converted++;
+    }
+
+  return n_converted;
+}
+
+/* Пакетный пересчет топоцентрических координат в геодезические. */
+guint
+hyscan_geo_topo2geo_array (HyScanGeo     *geo,
+                           const gdouble *x,
+                           const gdouble *y,
+                           const gdouble *z,
+                           gdouble       *lat,
+                           gdouble       *lon,
+                           gdouble       *h,
+                           guint          n_points)
+{
+  HyScanGeoPrivate *priv;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_GEO (geo), 0);
+  g_return_val_if_fail (n_points == 0 || (x != NULL && y != NULL && z != NULL), 0);
+  g_return_val_if_fail (n_points == 0 || (lat != NULL && lon != NULL), 0);
+  priv = geo->priv;
+
+  /* Убеждаемся, что эллипсоид и начальная точка заданы. */
+  if (g_atomic_int_get (&(priv->initialized)) == 0)
+    return 0;
+
+  for (i = 0; i < n_points; i++)
+    {
+      HyScanGeoCartesian3D src;
+      HyScanGeoGeodetic dst;
+
+      src.x = x[i];
+      src.y = y[i];
+      src.z = z[i];
+
+      hyscan_geo_topo2geo_point (geo, &dst, src);
+
+      lat[i] = dst.lat;
+      lon[i] = dst.lon;
+      if (h != NULL)
+        h[i] = dst.h;
+    }
+
+  return n_points;
+}
+
+/* Пакетный пересчет геодезических координат в плоскость XOY топоцентрической СК. */
+guint
+hyscan_geo_geo2topoXY_array (HyScanGeo     *geo,
+                             const gdouble *lat,
+                             const gdouble *lon,
+                             const gdouble *h,
+                             gdouble       *x,
+                             gdouble       *y,
+                             guint          n_points)
+{
+  HyScanGeoPrivate *priv;
+  gdouble a, e, e2;
+  gdouble A1, A2, B1, B2, C1, C2, N0_e;
+  guint n_converted = 0;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_GEO (geo), 0);
+  g_return_val_if_fail (n_points == 0 || (lat != NULL && lon != NULL), 0);
+  g_return_val_if_fail (n_points == 0 || (x != NULL && y != NULL), 0);
+  priv = geo->priv;
+
+  /* Убеждаемся, что эллипсоид и начальная точка заданы. */
+  if (g_atomic_int_get (&(priv->initialized)) == 0)
+    return 0;
+
+  /* Локальная проекция. */
+  if (g_atomic_int_get (&(priv->fast_local)))
+    {
+      for (i = 0; i < n_points; i++)
+        {
+          HyScanGeoGeodetic src;
+          HyScanGeoCartesian3D dst;
+
+          if (LAT_OUT_OF_RANGE(lat[i]) || LON_OUT_OF_RANGE(lon[i]))
+            {
+              x[i] = y[i] = NAN;
+              continue;
+            }
+
+          src.lat = lat[i];
+          src.lon = lon[i];
+          src.h = (h != NULL) ? h[i] : 0.0;
+          hyscan_geo_geo2topo_point (geo, &dst, src);
+
+          x[i] = dst.x;
+          y[i] = dst.y;
+          n_converted++;
+        }
+
+      return n_converted;
+    }
+
+  a = priv->sphere_params.a;
+  e = priv->sphere_params.e;
+  e2 = priv->sphere_params.e2;
+  A1 = priv->A1; A2 = priv->A2;
+  B1 = priv->B1; B2 = priv->B2;
+  C1 = priv->C1; C2 = priv->C2;
+  N0_e = priv->N0_e;
+
+  for (i = 0; i < n_points; i++)
+    {
+      gdouble sinb, cosb, sinl, cosl, H, N, r, x_c, y_c, z_c;
+
+      if (LAT_OUT_OF_RANGE(lat[i]) || LON_OUT_OF_RANGE(lon[i]))
+        {
+          x[i] = y[i] = NAN;
+          continue;
+        }
+
+      sinb = sin (DEG2RAD (lat[i]));
+      cosb = cos (DEG2RAD (lat[i]));
+      sinl = sin (DEG2RAD (lon[i]));
+      cosl = cos (DEG2RAD (lon[i]));
+      H = (h != NULL) ? h[i] : 0.0;
+
+      N = e * sinb;
+      N = a / sqrt (1.0 - N * N);
+      r = (N + H) * cosb;
+      x_c = r * cosl;
+      y_c = r * sinl;
+      z_c = (N * (1.0 - e2) + H) * sinb + N0_e;
+
+      x[i] = A1 * x_c + B1 * y_c + C1 * z_c;
+      y[i] = A2 * x_c + B2 * y_c + C2 * z_c;
+
+      n_converted++;
+    }
+
+  return n_converted;
+}
+
+/* Пакетный пересчет топоцентрических координат X, Y в геодезические. */
+guint
+hyscan_geo_topoXY2geo_array (HyScanGeo     *geo,
+                             const gdouble *x,
+                             const gdouble *y,
+                             const gdouble *h_geodetic,
+                             gdouble       *lat,
+                             gdouble       *lon,
+                             guint          n_points,
+                             guint          num_of_iter)
+{
+  HyScanGeoPrivate *priv;
+  guint n_converted = 0;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_GEO (geo), 0);
+  g_return_val_if_fail (n_points == 0 || (x != NULL && y != NULL), 0);
+  g_return_val_if_fail (n_points == 0 || (lat != NULL && lon != NULL), 0);
+  priv = geo->priv;
+
+  /* Убеждаемся, что эллипсоид и начальная точка заданы. */
+  if (g_atomic_int_get (&(priv->initialized)) == 0)
+    return 0;
+
+  for (i = 0; i < n_points; i++)
+    {
+      HyScanGeoCartesian2D src;
+      HyScanGeoGeodetic dst;
+
+      src.x = x[i];
+      src.y = y[i];
+
+      if (hyscan_geo_topoXY2geo_point (geo, &dst, src, (h_geodetic != NULL) ? h_geodetic[i] : 0.0, num_of_iter))
+        {
+          lat[i] = dst.lat;
+          lon[i] = dst.lon;
+          n_converted++;
+        }
+      else
+        {
+          lat[i] = lon[i] = NAN;
+        }
+    }
+
+  return n_converted;
+}
+
 /* Перевод геодезических координат. */
 gboolean
 hyscan_geo_cs_transform (HyScanGeoGeodetic    *dst,
@@ -531,40 +1060,24 @@ hyscan_geo_cs_transform (HyScanGeoGeodetic    *dst,
                          HyScanGeoCSType       cs_in,
                          HyScanGeoCSType       cs_out)
 {
-  HyScanGeoDatumParam datum_param;
-  HyScanGeoGeodetic src_rad, dst_rad;
-  HyScanGeoEllipsoidType elps_in, elps_out;
-  HyScanGeoEllipsoidParam el_params_in, el_params_out;
+  volatile gsize *cached;
+  gint index_in, index_out;
 
   /* Проверка на попадание в диапазон. */
   if (LON_OUT_OF_RANGE(src.lon) || LAT_OUT_OF_RANGE(src.lat))
     return FALSE;
 
-  src_rad.lat = (src.lat);
-  src_rad.lon = (src.lon);
-  src_rad.h = (src.h);
-
-  /* Определяем датум */
-  datum_param = hyscan_geo_get_datum_params (cs_in, cs_out);
-
-  /* Определяем тип референц-эллипсоида входной координаты */
-  elps_in = hyscan_geo_get_ellipse_by_cs (cs_in);
-
-  /* Определяем тип референц-эллипсоида выходной координаты */
-  elps_out = hyscan_geo_get_ellipse_by_cs (cs_out);
-
-  /* Определяем параметры референц-эллипсоида входной координаты */
-  hyscan_geo_init_ellipsoid (&el_params_in, elps_in);
+  index_in = hyscan_geo_cs_index (cs_in);
+  index_out = hyscan_geo_cs_index (cs_out);
+  if (index_in < 0 || index_out < 0)
+    return FALSE;
 
-  /* Определяем параметры референц-эллипсоида выходной координаты */
-  hyscan_geo_init_ellipsoid (&el_params_out, elps_out);
+  /* Преобразование для каждой пары СК создается один раз и больше не изменяется. */
+  cached = &hyscan_geo_transforms[index_in][index_out];
+  if (g_once_init_enter (cached))
+    g_once_init_leave (cached, (gsize) hyscan_geo_transform_new (cs_in, cs_out));
 
-  /* Вызываем функцию пересчета */
-  hyscan_geo_cs_transform_user (&dst_rad, src_rad, el_params_in, el_params_out, datum_param);
-
-  dst->lat = (dst_rad.lat);
-  dst->lon = (dst_rad.lon);
-  dst->h = (dst_rad.h);
+  hyscan_geo_transform_apply ((const HyScanGeoTransform *) *cached, dst, src);
 
   return TRUE;
 }
@@ -576,41 +1089,78 @@ hyscan_geo_cs_transform_user (HyScanGeoGeodetic          *dst,
                               HyScanGeoEllipsoidParam     el_params_out,
                               HyScanGeoDatumParam         datum_param)
 {
-  gdouble wx, wy, wz, m_1, x_w, y_w, z_w;
-  HyScanGeoCartesian3D ref;
-  HyScanGeoGeodetic src_rad, dst_rad;
+  HyScanGeoTransform transform;
 
   /* Проверка на попадание в диапазон. */
   if (LON_OUT_OF_RANGE(src.lon) || LAT_OUT_OF_RANGE(src.lat))
     return FALSE;
 
+  hyscan_geo_transform_setup (&transform, el_params_in, el_params_out, datum_param);
+  hyscan_geo_transform_apply (&transform, dst, src);
+
+  return TRUE;
+}
+
+/* Вычисление матрицы преобразования Гельмерта. */
+static void
+hyscan_geo_transform_setup (HyScanGeoTransform      *transform,
+                            HyScanGeoEllipsoidParam  el_params_in,
+                            HyScanGeoEllipsoidParam  el_params_out,
+                            HyScanGeoDatumParam      datum_param)
+{
+  gdouble wx, wy, wz, m_1;
+
+  wx = datum_param.wx;
+  wy = datum_param.wy;
+  wz = datum_param.wz;
+  m_1 = datum_param.m + 1;
+
+  transform->el_in = el_params_in;
+  transform->el_out = el_params_out;
+
+  transform->matrix[0][0] = m_1;
+  transform->matrix[0][1] = m_1 * wz;
+  transform->matrix[0][2] = -m_1 * wy;
+  transform->matrix[1][0] = -m_1 * wz;
+  transform->matrix[1][1] = m_1;
+  transform->matrix[1][2] = m_1 * wx;
+  transform->matrix[2][0] = m_1 * wy;
+  transform->matrix[2][1] = -m_1 * wx;
+  transform->matrix[2][2] = m_1;
+
+  transform->shift[0] = datum_param.dX;
+  transform->shift[1] = datum_param.dY;
+  transform->shift[2] = datum_param.dZ;
+}
+
+/* Пересчет одной точки, координаты в градусах. */
+static inline void
+hyscan_geo_transform_apply (const HyScanGeoTransform *transform,
+                            HyScanGeoGeodetic        *dst,
+                            HyScanGeoGeodetic         src)
+{
+  const gdouble (*m)[3] = transform->matrix;
+  HyScanGeoCartesian3D ref, out;
+  HyScanGeoGeodetic src_rad, dst_rad;
+
   src_rad.lat = DEG2RAD (src.lat);
   src_rad.lon = DEG2RAD (src.lon);
   src_rad.h = (src.h);
 
   /* Переводим геодезические в декартовы  */
-  hyscan_geo_geo2ecef (&ref, src_rad, el_params_in);
+  hyscan_geo_geo2ecef (&ref, src_rad, transform->el_in);
 
   /* Преобразование Гельмерта. */
-  wx = datum_param.wx;
-  wy = datum_param.wy;
-  wz = datum_param.wz;
-  m_1 = datum_param.m + 1;
-  x_w = m_1 * ( ref.x      +  wz * ref.y - wy * ref.z) + datum_param.dX;
-  y_w = m_1 * (-wz * ref.x + ref.y       + wx * ref.z) + datum_param.dY;
-  z_w = m_1 * ( wy * ref.x - wx * ref.y  + ref.z     ) + datum_param.dZ;
-  ref.x = x_w;
-  ref.y = y_w;
-  ref.z = z_w;
+  out.x = m[0][0] * ref.x + m[0][1] * ref.y + m[0][2] * ref.z + transform->shift[0];
+  out.y = m[1][0] * ref.x + m[1][1] * ref.y + m[1][2] * ref.z + transform->shift[1];
+  out.z = m[2][0] * ref.x + m[2][1] * ref.y + m[2][2] * ref.z + transform->shift[2];
 
   /* Переводим декартовы в геодезические */
-  hyscan_geo_ecef2geo (&dst_rad, ref, el_params_out);
+  hyscan_geo_ecef2geo (&dst_rad, out, transform->el_out);
 
   dst->lat = RAD2DEG (dst_rad.lat);
   dst->lon = RAD2DEG (dst_rad.lon);
   dst->h = (dst_rad.h);
-
-  return TRUE;
 }
 
 /* Параметры для 7-параметрического преобразовния Гельмерта. */
@@ -797,3 +1347,145 @@ hyscan_geo_init_ellipsoid_user (HyScanGeoEllipsoidParam *p,
 
   return TRUE;
 };
+
+/* Функция возвращает индекс СК в кэше преобразований или -1. */
+static gint
+hyscan_geo_cs_index (HyScanGeoCSType cs_type)
+{
+  switch (cs_type)
+    {
+    case HYSCAN_GEO_CS_WGS84:
+      return 0;
+    case HYSCAN_GEO_CS_SK42:
+      return 1;
+    case HYSCAN_GEO_CS_SK95:
+      return 2;
+    case HYSCAN_GEO_CS_PZ90:
+      return 3;
+    case HYSCAN_GEO_CS_PZ90_02:
+      return 4;
+    case HYSCAN_GEO_CS_PZ90_11:
+      return 5;
+    default:
+      return -1;
+    }
+}
+
+/* Создание преобразования между стандартными СК. */
+HyScanGeoTransform *
+hyscan_geo_transform_new (HyScanGeoCSType cs_in,
+                          HyScanGeoCSType cs_out)
+{
+  HyScanGeoEllipsoidParam el_params_in, el_params_out;
+
+  if (!hyscan_geo_init_ellipsoid (&el_params_in, hyscan_geo_get_ellipse_by_cs (cs_in)) ||
+      !hyscan_geo_init_ellipsoid (&el_params_out, hyscan_geo_get_ellipse_by_cs (cs_out)))
+    {
+      return NULL;
+    }
+
+  return hyscan_geo_transform_new_user (el_params_in, el_params_out,
+                                        hyscan_geo_get_datum_params (cs_in, cs_out));
+}
+
+/* Создание преобразования с пользовательскими параметрами. */
+HyScanGeoTransform *
+hyscan_geo_transform_new_user (HyScanGeoEllipsoidParam el_params_in,
+                               HyScanGeoEllipsoidParam el_params_out,
+                               HyScanGeoDatumParam     datum_param)
+{
+  HyScanGeoTransform *transform;
+
+  transform = g_slice_new (HyScanGeoTransform);
+  transform->ref_count = 1;
+  hyscan_geo_transform_setup (transform, el_params_in, el_params_out, datum_param);
+
+  return transform;
+}
+
+HyScanGeoTransform *
+hyscan_geo_transform_ref (HyScanGeoTransform *transform)
+{
+  g_return_val_if_fail (transform != NULL, NULL);
+
+  g_atomic_int_inc (&transform->ref_count);
+
+  return transform;
+}
+
+void
+hyscan_geo_transform_unref (HyScanGeoTransform *transform)
+{
+  g_return_if_fail (transform != NULL);
+
+  if (g_atomic_int_dec_and_test (&transform->ref_count))
+    g_slice_free (HyScanGeoTransform, transform);
+}
+
+/* Пересчет одной точки. */
+gboolean
+hyscan_geo_transform_point (HyScanGeoTransform *transform,
+                            HyScanGeoGeodetic  *dst,
+                            HyScanGeoGeodetic   src)
+{
+  g_return_val_if_fail (transform != NULL, FALSE);
+
+  /* Проверка на попадание в диапазон. */
+  if (LON_OUT_OF_RANGE(src.lon) || LAT_OUT_OF_RANGE(src.lat))
+    return FALSE;
+
+  hyscan_geo_transform_apply (transform, dst, src);
+
+  return TRUE;
+}
+
+/* Пакетный пересчет точек. */
+guint
+hyscan_geo_transform_array (HyScanGeoTransform *transform,
+                            const gdouble      *lat_in,
+                            const gdouble      *lon_in,
+                            const gdouble      *h_in,
+                            gdouble            *lat_out,
+                            gdouble            *lon_out,
+                            gdouble            *h_out,
+                            guint               n_points)
+{
+  HyScanGeoTransform local;
+  guint n_converted = 0;
+  guint i;
+
+  g_return_val_if_fail (transform != NULL, 0);
+  g_return_val_if_fail (n_points == 0 || (lat_in != NULL && lon_in != NULL), 0);
+  g_return_val_if_fail (n_points == 0 || (lat_out != NULL && lon_out != NULL), 0);
+
+  /* Локальная копия параметров не пересекается с выходными массивами. */
+  local = *transform;
+
+  for (i = 0; i < n_points; i++)
+    {
+      HyScanGeoGeodetic src, dst;
+
+      if (LAT_OUT_OF_RANGE(lat_in[i]) || LON_OUT_OF_RANGE(lon_in[i]))
+        {
+          lat_out[i] = lon_out[i] = NAN;
+          if (h_out != NULL)
+            h_out[i] = NAN;
+          continue;
+        }
+
+      src.lat = lat_in[i];
+      src.lon = lon_in[i];
+      src.h = (h_in != NULL) ? h_in[i] : 0.0;
+
+      hyscan_geo_transform_apply (&local, &dst, src);
+
+      lat_out[i] = dst.lat;
+      lon_out[i] = dst.lon;
+      if (h_out != NULL)
+        h_out[i] = dst.h;
+
+      n_converted++;
+    }
+
+  return n_converted;
+}
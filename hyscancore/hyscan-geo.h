@@ -51,10 +51,13 @@
  * - #hyscan_geo_new_user - создание нового объекта с пользовательским эллипсоидом;
  * - #hyscan_geo_set_origin - смена начала координат топоцентрической СК;
  * - #hyscan_geo_set_origin_user - смена начала координат топоцентрической СК и с пользовательским эллипсоидом;
+ * - #hyscan_geo_set_fast_local - включение быстрой локальной проекции в окрестности начала координат;
  * - #hyscan_geo_geo2topo - перевод геоцентрических координат в топоцентрические;
  * - #hyscan_geo_topo2geo - перевод топоцентрических координат в геоцентрические;
  * - #hyscan_geo_geo2topoXY - перевод геоцентрических координат в топоцентрические без учета высоты;
- * - #hyscan_geo_topoXY2geo - перевод топоцентрических координат в геоцентрические без учета высоты.
+ * - #hyscan_geo_topoXY2geo - перевод топоцентрических координат в геоцентрические без учета высоты;
+ * - #hyscan_geo_geo2topo_array, #hyscan_geo_topo2geo_array, #hyscan_geo_geo2topoXY_array,
+ *   #hyscan_geo_topoXY2geo_array - пакетные варианты тех же функций для массивов координат.
  *
  * - - -
  * Функции пересчета координат.
@@ -66,6 +69,15 @@
  * - #hyscan_geo_init_ellipsoid_user - вычисление параметров референц-эллипсоида по двум параметрам (большая полуось и сжатие);
  * - #hyscan_geo_get_ellipse_params - получение основных параметров эллипсоида по его типу;
  * - - -
+ * Преобразование между СК #HyScanGeoTransform.
+ *
+ * Для пересчета большого числа точек между одними и теми же СК удобнее создать объект преобразования
+ * функцией #hyscan_geo_transform_new или #hyscan_geo_transform_new_user. В нем заранее вычисляются
+ * параметры обоих эллипсоидов и матрица преобразования Гельмерта. Точки пересчитываются функциями
+ * #hyscan_geo_transform_point и #hyscan_geo_transform_array. Объект не изменяется после создания,
+ * поэтому может одновременно использоваться из нескольких потоков. Функция #hyscan_geo_cs_transform
+ * использует такие объекты, созданные один раз для каждой пары СК.
+ * - - -
  * Работа класса.
  *
  * Объект создается с помощью hyscan_geo_new. При этом передается тип эллипсоида и координаты начальной точки.
@@ -150,6 +162,11 @@ typedef struct
   gdouble  e12;            /**< Квадрат второго эксцентриситета. */
 } HyScanGeoEllipsoidParam;
 
+#define HYSCAN_TYPE_GEO_TRANSFORM   (hyscan_geo_transform_get_type ())
+
+/** \brief Преобразование координат между геодезическими СК. */
+typedef struct _HyScanGeoTransform HyScanGeoTransform;
+
 #define HYSCAN_TYPE_GEO             (hyscan_geo_get_type ())
 #define HYSCAN_GEO(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_GEO, HyScanGeo))
 #define HYSCAN_IS_GEO(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_GEO))
@@ -231,6 +248,32 @@ gboolean                hyscan_geo_set_origin_user             (HyScanGeo
                                                                 HyScanGeoGeodetic               origin,
                                                                 HyScanGeoEllipsoidParam         ell_params);
 
+/**
+ *
+ * \brief Включение быстрой локальной проекции.
+ * При установке начала координат вычисляются коэффициенты полиномов второго порядка,
+ * приближающих пересчет геодезических координат в топоцентрические и обратно в окрестности
+ * начала координат. В быстром режиме функции пересчета HyScanGeo (в том числе пакетные) вместо
+ * точного пересчета через геоцентрические координаты вычисляют эти полиномы, что требует
+ * нескольких умножений и сложений на точку, а #hyscan_geo_topoXY2geo не выполняет итераций.
+ * Погрешность растет пропорционально кубу удаления от начала координат и с широтой.
+ * Максимальная погрешность в метрах при геодезической высоте до 1 км по модулю:
+ * | Удаление от начала координат, км | широта до 60° | широта до 70° |
+ * |:--------------------------------:|:-------------:|:-------------:|
+ * |                 1                |     0.001     |     0.001     |
+ * |                 5                |     0.005     |     0.01      |
+ * |                10                |     0.04      |     0.08      |
+ * |                20                |     0.3       |     0.6       |
+ * |                50                |     4         |     9         |
+ *
+ * \param[in] geo - указатель на объект класcа;
+ * \param[in] fast_local - TRUE для быстрого режима, FALSE для точного пересчета.
+ *
+ */
+HYSCAN_API
+void                    hyscan_geo_set_fast_local              (HyScanGeo                      *geo,
+                                                                gboolean                        fast_local);
+
 /**
  *
  * Функция возвращает значение флага initialized.
@@ -316,6 +359,115 @@ gboolean                hyscan_geo_topoXY2geo                  (HyScanGeo
                                                                 gdouble                         h_geodetic,
                                                                 guint                           num_of_iter);
 
+/**
+ *
+ * Пакетный пересчет геодезических координат в топоцентрическую СК.
+ * Координаты передаются отдельными массивами. Результат для каждой точки совпадает с #hyscan_geo_geo2topo,
+ * но готовность объекта проверяется один раз на весь массив. Для точек вне допустимого диапазона
+ * выходные координаты устанавливаются в NAN. Выходные массивы могут совпадать с входными.
+ *
+ * \param[in] geo - указатель на объект класcа;
+ * \param[in] lat - широты точек, градусы;
+ * \param[in] lon - долготы точек, градусы;
+ * \param[in] h - высоты точек или NULL, если высоты нулевые;
+ * \param[out] x - топоцентрические координаты X;
+ * \param[out] y - топоцентрические координаты Y;
+ * \param[out] z - топоцентрические координаты Z;
+ * \param[in] n_points - число точек.
+ *
+ * \return число пересчитанных точек или 0, если объект не готов к работе.
+ *
+ */
+HYSCAN_API
+guint                   hyscan_geo_geo2topo_array              (HyScanGeo                      *geo,
+                                                                const gdouble                  *lat,
+                                                                const gdouble                  *lon,
+                                                                const gdouble                  *h,
+                                                                gdouble                        *x,
+                                                                gdouble                        *y,
+                                                                gdouble                        *z,
+                                                                guint                           n_points);
+
+/**
+ *
+ * Пакетный пересчет топоцентрических координат в геодезические, аналог #hyscan_geo_topo2geo.
+ * Выходные массивы могут совпадать с входными.
+ *
+ * \param[in] geo - указатель на объект класcа;
+ * \param[in] x - топоцентрические координаты X;
+ * \param[in] y - топоцентрические координаты Y;
+ * \param[in] z - топоцентрические координаты Z;
+ * \param[out] lat - широты точек, градусы;
+ * \param[out] lon - долготы точек, градусы;
+ * \param[out] h - высоты точек или NULL;
+ * \param[in] n_points - число точек.
+ *
+ * \return число пересчитанных точек или 0, если объект не готов к работе.
+ *
+ */
+HYSCAN_API
+guint                   hyscan_geo_topo2geo_array              (HyScanGeo                      *geo,
+                                                                const gdouble                  *x,
+                                                                const gdouble                  *y,
+                                                                const gdouble                  *z,
+                                                                gdouble                        *lat,
+                                                                gdouble                        *lon,
+                                                                gdouble                        *h,
+                                                                guint                           n_points);
+
+/**
+ *
+ * Пакетный пересчет геодезических координат в плоскость XOY топоцентрической СК,
+ * аналог #hyscan_geo_geo2topoXY. Для точек вне допустимого диапазона выходные координаты
+ * устанавливаются в NAN.
+ *
+ * \param[in] geo - указатель на объект класcа;
+ * \param[in] lat - широты точек, градусы;
+ * \param[in] lon - долготы точек, градусы;
+ * \param[in] h - высоты точек или NULL, если высоты нулевые;
+ * \param[out] x - топоцентрические координаты X;
+ * \param[out] y - топоцентрические координаты Y;
+ * \param[in] n_points - число точек.
+ *
+ * \return число пересчитанных точек или 0, если объект не готов к работе.
+ *
+ */
+HYSCAN_API
+guint                   hyscan_geo_geo2topoXY_array            (HyScanGeo                      *geo,
+                                                                const gdouble                  *lat,
+                                                                const gdouble                  *lon,
+                                                                const gdouble                  *h,
+                                                                gdouble                        *x,
+                                                                gdouble                        *y,
+                                                                guint                           n_points);
+
+/**
+ *
+ * Пакетный пересчет топоцентрических координат X, Y в геодезические, аналог #hyscan_geo_topoXY2geo.
+ * Для точек вне допустимого диапазона выходные координаты устанавливаются в NAN.
+ *
+ * \param[in] geo - указатель на объект класcа;
+ * \param[in] x - топоцентрические координаты X;
+ * \param[in] y - топоцентрические координаты Y;
+ * \param[in] h_geodetic - геодезические высоты точек или NULL, если высоты нулевые;
+ * \param[out] lat - широты точек, градусы;
+ * \param[out] lon - долготы точек, градусы;
+ * \param[in] n_points - число точек;
+ * \param[in] num_of_iter - число итераций, см. #hyscan_geo_topoXY2geo.
+ *
+ * \return число пересчитанных точек или 0, если объект не готов к работе.
+ *
+ */
+HYSCAN_API
+guint                   hyscan_geo_topoXY2geo_array            (HyScanGeo                      *geo,
+                                                                const gdouble                  *x,
+                                                                const gdouble                  *y,
+                                                                const gdouble                  *h_geodetic,
+                                                                gdouble                        *lat,
+                                                                gdouble                        *lon,
+                                                                guint                           n_points,
+                                                                guint                           num_of_iter);
+
 /* Функции для пересчета геодезических координат в различные СК. */
 
 /**
@@ -414,6 +566,85 @@ gboolean                hyscan_geo_get_ellipse_params          (gdouble
                                                                 gdouble                        *epsg,
                                                                 HyScanGeoEllipsoidType          ell_type);
 
+HYSCAN_API
+GType                   hyscan_geo_transform_get_type          (void);
+
+/**
+ *
+ * Функция создаёт преобразование координат из СК cs_in в СК cs_out.
+ *
+ * \param[in] cs_in - тип входной СК, структура #HyScanGeoCSType;
+ * \param[in] cs_out - тип выходной СК, структура #HyScanGeoCSType.
+ * \return NULL при некорректных входных данных. Для удаления #hyscan_geo_transform_unref.
+ *
+ */
+HYSCAN_API
+HyScanGeoTransform     *hyscan_geo_transform_new               (HyScanGeoCSType                 cs_in,
+                                                                HyScanGeoCSType                 cs_out);
+
+/**
+ *
+ * Функция создаёт преобразование координат с известными параметрами, аналог #hyscan_geo_cs_transform_user.
+ *
+ * \param[in] el_params_in - параметры референц-эллипсоида входной СК, структура #HyScanGeoEllipsoidParam;
+ * \param[in] el_params_out - параметры референц-эллипсоида выходной СК, структура #HyScanGeoEllipsoidParam;
+ * \param[in] datum_param - параметры пересчета, структура #HyScanGeoDatumParam.
+ * \return преобразование координат. Для удаления #hyscan_geo_transform_unref.
+ *
+ */
+HYSCAN_API
+HyScanGeoTransform     *hyscan_geo_transform_new_user          (HyScanGeoEllipsoidParam         el_params_in,
+                                                                HyScanGeoEllipsoidParam         el_params_out,
+                                                                HyScanGeoDatumParam             datum_param);
+
+/** Функция увеличивает счётчик ссылок на преобразование. */
+HYSCAN_API
+HyScanGeoTransform     *hyscan_geo_transform_ref               (HyScanGeoTransform             *transform);
+
+/** Функция уменьшает счётчик ссылок на преобразование и удаляет его, если ссылок не осталось. */
+HYSCAN_API
+void                    hyscan_geo_transform_unref             (HyScanGeoTransform             *transform);
+
+/**
+ *
+ * Пересчет геодезических координат точки src в точку dst.
+ *
+ * \param[in] transform - преобразование координат;
+ * \param[out] dst - выходная координата, указатель на структуру #HyScanGeoGeodetic;
+ * \param[in] src - входная координата, структура #HyScanGeoGeodetic.
+ * \return FALSE, если входная координата вне допустимого диапазона.
+ *
+ */
+HYSCAN_API
+gboolean                hyscan_geo_transform_point             (HyScanGeoTransform             *transform,
+                                                                HyScanGeoGeodetic              *dst,
+                                                                HyScanGeoGeodetic               src);
+
+/**
+ *
+ * Пакетный пересчет геодезических координат. Для точек вне допустимого диапазона
+ * выходные координаты устанавливаются в NAN. Выходные массивы могут совпадать с входными.
+ *
+ * \param[in] transform - преобразование координат;
+ * \param[in] lat_in - широты точек во входной СК, градусы;
+ * \param[in] lon_in - долготы точек во входной СК, градусы;
+ * \param[in] h_in - высоты точек во входной СК или NULL, если высоты нулевые;
+ * \param[out] lat_out - широты точек в выходной СК, градусы;
+ * \param[out] lon_out - долготы точек в выходной СК, градусы;
+ * \param[out] h_out - высоты точек в выходной СК или NULL;
+ * \param[in] n_points - число точек.
+ * \return число пересчитанных точек.
+ *
+ */
+HYSCAN_API
+guint                   hyscan_geo_transform_array             (HyScanGeoTransform             *transform,
+                                                                const gdouble                  *lat_in,
+                                                                const gdouble                  *lon_in,
+                                                                const gdouble                  *h_in,
+                                                                gdouble                        *lat_out,
+                                                                gdouble                        *lon_out,
+                                                                gdouble                        *h_out,
+                                                                guint                           n_points);
 
 G_END_DECLS
 #endif /* __HYSCAN_GEO_H__ */
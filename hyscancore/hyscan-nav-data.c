@@ -52,9 +52,15 @@
  * обрабатывающих один и тот же навигационный параметр с одинаковыми параметрами
  * токен должен быть одинаковым. Например, курс можно извлекать из RMC-строк или
  * вычислять из координат. В этом случае токен должен различаться.
+ *
+ * Для получения большого числа значений за один вызов предназначены функции
+ * hyscan_nav_data_get_values() и hyscan_nav_data_get_at_times(). Реализация
+ * интерфейса может не поддерживать их, в этом случае они выполняются через
+ * hyscan_nav_data_get() и hyscan_nav_data_find_data().
  */
 
 #include "hyscan-nav-data.h"
+#include <math.h>
 
 G_DEFINE_INTERFACE (HyScanNavData, hyscan_nav_data, G_TYPE_OBJECT);
 
@@ -280,3 +286,129 @@ hyscan_nav_data_get_mod_count (HyScanNavData *navdata)
 
   return 0;
 }
+
+/**
+ * hyscan_nav_data_get_values:
+ * @ndata: указатель на интерфейс #HyScanNavData
+ * @first: первый индекс
+ * @last: последний индекс
+ * @times: (out) (nullable) (array): массив для меток времени
+ * @values: (out) (nullable) (array): массив для значений
+ *
+ * Функция возвращает значения для индексов от @first до @last включительно.
+ * Размер массивов должен быть не меньше @last - @first + 1.
+ *
+ * Returns: %TRUE, если удалось определить все значения, %FALSE в случае ошибки.
+ */
+gboolean
+hyscan_nav_data_get_values (HyScanNavData *navdata,
+                            guint32        first,
+                            guint32        last,
+                            gint64        *times,
+                            gdouble       *values)
+{
+  HyScanNavDataInterface *iface;
+  guint32 i;
+
+  g_return_val_if_fail (HYSCAN_IS_NAV_DATA (navdata), FALSE);
+  g_return_val_if_fail (first <= last, FALSE);
+  iface = HYSCAN_NAV_DATA_GET_IFACE (navdata);
+
+  if (iface->get_values != NULL)
+    return (*iface->get_values) (navdata, first, last, times, values);
+
+  if (iface->get == NULL)
+    return FALSE;
+
+  for (i = 0; i <= last - first; i++)
+    {
+      if (!(*iface->get) (navdata, first + i,
+                          (times != NULL) ? &times[i] : NULL,
+                          (values != NULL) ? &values[i] : NULL))
+        {
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_nav_data_get_at_times:
+ * @ndata: указатель на интерфейс #HyScanNavData
+ * @times: (array length=n_times): моменты времени
+ * @n_times: число моментов времени
+ * @values: (out) (array length=n_times): массив для значений
+ *
+ * Функция возвращает значения для заданных моментов времени. Значение между
+ * двумя записями определяется линейной интерполяцией. Для моментов времени,
+ * для которых значение определить не удалось, записывается NAN.
+ *
+ * Функция наиболее эффективна, если моменты времени упорядочены по
+ * возрастанию: соседние моменты, попадающие между одними и теми же
+ * записями, обрабатываются без повторного поиска.
+ *
+ * Если реализация интерфейса не поддерживает эту функцию, значения
+ * интерполируются без учёта перехода угловых величин через 0. Для курса и
+ * путевого угла такого источника следует использовать #HyScanNavInterp,
+ * созданный с параметром angular = %TRUE.
+ *
+ * Returns: число определённых значений.
+ */
+guint
+hyscan_nav_data_get_at_times (HyScanNavData *navdata,
+                              const gint64  *times,
+                              guint          n_times,
+                              gdouble       *values)
+{
+  HyScanNavDataInterface *iface;
+  gboolean segment = FALSE;
+  guint32 lindex, rindex;
+  gint64 ltime = 0, rtime = 0;
+  gdouble lvalue = 0.0, rvalue = 0.0;
+  guint n_found = 0;
+  guint i;
+
+  g_return_val_if_fail (HYSCAN_IS_NAV_DATA (navdata), 0);
+  g_return_val_if_fail (n_times == 0 || (times != NULL && values != NULL), 0);
+  iface = HYSCAN_NAV_DATA_GET_IFACE (navdata);
+
+  if (iface->get_at_times != NULL)
+    return (*iface->get_at_times) (navdata, times, n_times, values);
+
+  if ((iface->find_data == NULL) || (iface->get == NULL))
+    {
+      for (i = 0; i < n_times; i++)
+        values[i] = NAN;
+
+      return 0;
+    }
+
+  for (i = 0; i < n_times; i++)
+    {
+      gint64 time = times[i];
+
+      /* Ищем записи только если момент времени вне текущего отрезка. */
+      if (!segment || (time < ltime) || (time > rtime))
+        {
+          segment = ((*iface->find_data) (navdata, time, &lindex, &rindex, &ltime, &rtime) == HYSCAN_DB_FIND_OK) &&
+                    (*iface->get) (navdata, lindex, NULL, &lvalue) &&
+                    (*iface->get) (navdata, rindex, NULL, &rvalue);
+        }
+
+      if (!segment)
+        {
+          values[i] = NAN;
+          continue;
+        }
+
+      if (rtime == ltime)
+        values[i] = lvalue;
+      else
+        values[i] = lvalue + (rvalue - lvalue) * (gdouble) (time - ltime) / (gdouble) (rtime - ltime);
+
+      n_found++;
+    }
+
+  return n_found;
+}
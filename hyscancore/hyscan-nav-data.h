@@ -60,6 +60,8 @@ typedef struct _HyScanNavDataInterface HyScanNavDataInterface;
  * @is_writable: Определяет возможность записи в канал данных.
  * @get_token: Возвращает токен.
  * @get_mod_count: Возвращает счётчик изменений.
+ * @get_values: Возвращает значения для диапазона индексов.
+ * @get_at_times: Возвращает значения для массива моментов времени.
  */
 struct _HyScanNavDataInterface
 {
@@ -84,6 +86,16 @@ struct _HyScanNavDataInterface
   gboolean                (*is_writable)                  (HyScanNavData       *ndata);
   const gchar            *(*get_token)                    (HyScanNavData       *ndata);
   guint32                 (*get_mod_count)                (HyScanNavData       *ndata);
+
+  gboolean                (*get_values)                   (HyScanNavData       *ndata,
+                                                           guint32              first,
+                                                           guint32              last,
+                                                           gint64              *times,
+                                                           gdouble             *values);
+  guint                   (*get_at_times)                 (HyScanNavData       *ndata,
+                                                           const gint64        *times,
+                                                           guint                n_times,
+                                                           gdouble             *values);
 };
 
 HYSCAN_API
@@ -124,6 +136,19 @@ const gchar            *hyscan_nav_data_get_token       (HyScanNavData         *
 HYSCAN_API
 guint32                 hyscan_nav_data_get_mod_count   (HyScanNavData          *ndata);
 
+HYSCAN_API
+gboolean                hyscan_nav_data_get_values      (HyScanNavData         *ndata,
+                                                         guint32                first,
+                                                         guint32                last,
+                                                         gint64                *times,
+                                                         gdouble               *values);
+
+HYSCAN_API
+guint                   hyscan_nav_data_get_at_times    (HyScanNavData         *ndata,
+                                                         const gint64          *times,
+                                                         guint                  n_times,
+                                                         gdouble               *values);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_NAV_DATA_H__ */
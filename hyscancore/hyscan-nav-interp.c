@@ -0,0 +1,736 @@
+/* hyscan-nav-interp.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-nav-interp
+ * @Short_description: интерполяция навигационных данных по времени
+ * @Title: HyScanNavInterp
+ *
+ * Класс #HyScanNavInterp определяет значение навигационного параметра для
+ * произвольного момента времени. Класс является надстройкой над интерфейсом
+ * #HyScanNavData и сам реализует этот интерфейс, поэтому может
+ * использоваться вместо исходного объекта.
+ *
+ * При первом обращении класс считывает все значения источника и заранее
+ * вычисляет коэффициенты полиномов на каждом отрезке между соседними
+ * записями. Поддерживаются два метода интерполяции #HyScanNavInterpMethod:
+ * линейная и монотонная кубическая (метод Фрича-Бутланда). Кубическая
+ * интерполяция не создаёт выбросов за пределы соседних значений.
+ *
+ * Для угловых величин (курс, путевой угол) перед вычислением коэффициентов
+ * значения "разворачиваются" так, чтобы разность соседних значений не
+ * превышала 180 градусов. Благодаря этому переход через 0 интерполируется
+ * правильно. Результат приводится к диапазону [0, 360).
+ *
+ * Функция hyscan_nav_data_get_at_times() для упорядоченного по возрастанию
+ * массива моментов времени выполняется за один проход по отрезкам, то есть
+ * за время O(n + m). Индексы интерфейса совпадают с индексами источника.
+ *
+ * Если в источник продолжается запись, новые значения добавляются при
+ * очередном обращении после изменения счётчика изменений источника.
+ *
+ * Класс не является потокобезопасным.
+ */
+
+#include "hyscan-nav-interp.h"
+#include <string.h>
+#include <math.h>
+
+#define READ_BLOCK_SIZE        4096          /* Число значений, считываемых за один запрос. */
+#define MAX_LINEAR_STEP        64            /* Максимальный шаг линейного поиска. */
+
+enum
+{
+  PROP_O,
+  PROP_SOURCE,
+  PROP_METHOD,
+  PROP_ANGULAR
+};
+
+/* Отрезок интерполяции. Значение на отрезке:
+ * value + c1 * dt + c2 * dt^2 + c3 * dt^3, dt - время от начала отрезка в секундах. */
+typedef struct
+{
+  gint64                time;           /* Время начала отрезка. */
+  gdouble               value;          /* Значение в начале отрезка. */
+  gdouble               c1;             /* Коэффициенты полинома. */
+  gdouble               c2;
+  gdouble               c3;
+} HyScanNavInterpSegment;
+
+struct _HyScanNavInterpPrivate
+{
+  HyScanNavData        *source;         /* Источник данных. */
+  HyScanNavInterpMethod method;         /* Метод интерполяции. */
+  gboolean              angular;        /* Признак угловой величины. */
+  gchar                *token;          /* Токен объекта. */
+
+  GArray               *segments;       /* Отрезки интерполяции. */
+  gint64               *read_times;     /* Буфер меток времени. */
+  gdouble              *read_values;    /* Буфер значений. */
+
+  gboolean              valid;          /* Признак наличия данных. */
+  guint32               first;          /* Первый индекс источника. */
+  guint32               next;           /* Следующий считываемый индекс источника. */
+  guint32               mod_count;      /* Счётчик изменений на момент обновления. */
+};
+
+static void      hyscan_nav_interp_interface_init       (HyScanNavDataInterface *iface);
+static void      hyscan_nav_interp_set_property         (GObject                *object,
+                                                         guint                   prop_id,
+                                                         const GValue           *value,
+                                                         GParamSpec             *pspec);
+static void      hyscan_nav_interp_object_constructed   (GObject                *object);
+static void      hyscan_nav_interp_object_finalize      (GObject                *object);
+
+static gdouble   hyscan_nav_interp_slope                (const HyScanNavInterpSegment *segments,
+                                                         guint32                 k);
+static gdouble   hyscan_nav_interp_tangent              (const HyScanNavInterpSegment *segments,
+                                                         guint32                 n_segments,
+                                                         guint32                 k);
+static void      hyscan_nav_interp_build                (HyScanNavInterpPrivate *priv,
+                                                         guint32                 from);
+static guint32   hyscan_nav_interp_search               (const HyScanNavInterpSegment *segments,
+                                                         guint32                 n_segments,
+                                                         gint64                  time);
+static gboolean  hyscan_nav_interp_locate               (HyScanNavInterpPrivate *priv,
+                                                         gint64                  time,
+                                                         guint32                *hint);
+static gdouble   hyscan_nav_interp_eval                 (HyScanNavInterpPrivate *priv,
+                                                         guint32                 k,
+                                                         gint64                  time);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanNavInterp, hyscan_nav_interp, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanNavInterp)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_NAV_DATA, hyscan_nav_interp_interface_init));
+
+static void
+hyscan_nav_interp_class_init (HyScanNavInterpClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_nav_interp_set_property;
+
+  object_class->constructed = hyscan_nav_interp_object_constructed;
+  object_class->finalize = hyscan_nav_interp_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_SOURCE,
+    g_param_spec_object ("source", "Source", "Navigation data", HYSCAN_TYPE_NAV_DATA,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_METHOD,
+    g_param_spec_int ("method", "Method", "Interpolation method",
+                      HYSCAN_NAV_INTERP_LINEAR, HYSCAN_NAV_INTERP_CUBIC, HYSCAN_NAV_INTERP_LINEAR,
+                      G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_ANGULAR,
+    g_param_spec_boolean ("angular", "Angular", "Angular value in degrees", FALSE,
+                          G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_nav_interp_init (HyScanNavInterp *interp)
+{
+  interp->priv = hyscan_nav_interp_get_instance_private (interp);
+}
+
+static void
+hyscan_nav_interp_set_property (GObject      *object,
+                                guint         prop_id,
+                                const GValue *value,
+                                GParamSpec   *pspec)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (object);
+  HyScanNavInterpPrivate *priv = interp->priv;
+
+  switch (prop_id)
+    {
+    case PROP_SOURCE:
+      priv->source = g_value_dup_object (value);
+      break;
+
+    case PROP_METHOD:
+      priv->method = g_value_get_int (value);
+      break;
+
+    case PROP_ANGULAR:
+      priv->angular = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_nav_interp_object_constructed (GObject *object)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (object);
+  HyScanNavInterpPrivate *priv = interp->priv;
+  const gchar *source_token;
+
+  priv->segments = g_array_new (FALSE, FALSE, sizeof (HyScanNavInterpSegment));
+  priv->read_times = g_new (gint64, READ_BLOCK_SIZE);
+  priv->read_values = g_new (gdouble, READ_BLOCK_SIZE);
+
+  if (priv->source == NULL)
+    return;
+
+  source_token = hyscan_nav_data_get_token (priv->source);
+  if (source_token != NULL)
+    {
+      gchar *token;
+
+      token = g_strdup_printf ("interp.%s.%d.%d", source_token, priv->method, priv->angular);
+      priv->token = g_compute_checksum_for_string (G_CHECKSUM_SHA1, token, -1);
+      g_free (token);
+    }
+}
+
+static void
+hyscan_nav_interp_object_finalize (GObject *object)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (object);
+  HyScanNavInterpPrivate *priv = interp->priv;
+
+  g_array_unref (priv->segments);
+  g_free (priv->read_times);
+  g_free (priv->read_values);
+  g_free (priv->token);
+
+  g_clear_object (&priv->source);
+
+  G_OBJECT_CLASS (hyscan_nav_interp_parent_class)->finalize (object);
+}
+
+/* Функция возвращает наклон хорды на отрезке k. */
+static gdouble
+hyscan_nav_interp_slope (const HyScanNavInterpSegment *segments,
+                         guint32                       k)
+{
+  gdouble h = 1e-6 * (segments[k + 1].time - segments[k].time);
+
+  if (h <= 0.0)
+    return 0.0;
+
+  return (segments[k + 1].value - segments[k].value) / h;
+}
+
+/* Функция возвращает производную в точке k по методу Фрича-Бутланда. */
+static gdouble
+hyscan_nav_interp_tangent (const HyScanNavInterpSegment *segments,
+                           guint32                       n_segments,
+                           guint32                       k)
+{
+  gdouble d0, d1, h0, h1;
+
+  if (n_segments < 2)
+    return 0.0;
+
+  /* На краях используется наклон крайней хорды. */
+  if (k == 0)
+    return hyscan_nav_interp_slope (segments, 0);
+  if (k == n_segments - 1)
+    return hyscan_nav_interp_slope (segments, k - 1);
+
+  /* В локальных экстремумах производная равна нулю. */
+  d0 = hyscan_nav_interp_slope (segments, k - 1);
+  d1 = hyscan_nav_interp_slope (segments, k);
+  if (d0 * d1 <= 0.0)
+    return 0.0;
+
+  h0 = 1e-6 * (segments[k].time - segments[k - 1].time);
+  h1 = 1e-6 * (segments[k + 1].time - segments[k].time);
+
+  return 3.0 * (h0 + h1) / ((2.0 * h1 + h0) / d0 + (h1 + 2.0 * h0) / d1);
+}
+
+/* Функция вычисляет коэффициенты отрезков, начиная с отрезка from. */
+static void
+hyscan_nav_interp_build (HyScanNavInterpPrivate *priv,
+                         guint32                 from)
+{
+  HyScanNavInterpSegment *segments = (HyScanNavInterpSegment *) priv->segments->data;
+  guint32 n = priv->segments->len;
+  gdouble m0, m1;
+  guint32 k;
+
+  if (n == 0)
+    return;
+
+  m1 = hyscan_nav_interp_tangent (segments, n, from);
+
+  for (k = from; k + 1 < n; k++)
+    {
+      gdouble h = 1e-6 * (segments[k + 1].time - segments[k].time);
+      gdouble d = hyscan_nav_interp_slope (segments, k);
+
+      m0 = m1;
+      m1 = hyscan_nav_interp_tangent (segments, n, k + 1);
+
+      if ((priv->method == HYSCAN_NAV_INTERP_LINEAR) || (h <= 0.0))
+        {
+          segments[k].c1 = d;
+          segments[k].c2 = 0.0;
+          segments[k].c3 = 0.0;
+        }
+      else
+        {
+          segments[k].c1 = m0;
+          segments[k].c2 = (3.0 * d - 2.0 * m0 - m1) / h;
+          segments[k].c3 = (m0 + m1 - 2.0 * d) / (h * h);
+        }
+    }
+
+  /* Последняя точка - вырожденный отрезок. */
+  segments[n - 1].c1 = 0.0;
+  segments[n - 1].c2 = 0.0;
+  segments[n - 1].c3 = 0.0;
+}
+
+/* Функция ищет последний отрезок, время начала которого не больше time.
+ * Время начала первого отрезка должно быть не больше time. */
+static guint32
+hyscan_nav_interp_search (const HyScanNavInterpSegment *segments,
+                          guint32                       n_segments,
+                          gint64                        time)
+{
+  guint32 l = 0;
+  guint32 r = n_segments;
+
+  while (r - l > 1)
+    {
+      guint32 m = l + (r - l) / 2;
+
+      if (segments[m].time <= time)
+        l = m;
+      else
+        r = m;
+    }
+
+  return l;
+}
+
+/* Функция ищет отрезок для момента времени, начиная с отрезка hint. Для
+ * возрастающих моментов времени отрезок сдвигается вперёд на несколько
+ * элементов, в остальных случаях выполняется двоичный поиск. */
+static gboolean
+hyscan_nav_interp_locate (HyScanNavInterpPrivate *priv,
+                          gint64                  time,
+                          guint32                *hint)
+{
+  const HyScanNavInterpSegment *segments = (const HyScanNavInterpSegment *) priv->segments->data;
+  guint32 n = priv->segments->len;
+  guint32 k = *hint;
+
+  if ((n == 0) || (time < segments[0].time) || (time > segments[n - 1].time))
+    return FALSE;
+
+  if ((k >= n) || (time < segments[k].time) ||
+      ((k + MAX_LINEAR_STEP < n) && (segments[k + MAX_LINEAR_STEP].time <= time)))
+    {
+      k = hyscan_nav_interp_search (segments, n, time);
+    }
+  else
+    {
+      while ((k + 1 < n) && (segments[k + 1].time <= time))
+        k++;
+    }
+
+  *hint = k;
+
+  return TRUE;
+}
+
+/* Функция вычисляет значение на отрезке k. */
+static gdouble
+hyscan_nav_interp_eval (HyScanNavInterpPrivate *priv,
+                        guint32                 k,
+                        gint64                  time)
+{
+  const HyScanNavInterpSegment *segment = &g_array_index (priv->segments, HyScanNavInterpSegment, k);
+  gdouble dt = 1e-6 * (time - segment->time);
+  gdouble value;
+
+  value = segment->value + dt * (segment->c1 + dt * (segment->c2 + dt * segment->c3));
+
+  if (priv->angular)
+    {
+      value = fmod (value, 360.0);
+      if (value < 0.0)
+        value += 360.0;
+    }
+
+  return value;
+}
+
+static void
+hyscan_nav_interp_set_cache (HyScanNavData *ndata,
+                             HyScanCache   *cache)
+{
+  HyScanNavInterpPrivate *priv = HYSCAN_NAV_INTERP (ndata)->priv;
+
+  if (priv->source != NULL)
+    hyscan_nav_data_set_cache (priv->source, cache);
+}
+
+static gboolean
+hyscan_nav_interp_get (HyScanNavData *ndata,
+                       guint32        index,
+                       gint64        *time,
+                       gdouble       *value)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (ndata);
+  HyScanNavInterpPrivate *priv = interp->priv;
+  guint32 k;
+
+  if (!hyscan_nav_interp_update (interp) || (index < priv->first))
+    return FALSE;
+
+  k = index - priv->first;
+  if (k >= priv->segments->len)
+    return FALSE;
+
+  (time != NULL) ? *time = g_array_index (priv->segments, HyScanNavInterpSegment, k).time : 0;
+  (value != NULL) ? *value = hyscan_nav_interp_eval (priv, k, g_array_index (priv->segments, HyScanNavInterpSegment, k).time) : 0;
+
+  return TRUE;
+}
+
+static HyScanDBFindStatus
+hyscan_nav_interp_find_data (HyScanNavData *ndata,
+                             gint64         time,
+                             guint32       *lindex,
+                             guint32       *rindex,
+                             gint64        *ltime,
+                             gint64        *rtime)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (ndata);
+  HyScanNavInterpPrivate *priv = interp->priv;
+  const HyScanNavInterpSegment *segments;
+  guint32 n, l, r;
+
+  if (!hyscan_nav_interp_update (interp))
+    return HYSCAN_DB_FIND_FAIL;
+
+  segments = (const HyScanNavInterpSegment *) priv->segments->data;
+  n = priv->segments->len;
+
+  if (n == 0)
+    return HYSCAN_DB_FIND_FAIL;
+
+  if (time < segments[0].time)
+    {
+      (rindex != NULL) ? *rindex = priv->first : 0;
+      (rtime != NULL) ? *rtime = segments[0].time : 0;
+      return HYSCAN_DB_FIND_LESS;
+    }
+
+  if (time > segments[n - 1].time)
+    {
+      (lindex != NULL) ? *lindex = priv->first + n - 1 : 0;
+      (ltime != NULL) ? *ltime = segments[n - 1].time : 0;
+      return HYSCAN_DB_FIND_GREATER;
+    }
+
+  l = hyscan_nav_interp_search (segments, n, time);
+  r = (segments[l].time == time) ? l : l + 1;
+
+  (lindex != NULL) ? *lindex = priv->first + l : 0;
+  (rindex != NULL) ? *rindex = priv->first + r : 0;
+  (ltime != NULL) ? *ltime = segments[l].time : 0;
+  (rtime != NULL) ? *rtime = segments[r].time : 0;
+
+  return HYSCAN_DB_FIND_OK;
+}
+
+static gboolean
+hyscan_nav_interp_get_range (HyScanNavData *ndata,
+                             guint32       *first,
+                             guint32       *last)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (ndata);
+  HyScanNavInterpPrivate *priv = interp->priv;
+
+  if (!hyscan_nav_interp_update (interp) || (priv->segments->len == 0))
+    return FALSE;
+
+  (first != NULL) ? *first = priv->first : 0;
+  (last != NULL) ? *last = priv->first + priv->segments->len - 1 : 0;
+
+  return TRUE;
+}
+
+static HyScanAntennaOffset
+hyscan_nav_interp_get_offset (HyScanNavData *ndata)
+{
+  return hyscan_nav_data_get_offset (HYSCAN_NAV_INTERP (ndata)->priv->source);
+}
+
+static gboolean
+hyscan_nav_interp_is_writable (HyScanNavData *ndata)
+{
+  return hyscan_nav_data_is_writable (HYSCAN_NAV_INTERP (ndata)->priv->source);
+}
+
+static const gchar *
+hyscan_nav_interp_get_token (HyScanNavData *ndata)
+{
+  return HYSCAN_NAV_INTERP (ndata)->priv->token;
+}
+
+static guint32
+hyscan_nav_interp_get_mod_count (HyScanNavData *ndata)
+{
+  return hyscan_nav_data_get_mod_count (HYSCAN_NAV_INTERP (ndata)->priv->source);
+}
+
+static gboolean
+hyscan_nav_interp_get_values (HyScanNavData *ndata,
+                              guint32        first,
+                              guint32        last,
+                              gint64        *times,
+                              gdouble       *values)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (ndata);
+  HyScanNavInterpPrivate *priv = interp->priv;
+  const HyScanNavInterpSegment *segments;
+  guint32 i;
+
+  if (!hyscan_nav_interp_update (interp) || (first < priv->first) ||
+      (last - priv->first >= priv->segments->len))
+    {
+      return FALSE;
+    }
+
+  segments = &g_array_index (priv->segments, HyScanNavInterpSegment, first - priv->first);
+  for (i = 0; i <= last - first; i++)
+    {
+      (times != NULL) ? times[i] = segments[i].time : 0;
+      (values != NULL) ? values[i] = hyscan_nav_interp_eval (priv, first - priv->first + i, segments[i].time) : 0;
+    }
+
+  return TRUE;
+}
+
+static guint
+hyscan_nav_interp_get_at_times (HyScanNavData *ndata,
+                                const gint64  *times,
+                                guint          n_times,
+                                gdouble       *values)
+{
+  HyScanNavInterp *interp = HYSCAN_NAV_INTERP (ndata);
+  HyScanNavInterpPrivate *priv = interp->priv;
+  guint32 k = 0;
+  guint n_found = 0;
+  guint i;
+
+  hyscan_nav_interp_update (interp);
+
+  for (i = 0; i < n_times; i++)
+    {
+      if (!hyscan_nav_interp_locate (priv, times[i], &k))
+        {
+          values[i] = NAN;
+          continue;
+        }
+
+      values[i] = hyscan_nav_interp_eval (priv, k, times[i]);
+      n_found++;
+    }
+
+  return n_found;
+}
+
+/**
+ * hyscan_nav_interp_new:
+ * @source: источник данных #HyScanNavData
+ * @method: метод интерполяции
+ * @angular: признак угловой величины в градусах
+ *
+ * Функция создаёт новый объект интерполяции навигационных данных. Для
+ * курса и путевого угла следует передать @angular = %TRUE.
+ *
+ * Returns: (nullable): указатель на объект #HyScanNavInterp или NULL.
+ */
+HyScanNavInterp *
+hyscan_nav_interp_new (HyScanNavData         *source,
+                       HyScanNavInterpMethod  method,
+                       gboolean               angular)
+{
+  if (!HYSCAN_IS_NAV_DATA (source))
+    return NULL;
+
+  return g_object_new (HYSCAN_TYPE_NAV_INTERP,
+                       "source", source,
+                       "method", method,
+                       "angular", angular,
+                       NULL);
+}
+
+/**
+ * hyscan_nav_interp_update:
+ * @interp: указатель на #HyScanNavInterp
+ *
+ * Функция считывает значения, появившиеся в источнике с момента предыдущего
+ * вызова, и вычисляет коэффициенты новых отрезков. Если счётчик изменений
+ * источника не изменился, функция ничего не делает. Функция вызывается
+ * автоматически при обращении к данным.
+ *
+ * Returns: %TRUE - если данные доступны, %FALSE - в случае ошибки.
+ */
+gboolean
+hyscan_nav_interp_update (HyScanNavInterp *interp)
+{
+  HyScanNavInterpPrivate *priv;
+  guint32 mod_count;
+  guint32 first, last;
+  guint32 n_old;
+
+  g_return_val_if_fail (HYSCAN_IS_NAV_INTERP (interp), FALSE);
+  priv = interp->priv;
+
+  if (priv->source == NULL)
+    return FALSE;
+
+  mod_count = hyscan_nav_data_get_mod_count (priv->source);
+  if (priv->valid && (priv->mod_count == mod_count))
+    return TRUE;
+
+  if (!hyscan_nav_data_get_range (priv->source, &first, &last))
+    return priv->valid;
+
+  /* Начало данных изменилось - вычисляем всё заново. */
+  if (!priv->valid || (priv->first != first))
+    {
+      g_array_set_size (priv->segments, 0);
+      priv->first = first;
+      priv->next = first;
+      priv->valid = TRUE;
+    }
+
+  n_old = priv->segments->len;
+
+  while (priv->next <= last)
+    {
+      guint32 n_read = MIN (last - priv->next + 1, READ_BLOCK_SIZE);
+      guint32 i;
+
+      if (!hyscan_nav_data_get_values (priv->source, priv->next, priv->next + n_read - 1,
+                                       priv->read_times, priv->read_values))
+        {
+          break;
+        }
+
+      for (i = 0; i < n_read; i++)
+        {
+          HyScanNavInterpSegment segment = {0};
+          guint32 n = priv->segments->len;
+
+          segment.time = priv->read_times[i];
+          segment.value = priv->read_values[i];
+
+          /* Разворачиваем угол относительно предыдущего значения. */
+          if (priv->angular && (n > 0))
+            {
+              gdouble prev = g_array_index (priv->segments, HyScanNavInterpSegment, n - 1).value;
+              gdouble delta = segment.value - prev;
+
+              segment.value = prev + (delta - 360.0 * floor (delta / 360.0 + 0.5));
+            }
+
+          g_array_append_val (priv->segments, segment);
+        }
+
+      priv->next += n_read;
+    }
+
+  /* Новые точки меняют производную в последней старой точке,
+   * поэтому пересчитываем и предпоследний старый отрезок. */
+  if (priv->segments->len != n_old)
+    hyscan_nav_interp_build (priv, (n_old >= 2) ? n_old - 2 : 0);
+
+  if (priv->next > last)
+    priv->mod_count = mod_count;
+
+  return TRUE;
+}
+
+/**
+ * hyscan_nav_interp_get_value:
+ * @interp: указатель на #HyScanNavInterp
+ * @time: момент времени
+ * @value: (out): значение
+ *
+ * Функция возвращает интерполированное значение для момента времени. Для
+ * большого числа моментов времени эффективнее использовать функцию
+ * hyscan_nav_data_get_at_times().
+ *
+ * Returns: %TRUE - если момент времени находится в пределах данных,
+ * %FALSE - в противном случае.
+ */
+gboolean
+hyscan_nav_interp_get_value (HyScanNavInterp *interp,
+                             gint64           time,
+                             gdouble         *value)
+{
+  HyScanNavInterpPrivate *priv;
+  guint32 k = 0;
+
+  g_return_val_if_fail (HYSCAN_IS_NAV_INTERP (interp), FALSE);
+  priv = interp->priv;
+
+  if (!hyscan_nav_interp_update (interp) || !hyscan_nav_interp_locate (priv, time, &k))
+    return FALSE;
+
+  (value != NULL) ? *value = hyscan_nav_interp_eval (priv, k, time) : 0;
+
+  return TRUE;
+}
+
+static void
+hyscan_nav_interp_interface_init (HyScanNavDataInterface *iface)
+{
+  iface->set_cache = hyscan_nav_interp_set_cache;
+  iface->get = hyscan_nav_interp_get;
+  iface->find_data = hyscan_nav_interp_find_data;
+  iface->get_range = hyscan_nav_interp_get_range;
+  iface->get_offset = hyscan_nav_interp_get_offset;
+  iface->is_writable = hyscan_nav_interp_is_writable;
+  iface->get_token = hyscan_nav_interp_get_token;
+  iface->get_mod_count = hyscan_nav_interp_get_mod_count;
+  iface->get_values = hyscan_nav_interp_get_values;
+  iface->get_at_times = hyscan_nav_interp_get_at_times;
+}
@@ -0,0 +1,96 @@
+/* hyscan-nav-interp.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_NAV_INTERP_H__
+#define __HYSCAN_NAV_INTERP_H__
+
+#include <hyscan-nav-data.h>
+
+G_BEGIN_DECLS
+
+/**
+ * HyScanNavInterpMethod:
+ * @HYSCAN_NAV_INTERP_LINEAR: линейная интерполяция
+ * @HYSCAN_NAV_INTERP_CUBIC: монотонная кубическая интерполяция
+ *
+ * Метод интерполяции навигационных данных.
+ */
+typedef enum
+{
+  HYSCAN_NAV_INTERP_LINEAR,
+  HYSCAN_NAV_INTERP_CUBIC
+} HyScanNavInterpMethod;
+
+#define HYSCAN_TYPE_NAV_INTERP             (hyscan_nav_interp_get_type ())
+#define HYSCAN_NAV_INTERP(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_NAV_INTERP, HyScanNavInterp))
+#define HYSCAN_IS_NAV_INTERP(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_NAV_INTERP))
+#define HYSCAN_NAV_INTERP_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_NAV_INTERP, HyScanNavInterpClass))
+#define HYSCAN_IS_NAV_INTERP_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_NAV_INTERP))
+#define HYSCAN_NAV_INTERP_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_NAV_INTERP, HyScanNavInterpClass))
+
+typedef struct _HyScanNavInterp HyScanNavInterp;
+typedef struct _HyScanNavInterpPrivate HyScanNavInterpPrivate;
+typedef struct _HyScanNavInterpClass HyScanNavInterpClass;
+
+struct _HyScanNavInterp
+{
+  GObject parent_instance;
+
+  HyScanNavInterpPrivate *priv;
+};
+
+struct _HyScanNavInterpClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                   hyscan_nav_interp_get_type             (void);
+
+HYSCAN_API
+HyScanNavInterp *       hyscan_nav_interp_new                  (HyScanNavData         *source,
+                                                                HyScanNavInterpMethod  method,
+                                                                gboolean               angular);
+
+HYSCAN_API
+gboolean                hyscan_nav_interp_update               (HyScanNavInterp       *interp);
+
+HYSCAN_API
+gboolean                hyscan_nav_interp_get_value            (HyScanNavInterp       *interp,
+                                                                gint64                 time,
+                                                                gdouble               *value);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_NAV_INTERP_H__ */
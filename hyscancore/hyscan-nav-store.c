@@ -0,0 +1,990 @@
+/* hyscan-nav-store.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-nav-store
+ * @Short_description: декодированные навигационные данные из NMEA-канала
+ * @Title: HyScanNavStore
+ *
+ * Класс #HyScanNavStore разбирает NMEA-канал галса один раз и хранит
+ * извлечённые навигационные параметры в памяти в виде столбцов: для каждого
+ * параметра #HyScanNavStoreField упорядоченный массив меток времени и массив
+ * значений. Метка времени значения - это метка времени записи в канале.
+ *
+ * Параметры извлекаются из следующих сообщений:
+ * - RMC: широта, долгота, путевой угол и скорость (только для сообщений
+ *   с признаком достоверности "A");
+ * - DPT: глубина;
+ * - HDT: курс.
+ *
+ * Сообщения GGA не используются, чтобы координаты не дублировались при
+ * одновременной записи RMC и GGA. Если в одной записи канала несколько
+ * сообщений одного типа, используется последнее из них.
+ *
+ * Класс реализует интерфейс #HyScanNavData для параметра, указанного при
+ * создании объекта. Индексами интерфейса являются номера элементов столбца,
+ * поэтому функции hyscan_nav_data_get() и hyscan_nav_data_find_data()
+ * сводятся к обращению к массиву и двоичному поиску по времени. Столбцы
+ * всех параметров можно получить функцией hyscan_nav_store_get_column().
+ *
+ * Если в канал продолжается запись, новые записи разбираются при очередном
+ * обращении к объекту после изменения счётчика изменений канала. Разбор
+ * можно выполнить явно функцией hyscan_nav_store_update(). Если задан кэш,
+ * декодированные данные сохраняются в нём после завершения записи в канал
+ * или при явном вызове hyscan_nav_store_update() и используются повторно
+ * другими объектами для того же канала.
+ *
+ * Функция hyscan_nav_data_get_at_times() интерполирует курс и путевой угол
+ * с учётом перехода через 0 и возвращает их в диапазоне [0, 360).
+ *
+ * Класс не является потокобезопасным.
+ */
+
+#include "hyscan-nav-store.h"
+#include "hyscan-nmea-data.h"
+#include <string.h>
+#include <math.h>
+
+#define CACHE_HEADER_MAGIC     0x2b6e91d4    /* Идентификатор заголовка кэша. */
+#define N_FIELDS               6             /* Число навигационных параметров. */
+#define MAX_FIELDS             13            /* Максимальное число разбираемых полей сообщения. */
+#define KNOTS_TO_MS            (1852.0 / 3600.0)
+#define MAX_LINEAR_STEP        64            /* Максимальный шаг линейного поиска. */
+
+enum
+{
+  PROP_O,
+  PROP_DB,
+  PROP_PROJECT_NAME,
+  PROP_TRACK_NAME,
+  PROP_SOURCE_CHANNEL,
+  PROP_FIELD
+};
+
+/* Заголовок декодированных данных в кэше. */
+typedef struct
+{
+  guint32               magic;          /* Идентификатор заголовка. */
+  guint32               first;          /* Первый разобранный индекс канала. */
+  guint32               next;           /* Следующий разбираемый индекс канала. */
+  guint32               counts[N_FIELDS]; /* Число значений каждого параметра. */
+} HyScanNavStoreCacheHeader;
+
+struct _HyScanNavStorePrivate
+{
+  HyScanDB             *db;             /* Интерфейс базы данных. */
+  gchar                *project;        /* Название проекта. */
+  gchar                *track;          /* Название галса. */
+  guint                 source_channel; /* Индекс канала данных. */
+  HyScanNavStoreField   field;          /* Параметр для интерфейса HyScanNavData. */
+
+  HyScanNMEAData       *nmea;           /* NMEA-данные. */
+  HyScanCache          *cache;          /* Интерфейс системы кэширования. */
+  HyScanBuffer         *cache_buffer;   /* Буфер заголовка кэша. */
+  HyScanBuffer         *data_buffer;    /* Буфер данных кэша. */
+  gchar                *key;            /* Ключ кэширования. */
+  gchar                *token;          /* Токен объекта. */
+
+  GArray               *times[N_FIELDS];  /* Метки времени значений. */
+  GArray               *values[N_FIELDS]; /* Значения параметров. */
+
+  gboolean              valid;          /* Признак наличия декодированных данных. */
+  gboolean              dirty;          /* Признак отличия данных от сохранённых в кэше. */
+  guint32               first;          /* Первый разобранный индекс канала. */
+  guint32               next;           /* Следующий разбираемый индекс канала. */
+  guint32               mod_count;      /* Счётчик изменений на момент разбора. */
+};
+
+static void      hyscan_nav_store_interface_init        (HyScanNavDataInterface *iface);
+static void      hyscan_nav_store_set_property          (GObject               *object,
+                                                         guint                  prop_id,
+                                                         const GValue          *value,
+                                                         GParamSpec            *pspec);
+static void      hyscan_nav_store_object_constructed    (GObject               *object);
+static void      hyscan_nav_store_object_finalize       (GObject               *object);
+
+static gboolean  hyscan_nav_store_parse_double          (const HyScanNmeaSpan  *field,
+                                                         gdouble               *value);
+static gboolean  hyscan_nav_store_parse_coord           (const HyScanNmeaSpan  *field,
+                                                         const HyScanNmeaSpan  *hemisphere,
+                                                         gdouble               *value);
+static void      hyscan_nav_store_append                (HyScanNavStorePrivate *priv,
+                                                         HyScanNavStoreField    field,
+                                                         gint64                 time,
+                                                         gdouble                value);
+static void      hyscan_nav_store_decode                (HyScanNavStorePrivate *priv,
+                                                         const HyScanNmeaSpan  *sentence,
+                                                         HyScanNmeaDataType     type,
+                                                         gint64                 time);
+static guint32   hyscan_nav_store_search                (const gint64          *times,
+                                                         guint32                n_times,
+                                                         gint64                 time);
+static void      hyscan_nav_store_reset                 (HyScanNavStorePrivate *priv);
+static gboolean  hyscan_nav_store_load                  (HyScanNavStorePrivate *priv);
+static void      hyscan_nav_store_save                  (HyScanNavStorePrivate *priv);
+static gboolean  hyscan_nav_store_sync                  (HyScanNavStore        *store,
+                                                         gboolean               save);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanNavStore, hyscan_nav_store, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanNavStore)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_NAV_DATA, hyscan_nav_store_interface_init));
+
+static void
+hyscan_nav_store_class_init (HyScanNavStoreClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_nav_store_set_property;
+
+  object_class->constructed = hyscan_nav_store_object_constructed;
+  object_class->finalize = hyscan_nav_store_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_DB,
+    g_param_spec_object ("db", "DB", "HyScanDB interface", HYSCAN_TYPE_DB,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_PROJECT_NAME,
+    g_param_spec_string ("project-name", "ProjectName", "Project name", NULL,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_TRACK_NAME,
+    g_param_spec_string ("track-name", "TrackName", "Track name", NULL,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_SOURCE_CHANNEL,
+    g_param_spec_uint ("source-channel", "SourceChannel", "Source channel", 1, G_MAXUINT, 1,
+                       G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_FIELD,
+    g_param_spec_int ("field", "Field", "Navigation field",
+                      HYSCAN_NAV_STORE_LAT, HYSCAN_NAV_STORE_HEADING, HYSCAN_NAV_STORE_LAT,
+                      G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_nav_store_init (HyScanNavStore *store)
+{
+  store->priv = hyscan_nav_store_get_instance_private (store);
+}
+
+static void
+hyscan_nav_store_set_property (GObject      *object,
+                               guint         prop_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (object);
+  HyScanNavStorePrivate *priv = store->priv;
+
+  switch (prop_id)
+    {
+    case PROP_DB:
+      priv->db = g_value_dup_object (value);
+      break;
+
+    case PROP_PROJECT_NAME:
+      priv->project = g_value_dup_string (value);
+      break;
+
+    case PROP_TRACK_NAME:
+      priv->track = g_value_dup_string (value);
+      break;
+
+    case PROP_SOURCE_CHANNEL:
+      priv->source_channel = g_value_get_uint (value);
+      break;
+
+    case PROP_FIELD:
+      priv->field = g_value_get_int (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_nav_store_object_constructed (GObject *object)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (object);
+  HyScanNavStorePrivate *priv = store->priv;
+  const gchar *channel_name;
+  gchar *db_uri;
+  gchar *token;
+  guint i;
+
+  priv->cache_buffer = hyscan_buffer_new ();
+  priv->data_buffer = hyscan_buffer_new ();
+
+  for (i = 0; i < N_FIELDS; i++)
+    {
+      priv->times[i] = g_array_new (FALSE, FALSE, sizeof (gint64));
+      priv->values[i] = g_array_new (FALSE, FALSE, sizeof (gdouble));
+    }
+
+  if ((priv->db == NULL) || (priv->project == NULL) || (priv->track == NULL))
+    return;
+
+  priv->nmea = hyscan_nmea_data_new (priv->db, priv->project, priv->track, priv->source_channel);
+  if (priv->nmea == NULL)
+    return;
+
+  channel_name = hyscan_channel_get_id_by_types (HYSCAN_SOURCE_NMEA,
+                                                 HYSCAN_CHANNEL_DATA,
+                                                 priv->source_channel);
+
+  db_uri = hyscan_db_get_uri (priv->db);
+  priv->key = g_strdup_printf ("NAVSTORE.%s.%s.%s.%s",
+                               db_uri, priv->project, priv->track, channel_name);
+
+  /* Токен не зависит от длины названий проекта и галса. */
+  token = g_strdup_printf ("%s.%d", priv->key, priv->field);
+  priv->token = g_compute_checksum_for_string (G_CHECKSUM_SHA1, token, -1);
+
+  g_free (token);
+  g_free (db_uri);
+}
+
+static void
+hyscan_nav_store_object_finalize (GObject *object)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (object);
+  HyScanNavStorePrivate *priv = store->priv;
+  guint i;
+
+  for (i = 0; i < N_FIELDS; i++)
+    {
+      g_array_unref (priv->times[i]);
+      g_array_unref (priv->values[i]);
+    }
+
+  g_object_unref (priv->cache_buffer);
+  g_object_unref (priv->data_buffer);
+
+  g_free (priv->project);
+  g_free (priv->track);
+  g_free (priv->key);
+  g_free (priv->token);
+
+  g_clear_object (&priv->nmea);
+  g_clear_object (&priv->cache);
+  g_clear_object (&priv->db);
+
+  G_OBJECT_CLASS (hyscan_nav_store_parent_class)->finalize (object);
+}
+
+/* Функция считывает число с плавающей точкой из поля сообщения. */
+static gboolean
+hyscan_nav_store_parse_double (const HyScanNmeaSpan *field,
+                               gdouble              *value)
+{
+  gchar text[32];
+  gchar *end;
+
+  if ((field->length == 0) || (field->length >= sizeof (text)))
+    return FALSE;
+
+  memcpy (text, field->data, field->length);
+  text[field->length] = '\0';
+
+  *value = g_ascii_strtod (text, &end);
+
+  return (end == text + field->length);
+}
+
+/* Функция считывает координату в формате "ddmm.mmmm" с признаком полушария. */
+static gboolean
+hyscan_nav_store_parse_coord (const HyScanNmeaSpan *field,
+                              const HyScanNmeaSpan *hemisphere,
+                              gdouble              *value)
+{
+  gdouble raw, degrees;
+
+  if ((hemisphere->length != 1) || !hyscan_nav_store_parse_double (field, &raw))
+    return FALSE;
+
+  degrees = floor (raw / 100.0);
+  *value = degrees + (raw - 100.0 * degrees) / 60.0;
+
+  switch (hemisphere->data[0])
+    {
+    case 'N':
+    case 'E':
+      return TRUE;
+
+    case 'S':
+    case 'W':
+      *value = -*value;
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/* Функция добавляет значение параметра. Значение с той же меткой времени
+ * заменяет предыдущее. */
+static void
+hyscan_nav_store_append (HyScanNavStorePrivate *priv,
+                         HyScanNavStoreField    field,
+                         gint64                 time,
+                         gdouble                value)
+{
+  GArray *times = priv->times[field];
+  GArray *values = priv->values[field];
+
+  if ((times->len > 0) && (g_array_index (times, gint64, times->len - 1) == time))
+    {
+      g_array_index (values, gdouble, values->len - 1) = value;
+      return;
+    }
+
+  g_array_append_val (times, time);
+  g_array_append_val (values, value);
+}
+
+/* Функция извлекает навигационные параметры из сообщения. */
+static void
+hyscan_nav_store_decode (HyScanNavStorePrivate *priv,
+                         const HyScanNmeaSpan  *sentence,
+                         HyScanNmeaDataType     type,
+                         gint64                 time)
+{
+  HyScanNmeaSpan fields[MAX_FIELDS];
+  guint32 position = 0;
+  guint n_fields = 0;
+  gdouble lat, lon, value;
+
+  while ((n_fields < MAX_FIELDS) && hyscan_nmea_data_next_field (sentence, &position, &fields[n_fields]))
+    n_fields++;
+
+  switch (type)
+    {
+    /* $--RMC,время,статус,широта,N/S,долгота,E/W,скорость,путевой угол,... */
+    case HYSCAN_NMEA_DATA_RMC:
+      if ((n_fields < 9) || (fields[2].length != 1) || (fields[2].data[0] != 'A'))
+        break;
+
+      if (hyscan_nav_store_parse_coord (&fields[3], &fields[4], &lat) &&
+          hyscan_nav_store_parse_coord (&fields[5], &fields[6], &lon))
+        {
+          hyscan_nav_store_append (priv, HYSCAN_NAV_STORE_LAT, time, lat);
+          hyscan_nav_store_append (priv, HYSCAN_NAV_STORE_LON, time, lon);
+        }
+
+      if (hyscan_nav_store_parse_double (&fields[7], &value))
+        hyscan_nav_store_append (priv, HYSCAN_NAV_STORE_SPEED, time, value * KNOTS_TO_MS);
+
+      if (hyscan_nav_store_parse_double (&fields[8], &value))
+        hyscan_nav_store_append (priv, HYSCAN_NAV_STORE_TRACK, time, value);
+      break;
+
+    /* $--DPT,глубина,смещение,... */
+    case HYSCAN_NMEA_DATA_DPT:
+      if ((n_fields >= 2) && hyscan_nav_store_parse_double (&fields[1], &value))
+        hyscan_nav_store_append (priv, HYSCAN_NAV_STORE_DEPTH, time, value);
+      break;
+
+    /* $--HDT,курс,T */
+    case HYSCAN_NMEA_DATA_HDT:
+      if ((n_fields >= 2) && hyscan_nav_store_parse_double (&fields[1], &value))
+        hyscan_nav_store_append (priv, HYSCAN_NAV_STORE_HEADING, time, value);
+      break;
+
+    default:
+      break;
+    }
+}
+
+/* Функция ищет последний элемент, метка времени которого не больше time.
+ * Метка времени первого элемента должна быть не больше time. */
+static guint32
+hyscan_nav_store_search (const gint64 *times,
+                         guint32       n_times,
+                         gint64        time)
+{
+  guint32 l = 0;
+  guint32 r = n_times;
+
+  /* Двоичный поиск: times[l] <= time < times[r]. */
+  while (r - l > 1)
+    {
+      guint32 m = l + (r - l) / 2;
+
+      if (times[m] <= time)
+        l = m;
+      else
+        r = m;
+    }
+
+  return l;
+}
+
+/* Функция очищает декодированные данные. */
+static void
+hyscan_nav_store_reset (HyScanNavStorePrivate *priv)
+{
+  guint i;
+
+  for (i = 0; i < N_FIELDS; i++)
+    {
+      g_array_set_size (priv->times[i], 0);
+      g_array_set_size (priv->values[i], 0);
+    }
+
+  priv->valid = FALSE;
+  priv->dirty = FALSE;
+}
+
+/* Функция загружает декодированные данные из кэша. */
+static gboolean
+hyscan_nav_store_load (HyScanNavStorePrivate *priv)
+{
+  HyScanNavStoreCacheHeader header;
+  const gchar *data;
+  guint32 n_values = 0;
+  guint32 size;
+  guint i;
+
+  if (priv->cache == NULL)
+    return FALSE;
+
+  hyscan_buffer_wrap (priv->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+  if (!hyscan_cache_get2 (priv->cache, priv->key, NULL, sizeof (header), priv->cache_buffer, priv->data_buffer))
+    return FALSE;
+
+  /* Верификация данных. */
+  for (i = 0; i < N_FIELDS; i++)
+    n_values += header.counts[i];
+
+  data = hyscan_buffer_get (priv->data_buffer, NULL, &size);
+  if ((header.magic != CACHE_HEADER_MAGIC) ||
+      (size != n_values * (sizeof (gint64) + sizeof (gdouble))))
+    {
+      return FALSE;
+    }
+
+  /* Для каждого параметра сначала метки времени, потом значения. */
+  for (i = 0; i < N_FIELDS; i++)
+    {
+      g_array_set_size (priv->times[i], 0);
+      g_array_append_vals (priv->times[i], data, header.counts[i]);
+      data += header.counts[i] * sizeof (gint64);
+
+      g_array_set_size (priv->values[i], 0);
+      g_array_append_vals (priv->values[i], data, header.counts[i]);
+      data += header.counts[i] * sizeof (gdouble);
+    }
+
+  priv->first = header.first;
+  priv->next = header.next;
+  priv->valid = TRUE;
+  priv->dirty = FALSE;
+
+  return TRUE;
+}
+
+/* Функция сохраняет декодированные данные в кэше. */
+static void
+hyscan_nav_store_save (HyScanNavStorePrivate *priv)
+{
+  HyScanNavStoreCacheHeader header;
+  guint32 n_values = 0;
+  guint32 size;
+  gchar *data;
+  guint i;
+
+  if (priv->cache == NULL)
+    return;
+
+  header.magic = CACHE_HEADER_MAGIC;
+  header.first = priv->first;
+  header.next = priv->next;
+
+  for (i = 0; i < N_FIELDS; i++)
+    {
+      header.counts[i] = priv->times[i]->len;
+      n_values += header.counts[i];
+    }
+
+  hyscan_buffer_set_data_size (priv->data_buffer, n_values * (sizeof (gint64) + sizeof (gdouble)));
+  data = hyscan_buffer_get (priv->data_buffer, NULL, &size);
+
+  for (i = 0; i < N_FIELDS; i++)
+    {
+      size = header.counts[i] * sizeof (gint64);
+      memcpy (data, priv->times[i]->data, size);
+      data += size;
+
+      size = header.counts[i] * sizeof (gdouble);
+      memcpy (data, priv->values[i]->data, size);
+      data += size;
+    }
+
+  hyscan_buffer_wrap (priv->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+  hyscan_cache_set2 (priv->cache, priv->key, NULL, priv->cache_buffer, priv->data_buffer);
+
+  priv->dirty = FALSE;
+}
+
+/* Функция разбирает записи, появившиеся в канале с момента предыдущего
+ * вызова. Новые значения добавляются в конец столбцов. Данные сохраняются
+ * в кэше после завершения записи в канал или, если задан признак save,
+ * после каждого разбора. */
+static gboolean
+hyscan_nav_store_sync (HyScanNavStore *store,
+                       gboolean        save)
+{
+  HyScanNavStorePrivate *priv = store->priv;
+  guint32 mod_count;
+  guint32 first, last;
+  guint32 index;
+
+  if (priv->nmea == NULL)
+    return FALSE;
+
+  mod_count = hyscan_nmea_data_get_mod_count (priv->nmea);
+  if (priv->valid && (priv->mod_count == mod_count))
+    {
+      if (priv->dirty && (save || !hyscan_nmea_data_is_writable (priv->nmea)))
+        hyscan_nav_store_save (priv);
+
+      return TRUE;
+    }
+
+  if (!hyscan_nmea_data_get_range (priv->nmea, &first, &last))
+    return priv->valid;
+
+  /* Загружаем данные из кэша. */
+  if (!priv->valid)
+    hyscan_nav_store_load (priv);
+
+  /* Начало данных изменилось - разбираем канал заново. */
+  if (priv->valid && (priv->first != first))
+    hyscan_nav_store_reset (priv);
+
+  if (!priv->valid)
+    {
+      priv->first = first;
+      priv->next = first;
+      priv->valid = TRUE;
+      priv->dirty = TRUE;
+    }
+
+  for (index = priv->next; index <= last; index++)
+    {
+      HyScanNmeaSpan span;
+      const gchar *nmea;
+      guint32 length;
+      guint32 position = 0;
+      gint64 time;
+
+      nmea = hyscan_nmea_data_get_sentences (priv->nmea, index, &length, &time);
+      if (nmea == NULL)
+        break;
+
+      while (hyscan_nmea_data_next_sentence (nmea, length, &position, &span))
+        hyscan_nav_store_decode (priv, &span, hyscan_nmea_data_check_span (&span), time);
+
+      priv->next = index + 1;
+      priv->dirty = TRUE;
+    }
+
+  /* Счётчик запоминаем только если разобраны все записи. */
+  if (priv->next > last)
+    priv->mod_count = mod_count;
+
+  if (priv->dirty && (save || !hyscan_nmea_data_is_writable (priv->nmea)))
+    hyscan_nav_store_save (priv);
+
+  return TRUE;
+}
+
+static void
+hyscan_nav_store_set_cache (HyScanNavData *ndata,
+                            HyScanCache   *cache)
+{
+  HyScanNavStorePrivate *priv = HYSCAN_NAV_STORE (ndata)->priv;
+
+  g_clear_object (&priv->cache);
+  priv->cache = (cache != NULL) ? g_object_ref (cache) : NULL;
+
+  /* В новом кэше данные ещё не сохранены. */
+  priv->dirty = priv->valid;
+}
+
+static gboolean
+hyscan_nav_store_get (HyScanNavData *ndata,
+                      guint32        index,
+                      gint64        *time,
+                      gdouble       *value)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (ndata);
+  HyScanNavStorePrivate *priv = store->priv;
+  GArray *times = priv->times[priv->field];
+
+  if (!hyscan_nav_store_sync (store, FALSE) || (index >= times->len))
+    return FALSE;
+
+  (time != NULL) ? *time = g_array_index (times, gint64, index) : 0;
+  (value != NULL) ? *value = g_array_index (priv->values[priv->field], gdouble, index) : 0;
+
+  return TRUE;
+}
+
+static HyScanDBFindStatus
+hyscan_nav_store_find_data (HyScanNavData *ndata,
+                            gint64         time,
+                            guint32       *lindex,
+                            guint32       *rindex,
+                            gint64        *ltime,
+                            gint64        *rtime)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (ndata);
+  HyScanNavStorePrivate *priv = store->priv;
+  const gint64 *times;
+  guint32 n, l, r;
+
+  if (!hyscan_nav_store_sync (store, FALSE))
+    return HYSCAN_DB_FIND_FAIL;
+
+  times = (const gint64 *) priv->times[priv->field]->data;
+  n = priv->times[priv->field]->len;
+
+  if (n == 0)
+    return HYSCAN_DB_FIND_FAIL;
+
+  if (time < times[0])
+    {
+      (rindex != NULL) ? *rindex = 0 : 0;
+      (rtime != NULL) ? *rtime = times[0] : 0;
+      return HYSCAN_DB_FIND_LESS;
+    }
+
+  if (time > times[n - 1])
+    {
+      (lindex != NULL) ? *lindex = n - 1 : 0;
+      (ltime != NULL) ? *ltime = times[n - 1] : 0;
+      return HYSCAN_DB_FIND_GREATER;
+    }
+
+  l = hyscan_nav_store_search (times, n, time);
+  r = (times[l] == time) ? l : l + 1;
+
+  (lindex != NULL) ? *lindex = l : 0;
+  (rindex != NULL) ? *rindex = r : 0;
+  (ltime != NULL) ? *ltime = times[l] : 0;
+  (rtime != NULL) ? *rtime = times[r] : 0;
+
+  return HYSCAN_DB_FIND_OK;
+}
+
+static gboolean
+hyscan_nav_store_get_range (HyScanNavData *ndata,
+                            guint32       *first,
+                            guint32       *last)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (ndata);
+  HyScanNavStorePrivate *priv = store->priv;
+  guint32 n;
+
+  if (!hyscan_nav_store_sync (store, FALSE))
+    return FALSE;
+
+  n = priv->times[priv->field]->len;
+  if (n == 0)
+    return FALSE;
+
+  (first != NULL) ? *first = 0 : 0;
+  (last != NULL) ? *last = n - 1 : 0;
+
+  return TRUE;
+}
+
+static gboolean
+hyscan_nav_store_get_values (HyScanNavData *ndata,
+                             guint32        first,
+                             guint32        last,
+                             gint64        *times,
+                             gdouble       *values)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (ndata);
+  HyScanNavStorePrivate *priv = store->priv;
+  guint32 n = last - first + 1;
+
+  if ((first > last) || !hyscan_nav_store_sync (store, FALSE) || (last >= priv->times[priv->field]->len))
+    return FALSE;
+
+  if (times != NULL)
+    memcpy (times, &g_array_index (priv->times[priv->field], gint64, first), n * sizeof (gint64));
+  if (values != NULL)
+    memcpy (values, &g_array_index (priv->values[priv->field], gdouble, first), n * sizeof (gdouble));
+
+  return TRUE;
+}
+
+static guint
+hyscan_nav_store_get_at_times (HyScanNavData *ndata,
+                               const gint64  *times,
+                               guint          n_times,
+                               gdouble       *values)
+{
+  HyScanNavStore *store = HYSCAN_NAV_STORE (ndata);
+  HyScanNavStorePrivate *priv = store->priv;
+  const gint64 *column_times;
+  const gdouble *column_values;
+  gboolean angular;
+  guint32 n, l = 0;
+  guint n_found = 0;
+  guint i;
+
+  n = hyscan_nav_store_get_column (store, priv->field, &column_times, &column_values);
+
+  /* Угловые величины интерполируются по кратчайшей дуге, как в
+   * HyScanNavInterp с angular = TRUE. */
+  angular = (priv->field == HYSCAN_NAV_STORE_HEADING) || (priv->field == HYSCAN_NAV_STORE_TRACK);
+
+  for (i = 0; i < n_times; i++)
+    {
+      gint64 time = times[i];
+
+      if ((n == 0) || (time < column_times[0]) || (time > column_times[n - 1]))
+        {
+          values[i] = NAN;
+          continue;
+        }
+
+      /* Для упорядоченных по возрастанию моментов времени отрезок сдвигается
+       * вперёд на несколько элементов, в остальных случаях ищем заново. */
+      if ((time < column_times[l]) ||
+          ((l + MAX_LINEAR_STEP < n) && (column_times[l + MAX_LINEAR_STEP] <= time)))
+        {
+          l = hyscan_nav_store_search (column_times, n, time);
+        }
+      else
+        {
+          while ((l + 1 < n) && (column_times[l + 1] <= time))
+            l++;
+        }
+
+      if (column_times[l] == time)
+        {
+          values[i] = column_values[l];
+        }
+      else
+        {
+          gdouble delta = column_values[l + 1] - column_values[l];
+
+          if (angular)
+            delta -= 360.0 * floor (delta / 360.0 + 0.5);
+
+          values[i] = column_values[l] + delta *
+                      (gdouble) (time - column_times[l]) / (gdouble) (column_times[l + 1] - column_times[l]);
+
+          if (angular)
+            {
+              values[i] = fmod (values[i], 360.0);
+              if (values[i] < 0.0)
+                values[i] += 360.0;
+            }
+        }
+
+      n_found++;
+    }
+
+  return n_found;
+}
+
+static HyScanAntennaOffset
+hyscan_nav_store_get_offset (HyScanNavData *ndata)
+{
+  HyScanNavStorePrivate *priv = HYSCAN_NAV_STORE (ndata)->priv;
+  HyScanAntennaOffset zero = {0};
+
+  if (priv->nmea == NULL)
+    return zero;
+
+  return hyscan_nmea_data_get_offset (priv->nmea);
+}
+
+static gboolean
+hyscan_nav_store_is_writable (HyScanNavData *ndata)
+{
+  HyScanNavStorePrivate *priv = HYSCAN_NAV_STORE (ndata)->priv;
+
+  if (priv->nmea == NULL)
+    return FALSE;
+
+  return hyscan_nmea_data_is_writable (priv->nmea);
+}
+
+static const gchar *
+hyscan_nav_store_get_token (HyScanNavData *ndata)
+{
+  return HYSCAN_NAV_STORE (ndata)->priv->token;
+}
+
+static guint32
+hyscan_nav_store_get_mod_count (HyScanNavData *ndata)
+{
+  HyScanNavStorePrivate *priv = HYSCAN_NAV_STORE (ndata)->priv;
+
+  if (priv->nmea == NULL)
+    return 0;
+
+  return hyscan_nmea_data_get_mod_count (priv->nmea);
+}
+
+/**
+ * hyscan_nav_store_new:
+ * @db: указатель на #HyScanDB
+ * @project_name: название проекта
+ * @track_name: название галса
+ * @source_channel: индекс канала NMEA-данных
+ * @field: параметр для интерфейса #HyScanNavData
+ *
+ * Функция создаёт новый объект #HyScanNavStore. В канале данных должна быть
+ * хотя бы одна запись, иначе будет возвращён NULL.
+ *
+ * Returns: (nullable): указатель на объект #HyScanNavStore или NULL.
+ */
+HyScanNavStore *
+hyscan_nav_store_new (HyScanDB            *db,
+                      const gchar         *project_name,
+                      const gchar         *track_name,
+                      guint                source_channel,
+                      HyScanNavStoreField  field)
+{
+  HyScanNavStore *store;
+
+  store = g_object_new (HYSCAN_TYPE_NAV_STORE,
+                        "db", db,
+                        "project-name", project_name,
+                        "track-name", track_name,
+                        "source-channel", source_channel,
+                        "field", field,
+                        NULL);
+
+  if (store->priv->nmea == NULL)
+    g_clear_object (&store);
+
+  return store;
+}
+
+/**
+ * hyscan_nav_store_get_field:
+ * @store: указатель на #HyScanNavStore
+ *
+ * Функция возвращает параметр, значения которого возвращаются через
+ * интерфейс #HyScanNavData.
+ *
+ * Returns: навигационный параметр.
+ */
+HyScanNavStoreField
+hyscan_nav_store_get_field (HyScanNavStore *store)
+{
+  g_return_val_if_fail (HYSCAN_IS_NAV_STORE (store), HYSCAN_NAV_STORE_LAT);
+
+  return store->priv->field;
+}
+
+/**
+ * hyscan_nav_store_update:
+ * @store: указатель на #HyScanNavStore
+ *
+ * Функция разбирает записи, появившиеся в канале с момента предыдущего
+ * вызова, и сохраняет декодированные данные в кэше, если он задан. Если
+ * счётчик изменений канала не изменился, записи не разбираются. При
+ * обращении к данным записи разбираются автоматически, но в кэше данные
+ * сохраняются только после завершения записи в канал.
+ *
+ * Returns: %TRUE - если данные доступны, %FALSE - в случае ошибки.
+ */
+gboolean
+hyscan_nav_store_update (HyScanNavStore *store)
+{
+  g_return_val_if_fail (HYSCAN_IS_NAV_STORE (store), FALSE);
+
+  return hyscan_nav_store_sync (store, TRUE);
+}
+
+/**
+ * hyscan_nav_store_get_column:
+ * @store: указатель на #HyScanNavStore
+ * @field: навигационный параметр
+ * @times: (out) (nullable) (transfer none): метки времени значений
+ * @values: (out) (nullable) (transfer none): значения параметра
+ *
+ * Функция возвращает декодированные значения параметра в виде массивов
+ * меток времени и значений, упорядоченных по времени. Массивы принадлежат
+ * объекту и действительны до следующего обращения к нему.
+ *
+ * Returns: число значений.
+ */
+guint32
+hyscan_nav_store_get_column (HyScanNavStore        *store,
+                             HyScanNavStoreField    field,
+                             const gint64         **times,
+                             const gdouble        **values)
+{
+  HyScanNavStorePrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_NAV_STORE (store), 0);
+  g_return_val_if_fail (field < N_FIELDS, 0);
+  priv = store->priv;
+
+  if (!hyscan_nav_store_sync (store, FALSE))
+    return 0;
+
+  (times != NULL) ? *times = (const gint64 *) priv->times[field]->data : 0;
+  (values != NULL) ? *values = (const gdouble *) priv->values[field]->data : 0;
+
+  return priv->times[field]->len;
+}
+
+static void
+hyscan_nav_store_interface_init (HyScanNavDataInterface *iface)
+{
+  iface->set_cache = hyscan_nav_store_set_cache;
+  iface->get = hyscan_nav_store_get;
+  iface->find_data = hyscan_nav_store_find_data;
+  iface->get_range = hyscan_nav_store_get_range;
+  iface->get_offset = hyscan_nav_store_get_offset;
+  iface->is_writable = hyscan_nav_store_is_writable;
+  iface->get_token = hyscan_nav_store_get_token;
+  iface->get_mod_count = hyscan_nav_store_get_mod_count;
+  iface->get_values = hyscan_nav_store_get_values;
+  iface->get_at_times = hyscan_nav_store_get_at_times;
+}
@@ -0,0 +1,110 @@
+/* hyscan-nav-store.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_NAV_STORE_H__
+#define __HYSCAN_NAV_STORE_H__
+
+#include <hyscan-nav-data.h>
+
+G_BEGIN_DECLS
+
+/**
+ * HyScanNavStoreField:
+ * @HYSCAN_NAV_STORE_LAT: широта, градусы (RMC)
+ * @HYSCAN_NAV_STORE_LON: долгота, градусы (RMC)
+ * @HYSCAN_NAV_STORE_TRACK: путевой угол, градусы (RMC)
+ * @HYSCAN_NAV_STORE_SPEED: скорость, м/с (RMC)
+ * @HYSCAN_NAV_STORE_DEPTH: глубина, м (DPT)
+ * @HYSCAN_NAV_STORE_HEADING: курс, градусы (HDT)
+ *
+ * Навигационный параметр, извлекаемый из NMEA-сообщений.
+ */
+typedef enum
+{
+  HYSCAN_NAV_STORE_LAT,
+  HYSCAN_NAV_STORE_LON,
+  HYSCAN_NAV_STORE_TRACK,
+  HYSCAN_NAV_STORE_SPEED,
+  HYSCAN_NAV_STORE_DEPTH,
+  HYSCAN_NAV_STORE_HEADING
+} HyScanNavStoreField;
+
+#define HYSCAN_TYPE_NAV_STORE             (hyscan_nav_store_get_type ())
+#define HYSCAN_NAV_STORE(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_NAV_STORE, HyScanNavStore))
+#define HYSCAN_IS_NAV_STORE(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_NAV_STORE))
+#define HYSCAN_NAV_STORE_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_NAV_STORE, HyScanNavStoreClass))
+#define HYSCAN_IS_NAV_STORE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_NAV_STORE))
+#define HYSCAN_NAV_STORE_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_NAV_STORE, HyScanNavStoreClass))
+
+typedef struct _HyScanNavStore HyScanNavStore;
+typedef struct _HyScanNavStorePrivate HyScanNavStorePrivate;
+typedef struct _HyScanNavStoreClass HyScanNavStoreClass;
+
+struct _HyScanNavStore
+{
+  GObject parent_instance;
+
+  HyScanNavStorePrivate *priv;
+};
+
+struct _HyScanNavStoreClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                   hyscan_nav_store_get_type              (void);
+
+HYSCAN_API
+HyScanNavStore *        hyscan_nav_store_new                   (HyScanDB              *db,
+                                                                const gchar           *project_name,
+                                                                const gchar           *track_name,
+                                                                guint                  source_channel,
+                                                                HyScanNavStoreField    field);
+
+HYSCAN_API
+HyScanNavStoreField     hyscan_nav_store_get_field             (HyScanNavStore        *store);
+
+HYSCAN_API
+gboolean                hyscan_nav_store_update                (HyScanNavStore        *store);
+
+HYSCAN_API
+guint32                 hyscan_nav_store_get_column            (HyScanNavStore        *store,
+                                                                HyScanNavStoreField    field,
+                                                                const gint64         **times,
+                                                                const gdouble        **values);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_NAV_STORE_H__ */
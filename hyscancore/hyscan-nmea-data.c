@@ -45,6 +45,23 @@
  * класс вернет всю строку целиком. Для разбиения этой строки на отдельные
  * сообщения можно использовать функцию #hyscan_nmea_data_split_sentence,
  * которая вернет нуль-терминированный список строк.
+ *
+ * Для разбора больших объёмов данных без выделения памяти предназначены
+ * функции #hyscan_nmea_data_next_sentence и #hyscan_nmea_data_next_field.
+ * Они последовательно возвращают фрагменты #HyScanNmeaSpan, указывающие на
+ * сообщения и их поля внутри исходной строки. Строку вместе с её длиной
+ * можно получить функцией #hyscan_nmea_data_get_sentences.
+ *
+ * Для быстрого поиска сообщений определённого типа класс строит индекс:
+ * для каждого известного типа сообщений упорядоченный по времени список
+ * записей (метка времени, индекс в канале, смещение сообщения в записи).
+ * Индекс строится при первом обращении и дополняется по мере записи новых
+ * данных функцией #hyscan_nmea_data_index_type. Если задан кэш, индекс
+ * сохраняется в нём после завершения записи в канал или при вызове функции
+ * #hyscan_nmea_data_build_index и используется повторно другими объектами.
+ * Поиск сообщения по времени выполняется функцией #hyscan_nmea_data_find_type
+ * двоичным поиском без разбора строк, а само сообщение можно получить
+ * функцией #hyscan_nmea_data_get_type_sentence.
  */
 
 #include "hyscan-nmea-data.h"
@@ -53,6 +70,38 @@
 #include <string.h>
 
 #define CACHE_HEADER_MAGIC     0x3f0a4b87    /* Идентификатор заголовка кэша. */
+#define INDEX_HEADER_MAGIC     0x5c1e7d02    /* Идентификатор заголовка индекса в кэше. */
+#define N_INDEX_TYPES          8             /* Число индексируемых типов сообщений. */
+
+/* Хэш-функция типа сообщения "$XXabc": (a + 8 * c) mod 16. Для известных
+ * типов сообщений она даёт различные значения, поэтому тип определяется
+ * одним обращением к таблице и сравнением трёх символов. */
+#define NMEA_TYPE_HASH(type)   (((guchar)(type)[0] + 8 * (guchar)(type)[2]) & 15)
+
+/* Таблица известных типов сообщений, индексируемая NMEA_TYPE_HASH. */
+static const struct
+{
+  gchar                 name[4];
+  HyScanNmeaDataType    type;
+} hyscan_nmea_data_types[16] =
+{
+  { "",    HYSCAN_NMEA_DATA_ANY },              /*  0 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /*  1 */
+  { "ZDA", HYSCAN_NMEA_DATA_ZDA },              /*  2 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /*  3 */
+  { "DPT", HYSCAN_NMEA_DATA_DPT },              /*  4 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /*  5 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /*  6 */
+  { "GLL", HYSCAN_NMEA_DATA_GLL },              /*  7 */
+  { "HDT", HYSCAN_NMEA_DATA_HDT },              /*  8 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /*  9 */
+  { "RMC", HYSCAN_NMEA_DATA_RMC },              /* 10 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /* 11 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /* 12 */
+  { "",    HYSCAN_NMEA_DATA_ANY },              /* 13 */
+  { "VTG", HYSCAN_NMEA_DATA_VTG },              /* 14 */
+  { "GGA", HYSCAN_NMEA_DATA_GGA },              /* 15 */
+};
 
 enum
 {
@@ -63,6 +112,23 @@ enum
   PROP_SOURCE_CHANNEL,
 };
 
+/* Элемент индекса сообщений одного типа. */
+typedef struct
+{
+  gint64                time;           /* Метка времени записи. */
+  guint32               index;          /* Индекс записи в канале. */
+  guint32               offset;         /* Смещение сообщения в записи. */
+} HyScanNMEADataIndexEntry;
+
+/* Заголовок индекса в кэше. */
+typedef struct
+{
+  guint32               magic;          /* Идентификатор заголовка. */
+  guint32               first;          /* Первый индексированный индекс. */
+  guint32               next;           /* Следующий индексируемый индекс. */
+  guint32               counts[N_INDEX_TYPES]; /* Число элементов индекса каждого типа. */
+} HyScanNMEADataIndexHeader;
+
 /* Структруа заголовка кэша. */
 typedef struct
 {
@@ -92,6 +158,13 @@ struct _HyScanNMEADataPrivate
 
   HyScanBuffer         *nmea_buffer;    /* Буфер данных. */
 
+  GArray               *index[N_INDEX_TYPES]; /* Индексы сообщений по типам. */
+  gboolean              index_valid;    /* Признак наличия индекса. */
+  gboolean              index_dirty;    /* Признак отличия индекса от сохранённого в кэше. */
+  guint32               index_mod_count;/* Номер изменения канала при обновлении индекса. */
+  guint32               index_first;    /* Первый индексированный индекс. */
+  guint32               index_next;     /* Следующий индексируемый индекс. */
+  HyScanBuffer         *index_buffer;   /* Буфер для построения индекса. */
 };
 
 static void      hyscan_nmea_data_set_property          (GObject               *object,
@@ -107,6 +180,13 @@ static gboolean  hyscan_nmea_data_check_cache           (HyScanNMEADataPrivate *
                                                          guint32                index,
                                                          gint64                *time);
 
+static gint      hyscan_nmea_data_type_slot             (HyScanNmeaDataType     type);
+static void      hyscan_nmea_data_index_reset           (HyScanNMEADataPrivate *priv);
+static gboolean  hyscan_nmea_data_index_load            (HyScanNMEADataPrivate *priv);
+static void      hyscan_nmea_data_index_save            (HyScanNMEADataPrivate *priv);
+static gboolean  hyscan_nmea_data_index_update          (HyScanNMEADataPrivate *priv,
+                                                         gboolean               save);
+
 G_DEFINE_TYPE_WITH_PRIVATE (HyScanNMEAData, hyscan_nmea_data, G_TYPE_OBJECT);
 
 static void
@@ -189,11 +269,16 @@ hyscan_nmea_data_object_constructed (GObject *object)
 
   gchar *db_uri = NULL;
   gboolean status = FALSE;
+  guint i;
 
   priv->channel_id = -1;
 
   priv->cache_buffer = hyscan_buffer_new ();
   priv->nmea_buffer = hyscan_buffer_new ();
+  priv->index_buffer = hyscan_buffer_new ();
+
+  for (i = 0; i < N_INDEX_TYPES; i++)
+    priv->index[i] = g_array_new (FALSE, FALSE, sizeof (HyScanNMEADataIndexEntry));
 
   channel_name = hyscan_channel_get_id_by_types (HYSCAN_SOURCE_NMEA,
                                                  HYSCAN_CHANNEL_DATA,
@@ -285,6 +370,7 @@ hyscan_nmea_data_object_finalize (GObject *object)
 {
   HyScanNMEAData *data = HYSCAN_NMEA_DATA (object);
   HyScanNMEADataPrivate *priv = data->priv;
+  guint i;
 
   priv->channel_id > 0 ? hyscan_db_close (priv->db, priv->channel_id) : 0;
 
@@ -296,6 +382,10 @@ hyscan_nmea_data_object_finalize (GObject *object)
 
   g_object_unref (priv->cache_buffer);
   g_object_unref (priv->nmea_buffer);
+  g_object_unref (priv->index_buffer);
+
+  for (i = 0; i < N_INDEX_TYPES; i++)
+    g_array_unref (priv->index[i]);
 
   g_clear_object (&priv->db);
   g_clear_object (&priv->cache);
@@ -354,6 +444,210 @@ hyscan_nmea_data_check_cache (HyScanNMEADataPrivate *priv,
   return TRUE;
 }
 
+/* Функция возвращает номер индекса для типа сообщений или -1. */
+static gint
+hyscan_nmea_data_type_slot (HyScanNmeaDataType type)
+{
+  gint slot;
+
+  /* Индексируются только конкретные типы сообщений. */
+  if ((type <= HYSCAN_NMEA_DATA_ANY) || ((type & (type - 1)) != 0))
+    return -1;
+
+  slot = g_bit_nth_lsf (type, -1);
+
+  return (slot < N_INDEX_TYPES) ? slot : -1;
+}
+
+/* Функция очищает индекс сообщений. */
+static void
+hyscan_nmea_data_index_reset (HyScanNMEADataPrivate *priv)
+{
+  guint i;
+
+  for (i = 0; i < N_INDEX_TYPES; i++)
+    g_array_set_size (priv->index[i], 0);
+
+  priv->index_valid = FALSE;
+  priv->index_dirty = FALSE;
+  priv->index_first = 0;
+  priv->index_next = 0;
+}
+
+/* Функция загружает индекс сообщений из кэша. */
+static gboolean
+hyscan_nmea_data_index_load (HyScanNMEADataPrivate *priv)
+{
+  HyScanNMEADataIndexHeader header;
+  const HyScanNMEADataIndexEntry *entries;
+  guint32 n_entries = 0;
+  guint32 size;
+  gchar *key;
+  guint i;
+
+  if (priv->cache == NULL)
+    return FALSE;
+
+  key = g_strdup_printf ("NMEA.%s.INDEX", priv->path);
+
+  hyscan_buffer_wrap (priv->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+  if (!hyscan_cache_get2 (priv->cache, key, NULL, sizeof (header), priv->cache_buffer, priv->index_buffer))
+    {
+      g_free (key);
+      return FALSE;
+    }
+
+  g_free (key);
+
+  /* Верификация данных. */
+  for (i = 0; i < N_INDEX_TYPES; i++)
+    n_entries += header.counts[i];
+
+  entries = hyscan_buffer_get (priv->index_buffer, NULL, &size);
+  if ((header.magic != INDEX_HEADER_MAGIC) ||
+      (size != n_entries * sizeof (HyScanNMEADataIndexEntry)))
+    {
+      return FALSE;
+    }
+
+  for (i = 0; i < N_INDEX_TYPES; i++)
+    {
+      g_array_set_size (priv->index[i], 0);
+      g_array_append_vals (priv->index[i], entries, header.counts[i]);
+      entries += header.counts[i];
+    }
+
+  priv->index_first = header.first;
+  priv->index_next = header.next;
+  priv->index_valid = TRUE;
+  priv->index_dirty = FALSE;
+
+  return TRUE;
+}
+
+/* Функция сохраняет индекс сообщений в кэше. */
+static void
+hyscan_nmea_data_index_save (HyScanNMEADataPrivate *priv)
+{
+  HyScanNMEADataIndexHeader header;
+  gchar *key;
+  guint i;
+
+  if (priv->cache == NULL)
+    return;
+
+  header.magic = INDEX_HEADER_MAGIC;
+  header.first = priv->index_first;
+  header.next = priv->index_next;
+
+  hyscan_buffer_set_data_size (priv->index_buffer, 0);
+  for (i = 0; i < N_INDEX_TYPES; i++)
+    {
+      guint32 size = priv->index[i]->len * sizeof (HyScanNMEADataIndexEntry);
+      guint32 offset = hyscan_buffer_get_data_size (priv->index_buffer);
+      guint32 total;
+      gchar *data;
+
+      header.counts[i] = priv->index[i]->len;
+      if (size == 0)
+        continue;
+
+      hyscan_buffer_set_data_size (priv->index_buffer, offset + size);
+      data = hyscan_buffer_get (priv->index_buffer, NULL, &total);
+      memcpy (data + offset, priv->index[i]->data, size);
+    }
+
+  key = g_strdup_printf ("NMEA.%s.INDEX", priv->path);
+  hyscan_buffer_wrap (priv->cache_buffer, HYSCAN_DATA_BLOB, &header, sizeof (header));
+  hyscan_cache_set2 (priv->cache, key, NULL, priv->cache_buffer, priv->index_buffer);
+  g_free (key);
+
+  priv->index_dirty = FALSE;
+}
+
+/* Функция дополняет индекс сообщений записями, появившимися с момента
+ * предыдущего вызова. Новые элементы добавляются в конец индекса. Индекс
+ * сохраняется в кэше после завершения записи в канал или, если задан
+ * признак save, после каждого обновления. */
+static gboolean
+hyscan_nmea_data_index_update (HyScanNMEADataPrivate *priv,
+                               gboolean               save)
+{
+  guint32 mod_count;
+  guint32 first, last;
+  guint32 index;
+
+  /* Данные в канале не изменились. */
+  mod_count = hyscan_db_get_mod_count (priv->db, priv->channel_id);
+  if (priv->index_valid && (priv->index_mod_count == mod_count))
+    {
+      if (priv->index_dirty && (save || !hyscan_db_channel_is_writable (priv->db, priv->channel_id)))
+        hyscan_nmea_data_index_save (priv);
+
+      return TRUE;
+    }
+
+  if (!hyscan_db_channel_get_data_range (priv->db, priv->channel_id, &first, &last))
+    return FALSE;
+
+  /* Загружаем индекс из кэша. */
+  if (!priv->index_valid)
+    hyscan_nmea_data_index_load (priv);
+
+  /* Начало данных изменилось - строим индекс заново. */
+  if (priv->index_valid && (priv->index_first != first))
+    hyscan_nmea_data_index_reset (priv);
+
+  if (!priv->index_valid)
+    {
+      priv->index_first = first;
+      priv->index_next = first;
+      priv->index_valid = TRUE;
+      priv->index_dirty = TRUE;
+    }
+
+  for (index = priv->index_next; index <= last; index++)
+    {
+      HyScanNmeaSpan span;
+      const gchar *nmea;
+      guint32 length;
+      guint32 position = 0;
+      gint64 time;
+
+      if (!hyscan_db_channel_get_data (priv->db, priv->channel_id, index, priv->index_buffer, &time))
+        break;
+
+      nmea = hyscan_buffer_get (priv->index_buffer, NULL, &length);
+
+      while (hyscan_nmea_data_next_sentence (nmea, length, &position, &span))
+        {
+          HyScanNMEADataIndexEntry entry;
+          gint slot;
+
+          slot = hyscan_nmea_data_type_slot (hyscan_nmea_data_check_span (&span));
+          if (slot < 0)
+            continue;
+
+          entry.time = time;
+          entry.index = index;
+          entry.offset = span.data - nmea;
+          g_array_append_val (priv->index[slot], entry);
+        }
+
+      priv->index_next = index + 1;
+      priv->index_dirty = TRUE;
+    }
+
+  /* Индекс построен по всем данным канала. */
+  if (priv->index_next > last)
+    priv->index_mod_count = mod_count;
+
+  if (priv->index_dirty && (save || !hyscan_db_channel_is_writable (priv->db, priv->channel_id)))
+    hyscan_nmea_data_index_save (priv);
+
+  return TRUE;
+}
+
 /**
  * hyscan_nmea_data_new:
  * @db: указатель на #HyScanDB
@@ -488,6 +782,9 @@ hyscan_nmea_data_set_cache (HyScanNMEAData *data,
   g_clear_object (&data->priv->cache);
   if (cache != NULL)
     data->priv->cache = g_object_ref (cache);
+
+  /* Индекс в новом кэше ещё не сохранён. */
+  data->priv->index_dirty = data->priv->index_valid;
 }
 
 /**
@@ -638,6 +935,32 @@ const gchar*
 hyscan_nmea_data_get_sentence (HyScanNMEAData *data,
                                guint32         index,
                                gint64         *time)
+{
+  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), FALSE);
+
+  return hyscan_nmea_data_get_sentences (data, index, NULL, time);
+}
+
+/**
+ * hyscan_nmea_data_get_sentences:
+ * @data: указатель на #HyScanNMEAData
+ * @index: индекс считываемых данных
+ * @length: (out) (nullable): длина строки без завершающего нуля
+ * @time: (out) (nullable): указатель на переменную для сохранения метки времени считанных данных
+ *
+ * Функция аналогична #hyscan_nmea_data_get_sentence, но дополнительно
+ * возвращает длину строки. Строка может содержать несколько сообщений,
+ * разделённых произвольными символами, в том числе нулевыми, поэтому для
+ * её разбора функцией #hyscan_nmea_data_next_sentence следует использовать
+ * возвращаемую длину.
+ *
+ * Returns: (transfer none): указатель на константную нуль-терминированную строку.
+ */
+const gchar *
+hyscan_nmea_data_get_sentences (HyScanNMEAData *data,
+                                guint32         index,
+                                guint32        *length,
+                                gint64         *time)
 {
   HyScanNMEADataPrivate *priv;
 
@@ -645,14 +968,19 @@ hyscan_nmea_data_get_sentence (HyScanNMEAData *data,
   guint32 size;
   gchar *nmea;
 
-  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), FALSE);
+  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), NULL);
   priv = data->priv;
 
   if (priv->channel_id <= 0)
     return NULL;
 
   if (hyscan_nmea_data_check_cache (priv, index, time))
-    return hyscan_buffer_get (priv->nmea_buffer, NULL, &size);
+    {
+      nmea = hyscan_buffer_get (priv->nmea_buffer, NULL, &size);
+      (length != NULL) ? *length = size - 1 : 0;
+
+      return nmea;
+    }
 
   /* Считываем всю строку во внутренний буфер. */
   if (!hyscan_db_channel_get_data (priv->db, priv->channel_id, index, priv->nmea_buffer, &nmea_time))
@@ -677,11 +1005,197 @@ hyscan_nmea_data_get_sentence (HyScanNMEAData *data,
       hyscan_cache_set2 (priv->cache, priv->key, NULL, priv->cache_buffer, priv->nmea_buffer);
     }
 
+  (length != NULL) ? *length = size - 1 : 0;
   (time != NULL) ? *time = nmea_time : 0;
 
   return nmea;
 }
 
+/**
+ * hyscan_nmea_data_index_type:
+ * @data: указатель на #HyScanNMEAData
+ * @type: тип сообщений
+ *
+ * Функция дополняет индекс сообщений новыми данными и возвращает число
+ * сообщений указанного типа. Индексируются сообщения с верной контрольной
+ * суммой конкретных типов: RMC, GGA, DPT, HDT, VTG, ZDA и GLL.
+ *
+ * Returns: число сообщений указанного типа.
+ */
+guint32
+hyscan_nmea_data_index_type (HyScanNMEAData     *data,
+                             HyScanNmeaDataType  type)
+{
+  HyScanNMEADataPrivate *priv;
+  gint slot;
+
+  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), 0);
+
+  priv = data->priv;
+
+  slot = hyscan_nmea_data_type_slot (type);
+  if ((priv->channel_id <= 0) || (slot < 0))
+    return 0;
+
+  hyscan_nmea_data_index_update (priv, FALSE);
+
+  return priv->index[slot]->len;
+}
+
+/**
+ * hyscan_nmea_data_build_index:
+ * @data: указатель на #HyScanNMEAData
+ *
+ * Функция строит индекс сообщений по всем записанным в канал данным и
+ * сохраняет его в кэше, если он задан. Без вызова этой функции индекс
+ * сохраняется в кэше только после завершения записи в канал.
+ *
+ * Returns: %TRUE - если индекс построен, %FALSE - в случае ошибки.
+ */
+gboolean
+hyscan_nmea_data_build_index (HyScanNMEAData *data)
+{
+  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), FALSE);
+
+  if (data->priv->channel_id <= 0)
+    return FALSE;
+
+  return hyscan_nmea_data_index_update (data->priv, TRUE);
+}
+
+/**
+ * hyscan_nmea_data_find_type:
+ * @data: указатель на #HyScanNMEAData
+ * @type: тип сообщений
+ * @time: искомый момент времени
+ * @lentry: (out) (nullable): "левый" номер сообщения
+ * @rentry: (out) (nullable): "правый" номер сообщения
+ * @ltime: (out) (nullable): "левая" метка времени
+ * @rtime: (out) (nullable): "правая" метка времени
+ *
+ * Функция ищет сообщения указанного типа, ближайшие к моменту времени
+ * @time. Поиск выполняется двоичным поиском по индексу сообщений. Номера
+ * сообщений соответствуют номерам в индексе от 0 до значения, возвращаемого
+ * функцией #hyscan_nmea_data_index_type.
+ *
+ * Returns: статус поиска #HyScanDBFindStatus.
+ */
+HyScanDBFindStatus
+hyscan_nmea_data_find_type (HyScanNMEAData     *data,
+                            HyScanNmeaDataType  type,
+                            gint64              time,
+                            guint32            *lentry,
+                            guint32            *rentry,
+                            gint64             *ltime,
+                            gint64             *rtime)
+{
+  HyScanNMEADataPrivate *priv;
+  const HyScanNMEADataIndexEntry *entries;
+  guint32 n_entries;
+  guint32 left, right;
+  gint slot;
+
+  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), HYSCAN_DB_FIND_FAIL);
+
+  priv = data->priv;
+
+  slot = hyscan_nmea_data_type_slot (type);
+  if ((priv->channel_id <= 0) || (slot < 0))
+    return HYSCAN_DB_FIND_FAIL;
+
+  hyscan_nmea_data_index_update (priv, FALSE);
+
+  entries = (const HyScanNMEADataIndexEntry *) priv->index[slot]->data;
+  n_entries = priv->index[slot]->len;
+  if (n_entries == 0)
+    return HYSCAN_DB_FIND_FAIL;
+
+  if (time < entries[0].time)
+    return HYSCAN_DB_FIND_LESS;
+  if (time > entries[n_entries - 1].time)
+    return HYSCAN_DB_FIND_GREATER;
+
+  /* Двоичный поиск: entries[left].time <= time <= entries[right].time. */
+  left = 0;
+  right = n_entries - 1;
+  while (right - left > 1)
+    {
+      guint32 middle = left + (right - left) / 2;
+
+      if (entries[middle].time <= time)
+        left = middle;
+      else
+        right = middle;
+    }
+
+  /* Точное совпадение. */
+  if (entries[left].time == time)
+    right = left;
+  else if (entries[right].time == time)
+    left = right;
+
+  (lentry != NULL) ? *lentry = left : 0;
+  (rentry != NULL) ? *rentry = right : 0;
+  (ltime != NULL) ? *ltime = entries[left].time : 0;
+  (rtime != NULL) ? *rtime = entries[right].time : 0;
+
+  return HYSCAN_DB_FIND_OK;
+}
+
+/**
+ * hyscan_nmea_data_get_type_sentence:
+ * @data: указатель на #HyScanNMEAData
+ * @type: тип сообщений
+ * @entry: номер сообщения в индексе
+ * @length: (out) (nullable): длина сообщения
+ * @time: (out) (nullable): метка времени сообщения
+ *
+ * Функция возвращает сообщение указанного типа по его номеру в индексе.
+ * Возвращаемый указатель указывает на сообщение внутри записи канала,
+ * полученной функцией #hyscan_nmea_data_get_sentences, поэтому сообщение
+ * не нуль-терминировано и его длину следует брать из @length.
+ *
+ * Returns: (transfer none): указатель на сообщение или NULL.
+ */
+const gchar *
+hyscan_nmea_data_get_type_sentence (HyScanNMEAData     *data,
+                                    HyScanNmeaDataType  type,
+                                    guint32             entry,
+                                    guint32            *length,
+                                    gint64             *time)
+{
+  HyScanNMEADataPrivate *priv;
+  HyScanNMEADataIndexEntry *index_entry;
+  HyScanNmeaSpan span;
+  const gchar *nmea;
+  guint32 nmea_length;
+  guint32 position;
+  gint slot;
+
+  g_return_val_if_fail (HYSCAN_IS_NMEA_DATA (data), NULL);
+
+  priv = data->priv;
+
+  slot = hyscan_nmea_data_type_slot (type);
+  if ((priv->channel_id <= 0) || (slot < 0) || (entry >= priv->index[slot]->len))
+    return NULL;
+
+  index_entry = &g_array_index (priv->index[slot], HyScanNMEADataIndexEntry, entry);
+
+  nmea = hyscan_nmea_data_get_sentences (data, index_entry->index, &nmea_length, NULL);
+  if (nmea == NULL)
+    return NULL;
+
+  position = index_entry->offset;
+  if (!hyscan_nmea_data_next_sentence (nmea, nmea_length, &position, &span))
+    return NULL;
+
+  (length != NULL) ? *length = span.length : 0;
+  (time != NULL) ? *time = index_entry->time : 0;
+
+  return span.data;
+}
+
 /**
  * hyscan_nmea_data_get_mod_count:
  * @data: указатель на #HyScanNMEAData
@@ -708,60 +1222,157 @@ hyscan_nmea_data_get_mod_count (HyScanNMEAData *data)
  * @sentence: указатель на строку
  *
  * Функция верифицирует NMEA-строку: проверяет контрольную сумму и тип строки.
- * Если тип сообщения совпадает с DPT, RMC или GGA, будут возвращены
- * соответственно HYSCAN_SOURCE_NMEA_DPT, HYSCAN_SOURCE_NMEA_GGA,
- * HYSCAN_SOURCE_NMEA_RMC. Если тип сообщения не соотвествует перечисленным
- * выше, но при этом контрольная сумма совпала, будет возвращено
- * HYSCAN_SOURCE_NMEA_ANY. Если контрольная сумма не совпала, будет возвращено
- * HYSCAN_SOURCE_INVALID.
+ * Если тип сообщения совпадает с DPT, RMC, GGA, HDT, VTG, ZDA или GLL, будет
+ * возвращён соответствующий тип, например %HYSCAN_NMEA_DATA_DPT. Если тип
+ * сообщения не соответствует перечисленным выше, но при этом контрольная
+ * сумма совпала, будет возвращено %HYSCAN_NMEA_DATA_ANY. Если контрольная
+ * сумма не совпала, будет возвращено %HYSCAN_NMEA_DATA_INVALID.
  *
  * Returns: тип строки.
  */
 HyScanNmeaDataType
 hyscan_nmea_data_check_sentence (const gchar *sentence)
 {
-  const gchar *ch = sentence;
-  gint checksum = 0;
-  gint parsed = 0;
-  gsize len = strlen (ch);
+  HyScanNmeaSpan span;
 
   if (sentence == NULL)
     return HYSCAN_NMEA_DATA_INVALID;
+
+  span.data = sentence;
+  span.length = strlen (sentence);
+
+  return hyscan_nmea_data_check_span (&span);
+}
+
+/* Функция вычисляет XOR всех байт блока. Основной объём данных
+ * обрабатывается машинными словами, после чего результат сворачивается
+ * до одного байта. */
+static guint8
+hyscan_nmea_data_xor (const gchar *data,
+                      gsize        length)
+{
+  guint64 acc = 0;
+  guint8 checksum;
+  gsize i;
+
+  for (i = 0; i + sizeof (acc) <= length; i += sizeof (acc))
+    {
+      guint64 word;
+
+      memcpy (&word, data + i, sizeof (word));
+      acc ^= word;
+    }
+
+  acc ^= acc >> 32;
+  acc ^= acc >> 16;
+  acc ^= acc >> 8;
+  checksum = acc & 0xff;
+
+  for (; i < length; i++)
+    checksum ^= (guint8) data[i];
+
+  return checksum;
+}
+
+/**
+ * hyscan_nmea_data_check_span:
+ * @sentence: фрагмент с NMEA-сообщением
+ *
+ * Функция аналогична #hyscan_nmea_data_check_sentence, но проверяет
+ * сообщение, заданное фрагментом #HyScanNmeaSpan, например полученным
+ * функцией #hyscan_nmea_data_next_sentence.
+ *
+ * Returns: тип строки.
+ */
+HyScanNmeaDataType
+hyscan_nmea_data_check_span (const HyScanNmeaSpan *sentence)
+{
+  const gchar *data;
+  const gchar *star;
+  guint32 length;
+  gint parsed_hi, parsed_lo;
+  guint hash;
+
+  g_return_val_if_fail (sentence != NULL, HYSCAN_NMEA_DATA_INVALID);
+
+  data = sentence->data;
+  length = sentence->length;
+
   /* Контрольная сумма считается как XOR всех элементов между $ и *.
    * В самой строке контрольная сумма располагается после символа *
    */
-  if (*ch != '$')
+  if ((data == NULL) || (length < 1) || (data[0] != '$'))
     return HYSCAN_NMEA_DATA_INVALID;
 
-  /* Подсчитываем контрольную сумму. */
-  for (ch = sentence + 1, len--; *ch != '*' && len > 0; ch++, len--)
-    checksum ^= *ch;
-
-  /* Если количество оставшихся меньше длины контрольной суммы, строка не валидна. */
-  if (len < strlen("*xx"))
+  /* Если после символа * меньше двух символов, строка не валидна. */
+  star = memchr (data + 1, '*', length - 1);
+  if ((star == NULL) || (star + 2 >= data + length))
     return HYSCAN_NMEA_DATA_INVALID;
 
-  /* Считываем контрольную сумму из строки. */
-  parsed = g_ascii_xdigit_value (*++ch) * 16; /*< Первый. */
-  parsed += g_ascii_xdigit_value (*++ch);     /*< Второй. */
-
-  /* Если контрольная сумма не совпала, строка не валидна. */
-  if (parsed != checksum)
-    return HYSCAN_NMEA_DATA_INVALID;
+  /* Считываем и сверяем контрольную сумму. */
+  parsed_hi = g_ascii_xdigit_value (star[1]);
+  parsed_lo = g_ascii_xdigit_value (star[2]);
+  if ((parsed_hi < 0) || (parsed_lo < 0) ||
+      ((parsed_hi * 16 + parsed_lo) != hyscan_nmea_data_xor (data + 1, star - data - 1)))
+    {
+      return HYSCAN_NMEA_DATA_INVALID;
+    }
 
   /* Определяем тип строки. Пропускаем первые 3 символа "$XXyyy". */
-  ch = sentence + 3;
+  if (star - data < 6)
+    return HYSCAN_NMEA_DATA_ANY;
 
-  if (g_str_has_prefix (ch, "DPT"))
-    return HYSCAN_NMEA_DATA_DPT;
-  if (g_str_has_prefix (ch, "GGA"))
-    return HYSCAN_NMEA_DATA_GGA;
-  if (g_str_has_prefix (ch, "RMC"))
-    return HYSCAN_NMEA_DATA_RMC;
+  hash = NMEA_TYPE_HASH (data + 3);
+  if (memcmp (hyscan_nmea_data_types[hash].name, data + 3, 3) == 0)
+    return hyscan_nmea_data_types[hash].type;
 
   return HYSCAN_NMEA_DATA_ANY;
 }
 
+/**
+ * hyscan_nmea_data_check_sentences:
+ * @data: указатель на строку с несколькими NMEA-сообщениями
+ * @length: длина строки
+ * @position: (inout): позиция начала поиска в строке
+ * @sentences: (out) (array length=n_sentences): массив для найденных сообщений
+ * @types: (out) (array length=n_sentences): массив для типов сообщений
+ * @n_sentences: размер массивов
+ *
+ * Функция находит в строке до @n_sentences сообщений, начиная с позиции
+ * @position, и проверяет каждое из них. Для каждого сообщения возвращается
+ * фрагмент строки и тип, определяемый так же, как в
+ * #hyscan_nmea_data_check_sentence. Сообщения с неверной контрольной суммой
+ * имеют тип %HYSCAN_NMEA_DATA_INVALID. После вызова @position указывает на
+ * символ, следующий за последним найденным сообщением, что позволяет
+ * обработать строку произвольной длины массивами фиксированного размера.
+ * Функция не выделяет память.
+ *
+ * Returns: число найденных сообщений.
+ */
+guint
+hyscan_nmea_data_check_sentences (const gchar        *data,
+                                  guint32             length,
+                                  guint32            *position,
+                                  HyScanNmeaSpan     *sentences,
+                                  HyScanNmeaDataType *types,
+                                  guint               n_sentences)
+{
+  guint i;
+
+  g_return_val_if_fail (position != NULL, 0);
+  g_return_val_if_fail (sentences != NULL && types != NULL, 0);
+
+  for (i = 0; i < n_sentences; i++)
+    {
+      if (!hyscan_nmea_data_next_sentence (data, length, position, &sentences[i]))
+        break;
+
+      types[i] = hyscan_nmea_data_check_span (&sentences[i]);
+    }
+
+  return i;
+}
+
 /**
  * hyscan_nmea_data_split_sentence:
  * @sentence: указатель на строку
@@ -781,8 +1392,9 @@ gchar**
 hyscan_nmea_data_split_sentence (const gchar *sentence,
                                  guint32      length)
 {
+  HyScanNmeaSpan span;
   guint num = 0;
-  guint32 i, j, k;
+  guint32 i, k;
   gchar **output = NULL;
 
   if (sentence == NULL)
@@ -809,37 +1421,131 @@ hyscan_nmea_data_split_sentence (const gchar *sentence,
   output = g_malloc0 ((num + 1) * sizeof (gchar*));
 
   /* Начинаем вычленять подстроки. */
-  k = 0;
-  for (i = 0; i < length; i++)
+  for (i = 0, k = 0; hyscan_nmea_data_next_sentence (sentence, length, &i, &span); k++)
+    output[k] = g_strndup (span.data, span.length);
+
+  return output;
+}
+
+/**
+ * hyscan_nmea_data_next_sentence:
+ * @sentence: указатель на строку
+ * @length: длина строки
+ * @position: (inout): позиция начала поиска в строке
+ * @span: (out): фрагмент с найденным сообщением
+ *
+ * Функция ищет очередное NMEA-сообщение в строке, начиная с позиции
+ * @position, и возвращает указатель на него и его длину. Сообщение
+ * начинается символом '$' и заканчивается контрольной суммой "*xx". Если
+ * контрольная сумма не найдена до начала следующего сообщения, фрагмент
+ * обрезанного сообщения заканчивается перед символом '$' следующего. После
+ * вызова @position указывает на символ, следующий за сообщением. Перед
+ * первым вызовом @position должна быть равна нулю.
+ *
+ * Функция не выделяет память и не копирует данные, поэтому может
+ * использоваться для разбора больших объёмов данных:
+ *
+ * |[<!-- language="C" -->
+ * guint32 position = 0;
+ * HyScanNmeaSpan span;
+ *
+ * while (hyscan_nmea_data_next_sentence (data, length, &position, &span))
+ *   process (span.data, span.length);
+ * ]|
+ *
+ * Returns: %TRUE - если сообщение найдено, %FALSE - если сообщений больше нет.
+ */
+gboolean
+hyscan_nmea_data_next_sentence (const gchar    *sentence,
+                                guint32         length,
+                                guint32        *position,
+                                HyScanNmeaSpan *span)
+{
+  const gchar *begin;
+  const gchar *limit;
+  const gchar *end;
+
+  g_return_val_if_fail (position != NULL && span != NULL, FALSE);
+
+  if ((sentence == NULL) || (*position >= length))
+    return FALSE;
+
+  /* Ищем вхождение знака '$'. */
+  begin = memchr (sentence + *position, '$', length - *position);
+  if (begin == NULL)
     {
-      guint32 size;
+      *position = length;
+      return FALSE;
+    }
 
-      /* Ищем вхождение знака '$'. */
-      if (sentence[i] != '$')
-        continue;
+  /* Сообщение не может продолжаться после начала следующего. */
+  limit = memchr (begin + 1, '$', sentence + length - (begin + 1));
+  if (limit == NULL)
+    limit = sentence + length;
 
-      /* Ищем конец текущей подстроки. */
-      for (j = i + 1; j < length; j++)
-        {
-          if (sentence[j] == '*')
-            {
-              /* Накидываем ещё 2 символа. */
-              j += 2;
-              break;
-            }
-        }
+  /* Ищем конец сообщения и добавляем 2 символа контрольной суммы. */
+  end = memchr (begin + 1, '*', limit - (begin + 1));
+  if ((end == NULL) || (end + 2 >= limit))
+    end = limit - 1;
+  else
+    end += 2;
 
-      if (G_UNLIKELY (j >= length))
-        j = length - 1;
+  span->data = begin;
+  span->length = end - begin + 1;
+  *position = end - sentence + 1;
 
-      size = j - i + 1;
+  return TRUE;
+}
+
+/**
+ * hyscan_nmea_data_next_field:
+ * @sentence: фрагмент с NMEA-сообщением
+ * @position: (inout): позиция начала поля в сообщении
+ * @field: (out): фрагмент с найденным полем
+ *
+ * Функция возвращает очередное поле NMEA-сообщения. Поля разделяются
+ * запятыми, первое поле - адрес сообщения без символа '$' (например,
+ * "GPRMC"), последнее поле заканчивается перед символом '*'. Перед первым
+ * вызовом @position должна быть равна нулю. Функция не выделяет память.
+ *
+ * Returns: %TRUE - если поле найдено, %FALSE - если полей больше нет.
+ */
+gboolean
+hyscan_nmea_data_next_field (const HyScanNmeaSpan *sentence,
+                             guint32              *position,
+                             HyScanNmeaSpan       *field)
+{
+  const gchar *data;
+  guint32 length;
+  guint32 i;
+
+  g_return_val_if_fail (sentence != NULL && position != NULL && field != NULL, FALSE);
 
-      /* Выделяем память, не забывая про \0. */
-      output[k] = g_malloc0 ((size + 1) * sizeof (gchar));
-      /* Копируем. */
-      memcpy (output[k], sentence + i, size * sizeof (gchar));
-      k++;
+  data = sentence->data;
+  length = sentence->length;
+
+  /* Пропускаем символ начала сообщения. */
+  if ((*position == 0) && (length > 0) && (data[0] == '$'))
+    *position = 1;
+
+  if (*position > length)
+    return FALSE;
+
+  /* Ищем конец поля. */
+  for (i = *position; i < length; i++)
+    {
+      if ((data[i] == ',') || (data[i] == '*'))
+        break;
     }
 
-  return output;
+  field->data = data + *position;
+  field->length = i - *position;
+
+  /* После последнего поля следующих полей нет. */
+  if ((i < length) && (data[i] == ','))
+    *position = i + 1;
+  else
+    *position = length + 1;
+
+  return TRUE;
 }
@@ -70,6 +70,10 @@ struct _HyScanNMEADataClass
  * @HYSCAN_NMEA_DATA_RMC: строка NMEA RMC
  * @HYSCAN_NMEA_DATA_GGA: строка NMEA GGA
  * @HYSCAN_NMEA_DATA_DPT: строка NMEA DPT
+ * @HYSCAN_NMEA_DATA_HDT: строка NMEA HDT
+ * @HYSCAN_NMEA_DATA_VTG: строка NMEA VTG
+ * @HYSCAN_NMEA_DATA_ZDA: строка NMEA ZDA
+ * @HYSCAN_NMEA_DATA_GLL: строка NMEA GLL
  *
  * Тип NMEA-0183 строки.
  */
@@ -79,9 +83,27 @@ typedef enum
   HYSCAN_NMEA_DATA_ANY       = 1,
   HYSCAN_NMEA_DATA_RMC       = 1 << 1,
   HYSCAN_NMEA_DATA_GGA       = 1 << 2,
-  HYSCAN_NMEA_DATA_DPT       = 1 << 3
+  HYSCAN_NMEA_DATA_DPT       = 1 << 3,
+  HYSCAN_NMEA_DATA_HDT       = 1 << 4,
+  HYSCAN_NMEA_DATA_VTG       = 1 << 5,
+  HYSCAN_NMEA_DATA_ZDA       = 1 << 6,
+  HYSCAN_NMEA_DATA_GLL       = 1 << 7
 } HyScanNmeaDataType;
 
+/**
+ * HyScanNmeaSpan:
+ * @data: указатель на начало фрагмента
+ * @length: длина фрагмента
+ *
+ * Фрагмент строки: NMEA-сообщение или поле сообщения. Фрагмент не
+ * нуль-терминирован и указывает на память исходной строки.
+ */
+typedef struct
+{
+  const gchar          *data;
+  guint32               length;
+} HyScanNmeaSpan;
+
 HYSCAN_API
 GType                   hyscan_nmea_data_get_type              (void);
 
@@ -135,16 +157,67 @@ const gchar            *hyscan_nmea_data_get_sentence          (HyScanNMEAData
                                                                 guint32           index,
                                                                 gint64           *time);
 
+HYSCAN_API
+const gchar            *hyscan_nmea_data_get_sentences         (HyScanNMEAData   *data,
+                                                                guint32           index,
+                                                                guint32          *length,
+                                                                gint64           *time);
+
+HYSCAN_API
+guint32                 hyscan_nmea_data_index_type            (HyScanNMEAData     *data,
+                                                                HyScanNmeaDataType  type);
+
+HYSCAN_API
+gboolean                hyscan_nmea_data_build_index           (HyScanNMEAData     *data);
+
+HYSCAN_API
+HyScanDBFindStatus      hyscan_nmea_data_find_type             (HyScanNMEAData     *data,
+                                                                HyScanNmeaDataType  type,
+                                                                gint64              time,
+                                                                guint32            *lentry,
+                                                                guint32            *rentry,
+                                                                gint64             *ltime,
+                                                                gint64             *rtime);
+
+HYSCAN_API
+const gchar            *hyscan_nmea_data_get_type_sentence     (HyScanNMEAData     *data,
+                                                                HyScanNmeaDataType  type,
+                                                                guint32             entry,
+                                                                guint32            *length,
+                                                                gint64             *time);
+
 HYSCAN_API
 guint32                 hyscan_nmea_data_get_mod_count         (HyScanNMEAData   *data);
 
 HYSCAN_API
 HyScanNmeaDataType      hyscan_nmea_data_check_sentence        (const gchar      *sentence);
 
+HYSCAN_API
+HyScanNmeaDataType      hyscan_nmea_data_check_span            (const HyScanNmeaSpan *sentence);
+
+HYSCAN_API
+guint                   hyscan_nmea_data_check_sentences       (const gchar          *data,
+                                                                guint32               length,
+                                                                guint32              *position,
+                                                                HyScanNmeaSpan       *sentences,
+                                                                HyScanNmeaDataType   *types,
+                                                                guint                 n_sentences);
+
 HYSCAN_API
 gchar **                hyscan_nmea_data_split_sentence        (const gchar      *sentence,
                                                                 guint32           length);
 
+HYSCAN_API
+gboolean                hyscan_nmea_data_next_sentence         (const gchar      *sentence,
+                                                                guint32           length,
+                                                                guint32          *position,
+                                                                HyScanNmeaSpan   *span);
+
+HYSCAN_API
+gboolean                hyscan_nmea_data_next_field            (const HyScanNmeaSpan *sentence,
+                                                                guint32              *position,
+                                                                HyScanNmeaSpan       *field);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_NMEA_DATA_H__ */
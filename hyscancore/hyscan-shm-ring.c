@@ -0,0 +1,754 @@
+/* hyscan-shm-ring.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-shm-ring
+ * @Short_description: кольцевой буфер строк данных в разделяемой памяти
+ * @Title: HyScanShmRing
+ *
+ * Класс реализует кольцевой буфер строк гидролокационных данных в разделяемой
+ * памяти. Буфер предназначен для передачи обработанных данных от одного
+ * процесса, например #HyScanControlProxy, к нескольким процессам отображения
+ * на том же компьютере без копирования и блокировок.
+ *
+ * Буфер состоит из заголовка и фиксированного числа ячеек одинакового размера.
+ * Каждой записанной строке присваивается последовательный номер. Строка с
+ * номером seq размещается в ячейке seq % n_slots. Число ячеек всегда
+ * округляется до степени двойки, но не менее двух.
+ *
+ * Буфер создаётся записывающей стороной функцией #hyscan_shm_ring_create и
+ * удаляется из системы при уничтожении объекта. Если буфер с таким же
+ * названием и размерами уже существует, например остался от аварийно
+ * завершённого процесса, он не удаляется, так как может быть отображён
+ * читателями, а используется повторно с продолжением нумерации строк.
+ * Читатели подключаются к буферу функцией #hyscan_shm_ring_open. Запись в буфер выполняется функцией
+ * #hyscan_shm_ring_write. Одновременно в буфер может писать только один
+ * поток.
+ *
+ * Функция #hyscan_shm_ring_get_head возвращает номер, который будет присвоен
+ * следующей записанной строке. Строки с номерами от head - n_slots до head - 1
+ * доступны для чтения. Читатель может получить указатель на данные строки в
+ * разделяемой памяти функцией #hyscan_shm_ring_peek. Так как запись в буфер
+ * не ожидает читателей, после использования данных необходимо убедиться
+ * функцией #hyscan_shm_ring_check, что ячейка не была перезаписана. Функция
+ * #hyscan_shm_ring_read выполняет все эти действия и копирует данные в
+ * #HyScanBuffer.
+ *
+ * Класс не является потокобезопасным для записи из нескольких потоков.
+ * Чтение может выполняться из любого числа потоков и процессов.
+ */
+
+#include "hyscan-shm-ring.h"
+
+#include <string.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define SHM_RING_MAGIC         0x52d9f3a7        /* Идентификатор буфера. */
+#define SHM_RING_VERSION       20191001          /* Версия формата буфера. */
+#define SHM_RING_ALIGN         64                /* Выравнивание ячеек. */
+#define SHM_RING_MAX_SLOTS     65536             /* Максимальное число ячеек. */
+#define SHM_RING_MAX_SIZE      (16 * 1024 * 1024) /* Максимальный размер данных ячейки. */
+
+/* Полный барьер памяти. Атомарные операции GLib упорядочивают доступ к памяти
+ * только в одну сторону: на процессорах со слабым упорядочиванием обычные
+ * записи данных ячейки могут стать видны раньше записи номера begin, а
+ * обычные чтения данных могут выполниться после повторного чтения begin. */
+#if defined (__GNUC__) || defined (__clang__)
+#define SHM_RING_FENCE()       __atomic_thread_fence (__ATOMIC_SEQ_CST)
+#elif defined (G_OS_WIN32)
+#define SHM_RING_FENCE()       MemoryBarrier ()
+#else
+#error "memory fence is not defined for this compiler"
+#endif
+
+/* Заголовок буфера в разделяемой памяти. */
+typedef struct
+{
+  guint32                      magic;            /* Идентификатор буфера. */
+  guint32                      version;          /* Версия формата буфера. */
+  guint32                      n_slots;          /* Число ячеек. */
+  guint32                      slot_size;        /* Размер данных ячейки. */
+  gint                         head;             /* Номер следующей строки. */
+  guint32                      reserved[11];     /* Зарезервировано. */
+} HyScanShmRingHeader;
+
+/* Заголовок ячейки в разделяемой памяти. Номера begin и end образуют
+ * последовательную блокировку: перед записью begin устанавливается в номер
+ * новой строки, после записи тот же номер записывается в end. */
+typedef struct
+{
+  gint                         begin;            /* Номер строки в начале записи. */
+  gint                         end;              /* Номер строки в конце записи. */
+  gint64                       time;             /* Метка времени строки. */
+  gint32                       source;           /* Тип источника данных. */
+  guint32                      channel;          /* Индекс канала данных. */
+  guint32                      data_type;        /* Тип данных. */
+  guint32                      size;             /* Размер данных. */
+  gdouble                      data_rate;        /* Частота дискретизации. */
+  guint32                      reserved[6];      /* Зарезервировано. */
+} HyScanShmRingSlot;
+
+G_STATIC_ASSERT (sizeof (HyScanShmRingHeader) == SHM_RING_ALIGN);
+G_STATIC_ASSERT (sizeof (HyScanShmRingSlot) == SHM_RING_ALIGN);
+
+struct _HyScanShmRingPrivate
+{
+  gchar                       *name;             /* Название буфера. */
+  gboolean                     writer;           /* Признак записывающей стороны. */
+
+  guint8                      *memory;           /* Отображение разделяемой памяти. */
+  gsize                        size;             /* Размер отображения. */
+#ifdef G_OS_WIN32
+  HANDLE                       handle;           /* Объект отображения. */
+#endif
+
+  HyScanShmRingHeader         *header;           /* Заголовок буфера. */
+  guint32                      n_slots;          /* Число ячеек. */
+  guint32                      slot_size;        /* Размер данных ячейки. */
+  gsize                        stride;           /* Шаг ячеек в памяти. */
+};
+
+static void            hyscan_shm_ring_object_finalize (GObject               *object);
+static gchar *         hyscan_shm_ring_system_name     (const gchar           *name);
+static gsize           hyscan_shm_ring_stride          (guint32                slot_size);
+static gboolean        hyscan_shm_ring_map             (HyScanShmRingPrivate  *priv,
+                                                        gboolean               create,
+                                                        gsize                  size,
+                                                        gboolean              *exists);
+static void            hyscan_shm_ring_unmap           (HyScanShmRingPrivate  *priv);
+
+static inline HyScanShmRingSlot *
+                       hyscan_shm_ring_slot            (HyScanShmRingPrivate  *priv,
+                                                        guint32                seq);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanShmRing, hyscan_shm_ring, G_TYPE_OBJECT)
+
+static void
+hyscan_shm_ring_class_init (HyScanShmRingClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_shm_ring_object_finalize;
+}
+
+static void
+hyscan_shm_ring_init (HyScanShmRing *ring)
+{
+  ring->priv = hyscan_shm_ring_get_instance_private (ring);
+}
+
+static void
+hyscan_shm_ring_object_finalize (GObject *object)
+{
+  HyScanShmRing *ring = HYSCAN_SHM_RING (object);
+  HyScanShmRingPrivate *priv = ring->priv;
+
+  hyscan_shm_ring_unmap (priv);
+
+  g_free (priv->name);
+
+  G_OBJECT_CLASS (hyscan_shm_ring_parent_class)->finalize (object);
+}
+
+/* Функция формирует системное название объекта разделяемой памяти. */
+static gchar *
+hyscan_shm_ring_system_name (const gchar *name)
+{
+#ifdef G_OS_WIN32
+  return g_strdup_printf ("Local\\%s", name);
+#else
+  return g_strdup_printf ("/%s", name);
+#endif
+}
+
+/* Функция возвращает шаг ячеек в памяти. */
+static gsize
+hyscan_shm_ring_stride (guint32 slot_size)
+{
+  gsize stride = sizeof (HyScanShmRingSlot) + slot_size;
+
+  return (stride + SHM_RING_ALIGN - 1) / SHM_RING_ALIGN * SHM_RING_ALIGN;
+}
+
+/* Функция создаёт или открывает объект разделяемой памяти и отображает его.
+ * При открытии размер отображения определяется размером объекта. Если при
+ * создании объект уже существует, он открывается для записи, а в exists
+ * записывается TRUE. */
+static gboolean
+hyscan_shm_ring_map (HyScanShmRingPrivate *priv,
+                     gboolean              create,
+                     gsize                 size,
+                     gboolean             *exists)
+{
+  gchar *name = hyscan_shm_ring_system_name (priv->name);
+
+#ifdef G_OS_WIN32
+  if (create)
+    {
+      guint64 size64 = size;
+
+      priv->handle = CreateFileMappingA (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                         (DWORD)(size64 >> 32), (DWORD)(size64 & 0xffffffff),
+                                         name);
+      if ((priv->handle != NULL) && (GetLastError () == ERROR_ALREADY_EXISTS))
+        *exists = TRUE;
+    }
+  else
+    {
+      priv->handle = OpenFileMappingA (FILE_MAP_READ, FALSE, name);
+    }
+
+  if (priv->handle == NULL)
+    {
+      g_warning ("HyScanShmRing: can't open shared memory %s", name);
+      goto exit;
+    }
+
+  priv->memory = MapViewOfFile (priv->handle, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+  if (priv->memory == NULL)
+    {
+      g_warning ("HyScanShmRing: can't map shared memory %s", name);
+      CloseHandle (priv->handle);
+      priv->handle = NULL;
+      goto exit;
+    }
+
+  if (!create)
+    {
+      MEMORY_BASIC_INFORMATION info;
+
+      if (VirtualQuery (priv->memory, &info, sizeof (info)) == 0)
+        {
+          hyscan_shm_ring_unmap (priv);
+          goto exit;
+        }
+
+      size = info.RegionSize;
+    }
+
+#else
+  struct stat st;
+  gint fd;
+
+  if (create)
+    {
+      fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0644);
+
+      /* Существующий объект может быть отображён читателями, поэтому он не
+       * удаляется, а открывается повторно, если совпадает его размер. */
+      if ((fd < 0) && (errno == EEXIST))
+        {
+          fd = shm_open (name, O_RDWR, 0);
+          if ((fd >= 0) && ((fstat (fd, &st) != 0) || ((gsize)st.st_size != size)))
+            {
+              close (fd);
+              fd = -1;
+              errno = EEXIST;
+            }
+
+          *exists = (fd >= 0);
+        }
+
+      else if ((fd >= 0) && (ftruncate (fd, size) != 0))
+        {
+          close (fd);
+          shm_unlink (name);
+          fd = -1;
+        }
+    }
+  else
+    {
+      fd = shm_open (name, O_RDONLY, 0);
+      if ((fd >= 0) && (fstat (fd, &st) == 0))
+        {
+          size = st.st_size;
+        }
+      else if (fd >= 0)
+        {
+          close (fd);
+          fd = -1;
+        }
+    }
+
+  if (fd < 0)
+    {
+      g_warning ("HyScanShmRing: can't open shared memory %s: %s", name, g_strerror (errno));
+      goto exit;
+    }
+
+  priv->memory = mmap (NULL, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+
+  if (priv->memory == MAP_FAILED)
+    {
+      g_warning ("HyScanShmRing: can't map shared memory %s: %s", name, g_strerror (errno));
+      priv->memory = NULL;
+      if (create && !*exists)
+        shm_unlink (name);
+      goto exit;
+    }
+#endif
+
+  priv->size = size;
+  priv->writer = create;
+  priv->header = (HyScanShmRingHeader *)priv->memory;
+
+exit:
+  g_free (name);
+
+  return (priv->memory != NULL);
+}
+
+/* Функция отключает отображение разделяемой памяти. Записывающая сторона
+ * также удаляет объект разделяемой памяти из системы. */
+static void
+hyscan_shm_ring_unmap (HyScanShmRingPrivate *priv)
+{
+  if (priv->memory == NULL)
+    return;
+
+#ifdef G_OS_WIN32
+  UnmapViewOfFile (priv->memory);
+  CloseHandle (priv->handle);
+  priv->handle = NULL;
+#else
+  munmap (priv->memory, priv->size);
+
+  if (priv->writer)
+    {
+      gchar *name = hyscan_shm_ring_system_name (priv->name);
+      shm_unlink (name);
+      g_free (name);
+    }
+#endif
+
+  priv->memory = NULL;
+  priv->header = NULL;
+}
+
+/* Функция возвращает ячейку для строки с указанным номером. */
+static inline HyScanShmRingSlot *
+hyscan_shm_ring_slot (HyScanShmRingPrivate *priv,
+                      guint32               seq)
+{
+  guint8 *slot = priv->memory + sizeof (HyScanShmRingHeader);
+
+  return (HyScanShmRingSlot *)(slot + (seq & (priv->n_slots - 1)) * priv->stride);
+}
+
+/**
+ * hyscan_shm_ring_create:
+ * @name: название буфера
+ * @n_slots: число ячеек
+ * @slot_size: максимальный размер данных строки, байт
+ *
+ * Функция создаёт кольцевой буфер в разделяемой памяти. Название буфера
+ * должно состоять из латинских букв, цифр и символов "-", "_". Число ячеек
+ * округляется до ближайшей большей степени двойки, но не менее двух. Буфер
+ * удаляется из системы при уничтожении объекта.
+ *
+ * Если буфер с таким названием уже существует, он не удаляется, так как его
+ * могут читать другие процессы. Буфер с теми же размерами используется
+ * повторно, запись продолжается со следующего номера строки. Если размеры
+ * отличаются, функция возвращает NULL.
+ *
+ * Returns: (nullable): #HyScanShmRing или NULL. Для удаления #g_object_unref.
+ */
+HyScanShmRing *
+hyscan_shm_ring_create (const gchar *name,
+                        guint32      n_slots,
+                        guint32      slot_size)
+{
+  HyScanShmRing *ring;
+  HyScanShmRingPrivate *priv;
+  HyScanShmRingHeader *header;
+  gboolean exists = FALSE;
+  guint32 i;
+
+  g_return_val_if_fail (name != NULL, NULL);
+  g_return_val_if_fail ((n_slots > 0) && (n_slots <= SHM_RING_MAX_SLOTS), NULL);
+  g_return_val_if_fail ((slot_size > 0) && (slot_size <= SHM_RING_MAX_SIZE), NULL);
+
+  ring = g_object_new (HYSCAN_TYPE_SHM_RING, NULL);
+  priv = ring->priv;
+
+  /* Число ячеек - степень двойки, чтобы номера строк после переполнения
+   * продолжали указывать на последовательные ячейки. */
+  for (priv->n_slots = 2; priv->n_slots < n_slots; priv->n_slots <<= 1);
+  priv->slot_size = slot_size;
+  priv->stride = hyscan_shm_ring_stride (slot_size);
+  priv->name = g_strdup (name);
+
+  if (!hyscan_shm_ring_map (priv, TRUE, sizeof (HyScanShmRingHeader) + priv->n_slots * priv->stride, &exists))
+    {
+      g_object_unref (ring);
+      return NULL;
+    }
+
+  /* Существующий буфер используется повторно без изменения содержимого. */
+  header = priv->header;
+  if (exists)
+    {
+      if (((guint32)g_atomic_int_get ((gint *)&header->magic) != SHM_RING_MAGIC) ||
+          (header->version != SHM_RING_VERSION) ||
+          (header->n_slots != priv->n_slots) ||
+          (header->slot_size != priv->slot_size))
+        {
+          g_warning ("HyScanShmRing: %s already exists with different layout", name);
+
+          /* Чужой буфер не удаляется из системы. */
+          priv->writer = FALSE;
+          g_object_unref (ring);
+
+          return NULL;
+        }
+
+      return ring;
+    }
+
+  /* В пустую ячейку i записывается номер i + 1. Строка с таким номером
+   * размещается в другой ячейке, поэтому пустая ячейка не совпадает ни с
+   * одной строкой, включая строку с номером G_MAXUINT32. */
+  memset (header, 0, sizeof (HyScanShmRingHeader));
+  for (i = 0; i < priv->n_slots; i++)
+    {
+      HyScanShmRingSlot *slot = hyscan_shm_ring_slot (priv, i);
+
+      memset (slot, 0, sizeof (HyScanShmRingSlot));
+      slot->begin = (gint)(i + 1);
+      slot->end = (gint)(i + 1);
+    }
+
+  header->n_slots = priv->n_slots;
+  header->slot_size = priv->slot_size;
+  header->version = SHM_RING_VERSION;
+  g_atomic_int_set (&header->head, 0);
+
+  /* Идентификатор записывается последним - признак готовности буфера. */
+  g_atomic_int_set ((gint *)&header->magic, SHM_RING_MAGIC);
+
+  return ring;
+}
+
+/**
+ * hyscan_shm_ring_open:
+ * @name: название буфера
+ *
+ * Функция подключается к существующему кольцевому буферу для чтения.
+ *
+ * Returns: (nullable): #HyScanShmRing или NULL. Для удаления #g_object_unref.
+ */
+HyScanShmRing *
+hyscan_shm_ring_open (const gchar *name)
+{
+  HyScanShmRing *ring;
+  HyScanShmRingPrivate *priv;
+  HyScanShmRingHeader *header;
+
+  g_return_val_if_fail (name != NULL, NULL);
+
+  ring = g_object_new (HYSCAN_TYPE_SHM_RING, NULL);
+  priv = ring->priv;
+  priv->name = g_strdup (name);
+
+  if (!hyscan_shm_ring_map (priv, FALSE, 0, NULL))
+    goto fail;
+
+  header = priv->header;
+  if ((priv->size < sizeof (HyScanShmRingHeader)) ||
+      ((guint32)g_atomic_int_get ((gint *)&header->magic) != SHM_RING_MAGIC) ||
+      (header->version != SHM_RING_VERSION))
+    {
+      g_warning ("HyScanShmRing: %s is not a ring buffer", name);
+      goto fail;
+    }
+
+  priv->n_slots = header->n_slots;
+  priv->slot_size = header->slot_size;
+  priv->stride = hyscan_shm_ring_stride (priv->slot_size);
+
+  if ((priv->n_slots < 2) || (priv->n_slots > SHM_RING_MAX_SLOTS) ||
+      ((priv->n_slots & (priv->n_slots - 1)) != 0) ||
+      (priv->slot_size > SHM_RING_MAX_SIZE) ||
+      (priv->size < sizeof (HyScanShmRingHeader) + priv->n_slots * priv->stride))
+    {
+      g_warning ("HyScanShmRing: %s has wrong layout", name);
+      goto fail;
+    }
+
+  return ring;
+
+fail:
+  g_object_unref (ring);
+
+  return NULL;
+}
+
+/**
+ * hyscan_shm_ring_get_name:
+ * @ring: указатель на #HyScanShmRing
+ *
+ * Функция возвращает название буфера.
+ *
+ * Returns: Название буфера.
+ */
+const gchar *
+hyscan_shm_ring_get_name (HyScanShmRing *ring)
+{
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), NULL);
+
+  return ring->priv->name;
+}
+
+/**
+ * hyscan_shm_ring_get_n_slots:
+ * @ring: указатель на #HyScanShmRing
+ *
+ * Функция возвращает число ячеек буфера.
+ *
+ * Returns: Число ячеек.
+ */
+guint32
+hyscan_shm_ring_get_n_slots (HyScanShmRing *ring)
+{
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), 0);
+
+  return ring->priv->n_slots;
+}
+
+/**
+ * hyscan_shm_ring_get_slot_size:
+ * @ring: указатель на #HyScanShmRing
+ *
+ * Функция возвращает максимальный размер данных строки.
+ *
+ * Returns: Размер данных ячейки, байт.
+ */
+guint32
+hyscan_shm_ring_get_slot_size (HyScanShmRing *ring)
+{
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), 0);
+
+  return ring->priv->slot_size;
+}
+
+/**
+ * hyscan_shm_ring_write:
+ * @ring: указатель на #HyScanShmRing
+ * @source: тип источника данных
+ * @channel: индекс канала данных
+ * @time: метка времени строки
+ * @data_rate: частота дискретизации данных, Гц
+ * @data: данные строки
+ *
+ * Функция записывает строку данных в очередную ячейку буфера. Если размер
+ * данных превышает размер ячейки, строка не записывается. Функция может
+ * вызываться только для буфера, созданного #hyscan_shm_ring_create.
+ *
+ * Returns: %TRUE если строка записана, иначе %FALSE.
+ */
+gboolean
+hyscan_shm_ring_write (HyScanShmRing    *ring,
+                       HyScanSourceType  source,
+                       guint             channel,
+                       gint64            time,
+                       gdouble           data_rate,
+                       HyScanBuffer     *data)
+{
+  HyScanShmRingPrivate *priv;
+  HyScanShmRingSlot *slot;
+  HyScanDataType data_type;
+  gpointer values;
+  guint32 size;
+  guint32 seq;
+
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), FALSE);
+
+  priv = ring->priv;
+
+  if (!priv->writer)
+    return FALSE;
+
+  values = hyscan_buffer_get (data, &data_type, &size);
+  if ((values == NULL) || (size > priv->slot_size))
+    return FALSE;
+
+  seq = (guint32)g_atomic_int_get (&priv->header->head);
+  slot = hyscan_shm_ring_slot (priv, seq);
+
+  /* Помечаем ячейку как изменяемую, читатели прежней строки обнаружат
+   * перезапись по несовпадению номера begin. */
+  g_atomic_int_set (&slot->begin, (gint)seq);
+  SHM_RING_FENCE ();
+
+  slot->time = time;
+  slot->source = source;
+  slot->channel = channel;
+  slot->data_type = data_type;
+  slot->size = size;
+  slot->data_rate = data_rate;
+  memcpy ((guint8 *)slot + sizeof (HyScanShmRingSlot), values, size);
+
+  g_atomic_int_set (&slot->end, (gint)seq);
+  g_atomic_int_set (&priv->header->head, (gint)(seq + 1));
+
+  return TRUE;
+}
+
+/**
+ * hyscan_shm_ring_get_head:
+ * @ring: указатель на #HyScanShmRing
+ *
+ * Функция возвращает номер, который будет присвоен следующей записанной
+ * строке. Номера строк увеличиваются на единицу и переходят через ноль при
+ * переполнении.
+ *
+ * Returns: Номер следующей строки.
+ */
+guint32
+hyscan_shm_ring_get_head (HyScanShmRing *ring)
+{
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), 0);
+
+  return (guint32)g_atomic_int_get (&ring->priv->header->head);
+}
+
+/**
+ * hyscan_shm_ring_peek:
+ * @ring: указатель на #HyScanShmRing
+ * @seq: номер строки
+ * @line: (out): описание строки
+ *
+ * Функция возвращает описание строки и указатель на её данные в разделяемой
+ * памяти без копирования. Данные могут быть перезаписаны в любой момент,
+ * поэтому после их использования необходимо вызвать #hyscan_shm_ring_check.
+ *
+ * Returns: %TRUE если строка доступна, иначе %FALSE.
+ */
+gboolean
+hyscan_shm_ring_peek (HyScanShmRing     *ring,
+                      guint32            seq,
+                      HyScanShmRingLine *line)
+{
+  HyScanShmRingPrivate *priv;
+  HyScanShmRingSlot *slot;
+
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), FALSE);
+  g_return_val_if_fail (line != NULL, FALSE);
+
+  priv = ring->priv;
+  slot = hyscan_shm_ring_slot (priv, seq);
+
+  /* Строка ещё не записана или уже перезаписывается. */
+  if ((guint32)g_atomic_int_get (&slot->end) != seq)
+    return FALSE;
+
+  line->source = slot->source;
+  line->channel = slot->channel;
+  line->time = slot->time;
+  line->data_type = slot->data_type;
+  line->data_rate = slot->data_rate;
+  line->size = MIN (slot->size, priv->slot_size);
+  line->data = (const guint8 *)slot + sizeof (HyScanShmRingSlot);
+
+  return hyscan_shm_ring_check (ring, seq);
+}
+
+/**
+ * hyscan_shm_ring_check:
+ * @ring: указатель на #HyScanShmRing
+ * @seq: номер строки
+ *
+ * Функция проверяет, что ячейка строки не была перезаписана с момента
+ * вызова #hyscan_shm_ring_peek.
+ *
+ * Returns: %TRUE если данные строки корректны, иначе %FALSE.
+ */
+gboolean
+hyscan_shm_ring_check (HyScanShmRing *ring,
+                       guint32        seq)
+{
+  HyScanShmRingSlot *slot;
+
+  g_return_val_if_fail (HYSCAN_IS_SHM_RING (ring), FALSE);
+
+  slot = hyscan_shm_ring_slot (ring->priv, seq);
+
+  /* Чтения данных ячейки должны завершиться до проверки номера. */
+  SHM_RING_FENCE ();
+
+  return ((guint32)g_atomic_int_get (&slot->begin) == seq);
+}
+
+/**
+ * hyscan_shm_ring_read:
+ * @ring: указатель на #HyScanShmRing
+ * @seq: номер строки
+ * @line: (out): описание строки
+ * @buffer: буфер для данных строки
+ *
+ * Функция копирует данные строки в буфер. Поле data в описании строки
+ * указывает на данные в @buffer.
+ *
+ * Returns: %TRUE если строка считана, иначе %FALSE.
+ */
+gboolean
+hyscan_shm_ring_read (HyScanShmRing     *ring,
+                      guint32            seq,
+                      HyScanShmRingLine *line,
+                      HyScanBuffer      *buffer)
+{
+  g_return_val_if_fail (HYSCAN_IS_BUFFER (buffer), FALSE);
+
+  if (!hyscan_shm_ring_peek (ring, seq, line))
+    return FALSE;
+
+  hyscan_buffer_set (buffer, line->data_type, (gpointer)line->data, line->size);
+
+  if (!hyscan_shm_ring_check (ring, seq))
+    return FALSE;
+
+  line->data = hyscan_buffer_get (buffer, NULL, &line->size);
+
+  return TRUE;
+}
@@ -0,0 +1,138 @@
+/* hyscan-shm-ring.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_SHM_RING_H__
+#define __HYSCAN_SHM_RING_H__
+
+#include <hyscan-api.h>
+#include <hyscan-buffer.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_SHM_RING             (hyscan_shm_ring_get_type ())
+#define HYSCAN_SHM_RING(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_SHM_RING, HyScanShmRing))
+#define HYSCAN_IS_SHM_RING(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_SHM_RING))
+#define HYSCAN_SHM_RING_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_SHM_RING, HyScanShmRingClass))
+#define HYSCAN_IS_SHM_RING_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_SHM_RING))
+#define HYSCAN_SHM_RING_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_SHM_RING, HyScanShmRingClass))
+
+typedef struct _HyScanShmRing HyScanShmRing;
+typedef struct _HyScanShmRingPrivate HyScanShmRingPrivate;
+typedef struct _HyScanShmRingClass HyScanShmRingClass;
+typedef struct _HyScanShmRingLine HyScanShmRingLine;
+
+/**
+ * HyScanShmRingLine:
+ * @source: тип источника данных
+ * @channel: индекс канала данных
+ * @time: метка времени строки
+ * @data_type: тип данных
+ * @data_rate: частота дискретизации данных, Гц
+ * @data: указатель на данные в разделяемой памяти
+ * @size: размер данных, байт
+ *
+ * Описание строки данных в разделяемой памяти.
+ */
+struct _HyScanShmRingLine
+{
+  HyScanSourceType             source;
+  guint                        channel;
+  gint64                       time;
+  HyScanDataType               data_type;
+  gdouble                      data_rate;
+  gconstpointer                data;
+  guint32                      size;
+};
+
+struct _HyScanShmRing
+{
+  GObject parent_instance;
+
+  HyScanShmRingPrivate *priv;
+};
+
+struct _HyScanShmRingClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_shm_ring_get_type        (void);
+
+HYSCAN_API
+HyScanShmRing *        hyscan_shm_ring_create          (const gchar           *name,
+                                                        guint32                n_slots,
+                                                        guint32                slot_size);
+
+HYSCAN_API
+HyScanShmRing *        hyscan_shm_ring_open            (const gchar           *name);
+
+HYSCAN_API
+const gchar *          hyscan_shm_ring_get_name        (HyScanShmRing         *ring);
+
+HYSCAN_API
+guint32                hyscan_shm_ring_get_n_slots     (HyScanShmRing         *ring);
+
+HYSCAN_API
+guint32                hyscan_shm_ring_get_slot_size   (HyScanShmRing         *ring);
+
+HYSCAN_API
+gboolean               hyscan_shm_ring_write           (HyScanShmRing         *ring,
+                                                        HyScanSourceType       source,
+                                                        guint                  channel,
+                                                        gint64                 time,
+                                                        gdouble                data_rate,
+                                                        HyScanBuffer          *data);
+
+HYSCAN_API
+guint32                hyscan_shm_ring_get_head        (HyScanShmRing         *ring);
+
+HYSCAN_API
+gboolean               hyscan_shm_ring_peek            (HyScanShmRing         *ring,
+                                                        guint32                seq,
+                                                        HyScanShmRingLine     *line);
+
+HYSCAN_API
+gboolean               hyscan_shm_ring_check           (HyScanShmRing         *ring,
+                                                        guint32                seq);
+
+HYSCAN_API
+gboolean               hyscan_shm_ring_read            (HyScanShmRing         *ring,
+                                                        guint32                seq,
+                                                        HyScanShmRingLine     *line,
+                                                        HyScanBuffer          *buffer);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_SHM_RING_H__ */
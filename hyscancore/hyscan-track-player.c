@@ -0,0 +1,1132 @@
+/* hyscan-track-player.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-track-player
+ * @Short_description: класс синхронного воспроизведения данных галса
+ * @Title: HyScanTrackPlayer
+ *
+ * Класс HyScanTrackPlayer воспроизводит во времени данные нескольких
+ * источников: акустические данные #HyScanAmplitude (ГБО, профилограф и т.п.)
+ * и навигационные данные #HyScanNavData. Все источники синхронизируются по
+ * меткам времени.
+ *
+ * Источники данных добавляются функциями #hyscan_track_player_add_amplitude
+ * и #hyscan_track_player_add_nav_data, которые возвращают идентификатор
+ * источника. Удалить все источники можно функцией #hyscan_track_player_clear.
+ * Объекты источников используются в потоке проигрывателя, поэтому после
+ * добавления их нельзя использовать в других потоках.
+ *
+ * Управление воспроизведением осуществляется функциями
+ * #hyscan_track_player_play, #hyscan_track_player_pause,
+ * #hyscan_track_player_stop и #hyscan_track_player_seek. Режим отображения
+ * данных в реальном времени включается функцией #hyscan_track_player_real_time.
+ *
+ * Данные считываются в фоновом потоке с упреждением на несколько периодов
+ * отображения. В каждом периоде, частота которого задаётся функцией
+ * #hyscan_track_player_set_fps, все строки всех источников, время которых
+ * наступило, отправляются одним сигналом "lines" в порядке возрастания
+ * времени (убывания при воспроизведении в обратном направлении). Если за
+ * один период от источника поступает слишком много строк, лишние строки
+ * пропускаются. По достижении конца (начала при обратном воспроизведении)
+ * данных проигрыватель переходит в режим паузы.
+ *
+ * Сигнал "range" отправляется при изменении диапазона времени данных.
+ *
+ * Сигналы отправляются в основном цикле GMainLoop.
+ */
+
+#include "hyscan-track-player.h"
+#include "hyscan-core-marshallers.h"
+
+#include <string.h>
+
+#define DEFAULT_FPS            30              /* Число кадров в секунду по умолчанию. */
+#define DEFAULT_DELAY          100000          /* Период ожидания при остановке, мкс. */
+#define MAX_BATCHES            4               /* Глубина упреждения, периодов. */
+#define MAX_LINES              256             /* Максимальное число строк источника за период. */
+#define CURSOR_UNSET           G_MININT64      /* Курсор источника не установлен. */
+
+enum
+{
+  SIGNAL_RANGE,
+  SIGNAL_LINES,
+  SIGNAL_LAST
+};
+
+typedef enum
+{
+  HYSCAN_TRACK_PLAYER_STOP,
+  HYSCAN_TRACK_PLAYER_START,
+  HYSCAN_TRACK_PLAYER_PLAY,
+  HYSCAN_TRACK_PLAYER_PAUSE,
+  HYSCAN_TRACK_PLAYER_REAL_TIME
+} HyScanTrackPlayerMode;
+
+/* Источник данных. */
+typedef struct
+{
+  guint                        id;             /* Идентификатор источника. */
+  HyScanAmplitude             *amplitude;      /* Акустические данные. */
+  HyScanNavData               *ndata;          /* Навигационные данные. */
+  gint64                       cursor;         /* Следующий проверяемый индекс. */
+  gboolean                     fresh;          /* Признак отображения строки на начальной границе интервала. */
+} HyScanTrackPlayerSource;
+
+/* Пакет строк, отправляемых за один период. */
+typedef struct
+{
+  gint64                       start_time;     /* Время проигрывателя, с которого собраны строки пакета. */
+  gint64                       end_time;       /* Время проигрывателя, после которого отправляется пакет. */
+  gboolean                     immediate;      /* Признак немедленной отправки. */
+  GArray                      *lines;          /* Строки данных HyScanTrackPlayerLine. */
+  GArray                      *offsets;        /* Смещения амплитуд строк в массиве values. */
+  GArray                      *values;         /* Амплитуды строк. */
+} HyScanTrackPlayerBatch;
+
+struct _HyScanTrackPlayerPrivate
+{
+  /* Параметры управления, защищены ctl_lock. */
+  GPtrArray                   *new_sources;    /* Новый список источников. */
+  gboolean                     sources_changed;/* Признак изменения списка источников. */
+  guint                        next_id;        /* Идентификатор следующего источника. */
+  HyScanTrackPlayerMode        mode;           /* Режим воспроизведения. */
+  gdouble                      speed;          /* Скорость воспроизведения. */
+  gint                         delay;          /* Период отображения, мкс. */
+  gint64                       seek_time;      /* Новая позиция воспроизведения. */
+  gboolean                     seek_changed;   /* Признак изменения позиции. */
+  GMutex                       ctl_lock;       /* Блокировка управления. */
+
+  /* Данные потока обработки. */
+  GPtrArray                   *sources;        /* Текущий список источников. */
+  gint64                       prepared_time;  /* Время, до которого подготовлены данные. */
+
+  /* Данные для отправки, защищены data_lock. */
+  GQueue                       batches;        /* Подготовленные пакеты строк. */
+  GTimer                      *clock;          /* Таймер воспроизведения. */
+  gint64                       clock_start;    /* Время проигрывателя при запуске таймера. */
+  gdouble                      clock_speed;    /* Скорость воспроизведения. */
+  gboolean                     clock_running;  /* Признак работы таймера. */
+  gint64                       min_time;       /* Начальное время данных. */
+  gint64                       max_time;       /* Конечное время данных. */
+  gboolean                     range_changed;  /* Признак изменения диапазона времени. */
+  GMutex                       data_lock;      /* Блокировка данных. */
+
+  gint                         shutdown;       /* Признак завершения работы. */
+  GThread                     *processor;      /* Поток фоновой обработки данных. */
+};
+
+static void            hyscan_track_player_object_constructed  (GObject                  *object);
+static void            hyscan_track_player_object_finalize     (GObject                  *object);
+
+static HyScanTrackPlayerSource *
+                       hyscan_track_player_source_copy         (HyScanTrackPlayerSource  *source);
+static void            hyscan_track_player_source_free         (gpointer                  data);
+static gboolean        hyscan_track_player_source_range        (HyScanTrackPlayerSource  *source,
+                                                                guint32                  *first,
+                                                                guint32                  *last);
+static gboolean        hyscan_track_player_source_time         (HyScanTrackPlayerSource  *source,
+                                                                guint32                   index,
+                                                                gint64                   *time);
+static void            hyscan_track_player_source_seek         (HyScanTrackPlayerSource  *source,
+                                                                gint64                    time,
+                                                                gboolean                  reverse);
+
+static HyScanTrackPlayerBatch *
+                       hyscan_track_player_batch_new           (void);
+static void            hyscan_track_player_batch_free          (gpointer                  data);
+static void            hyscan_track_player_batch_add           (HyScanTrackPlayerBatch   *batch,
+                                                                HyScanTrackPlayerSource  *source,
+                                                                guint32                   index,
+                                                                gint64                    time);
+static void            hyscan_track_player_batch_finish        (HyScanTrackPlayerBatch   *batch,
+                                                                gboolean                  reverse);
+
+static gint64          hyscan_track_player_clock_time          (HyScanTrackPlayerPrivate *priv);
+static void            hyscan_track_player_clear_batches       (HyScanTrackPlayerPrivate *priv);
+static void            hyscan_track_player_update_range        (HyScanTrackPlayerPrivate *priv);
+
+static void            hyscan_track_player_collect             (HyScanTrackPlayerPrivate *priv,
+                                                                HyScanTrackPlayerBatch   *batch,
+                                                                gint64                    from,
+                                                                gint64                    to);
+static void            hyscan_track_player_collect_new         (HyScanTrackPlayerPrivate *priv,
+                                                                HyScanTrackPlayerBatch   *batch);
+
+static gpointer        hyscan_track_player_processor           (gpointer                  data);
+static gboolean        hyscan_track_player_signaller           (gpointer                  data);
+
+static guint           hyscan_track_player_signals[SIGNAL_LAST] = { 0 };
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanTrackPlayer, hyscan_track_player, G_TYPE_OBJECT)
+
+static void
+hyscan_track_player_class_init (HyScanTrackPlayerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = hyscan_track_player_object_constructed;
+  object_class->finalize = hyscan_track_player_object_finalize;
+
+  /**
+   * HyScanTrackPlayer::range:
+   * @player: указатель на #HyScanTrackPlayer
+   * @min_time: начальное время данных
+   * @max_time: конечное время данных
+   *
+   * Сигнал отправляется при изменении диапазона времени данных.
+   */
+  hyscan_track_player_signals[SIGNAL_RANGE] =
+    g_signal_new ("range", HYSCAN_TYPE_TRACK_PLAYER, G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+                  hyscan_core_marshal_VOID__INT64_INT64,
+                  G_TYPE_NONE,
+                  2, G_TYPE_INT64, G_TYPE_INT64);
+
+  /**
+   * HyScanTrackPlayer::lines:
+   * @player: указатель на #HyScanTrackPlayer
+   * @lines: массив строк данных #HyScanTrackPlayerLine
+   * @n_lines: число строк данных
+   *
+   * Сигнал отправляется один раз за период отображения со всеми строками
+   * данных, время которых наступило в этом периоде. Данные строк доступны
+   * только во время обработки сигнала.
+   */
+  hyscan_track_player_signals[SIGNAL_LINES] =
+    g_signal_new ("lines", HYSCAN_TYPE_TRACK_PLAYER, G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+                  hyscan_core_marshal_VOID__POINTER_UINT,
+                  G_TYPE_NONE,
+                  2, G_TYPE_POINTER, G_TYPE_UINT);
+}
+
+static void
+hyscan_track_player_init (HyScanTrackPlayer *player)
+{
+  player->priv = hyscan_track_player_get_instance_private (player);
+}
+
+static void
+hyscan_track_player_object_constructed (GObject *object)
+{
+  HyScanTrackPlayer *player = HYSCAN_TRACK_PLAYER (object);
+  HyScanTrackPlayerPrivate *priv = player->priv;
+
+  g_mutex_init (&priv->ctl_lock);
+  g_mutex_init (&priv->data_lock);
+  g_queue_init (&priv->batches);
+
+  priv->new_sources = g_ptr_array_new_with_free_func (hyscan_track_player_source_free);
+  priv->sources = g_ptr_array_new_with_free_func (hyscan_track_player_source_free);
+  priv->clock = g_timer_new ();
+
+  priv->mode = HYSCAN_TRACK_PLAYER_STOP;
+  priv->speed = 1.0;
+  priv->delay = G_USEC_PER_SEC / DEFAULT_FPS;
+
+  priv->processor = g_thread_new ("track-processor", hyscan_track_player_processor, priv);
+
+  g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, priv->delay / 1000,
+                      hyscan_track_player_signaller, player, NULL);
+}
+
+static void
+hyscan_track_player_object_finalize (GObject *object)
+{
+  HyScanTrackPlayer *player = HYSCAN_TRACK_PLAYER (object);
+  HyScanTrackPlayerPrivate *priv = player->priv;
+
+  g_source_remove_by_user_data (player);
+
+  g_atomic_int_set (&priv->shutdown, 1);
+  g_clear_pointer (&priv->processor, g_thread_join);
+
+  hyscan_track_player_clear_batches (priv);
+  g_timer_destroy (priv->clock);
+  g_ptr_array_unref (priv->sources);
+  g_ptr_array_unref (priv->new_sources);
+
+  g_mutex_clear (&priv->data_lock);
+  g_mutex_clear (&priv->ctl_lock);
+
+  G_OBJECT_CLASS (hyscan_track_player_parent_class)->finalize (object);
+}
+
+/* Функция создаёт копию описания источника данных. */
+static HyScanTrackPlayerSource *
+hyscan_track_player_source_copy (HyScanTrackPlayerSource *source)
+{
+  HyScanTrackPlayerSource *copy = g_slice_new0 (HyScanTrackPlayerSource);
+
+  copy->id = source->id;
+  copy->amplitude = (source->amplitude != NULL) ? g_object_ref (source->amplitude) : NULL;
+  copy->ndata = (source->ndata != NULL) ? g_object_ref (source->ndata) : NULL;
+  copy->cursor = CURSOR_UNSET;
+  copy->fresh = TRUE;
+
+  return copy;
+}
+
+/* Функция освобождает описание источника данных. */
+static void
+hyscan_track_player_source_free (gpointer data)
+{
+  HyScanTrackPlayerSource *source = data;
+
+  g_clear_object (&source->amplitude);
+  g_clear_object (&source->ndata);
+  g_slice_free (HyScanTrackPlayerSource, source);
+}
+
+/* Функция возвращает диапазон индексов данных источника. */
+static gboolean
+hyscan_track_player_source_range (HyScanTrackPlayerSource *source,
+                                  guint32                 *first,
+                                  guint32                 *last)
+{
+  if (source->amplitude != NULL)
+    return hyscan_amplitude_get_range (source->amplitude, first, last);
+
+  return hyscan_nav_data_get_range (source->ndata, first, last);
+}
+
+/* Функция возвращает метку времени строки данных источника. */
+static gboolean
+hyscan_track_player_source_time (HyScanTrackPlayerSource *source,
+                                 guint32                  index,
+                                 gint64                  *time)
+{
+  if (source->amplitude != NULL)
+    return hyscan_amplitude_get_size_time (source->amplitude, index, NULL, time);
+
+  return hyscan_nav_data_get (source->ndata, index, time, NULL);
+}
+
+/* Функция устанавливает курсор источника на строку, с которой начнётся
+ * проверка при воспроизведении от указанного момента времени. */
+static void
+hyscan_track_player_source_seek (HyScanTrackPlayerSource *source,
+                                 gint64                   time,
+                                 gboolean                 reverse)
+{
+  HyScanDBFindStatus status;
+  guint32 first, last;
+  guint32 lindex, rindex;
+
+  source->cursor = CURSOR_UNSET;
+  if (!hyscan_track_player_source_range (source, &first, &last))
+    return;
+
+  if (source->amplitude != NULL)
+    status = hyscan_amplitude_find_data (source->amplitude, time, &lindex, &rindex, NULL, NULL);
+  else
+    status = hyscan_nav_data_find_data (source->ndata, time, &lindex, &rindex, NULL, NULL);
+
+  if (status == HYSCAN_DB_FIND_OK)
+    source->cursor = reverse ? rindex : lindex;
+  else if (status == HYSCAN_DB_FIND_LESS)
+    source->cursor = reverse ? (gint64)first - 1 : first;
+  else if (status == HYSCAN_DB_FIND_GREATER)
+    source->cursor = reverse ? last : (gint64)last + 1;
+}
+
+/* Функция создаёт пакет строк. */
+static HyScanTrackPlayerBatch *
+hyscan_track_player_batch_new (void)
+{
+  HyScanTrackPlayerBatch *batch = g_slice_new0 (HyScanTrackPlayerBatch);
+
+  batch->lines = g_array_new (FALSE, FALSE, sizeof (HyScanTrackPlayerLine));
+  batch->offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+  batch->values = g_array_new (FALSE, FALSE, sizeof (gfloat));
+
+  return batch;
+}
+
+/* Функция освобождает пакет строк. */
+static void
+hyscan_track_player_batch_free (gpointer data)
+{
+  HyScanTrackPlayerBatch *batch = data;
+
+  g_array_unref (batch->lines);
+  g_array_unref (batch->offsets);
+  g_array_unref (batch->values);
+  g_slice_free (HyScanTrackPlayerBatch, batch);
+}
+
+/* Функция добавляет в пакет строку данных источника. */
+static void
+hyscan_track_player_batch_add (HyScanTrackPlayerBatch  *batch,
+                               HyScanTrackPlayerSource *source,
+                               guint32                  index,
+                               gint64                   time)
+{
+  HyScanTrackPlayerLine line = { 0 };
+  gsize offset = batch->values->len;
+
+  line.source = source->id;
+  line.index = index;
+  line.time = time;
+
+  if (source->amplitude != NULL)
+    {
+      const gfloat *amplitude;
+
+      amplitude = hyscan_amplitude_get_amplitude (source->amplitude, index,
+                                                  &line.n_points, &line.time, &line.noise);
+      if (amplitude == NULL)
+        return;
+
+      g_array_append_vals (batch->values, amplitude, line.n_points);
+    }
+  else
+    {
+      if (!hyscan_nav_data_get (source->ndata, index, &line.time, &line.value))
+        return;
+    }
+
+  g_array_append_val (batch->lines, line);
+  g_array_append_val (batch->offsets, offset);
+}
+
+static gint
+hyscan_track_player_line_cmp (gconstpointer a,
+                              gconstpointer b)
+{
+  const HyScanTrackPlayerLine *line1 = a;
+  const HyScanTrackPlayerLine *line2 = b;
+
+  return (line1->time > line2->time) - (line1->time < line2->time);
+}
+
+static gint
+hyscan_track_player_line_cmp_reverse (gconstpointer a,
+                                      gconstpointer b)
+{
+  return hyscan_track_player_line_cmp (b, a);
+}
+
+/* Функция завершает формирование пакета: устанавливает указатели на
+ * амплитуды строк и сортирует строки по времени. */
+static void
+hyscan_track_player_batch_finish (HyScanTrackPlayerBatch *batch,
+                                  gboolean                reverse)
+{
+  const gfloat *values = (const gfloat *) batch->values->data;
+  guint i;
+
+  for (i = 0; i < batch->lines->len; i++)
+    {
+      HyScanTrackPlayerLine *line = &g_array_index (batch->lines, HyScanTrackPlayerLine, i);
+
+      if (line->n_points > 0)
+        line->amplitude = values + g_array_index (batch->offsets, gsize, i);
+    }
+
+  g_array_sort (batch->lines, reverse ? hyscan_track_player_line_cmp_reverse :
+                                        hyscan_track_player_line_cmp);
+}
+
+/* Функция возвращает текущее время проигрывателя. Во время воспроизведения
+ * время не выходит за диапазон времени данных. Вызывается с заблокированным
+ * data_lock. */
+static gint64
+hyscan_track_player_clock_time (HyScanTrackPlayerPrivate *priv)
+{
+  gint64 elapsed;
+
+  if (!priv->clock_running)
+    return priv->clock_start;
+
+  elapsed = G_USEC_PER_SEC * g_timer_elapsed (priv->clock, NULL) * priv->clock_speed;
+
+  return CLAMP (priv->clock_start + elapsed, priv->min_time, priv->max_time);
+}
+
+/* Функция удаляет все подготовленные пакеты строк. */
+static void
+hyscan_track_player_clear_batches (HyScanTrackPlayerPrivate *priv)
+{
+  g_mutex_lock (&priv->data_lock);
+
+  g_queue_foreach (&priv->batches, (GFunc) hyscan_track_player_batch_free, NULL);
+  g_queue_clear (&priv->batches);
+
+  g_mutex_unlock (&priv->data_lock);
+}
+
+/* Функция обновляет диапазон времени данных всех источников. */
+static void
+hyscan_track_player_update_range (HyScanTrackPlayerPrivate *priv)
+{
+  gint64 min_time = G_MAXINT64;
+  gint64 max_time = G_MININT64;
+  guint i;
+
+  for (i = 0; i < priv->sources->len; i++)
+    {
+      HyScanTrackPlayerSource *source = g_ptr_array_index (priv->sources, i);
+      guint32 first, last;
+      gint64 time;
+
+      if (!hyscan_track_player_source_range (source, &first, &last))
+        continue;
+
+      if (hyscan_track_player_source_time (source, first, &time))
+        min_time = MIN (min_time, time);
+      if (hyscan_track_player_source_time (source, last, &time))
+        max_time = MAX (max_time, time);
+    }
+
+  if (min_time > max_time)
+    min_time = max_time = 0;
+
+  g_mutex_lock (&priv->data_lock);
+
+  if ((priv->min_time != min_time) || (priv->max_time != max_time))
+    {
+      priv->min_time = min_time;
+      priv->max_time = max_time;
+      priv->range_changed = TRUE;
+    }
+
+  g_mutex_unlock (&priv->data_lock);
+}
+
+/* Функция добавляет в пакет строки всех источников, время которых попадает
+ * в интервал (from, to] при воспроизведении вперёд или [to, from) при
+ * воспроизведении в обратном направлении. Для источника, курсор которого
+ * установлен после запуска, перемещения или изменения списка источников,
+ * интервал включает и момент времени from. */
+static void
+hyscan_track_player_collect (HyScanTrackPlayerPrivate *priv,
+                             HyScanTrackPlayerBatch   *batch,
+                             gint64                    from,
+                             gint64                    to)
+{
+  gboolean reverse = (to < from);
+  guint i;
+
+  for (i = 0; i < priv->sources->len; i++)
+    {
+      HyScanTrackPlayerSource *source = g_ptr_array_index (priv->sources, i);
+      guint32 first, last;
+      guint n_lines = 0;
+
+      if (!hyscan_track_player_source_range (source, &first, &last))
+        continue;
+
+      if (source->cursor == CURSOR_UNSET)
+        hyscan_track_player_source_seek (source, from, reverse);
+
+      while ((source->cursor >= first) && (source->cursor <= last))
+        {
+          gint64 time;
+
+          if (!hyscan_track_player_source_time (source, source->cursor, &time))
+            break;
+
+          /* Строка ещё не должна отображаться. */
+          if (reverse ? (time < to) : (time > to))
+            break;
+
+          /* Строки, уже отображённые ранее, пропускаются. */
+          if ((reverse ? (time < from) : (time > from)) || (source->fresh && (time == from)))
+            {
+              hyscan_track_player_batch_add (batch, source, source->cursor, time);
+              n_lines += 1;
+            }
+
+          source->cursor += reverse ? -1 : 1;
+
+          /* Строки сверх лимита пропускаются без чтения: курсор сразу
+           * переносится на конец интервала. Строка под курсором при этом
+           * не позже to и в следующем интервале считается отображённой. */
+          if (n_lines == MAX_LINES)
+            {
+              hyscan_track_player_source_seek (source, to, reverse);
+              break;
+            }
+        }
+
+      source->fresh = FALSE;
+    }
+
+  hyscan_track_player_batch_finish (batch, reverse);
+}
+
+/* Функция добавляет в пакет строки, записанные после предыдущего вызова. */
+static void
+hyscan_track_player_collect_new (HyScanTrackPlayerPrivate *priv,
+                                 HyScanTrackPlayerBatch   *batch)
+{
+  guint i;
+
+  for (i = 0; i < priv->sources->len; i++)
+    {
+      HyScanTrackPlayerSource *source = g_ptr_array_index (priv->sources, i);
+      guint32 first, last;
+      gint64 time;
+
+      if (!hyscan_track_player_source_range (source, &first, &last))
+        continue;
+
+      /* При первом вызове отображается только последняя строка. */
+      if (source->cursor == CURSOR_UNSET)
+        source->cursor = last;
+
+      source->cursor = MAX (source->cursor, first);
+      if ((gint64)last - source->cursor >= MAX_LINES)
+        source->cursor = (gint64)last - MAX_LINES + 1;
+
+      for (; source->cursor <= last; source->cursor++)
+        {
+          if (hyscan_track_player_source_time (source, source->cursor, &time))
+            hyscan_track_player_batch_add (batch, source, source->cursor, time);
+        }
+    }
+
+  hyscan_track_player_batch_finish (batch, FALSE);
+}
+
+/* Поток фоновой обработки данных. */
+static gpointer
+hyscan_track_player_processor (gpointer user_data)
+{
+  HyScanTrackPlayerPrivate *priv = user_data;
+  HyScanTrackPlayerMode prev_mode = HYSCAN_TRACK_PLAYER_STOP;
+
+  GTimer *delay_timer = g_timer_new ();
+
+  while (!g_atomic_int_get (&priv->shutdown))
+    {
+      HyScanTrackPlayerMode mode;
+      gboolean sources_changed;
+      gboolean seek_changed;
+      gint64 seek_time;
+      gdouble speed;
+      gint delay;
+      guint i;
+
+      /* Начало текущего периода. */
+      g_timer_start (delay_timer);
+
+      g_mutex_lock (&priv->ctl_lock);
+
+      /* Новый список источников данных. */
+      sources_changed = priv->sources_changed;
+      if (sources_changed)
+        {
+          GPtrArray *prev_sources = priv->sources;
+
+          priv->sources = g_ptr_array_new_with_free_func (hyscan_track_player_source_free);
+          for (i = 0; i < priv->new_sources->len; i++)
+            {
+              HyScanTrackPlayerSource *source;
+              guint j;
+
+              source = hyscan_track_player_source_copy (g_ptr_array_index (priv->new_sources, i));
+
+              /* Источники, уже участвующие в воспроизведении, сохраняют
+               * признак отображения строки на границе интервала. */
+              for (j = 0; j < prev_sources->len; j++)
+                {
+                  HyScanTrackPlayerSource *prev = g_ptr_array_index (prev_sources, j);
+
+                  if (prev->id == source->id)
+                    source->fresh = prev->fresh;
+                }
+
+              g_ptr_array_add (priv->sources, source);
+            }
+
+          g_ptr_array_unref (prev_sources);
+          priv->sources_changed = FALSE;
+        }
+
+      mode = priv->mode;
+      speed = priv->speed;
+      delay = priv->delay;
+      seek_time = priv->seek_time;
+      seek_changed = priv->seek_changed;
+      priv->seek_changed = FALSE;
+
+      if (priv->mode == HYSCAN_TRACK_PLAYER_START)
+        priv->mode = HYSCAN_TRACK_PLAYER_PLAY;
+
+      g_mutex_unlock (&priv->ctl_lock);
+
+      /* Диапазон времени данных. */
+      hyscan_track_player_update_range (priv);
+
+      /* Изменение режима, позиции или источников - подготовленные данные
+       * больше не актуальны. Если воспроизведение продолжается, данные
+       * подготавливаются заново с момента, до которого они уже отправлены. */
+      if (sources_changed || seek_changed || (mode != prev_mode))
+        {
+          HyScanTrackPlayerBatch *pending;
+
+          g_mutex_lock (&priv->data_lock);
+          pending = g_queue_peek_head (&priv->batches);
+          if (mode == HYSCAN_TRACK_PLAYER_PLAY)
+            priv->prepared_time = (pending != NULL) ? pending->start_time : hyscan_track_player_clock_time (priv);
+          g_mutex_unlock (&priv->data_lock);
+
+          hyscan_track_player_clear_batches (priv);
+
+          for (i = 0; i < priv->sources->len; i++)
+            ((HyScanTrackPlayerSource *) g_ptr_array_index (priv->sources, i))->cursor = CURSOR_UNSET;
+        }
+
+      /* Положение и состояние таймера воспроизведения. */
+      g_mutex_lock (&priv->data_lock);
+
+      if (seek_changed)
+        priv->clock_start = seek_time;
+      else if ((mode != prev_mode) && (mode != HYSCAN_TRACK_PLAYER_PLAY))
+        priv->clock_start = hyscan_track_player_clock_time (priv);
+
+      if (mode == HYSCAN_TRACK_PLAYER_STOP)
+        priv->clock_start = priv->min_time;
+
+      if ((mode == HYSCAN_TRACK_PLAYER_START) || (seek_changed && (mode == HYSCAN_TRACK_PLAYER_PLAY)))
+        {
+          priv->clock_start = CLAMP (priv->clock_start, priv->min_time, priv->max_time);
+          priv->clock_speed = speed;
+          priv->clock_running = TRUE;
+          g_timer_start (priv->clock);
+
+          priv->prepared_time = priv->clock_start;
+          for (i = 0; i < priv->sources->len; i++)
+            {
+              HyScanTrackPlayerSource *source = g_ptr_array_index (priv->sources, i);
+
+              hyscan_track_player_source_seek (source, priv->clock_start, (speed < 0.0));
+              source->fresh = TRUE;
+            }
+
+          mode = HYSCAN_TRACK_PLAYER_PLAY;
+        }
+      else if (mode != HYSCAN_TRACK_PLAYER_PLAY)
+        {
+          priv->clock_running = FALSE;
+        }
+
+      g_mutex_unlock (&priv->data_lock);
+
+      prev_mode = mode;
+
+      /* Режим воспроизведения: подготавливаем данные на несколько периодов
+       * вперёд, но не дальше границы данных. */
+      if (mode == HYSCAN_TRACK_PLAYER_PLAY)
+        {
+          gint64 step = delay * speed;
+          gint64 min_time, max_time;
+          gint64 horizon;
+          gint64 now;
+          gboolean finished;
+
+          g_mutex_lock (&priv->data_lock);
+          min_time = priv->min_time;
+          max_time = priv->max_time;
+          horizon = hyscan_track_player_clock_time (priv) + MAX_BATCHES * step;
+          horizon = CLAMP (horizon, min_time, max_time);
+          g_mutex_unlock (&priv->data_lock);
+
+          while ((step > 0) ? (priv->prepared_time < horizon) : (priv->prepared_time > horizon))
+            {
+              HyScanTrackPlayerBatch *batch = hyscan_track_player_batch_new ();
+
+              batch->start_time = priv->prepared_time;
+              batch->end_time = CLAMP (priv->prepared_time + step, min_time, max_time);
+              hyscan_track_player_collect (priv, batch, batch->start_time, batch->end_time);
+              priv->prepared_time = batch->end_time;
+
+              if (batch->lines->len == 0)
+                {
+                  hyscan_track_player_batch_free (batch);
+                  continue;
+                }
+
+              g_mutex_lock (&priv->data_lock);
+              g_queue_push_tail (&priv->batches, batch);
+              g_mutex_unlock (&priv->data_lock);
+            }
+
+          /* Все данные до границы отправлены - останавливаем таймер. */
+          g_mutex_lock (&priv->data_lock);
+          now = hyscan_track_player_clock_time (priv);
+          finished = ((step > 0) ? (now >= priv->max_time) : (now <= priv->min_time)) &&
+                     g_queue_is_empty (&priv->batches);
+          if (finished)
+            {
+              priv->clock_start = now;
+              priv->clock_running = FALSE;
+            }
+          g_mutex_unlock (&priv->data_lock);
+
+          /* Переходим в режим паузы, если пользователь не изменил режим
+           * или позицию воспроизведения. */
+          if (finished)
+            {
+              g_mutex_lock (&priv->ctl_lock);
+              if ((priv->mode == HYSCAN_TRACK_PLAYER_PLAY) && !priv->seek_changed)
+                priv->mode = HYSCAN_TRACK_PLAYER_PAUSE;
+              g_mutex_unlock (&priv->ctl_lock);
+            }
+        }
+
+      /* Режим просмотра в реальном времени. */
+      else if (mode == HYSCAN_TRACK_PLAYER_REAL_TIME)
+        {
+          HyScanTrackPlayerBatch *batch = hyscan_track_player_batch_new ();
+
+          batch->immediate = TRUE;
+          hyscan_track_player_collect_new (priv, batch);
+
+          if (batch->lines->len > 0)
+            {
+              g_mutex_lock (&priv->data_lock);
+              g_queue_push_tail (&priv->batches, batch);
+              g_mutex_unlock (&priv->data_lock);
+            }
+          else
+            {
+              hyscan_track_player_batch_free (batch);
+            }
+        }
+
+      /* Остановка или пауза. */
+      else
+        {
+          delay = DEFAULT_DELAY;
+        }
+
+      /* Ожидание следующего периода. */
+      delay -= g_timer_elapsed (delay_timer, NULL) * G_USEC_PER_SEC;
+      if (delay > 0)
+        g_usleep (delay);
+    }
+
+  g_ptr_array_set_size (priv->sources, 0);
+  g_timer_destroy (delay_timer);
+
+  return NULL;
+}
+
+/* Функция отправляет пакеты строк, время которых наступило. */
+static gboolean
+hyscan_track_player_signaller (gpointer user_data)
+{
+  HyScanTrackPlayer *player = user_data;
+  HyScanTrackPlayerPrivate *priv = player->priv;
+  HyScanTrackPlayerBatch *batch;
+  GQueue ready = G_QUEUE_INIT;
+  gboolean range_changed;
+  gint64 min_time, max_time;
+  gint64 now;
+
+  g_mutex_lock (&priv->data_lock);
+
+  now = hyscan_track_player_clock_time (priv);
+  while ((batch = g_queue_peek_head (&priv->batches)) != NULL)
+    {
+      if (!batch->immediate &&
+          ((priv->clock_speed > 0.0) ? (batch->end_time > now) : (batch->end_time < now)))
+        {
+          break;
+        }
+
+      g_queue_push_tail (&ready, g_queue_pop_head (&priv->batches));
+    }
+
+  range_changed = priv->range_changed;
+  min_time = priv->min_time;
+  max_time = priv->max_time;
+  priv->range_changed = FALSE;
+
+  g_mutex_unlock (&priv->data_lock);
+
+  if (range_changed)
+    g_signal_emit (player, hyscan_track_player_signals[SIGNAL_RANGE], 0, min_time, max_time);
+
+  while ((batch = g_queue_pop_head (&ready)) != NULL)
+    {
+      g_signal_emit (player, hyscan_track_player_signals[SIGNAL_LINES], 0,
+                     batch->lines->data, batch->lines->len);
+
+      hyscan_track_player_batch_free (batch);
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_track_player_new:
+ *
+ * Функция создаёт новый объект #HyScanTrackPlayer.
+ *
+ * Returns: #HyScanTrackPlayer. Для удаления #g_object_unref.
+ */
+HyScanTrackPlayer *
+hyscan_track_player_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_TRACK_PLAYER, NULL);
+}
+
+/**
+ * hyscan_track_player_set_fps:
+ * @player: указатель на #HyScanTrackPlayer
+ * @fps: число кадров в секунду от 1 до 100
+ *
+ * Функция задаёт частоту отправки пакетов строк.
+ */
+void
+hyscan_track_player_set_fps (HyScanTrackPlayer *player,
+                             guint              fps)
+{
+  HyScanTrackPlayerPrivate *priv;
+  gint delay;
+
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+
+  priv = player->priv;
+
+  fps = CLAMP (fps, 1, 100);
+  delay = G_USEC_PER_SEC / fps;
+  g_source_remove_by_user_data (player);
+
+  g_mutex_lock (&priv->ctl_lock);
+
+  priv->delay = delay;
+
+  g_mutex_unlock (&priv->ctl_lock);
+
+  g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, delay / 1000,
+                      hyscan_track_player_signaller, player, NULL);
+}
+
+/* Функция добавляет источник данных. */
+static guint
+hyscan_track_player_add_source (HyScanTrackPlayer *player,
+                                HyScanAmplitude   *amplitude,
+                                HyScanNavData     *ndata)
+{
+  HyScanTrackPlayerPrivate *priv = player->priv;
+  HyScanTrackPlayerSource source = { 0 };
+  guint id;
+
+  g_mutex_lock (&priv->ctl_lock);
+
+  id = priv->next_id++;
+  source.id = id;
+  source.amplitude = amplitude;
+  source.ndata = ndata;
+
+  g_ptr_array_add (priv->new_sources, hyscan_track_player_source_copy (&source));
+  priv->sources_changed = TRUE;
+
+  g_mutex_unlock (&priv->ctl_lock);
+
+  return id;
+}
+
+/**
+ * hyscan_track_player_add_amplitude:
+ * @player: указатель на #HyScanTrackPlayer
+ * @amplitude: указатель на #HyScanAmplitude
+ *
+ * Функция добавляет источник акустических данных.
+ *
+ * Returns: идентификатор источника данных.
+ */
+guint
+hyscan_track_player_add_amplitude (HyScanTrackPlayer *player,
+                                   HyScanAmplitude   *amplitude)
+{
+  g_return_val_if_fail (HYSCAN_IS_TRACK_PLAYER (player), G_MAXUINT);
+  g_return_val_if_fail (HYSCAN_IS_AMPLITUDE (amplitude), G_MAXUINT);
+
+  return hyscan_track_player_add_source (player, amplitude, NULL);
+}
+
+/**
+ * hyscan_track_player_add_nav_data:
+ * @player: указатель на #HyScanTrackPlayer
+ * @ndata: указатель на #HyScanNavData
+ *
+ * Функция добавляет источник навигационных данных.
+ *
+ * Returns: идентификатор источника данных.
+ */
+guint
+hyscan_track_player_add_nav_data (HyScanTrackPlayer *player,
+                                  HyScanNavData     *ndata)
+{
+  g_return_val_if_fail (HYSCAN_IS_TRACK_PLAYER (player), G_MAXUINT);
+  g_return_val_if_fail (HYSCAN_IS_NAV_DATA (ndata), G_MAXUINT);
+
+  return hyscan_track_player_add_source (player, NULL, ndata);
+}
+
+/**
+ * hyscan_track_player_clear:
+ * @player: указатель на #HyScanTrackPlayer
+ *
+ * Функция удаляет все источники данных и останавливает воспроизведение.
+ */
+void
+hyscan_track_player_clear (HyScanTrackPlayer *player)
+{
+  HyScanTrackPlayerPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+
+  priv = player->priv;
+
+  g_mutex_lock (&priv->ctl_lock);
+
+  g_ptr_array_set_size (priv->new_sources, 0);
+  priv->sources_changed = TRUE;
+  priv->mode = HYSCAN_TRACK_PLAYER_STOP;
+
+  g_mutex_unlock (&priv->ctl_lock);
+}
+
+/* Функция изменяет режим воспроизведения. */
+static void
+hyscan_track_player_set_mode (HyScanTrackPlayer     *player,
+                              HyScanTrackPlayerMode  mode,
+                              gdouble                speed)
+{
+  HyScanTrackPlayerPrivate *priv = player->priv;
+
+  g_mutex_lock (&priv->ctl_lock);
+
+  priv->mode = mode;
+  if (mode == HYSCAN_TRACK_PLAYER_START)
+    priv->speed = speed;
+
+  g_mutex_unlock (&priv->ctl_lock);
+}
+
+/**
+ * hyscan_track_player_real_time:
+ * @player: указатель на #HyScanTrackPlayer
+ *
+ * Функция включает режим отображения данных в реальном времени. По мере
+ * записи новых данных они будут отправляться пользователю.
+ */
+void
+hyscan_track_player_real_time (HyScanTrackPlayer *player)
+{
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+
+  hyscan_track_player_set_mode (player, HYSCAN_TRACK_PLAYER_REAL_TIME, 0.0);
+}
+
+/**
+ * hyscan_track_player_play:
+ * @player: указатель на #HyScanTrackPlayer
+ * @speed: скорость воспроизведения
+ *
+ * Функция включает режим воспроизведения записанных данных с текущей
+ * позиции. Скорость воспроизведения определяет коэффициент замедления
+ * (< 1.0) или ускорения (> 1.0) течения времени. Если скорость отрицательная,
+ * данные воспроизводятся в обратном направлении.
+ */
+void
+hyscan_track_player_play (HyScanTrackPlayer *player,
+                          gdouble            speed)
+{
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+  g_return_if_fail (speed != 0.0);
+
+  hyscan_track_player_set_mode (player, HYSCAN_TRACK_PLAYER_START, speed);
+}
+
+/**
+ * hyscan_track_player_pause:
+ * @player: указатель на #HyScanTrackPlayer
+ *
+ * Функция приостанавливает воспроизведение. Текущая позиция не изменяется.
+ */
+void
+hyscan_track_player_pause (HyScanTrackPlayer *player)
+{
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+
+  hyscan_track_player_set_mode (player, HYSCAN_TRACK_PLAYER_PAUSE, 0.0);
+}
+
+/**
+ * hyscan_track_player_stop:
+ * @player: указатель на #HyScanTrackPlayer
+ *
+ * Функция останавливает воспроизведение. Текущая позиция перемещается в
+ * начало данных.
+ */
+void
+hyscan_track_player_stop (HyScanTrackPlayer *player)
+{
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+
+  hyscan_track_player_set_mode (player, HYSCAN_TRACK_PLAYER_STOP, 0.0);
+}
+
+/**
+ * hyscan_track_player_seek:
+ * @player: указатель на #HyScanTrackPlayer
+ * @time: новая позиция воспроизведения
+ *
+ * Функция перемещает текущую позицию воспроизведения в указанный момент
+ * времени.
+ */
+void
+hyscan_track_player_seek (HyScanTrackPlayer *player,
+                          gint64             time)
+{
+  HyScanTrackPlayerPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_TRACK_PLAYER (player));
+
+  priv = player->priv;
+
+  g_mutex_lock (&priv->ctl_lock);
+
+  priv->seek_time = time;
+  priv->seek_changed = TRUE;
+
+  g_mutex_unlock (&priv->ctl_lock);
+}
@@ -0,0 +1,129 @@
+/* hyscan-track-player.h
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_TRACK_PLAYER_H__
+#define __HYSCAN_TRACK_PLAYER_H__
+
+#include <hyscan-amplitude.h>
+#include <hyscan-nav-data.h>
+
+G_BEGIN_DECLS
+
+/**
+ * HyScanTrackPlayerLine:
+ * @source: идентификатор источника данных
+ * @index: индекс строки данных
+ * @time: метка времени строки данных
+ * @amplitude: (nullable): массив амплитуд или NULL для навигационных данных
+ * @n_points: число точек амплитуды
+ * @noise: признак шумовых данных
+ * @value: значение навигационного параметра
+ *
+ * Строка данных, отправляемая проигрывателем.
+ */
+typedef struct
+{
+  guint                        source;
+  guint32                      index;
+  gint64                       time;
+  const gfloat                *amplitude;
+  guint32                      n_points;
+  gboolean                     noise;
+  gdouble                      value;
+} HyScanTrackPlayerLine;
+
+#define HYSCAN_TYPE_TRACK_PLAYER             (hyscan_track_player_get_type ())
+#define HYSCAN_TRACK_PLAYER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_TRACK_PLAYER, HyScanTrackPlayer))
+#define HYSCAN_IS_TRACK_PLAYER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_TRACK_PLAYER))
+#define HYSCAN_TRACK_PLAYER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_TRACK_PLAYER, HyScanTrackPlayerClass))
+#define HYSCAN_IS_TRACK_PLAYER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_TRACK_PLAYER))
+#define HYSCAN_TRACK_PLAYER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_TRACK_PLAYER, HyScanTrackPlayerClass))
+
+typedef struct _HyScanTrackPlayer HyScanTrackPlayer;
+typedef struct _HyScanTrackPlayerPrivate HyScanTrackPlayerPrivate;
+typedef struct _HyScanTrackPlayerClass HyScanTrackPlayerClass;
+
+struct _HyScanTrackPlayer
+{
+  GObject parent_instance;
+
+  HyScanTrackPlayerPrivate *priv;
+};
+
+struct _HyScanTrackPlayerClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_track_player_get_type            (void);
+
+HYSCAN_API
+HyScanTrackPlayer *    hyscan_track_player_new                 (void);
+
+HYSCAN_API
+void                   hyscan_track_player_set_fps             (HyScanTrackPlayer     *player,
+                                                                guint                  fps);
+
+HYSCAN_API
+guint                  hyscan_track_player_add_amplitude       (HyScanTrackPlayer     *player,
+                                                                HyScanAmplitude       *amplitude);
+
+HYSCAN_API
+guint                  hyscan_track_player_add_nav_data        (HyScanTrackPlayer     *player,
+                                                                HyScanNavData         *ndata);
+
+HYSCAN_API
+void                   hyscan_track_player_clear               (HyScanTrackPlayer     *player);
+
+HYSCAN_API
+void                   hyscan_track_player_real_time           (HyScanTrackPlayer     *player);
+
+HYSCAN_API
+void                   hyscan_track_player_play                (HyScanTrackPlayer     *player,
+                                                                gdouble                speed);
+
+HYSCAN_API
+void                   hyscan_track_player_pause               (HyScanTrackPlayer     *player);
+
+HYSCAN_API
+void                   hyscan_track_player_stop                (HyScanTrackPlayer     *player);
+
+HYSCAN_API
+void                   hyscan_track_player_seek                (HyScanTrackPlayer     *player,
+                                                                gint64                 time);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_TRACK_PLAYER_H__ */
@@ -0,0 +1,407 @@
+/* control-reduce-test.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-control-proxy-reduce.h>
+#include <hyscan-control-proxy-plan.h>
+#include <math.h>
+
+#define MAX_ERROR      1e-5                  /* Максимальная погрешность вычислений. */
+#define N_POINTS       2                     /* Число выходных точек. */
+#define SCALE          3                     /* Коэффициент прореживания. */
+
+/* Входные комплексные данные. Амплитуды отсчётов: 5, 1, 2, 1, 0, 10. */
+static const HyScanComplexFloat complex_input[N_POINTS * SCALE] =
+{
+  {  3.0f, 4.0f }, { 0.0f,  1.0f }, { 0.0f, -2.0f },
+  {  1.0f, 0.0f }, { 0.0f,  0.0f }, {-6.0f,  8.0f }
+};
+
+/* Входные амплитудные данные, совпадающие с амплитудами комплексных. */
+static const gfloat amplitude_input[N_POINTS * SCALE] =
+{
+  5.0f, 1.0f, 2.0f,
+  1.0f, 0.0f, 10.0f
+};
+
+/* Ожидаемые значения для каждого способа объединения. */
+static gfloat reduce_expected[4][N_POINTS];
+
+static void              check_values            (const gchar              *name,
+                                                  const gfloat             *values,
+                                                  const gfloat             *expected,
+                                                  guint32                   n_points);
+static void              check_reduce_complex    (void);
+static void              check_reduce_amplitude  (void);
+static void              check_merge_line        (void);
+static void              check_reduce_doa        (void);
+static void              check_scale_update      (void);
+static HyScanControlProxyPlan *
+                         plan_new                (gint64                    time);
+static void              check_plans             (GQueue                   *plans,
+                                                  const gchar              *name,
+                                                  const gint64             *times,
+                                                  guint                     n_times);
+static void              check_plan_queue        (void);
+
+/* Функция сравнивает результат с ожидаемыми значениями. */
+static void
+check_values (const gchar  *name,
+              const gfloat *values,
+              const gfloat *expected,
+              guint32       n_points)
+{
+  guint32 i;
+
+  for (i = 0; i < n_points; i++)
+    {
+      if (fabs (values[i] - expected[i]) > MAX_ERROR)
+        {
+          g_error ("%s: point %d value %f, expected %f",
+                   name, i, values[i], expected[i]);
+        }
+    }
+}
+
+/* Функция проверяет вычисление амплитуды комплексных данных. */
+static void
+check_reduce_complex (void)
+{
+  HyScanControlProxyReduce reduce;
+  gfloat amplitude[N_POINTS];
+
+  for (reduce = HYSCAN_CONTROL_PROXY_REDUCE_SKIP; reduce <= HYSCAN_CONTROL_PROXY_REDUCE_RMS; reduce++)
+    {
+      hyscan_control_proxy_reduce_complex (complex_input, amplitude, N_POINTS, SCALE, reduce);
+      check_values ("reduce complex", amplitude, reduce_expected[reduce], N_POINTS);
+    }
+
+  /* Без прореживания все способы объединения дают амплитуду отсчёта. */
+  for (reduce = HYSCAN_CONTROL_PROXY_REDUCE_SKIP; reduce <= HYSCAN_CONTROL_PROXY_REDUCE_RMS; reduce++)
+    {
+      gfloat full[N_POINTS * SCALE];
+
+      hyscan_control_proxy_reduce_complex (complex_input, full, N_POINTS * SCALE, 1, reduce);
+      check_values ("reduce complex without scale", full, amplitude_input, N_POINTS * SCALE);
+    }
+}
+
+/* Функция проверяет прореживание амплитудных данных. */
+static void
+check_reduce_amplitude (void)
+{
+  HyScanControlProxyReduce reduce;
+  gfloat amplitude[N_POINTS];
+
+  for (reduce = HYSCAN_CONTROL_PROXY_REDUCE_SKIP; reduce <= HYSCAN_CONTROL_PROXY_REDUCE_RMS; reduce++)
+    {
+      hyscan_control_proxy_reduce_amplitude (amplitude_input, amplitude, N_POINTS, SCALE, reduce);
+      check_values ("reduce amplitude", amplitude, reduce_expected[reduce], N_POINTS);
+    }
+}
+
+/* Функция проверяет объединение строк. Для среднего и среднеквадратичного
+ * значений функция накапливает сумму амплитуд и сумму их квадратов. */
+static void
+check_merge_line (void)
+{
+  static const gfloat line[N_POINTS] = { 3.0f, 2.0f };
+  static const gfloat expected[4][N_POINTS] =
+  {
+    { 3.0f, 2.0f },
+    { 4.0f, 6.0f },
+    { 3.0f, 4.0f },
+    { 10.0f, 8.0f }
+  };
+
+  HyScanControlProxyReduce reduce;
+
+  for (reduce = HYSCAN_CONTROL_PROXY_REDUCE_SKIP; reduce <= HYSCAN_CONTROL_PROXY_REDUCE_RMS; reduce++)
+    {
+      gfloat merged[N_POINTS] = { 1.0f, 4.0f };
+
+      hyscan_control_proxy_merge_line (merged, line, N_POINTS, reduce);
+      check_values ("merge line", merged, expected[reduce], N_POINTS);
+    }
+}
+
+/* Функция проверяет вычисление амплитуды и разности фаз между каналами
+ * вперёдсмотрящего локатора. Во второй группе амплитуды отсчётов разные,
+ * поэтому способы объединения дают разные значения. */
+static void
+check_reduce_doa (void)
+{
+  static const gfloat amplitude_expected[4][2] =
+  {
+    { 4.0f, 1.0f },
+    { 4.0f, 2.0f },
+    { 4.0f, 3.0f },
+    { 4.0f, 2.2360680f }
+  };
+
+  HyScanComplexFloat data1[4];
+  HyScanComplexFloat data2[4];
+  HyScanComplexFloat cross[4];
+  HyScanComplexFloat output[2];
+  HyScanControlProxyReduce reduce;
+  gdouble phase[2] = { 0.3, -2.0 };
+  gdouble phase_step = 2.0 * G_PI / 16;
+  gfloat module1[4] = { 2.0f, 2.0f, 1.0f, 3.0f };
+  gfloat module2[4] = { 8.0f, 8.0f, 1.0f, 3.0f };
+  guint i;
+
+  for (i = 0; i < 4; i++)
+    {
+      data1[i].re = module1[i];
+      data1[i].im = 0.0f;
+      data2[i].re = module2[i] * cos (phase[i / 2]);
+      data2[i].im = module2[i] * sin (phase[i / 2]);
+    }
+
+  for (reduce = HYSCAN_CONTROL_PROXY_REDUCE_SKIP; reduce <= HYSCAN_CONTROL_PROXY_REDUCE_RMS; reduce++)
+    {
+      hyscan_control_proxy_reduce_doa (data1, data2, cross, output, 2, 2, 16, reduce);
+
+      for (i = 0; i < 2; i++)
+        {
+          gfloat amplitude = amplitude_expected[reduce][i];
+          gdouble quantized = phase_step * rint (phase[i] / phase_step);
+          gfloat values[2];
+          gfloat expected[2];
+
+          values[0] = output[i].re;
+          values[1] = output[i].im;
+
+          expected[0] = amplitude * cos (quantized);
+          expected[1] = amplitude * sin (quantized);
+
+          check_values ("reduce doa", values, expected, 2);
+        }
+    }
+}
+
+/* Функция проверяет изменение коэффициента прореживания по строкам
+ * в зависимости от нагрузки. */
+static void
+check_scale_update (void)
+{
+  guint scale = 1;
+  guint calm = 0;
+  guint i;
+
+  /* При высокой нагрузке коэффициент удваивается до максимального. */
+  for (i = 0; i < 6; i++)
+    scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.9, 0.0, &calm);
+  if (scale != 32)
+    g_error ("scale update: high load scale %d, expected 32", scale);
+
+  /* При потере строк коэффициент также увеличивается. */
+  scale = hyscan_control_proxy_scale_update (4, 2, 32, 0.0, 0.05, &calm);
+  if (scale != 8)
+    g_error ("scale update: drop scale %d, expected 8", scale);
+
+  /* Коэффициент уменьшается только после нескольких интервалов подряд
+   * с низкой нагрузкой и не становится меньше минимального. */
+  scale = 4;
+  calm = 0;
+  for (i = 0; i < 2; i++)
+    scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  if (scale != 4)
+    g_error ("scale update: early decrease to %d", scale);
+
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  if (scale != 3)
+    g_error ("scale update: low load scale %d, expected 3", scale);
+
+  for (i = 0; i < 6; i++)
+    scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  if (scale != 2)
+    g_error ("scale update: scale %d below minimum", scale);
+
+  /* Средняя нагрузка и единичные потери сбрасывают счётчик интервалов. */
+  scale = 4;
+  calm = 0;
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.5, 0.0, &calm);
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.01, &calm);
+  scale = hyscan_control_proxy_scale_update (scale, 2, 32, 0.1, 0.0, &calm);
+  if (scale != 4)
+    g_error ("scale update: calm counter is not reset");
+}
+
+/* Функция создаёт образ сигнала без данных. */
+static HyScanControlProxyPlan *
+plan_new (gint64 time)
+{
+  HyScanControlProxyPlan *plan = g_slice_new0 (HyScanControlProxyPlan);
+
+  plan->time = time;
+
+  return plan;
+}
+
+/* Функция проверяет времена начала действия сигналов в очереди. */
+static void
+check_plans (GQueue       *plans,
+             const gchar  *name,
+             const gint64 *times,
+             guint         n_times)
+{
+  guint i;
+
+  if (g_queue_get_length (plans) != n_times)
+    g_error ("plan queue %s: length %d, expected %d", name, g_queue_get_length (plans), n_times);
+
+  for (i = 0; i < n_times; i++)
+    {
+      HyScanControlProxyPlan *plan = g_queue_peek_nth (plans, i);
+
+      if (plan->time != times[i])
+        g_error ("plan queue %s: time %" G_GINT64_FORMAT ", expected %" G_GINT64_FORMAT,
+                 name, plan->time, times[i]);
+    }
+}
+
+/* Функция проверяет очередь образов сигналов и выбор сигнала по времени. */
+static void
+check_plan_queue (void)
+{
+  HyScanControlProxyPlan *replace;
+  HyScanControlProxyPlan *plan;
+  GQueue plans = G_QUEUE_INIT;
+  const gint64 ordered[] = { 100, 200, 300 };
+  const gint64 replaced[] = { 100, 200 };
+  const gint64 capped[] = { 300, 400 };
+
+  hyscan_control_proxy_plan_push (&plans, plan_new (100), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (200), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (300), 0);
+  check_plans (&plans, "ordered", ordered, G_N_ELEMENTS (ordered));
+
+  /* Новый сигнал отменяет ещё не применённые сигналы с тем же или более
+   * поздним временем начала действия. */
+  replace = plan_new (200);
+  hyscan_control_proxy_plan_push (&plans, replace, 0);
+  check_plans (&plans, "replaced", replaced, G_N_ELEMENTS (replaced));
+  if (g_queue_peek_tail (&plans) != replace)
+    g_error ("plan queue: signal is not replaced");
+
+  /* Данные до начала действия всех сигналов. */
+  if (hyscan_control_proxy_plan_select (&plans, 50) != NULL)
+    g_error ("plan queue: signal selected before its start");
+
+  /* Выбирается сигнал, начавший действовать не позже времени данных. */
+  plan = hyscan_control_proxy_plan_select (&plans, 150);
+  if ((plan == NULL) || (plan->time != 100) || (g_queue_get_length (&plans) != 1))
+    g_error ("plan queue: wrong signal selected at 150");
+  hyscan_control_proxy_plan_free (plan);
+
+  /* Граница начала действия сигнала включается. */
+  plan = hyscan_control_proxy_plan_select (&plans, 200);
+  if ((plan != replace) || !g_queue_is_empty (&plans))
+    g_error ("plan queue: wrong signal selected at 200");
+  hyscan_control_proxy_plan_free (plan);
+
+  /* Из нескольких начавших действовать сигналов выбирается последний. */
+  hyscan_control_proxy_plan_push (&plans, plan_new (100), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (200), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (300), 0);
+  plan = hyscan_control_proxy_plan_select (&plans, 250);
+  if ((plan == NULL) || (plan->time != 200) || (g_queue_get_length (&plans) != 1))
+    g_error ("plan queue: wrong signal selected at 250");
+  hyscan_control_proxy_plan_free (plan);
+  while (!g_queue_is_empty (&plans))
+    hyscan_control_proxy_plan_free (g_queue_pop_head (&plans));
+
+  /* Из сигналов, начавшихся до последних обработанных данных, в очереди
+   * остаётся только последний. */
+  hyscan_control_proxy_plan_push (&plans, plan_new (100), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (200), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (300), 0);
+  hyscan_control_proxy_plan_push (&plans, plan_new (400), 350);
+  check_plans (&plans, "capped", capped, G_N_ELEMENTS (capped));
+
+  plan = hyscan_control_proxy_plan_select (&plans, 350);
+  if ((plan == NULL) || (plan->time != 300))
+    g_error ("plan queue: wrong signal selected at 350");
+  hyscan_control_proxy_plan_free (plan);
+
+  while (!g_queue_is_empty (&plans))
+    hyscan_control_proxy_plan_free (g_queue_pop_head (&plans));
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  /* Прореживание без объединения. */
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_SKIP][0] = 5.0f;
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_SKIP][1] = 1.0f;
+
+  /* Среднее значение. */
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_MEAN][0] = 8.0f / 3.0f;
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_MEAN][1] = 11.0f / 3.0f;
+
+  /* Максимальное значение. */
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_MAX][0] = 5.0f;
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_MAX][1] = 10.0f;
+
+  /* Среднеквадратичное значение. */
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_RMS][0] = sqrt (30.0 / 3.0);
+  reduce_expected[HYSCAN_CONTROL_PROXY_REDUCE_RMS][1] = sqrt (101.0 / 3.0);
+
+  g_message ("Test complex data reduction");
+  check_reduce_complex ();
+
+  g_message ("Test amplitude data reduction");
+  check_reduce_amplitude ();
+
+  g_message ("Test line merging");
+  check_merge_line ();
+
+  g_message ("Test forward-look data reduction");
+  check_reduce_doa ();
+
+  g_message ("Test automatic line scale");
+  check_scale_update ();
+
+  g_message ("Test signal selection by time");
+  check_plan_queue ();
+
+  g_message ("All done");
+
+  return 0;
+}
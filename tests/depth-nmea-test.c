@@ -1,18 +1,28 @@
-#include <hyscan-depth-nmea.h>
+#include <hyscan-nav-store.h>
+#include <hyscan-depthometer.h>
 #include <hyscan-data-writer.h>
 #include <hyscan-cached.h>
+#include "hyscan-nmea-gen.h"
 #include <string.h>
+#include <math.h>
 
 #define CHANNEL 3
-#define DB_TIME_START 1e10
-#define DB_TIME_INC 1e6
+#define DB_TIME_START G_GINT64_CONSTANT (10000000000)
+#define DB_TIME_INC 1000000
 #define SAMPLES 100
-
-gint64    time_for_index   (guint32 index);
-gchar     dec_to_ascii     (gint    dec);
-gchar    *generate_string  (gfloat  seed);
-gboolean  compare_position (HyScanAntennaPosition p1,
-                            HyScanAntennaPosition p2);
+#define FILTER_SIZE 8
+#define SPIKE_PERIOD 10
+#define SPIKE_DEPTH 1000
+
+gint64    time_for_index   (guint32           index);
+gint      depth_for_index  (guint32           index,
+                            gboolean          spikes);
+void      write_track      (HyScanDataWriter *writer,
+                            const gchar      *project,
+                            const gchar      *track,
+                            gboolean          spikes);
+void      check_linear     (HyScanNavData    *ndata);
+void      check_outliers   (HyScanNavData    *ndata);
 
 int
 main (int argc, char **argv)
@@ -24,15 +34,11 @@ main (int argc, char **argv)
   HyScanCache *cache;
 
   /* Запись данных. */
-  HyScanBuffer          *buffer;
-  HyScanDataWriter      *writer;
-  HyScanAntennaPosition  position;
+  HyScanDataWriter *writer;
 
   /* Тестируемые объекты.*/
-  HyScanDepthNMEA *nmea;
-  HyScanDepth     *idepth;
-
-  gint i;
+  HyScanNavStore *linear;
+  HyScanNavStore *outliers;
 
   /* Парсим аргументы. */
   {
@@ -77,182 +83,232 @@ main (int argc, char **argv)
   /* Система хранения. */
   hyscan_data_writer_set_db (writer, db);
 
-  if (!hyscan_data_writer_start (writer, name, name, HYSCAN_TRACK_SURVEY))
-    g_error ("can't start write");
+  /* Галс с линейно растущей глубиной и галс с выбросами. */
+  write_track (writer, name, "linear", FALSE);
+  write_track (writer, name, "outliers", TRUE);
+  hyscan_data_writer_stop (writer);
 
-  /* Местоположение приёмных антенн. */
-  position.x = 10;
-  position.y = 20;
-  position.z = 30;
-  position.psi = 40;
-  position.gamma = 50;
-  position.theta = 60;
-  hyscan_data_writer_sensor_set_offset (writer, "sensor", &position);
+  /* Теперь потестируем объект. */
+  linear = hyscan_nav_store_new (db, name, "linear", CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  outliers = hyscan_nav_store_new (db, name, "outliers", CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  if (linear == NULL || outliers == NULL)
+    g_error ("Object creation failure");
 
-  /* Наполняем данными. */
-  buffer = hyscan_buffer_new ();
+  hyscan_nav_data_set_cache (HYSCAN_NAV_DATA (linear), cache);
+  hyscan_nav_data_set_cache (HYSCAN_NAV_DATA (outliers), cache);
 
-  for (i = 0; i < SAMPLES; i++)
-    {
-      gchar *data = generate_string (i);
+  check_linear (HYSCAN_NAV_DATA (linear));
+  check_outliers (HYSCAN_NAV_DATA (outliers));
 
-      hyscan_buffer_wrap_data (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
-      hyscan_data_writer_sensor_add_data (writer, "sensor", HYSCAN_SOURCE_NMEA_DPT, CHANNEL, time_for_index (i), buffer);
+  hyscan_db_project_remove (db, name);
 
-      g_free (data);
-    }
+  g_clear_object (&linear);
+  g_clear_object (&outliers);
+  g_clear_object (&writer);
+  g_clear_object (&cache);
+  g_clear_object (&db);
 
-  /* Теперь потестируем объект. */
-  nmea = hyscan_depth_nmea_new (db, name, name, CHANNEL);
-  idepth = HYSCAN_DEPTH (nmea);
+  g_free (db_uri);
 
-  /* hyscan_depth_get_range */
-  {
-    guint32 dclindex, dcrindex;
-    gboolean status;
+  g_message ("test passed");
+  return 0;
+}
 
-    status = hyscan_depth_get_range (idepth, &dclindex, &dcrindex);
+gint64
+time_for_index (guint32 index)
+{
+  return DB_TIME_START + index * DB_TIME_INC;
+}
 
-    if (dcrindex - dclindex + 1 != SAMPLES || !status)
-      g_error ("Failed to get data range");
-  }
+/* Глубина растёт на 1 метр с каждой записью. В галсе с выбросами каждая
+ * SPIKE_PERIOD-я запись заменена ложным отражением на глубине SPIKE_DEPTH. */
+gint
+depth_for_index (guint32  index,
+                 gboolean spikes)
+{
+  if (spikes && (index % SPIKE_PERIOD == SPIKE_PERIOD / 2))
+    return SPIKE_DEPTH;
 
-  /* hyscan_depth_find_data */
-  {
-    guint32 lindex, rindex, index;
-    gint64 ltime, rtime;
-    HyScanDBFindStatus status;
+  return 10 + index;
+}
 
-    status = hyscan_depth_find_data (idepth, 0, NULL, NULL, NULL, NULL);
-    if (status != HYSCAN_DB_FIND_LESS)
-      g_error ("Failed to find data");
+/* Функция записывает галс из SAMPLES сообщений DPT. */
+void
+write_track (HyScanDataWriter *writer,
+             const gchar      *project,
+             const gchar      *track,
+             gboolean          spikes)
+{
+  HyScanAntennaOffset offset = {0};
+  HyScanBuffer *buffer;
+  guint32 i;
 
-    status = hyscan_depth_find_data (idepth, time_for_index (SAMPLES + 10), &lindex, &rindex, &ltime, &rtime);
+  if (!hyscan_data_writer_start (writer, project, track, HYSCAN_TRACK_SURVEY, NULL, -1))
+    g_error ("can't start write");
 
-    if (status != HYSCAN_DB_FIND_GREATER)
-      g_error ("Failed to find data");
+  hyscan_data_writer_sensor_set_offset (writer, "sensor", &offset);
 
-    /* Найдем данные для произвольного индекса. */
-    index = SAMPLES / 2;
+  buffer = hyscan_buffer_new ();
+  for (i = 0; i < SAMPLES; i++)
+    {
+      gchar *data = hyscan_nmea_gen_sentence ("SDDPT,%d.0,0.0", depth_for_index (i, spikes));
 
-    status = hyscan_depth_find_data (idepth, time_for_index (index) + 1, &lindex, &rindex, &ltime, &rtime);
-    if (status != HYSCAN_DB_FIND_OK ||
-        lindex != index ||
-        rindex != index + 1 ||
-        ltime != time_for_index (index) ||
-        rtime != time_for_index (index + 1))
-      {
-        g_error ("Failed to find data");
-      }
-  }
-  /* hyscan_depth_get_position */
-  {
-    HyScanAntennaPosition acquired = hyscan_depth_get_position (idepth);
+      hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+      hyscan_data_writer_sensor_add_data (writer, "sensor", HYSCAN_SOURCE_NMEA, CHANNEL,
+                                          time_for_index (i), buffer);
 
-    if (!compare_position (acquired, position))
-      g_error ("Antenna positions are not equal");
-  }
+      g_free (data);
+    }
 
-  /* hyscan_depth_is_writable */
-  {
-    gboolean true_expected, false_expected;
-    true_expected = hyscan_depth_is_writable (idepth);
-    hyscan_data_writer_stop (writer);
-    false_expected = hyscan_depth_is_writable (idepth);
+  g_object_unref (buffer);
+}
 
-    if (true_expected != TRUE || false_expected != FALSE)
-      g_error ("Data channel writeability fail");
-  }
+/* Функция проверяет скользящее окно глубиномера на линейном профиле. */
+void
+check_linear (HyScanNavData *ndata)
+{
+  HyScanDepthometer *meter;
+  gint64 *times;
+  gdouble *depths;
+  gint n_times = 2 * (SAMPLES - 1);
+  gint i;
 
-  /* hyscan_depth_get */
-  {
-    gdouble val;
-    for (i = 0; i < SAMPLES; i++)
-      {
-        val = hyscan_depth_get (idepth, i, NULL);
-        if (val != (gdouble)i)
-          g_error ("Failed to get data at index %i", i);
-      }
-  }
+  meter = hyscan_depthometer_new (ndata);
+  hyscan_depthometer_set_filter_size (meter, 4);
+
+  /* Моменты времени в записях и между ними. */
+  times = g_new (gint64, n_times);
+  depths = g_new (gdouble, n_times);
+  for (i = 0; i < n_times; i++)
+    times[i] = DB_TIME_START + i * (DB_TIME_INC / 2);
+
+  if (hyscan_depthometer_get_many (meter, times, n_times, depths) != (guint) n_times)
+    g_error ("Depthometer count mismatch");
+
+  /* Вдали от краёв среднее по окну линейного профиля совпадает с ним. */
+  for (i = 2; i < n_times - 2; i++)
+    {
+      if (fabs (depths[i] - (10.0 + i / 2.0)) > 1e-9)
+        g_error ("Depthometer batch mismatch at %d: %f", i, depths[i]);
+    }
 
-  /* hyscan_depth_get с кэшем. */
-  hyscan_depth_set_cache (idepth, cache);
+  /* На линейном профиле медиана и фильтр Хампеля совпадают со средним. */
   {
-    gdouble val;
-    for (i = 0; i < SAMPLES; i++)
+    HyScanDepthometerFilter filters[] = { HYSCAN_DEPTHOMETER_FILTER_MEDIAN,
+                                          HYSCAN_DEPTHOMETER_FILTER_HAMPEL };
+    gdouble *filtered = g_new (gdouble, n_times);
+    guint f;
+
+    for (f = 0; f < G_N_ELEMENTS (filters); f++)
       {
-        /* Считываем дважды, чтобы гарантированно данные
-         * оказались в кэше. */
-        val = hyscan_depth_get (idepth, i, NULL);
-        val = hyscan_depth_get (idepth, i, NULL);
-        if (val != (gdouble)i)
-          g_error ("Failed to get data at index %i", i);
+        hyscan_depthometer_set_filter (meter, filters[f]);
+        hyscan_depthometer_get_many (meter, times, n_times, filtered);
+
+        for (i = 2; i < n_times - 2; i++)
+          {
+            if (fabs (filtered[i] - depths[i]) > 1e-9)
+              g_error ("Depthometer filter %d mismatch at %d: %f", filters[f], i, filtered[i]);
+          }
       }
-  }
 
-  hyscan_db_project_remove (db, name);
+    hyscan_depthometer_set_filter (meter, HYSCAN_DEPTHOMETER_FILTER_MEAN);
+    g_free (filtered);
+  }
 
-  g_clear_object (&db);
-  g_clear_object (&cache);
-  g_clear_object (&writer);
-  g_clear_object (&buffer);
-  g_clear_object (&nmea);
+  /* Последовательные и произвольные одиночные запросы дают тот же результат. */
+  for (i = 0; i < n_times; i++)
+    {
+      gint j = (i % 2) ? i : n_times - 1 - i;
 
-  g_free (db_uri);
+      if (fabs (hyscan_depthometer_get (meter, times[j]) - depths[j]) > 1e-9)
+        g_error ("Depthometer single mismatch at %d", j);
+    }
 
-  g_message ("test passed");
-  return 0;
-}
+  /* Профиль глубины совпадает с прямым расчётом. */
+  {
+    HyScanDepthProfile *profile = hyscan_depthometer_get_profile (meter);
 
-gint64
-time_for_index (guint32 index)
-{
-  return DB_TIME_START + index * DB_TIME_INC;
-}
+    if (profile == NULL)
+      g_error ("Depth profile failure");
 
-gchar
-dec_to_ascii (gint dec)
-{
-  if (dec >= 0x0 && dec <= 0x9)
-    return dec + '0';
+    for (i = 0; i < n_times; i++)
+      {
+        if (fabs (hyscan_depth_profile_get (profile, times[i]) - depths[i]) > 1e-9)
+          g_error ("Depth profile mismatch at %d", i);
+      }
 
-  if (dec >= 0xA && dec <= 0xF)
-    return dec -10 + 'A';
+    hyscan_depth_profile_unref (profile);
+  }
 
-  return 'z';
+  g_free (times);
+  g_free (depths);
+  g_object_unref (meter);
 }
 
-gchar*
-generate_string (gfloat seed)
+/* Функция проверяет фильтры глубиномера на профиле с выбросами. Глубина
+ * запрашивается посередине между записями, вдали от краёв данных. В окне из
+ * FILTER_SIZE записей оказывается не больше одного выброса: среднее уходит
+ * от линейного профиля на десятки метров, а медиана и фильтр Хампеля
+ * отклоняются от него не больше чем на шаг профиля. */
+void
+check_outliers (HyScanNavData *ndata)
 {
-  gchar *out, *inner, *ch;
-  gchar cs1, cs2;
-
-  gint checksum = 0;
-
-  inner = g_strdup_printf ("HSDPT,%f,", seed);
-
-  /* Подсчитываем чек-сумму. */
-  for (ch = inner; *ch != '\0'; ch++)
-    checksum ^= *ch;
+  HyScanDepthometerFilter filters[] = { HYSCAN_DEPTHOMETER_FILTER_MEAN,
+                                        HYSCAN_DEPTHOMETER_FILTER_MEDIAN,
+                                        HYSCAN_DEPTHOMETER_FILTER_HAMPEL };
+  HyScanDepthometer *meter;
+  gint64 *times;
+  gdouble *depths;
+  gint first = FILTER_SIZE / 2;
+  gint n_times = SAMPLES - FILTER_SIZE;
+  guint f;
+  gint i;
 
-  cs1 = dec_to_ascii (checksum / 16);
-  cs2 = dec_to_ascii (checksum % 16);
+  meter = hyscan_depthometer_new (ndata);
+  hyscan_depthometer_set_filter_size (meter, FILTER_SIZE);
 
-  out = g_strdup_printf ("$%s*%c%c", inner, cs1, cs2);
-  g_free (inner);
+  times = g_new (gint64, n_times);
+  depths = g_new (gdouble, n_times);
+  for (i = 0; i < n_times; i++)
+    times[i] = time_for_index (first + i) + DB_TIME_INC / 2;
 
-  return out;
-}
+  for (f = 0; f < G_N_ELEMENTS (filters); f++)
+    {
+      HyScanDepthProfile *profile;
+      gdouble max_error = 0.0;
+
+      hyscan_depthometer_set_filter (meter, filters[f]);
+      if (hyscan_depthometer_get_many (meter, times, n_times, depths) != (guint) n_times)
+        g_error ("Depthometer filter %d count mismatch", filters[f]);
+
+      for (i = 0; i < n_times; i++)
+        max_error = MAX (max_error, fabs (depths[i] - (10.0 + first + i + 0.5)));
+
+      if (filters[f] == HYSCAN_DEPTHOMETER_FILTER_MEAN)
+        {
+          if (max_error < 10.0)
+            g_error ("Depthometer mean ignores outliers: %f", max_error);
+        }
+      else if (max_error > 1.0 + 1e-9)
+        {
+          g_error ("Depthometer filter %d doesn't reject outliers: %f", filters[f], max_error);
+        }
+
+      /* Профиль рассчитывается тем же фильтром. */
+      profile = hyscan_depthometer_get_profile (meter);
+      if (profile == NULL)
+        g_error ("Depth profile failure");
+
+      for (i = 0; i < n_times; i++)
+        {
+          if (fabs (hyscan_depth_profile_get (profile, times[i]) - depths[i]) > 1e-9)
+            g_error ("Depth profile filter %d mismatch at %d", filters[f], i);
+        }
+
+      hyscan_depth_profile_unref (profile);
+    }
 
-gboolean
-compare_position (HyScanAntennaPosition p1,
-                  HyScanAntennaPosition p2)
-{
-  return (p1.x == p2.x &&
-          p1.y == p2.y &&
-          p1.z == p2.z &&
-          p1.psi == p2.psi &&
-          p1.gamma == p2.gamma &&
-          p1.theta == p2.theta);
+  g_free (times);
+  g_free (depths);
+  g_object_unref (meter);
 }
@@ -34,11 +34,13 @@
 
 #include <hyscan-forward-look-data.h>
 #include <hyscan-cached.h>
+#include <math.h>
 
 #include "hyscan-fl-gen.h"
 
 #define PROJECT_NAME           "test"
 #define TRACK_NAME             "track"
+#define REDUCED_TRACK_NAME     "reduced-track"
 #define SOUND_VELOCITY         1000.0
 
 int main( int argc, char **argv )
@@ -200,6 +202,103 @@ int main( int argc, char **argv )
         break;
     }
 
+  /* Проверяем параллельную обработку диапазона строк с отдельным кэшем.
+   * Потоки обработки выполняют расчёт при опорной скорости звука, поэтому
+   * результат сравнивается с построчной обработкой при заданной скорости. */
+  {
+    HyScanCache *range_cache;
+    HyScanForwardLookData *range_reader;
+    GTimer *timer = g_timer_new ();
+    gdouble alpha;
+    guint32 n_done;
+
+    g_message ("Parallel range processing");
+
+    range_cache = HYSCAN_CACHE (hyscan_cached_new ((cache_size > 0) ? cache_size : 64));
+    range_reader = hyscan_forward_look_data_new (db, range_cache, PROJECT_NAME, TRACK_NAME);
+    hyscan_forward_look_data_set_sound_velocity (range_reader, SOUND_VELOCITY);
+    alpha = hyscan_forward_look_data_get_alpha (range_reader);
+
+    n_done = hyscan_forward_look_data_process_range (range_reader, 0, n_lines - 1);
+    g_message ("Elapsed %.6fs", g_timer_elapsed (timer, NULL));
+
+    if (n_done != n_lines)
+      g_error ("range processing error");
+
+    for (i = 0; i < n_lines; i++)
+      {
+        const HyScanDOA *doa;
+        HyScanDOA *direct;
+        guint32 doa_size;
+
+        doa = hyscan_forward_look_data_get_doa (reader, i, &doa_size, NULL);
+        if ((doa == NULL) || (doa_size != n_points))
+          g_error ("can't get doa values");
+        direct = g_memdup (doa, doa_size * sizeof (HyScanDOA));
+
+        doa = hyscan_forward_look_data_get_doa (range_reader, i, &doa_size, NULL);
+        if ((doa == NULL) || (doa_size != n_points))
+          g_error ("can't get doa values");
+
+        if (!hyscan_fl_gen_check (doa, doa_size, 1000 * (i + 1), alpha))
+          g_error ("doa data error");
+
+        for (j = 0; j < doa_size; j++)
+          {
+            if ((fabs (doa[j].distance - direct[j].distance) > 1e-3) ||
+                (fabs (doa[j].angle - direct[j].angle) > 1e-3) ||
+                (fabs (doa[j].amplitude - direct[j].amplitude) > 1e-3))
+              {
+                g_error ("range processing mismatch at line %d point %d", i, j);
+              }
+          }
+
+        g_free (direct);
+      }
+
+    g_timer_destroy (timer);
+    g_object_unref (range_reader);
+    g_object_unref (range_cache);
+  }
+
+  /* Проверяем обработку сокращённого потока данных. */
+  {
+    HyScanForwardLookData *reduced_reader;
+    gdouble alpha;
+
+    g_message ("Reduced stream check");
+
+    hyscan_fl_gen_set_reduced (generator, TRUE);
+    if (!hyscan_fl_gen_set_track (generator, db, PROJECT_NAME, REDUCED_TRACK_NAME))
+      g_error ("can't set working project");
+
+    for (i = 0; i < n_lines; i++)
+      if (!hyscan_fl_gen_generate (generator, n_points, 1000 * (i + 1)))
+        g_error ("can't generate data");
+
+    reduced_reader = hyscan_forward_look_data_new (db, NULL, PROJECT_NAME, REDUCED_TRACK_NAME);
+    if (reduced_reader == NULL)
+      g_error ("can't create forward look data processor");
+
+    hyscan_forward_look_data_set_sound_velocity (reduced_reader, SOUND_VELOCITY);
+    alpha = hyscan_forward_look_data_get_alpha (reduced_reader);
+
+    for (i = 0; i < n_lines; i++)
+      {
+        const HyScanDOA *doa;
+        guint32 doa_size;
+
+        doa = hyscan_forward_look_data_get_doa (reduced_reader, i, &doa_size, NULL);
+        if ((doa == NULL) || (doa_size != n_points))
+          g_error ("can't get doa values");
+
+        if (!hyscan_fl_gen_check (doa, doa_size, 1000 * (i + 1), alpha))
+          g_error ("doa data error");
+      }
+
+    g_object_unref (reduced_reader);
+  }
+
   g_message ("All done");
 
   g_clear_object (&generator);
@@ -33,6 +33,7 @@
  */
 
 #include <hyscan-forward-look-player.h>
+#include <hyscan-forward-look-data.h>
 #include <hyscan-cached.h>
 
 #include <math.h>
@@ -42,12 +43,18 @@
 #define PROJECT_NAME           "test"
 #define STATIC_TRACK_NAME      "static"
 #define DYNAMIC_TRACK_NAME     "dynamic"
+#define SOUND_VELOCITY         1000.0
+#define N_AVERAGE              4
 
 enum {
   CONTROL_REAL_TIME_TEST,
   CONTROL_NORMAL_PLAY_TEST,
   CONTROL_REWIND_PLAY_TEST,
   CONTROL_SEEK_TEST,
+  CONTROL_PLAY_SEEK_TEST,
+  CONTROL_BOXCAR_TEST,
+  CONTROL_EXP_TEST,
+  CONTROL_AVERAGE_SEEK_TEST,
   CONTROL_END_TEST
 };
 
@@ -62,6 +69,7 @@ HyScanDB                      *db;
 HyScanCache                   *cache;
 HyScanForwardLookPlayer       *player;
 HyScanFLGen                   *generator;
+HyScanForwardLookData         *reference;
 
 GMainLoop                     *loop;
 GTimer                        *timer;
@@ -73,6 +81,126 @@ guint32                        check_index = 0;
 gboolean                       range_checked = TRUE;
 gboolean                       data_checked = TRUE;
 
+HyScanDOA                     *check_doa = NULL;
+guint32                        check_n_doa = 0;
+
+gdouble                       *exp_amplitude = NULL;
+gdouble                       *exp_angle = NULL;
+guint32                        exp_size = 0;
+gint64                         exp_index = -1;
+
+/* Функция рассчитывает ожидаемый результат скользящего среднего по
+ * N_AVERAGE зондированиям, заканчивающимся строкой index. */
+void
+average_boxcar (guint32 index)
+{
+  guint32 first = (index >= N_AVERAGE - 1) ? index - N_AVERAGE + 1 : 0;
+  guint32 n_frames = index - first + 1;
+  gdouble *amplitude;
+  gdouble *angle;
+  guint32 i, j;
+
+  g_free (check_doa);
+  check_doa = NULL;
+
+  amplitude = g_new0 (gdouble, n_points + index);
+  angle = g_new0 (gdouble, n_points + index);
+
+  for (i = first; i <= index; i++)
+    {
+      const HyScanDOA *doa;
+      guint32 n_doa;
+
+      doa = hyscan_forward_look_data_get_doa (reference, i, &n_doa, NULL);
+      if (doa == NULL)
+        g_error ("can't get reference data");
+
+      for (j = 0; j < n_doa; j++)
+        {
+          amplitude[j] += doa[j].amplitude;
+          angle[j] += doa[j].amplitude * doa[j].angle;
+        }
+
+      /* Дальность определяется текущим зондированием. */
+      if (i == index)
+        {
+          check_n_doa = n_doa;
+          check_doa = g_memdup (doa, n_doa * sizeof (HyScanDOA));
+        }
+    }
+
+  for (j = 0; j < check_n_doa; j++)
+    {
+      check_doa[j].amplitude = amplitude[j] / n_frames;
+      check_doa[j].angle = (amplitude[j] > 0.0) ? angle[j] / amplitude[j] : 0.0;
+    }
+
+  g_free (amplitude);
+  g_free (angle);
+}
+
+/* Функция рассчитывает ожидаемый результат экспоненциального среднего при
+ * переходе к строке index. При переходе более чем на N_AVERAGE строк
+ * накопитель заполняется заново. */
+void
+average_exp (guint32 index)
+{
+  const HyScanDOA *doa;
+  gdouble weight = 2.0 / (N_AVERAGE + 1.0);
+  gdouble decay = 1.0 - weight;
+  gint64 distance = ABS ((gint64)index - exp_index);
+  guint32 n_doa;
+  guint32 j;
+
+  doa = hyscan_forward_look_data_get_doa (reference, index, &n_doa, NULL);
+  if (doa == NULL)
+    g_error ("can't get reference data");
+
+  if (n_doa > exp_size)
+    {
+      exp_amplitude = g_renew (gdouble, exp_amplitude, n_doa);
+      exp_angle = g_renew (gdouble, exp_angle, n_doa);
+      for (j = exp_size; j < n_doa; j++)
+        exp_amplitude[j] = exp_angle[j] = 0.0;
+      exp_size = n_doa;
+    }
+
+  if ((exp_index < 0) || (distance > N_AVERAGE))
+    {
+      decay = 0.0;
+      weight = 1.0;
+    }
+  else if (distance == 0)
+    {
+      decay = 1.0;
+      weight = 0.0;
+    }
+
+  for (j = 0; j < exp_size; j++)
+    {
+      exp_amplitude[j] *= decay;
+      exp_angle[j] *= decay;
+    }
+
+  for (j = 0; j < n_doa; j++)
+    {
+      exp_amplitude[j] += weight * doa[j].amplitude;
+      exp_angle[j] += weight * doa[j].amplitude * doa[j].angle;
+    }
+
+  exp_index = index;
+
+  g_free (check_doa);
+  check_n_doa = n_doa;
+  check_doa = g_memdup (doa, n_doa * sizeof (HyScanDOA));
+
+  for (j = 0; j < n_doa; j++)
+    {
+      check_doa[j].amplitude = exp_amplitude[j];
+      check_doa[j].angle = (exp_amplitude[j] > 0.0) ? exp_angle[j] / exp_amplitude[j] : 0.0;
+    }
+}
+
 /* Функция тестирования. */
 gboolean
 control_test (gpointer user_data)
@@ -182,6 +310,106 @@ control_test (gpointer user_data)
       data_checked = FALSE;
     }
 
+  /* Тест перемотки во время воспроизведения. Переход на новую позицию
+   * не должен учитываться в статистике как пропуск строк. */
+  else if (test_step == CONTROL_PLAY_SEEK_TEST)
+    {
+      if (step_cnt == 0)
+        {
+          g_message ("Play seek test");
+
+          play_speed = 2.0;
+          hyscan_forward_look_player_seek (player, 0);
+          hyscan_forward_look_player_play (player, play_speed);
+        }
+
+      /* Через четверть галса переходим на его вторую половину. */
+      if (step_cnt == (n_lines / 4))
+        hyscan_forward_look_player_seek (player, step_cnt + (n_lines / 2));
+
+      /* Последняя строка показана - проверяем статистику. */
+      if (step_cnt == (n_lines / 2))
+        {
+          HyScanForwardLookPlayerStats stats;
+
+          hyscan_forward_look_player_pause (player);
+          hyscan_forward_look_player_get_stats (player, &stats);
+
+          if (stats.n_frames < (n_lines / 4))
+            g_error ("too few frames %d", stats.n_frames);
+          if (stats.n_skipped >= (n_lines / 4))
+            g_error ("seek counted as %d skipped frames", stats.n_skipped);
+
+          step_cnt = n_lines - 1;
+        }
+
+      /* На каждом шаге проверяем текущий индекс данных. */
+      else
+        {
+          check_index = (step_cnt < (n_lines / 4)) ? step_cnt : step_cnt + (n_lines / 2);
+          data_checked = FALSE;
+        }
+    }
+
+  /* Тест скользящего среднего при последовательном переходе по строкам. */
+  else if (test_step == CONTROL_BOXCAR_TEST)
+    {
+      if (step_cnt == 0)
+        {
+          g_message ("Boxcar average test");
+          hyscan_forward_look_player_set_average (player, HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_BOXCAR, N_AVERAGE);
+        }
+
+      check_index = step_cnt;
+      average_boxcar (check_index);
+      hyscan_forward_look_player_seek (player, check_index);
+      data_checked = FALSE;
+    }
+
+  /* Тест экспоненциального среднего при последовательном переходе по строкам. */
+  else if (test_step == CONTROL_EXP_TEST)
+    {
+      if (step_cnt == 0)
+        {
+          g_message ("Exponential average test");
+          hyscan_forward_look_player_set_average (player, HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_EXP, N_AVERAGE);
+          exp_index = -1;
+        }
+
+      check_index = step_cnt;
+      average_exp (check_index);
+      hyscan_forward_look_player_seek (player, check_index);
+      data_checked = FALSE;
+    }
+
+  /* Тест сброса окна усреднения при перемотке. Позиция поочерёдно
+   * переносится на половину галса, сначала для скользящего, затем для
+   * экспоненциального среднего. */
+  else if (test_step == CONTROL_AVERAGE_SEEK_TEST)
+    {
+      gboolean boxcar = (step_cnt < n_lines / 2);
+
+      if (step_cnt == 0)
+        {
+          g_message ("Average seek test");
+          hyscan_forward_look_player_set_average (player, HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_BOXCAR, N_AVERAGE);
+        }
+      else if (step_cnt == n_lines / 2)
+        {
+          hyscan_forward_look_player_set_average (player, HYSCAN_FORWARD_LOOK_PLAYER_AVERAGE_EXP, N_AVERAGE);
+          exp_index = -1;
+        }
+
+      check_index = (step_cnt % 2) ? (step_cnt / 2) + (n_lines / 2) : (step_cnt / 2);
+      if (boxcar)
+        average_boxcar (check_index);
+      else
+        average_exp (check_index);
+
+      hyscan_forward_look_player_seek (player, check_index);
+      data_checked = FALSE;
+    }
+
   /* Завершение тестирования. */
   else
     {
@@ -194,7 +422,9 @@ control_test (gpointer user_data)
       gdouble time_diff;
       gdouble play_time_diff;
 
-      if ((test_step == CONTROL_NORMAL_PLAY_TEST) || (test_step == CONTROL_REWIND_PLAY_TEST))
+      if ((test_step == CONTROL_NORMAL_PLAY_TEST) ||
+          (test_step == CONTROL_REWIND_PLAY_TEST) ||
+          (test_step == CONTROL_PLAY_SEEK_TEST))
         play_time_diff = (1.0 / n_rate) / ABS (play_speed);
       else
         play_time_diff = 1.0 / n_fps;
@@ -233,7 +463,8 @@ range_check (HyScanForwardLookPlayer *player,
     }
 }
 
-/* Функция проверки текущих данных. */
+/* Функция проверки текущих данных. При усреднении данные сравниваются
+ * с рассчитанными заранее. */
 void
 data_check (HyScanForwardLookPlayer     *player,
             HyScanForwardLookPlayerInfo *info,
@@ -242,11 +473,31 @@ data_check (HyScanForwardLookPlayer     *player,
             guint32                      n_doa,
             gpointer                     user_data)
 {
-  if ((info != NULL) &&
-      (info->index == check_index) &&
-      (info->time == ((G_USEC_PER_SEC / n_rate) * check_index)) &&
-      (hyscan_fl_gen_check (doa, n_doa, info->time, info->alpha)) &&
-      (n_doa == check_index + n_points))
+  if (check_doa != NULL)
+    {
+      guint32 i;
+
+      if ((info == NULL) || (info->index != check_index) || (n_doa != check_n_doa))
+        return;
+
+      for (i = 0; i < n_doa; i++)
+        {
+          if ((fabs (doa[i].distance - check_doa[i].distance) > 1e-3) ||
+              (fabs (doa[i].angle - check_doa[i].angle) > 1e-3) ||
+              (fabs (doa[i].amplitude - check_doa[i].amplitude) > 1e-3))
+            {
+              return;
+            }
+        }
+
+      data_checked = TRUE;
+    }
+
+  else if ((info != NULL) &&
+           (info->index == check_index) &&
+           (info->time == ((G_USEC_PER_SEC / n_rate) * check_index)) &&
+           (hyscan_fl_gen_check (doa, n_doa, info->time, info->alpha)) &&
+           (n_doa == check_index + n_points))
     {
       data_checked = TRUE;
     }
@@ -324,7 +575,7 @@ int main( int argc, char **argv )
   /* Объект управления просмотром данных врерёдсмотрящего локатора. */
   player = hyscan_forward_look_player_new ();
   hyscan_forward_look_player_set_fps (player, n_fps);
-  hyscan_forward_look_player_set_sv (player, 1000.0);
+  hyscan_forward_look_player_set_sv (player, SOUND_VELOCITY);
 
   /* Генератор данных. */
   generator = hyscan_fl_gen_new ();
@@ -340,6 +591,12 @@ int main( int argc, char **argv )
         g_error ("can't add data");
     }
 
+  /* Эталонные данные для проверки усреднения. */
+  reference = hyscan_forward_look_data_new (db, NULL, PROJECT_NAME, STATIC_TRACK_NAME);
+  if (reference == NULL)
+    g_error ("can't open track %s", STATIC_TRACK_NAME);
+  hyscan_forward_look_data_set_sound_velocity (reference, SOUND_VELOCITY);
+
   g_signal_connect (player, "range", G_CALLBACK (range_check), NULL);
   g_signal_connect (player, "data", G_CALLBACK (data_check), NULL);
   g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 10, control_test, NULL, NULL);
@@ -351,6 +608,8 @@ int main( int argc, char **argv )
 
   g_message ("All done");
 
+  g_clear_object (&reference);
+
   hyscan_db_project_remove (db, PROJECT_NAME);
 
   g_clear_object (&db);
@@ -360,6 +619,10 @@ int main( int argc, char **argv )
 
   g_timer_destroy (timer);
 
+  g_free (check_doa);
+  g_free (exp_amplitude);
+  g_free (exp_angle);
+
   g_free (db_uri);
 
   return 0;
@@ -0,0 +1,172 @@
+/* forward-look-raster-test.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-forward-look-raster.h>
+#include <math.h>
+
+#define WIDTH          400                   /* Ширина изображения. */
+#define HEIGHT         300                   /* Высота изображения. */
+#define N_POINTS       1000                  /* Число точек в строке. */
+#define ALPHA          0.5                   /* Угол сектора обзора. */
+#define DATA_RATE      150000.0              /* Частота дискретизации. */
+#define SOUND_VELOCITY 1500.0                /* Скорость звука. */
+#define TARGET_INDEX   800                   /* Индекс точки с целью. */
+#define TARGET_ANGLE   0.2                   /* Угол на цель. */
+
+/* Функция заполняет массив целей с одной целью. */
+static void
+fill_doa (HyScanDOA *doa,
+          gdouble    sound_velocity,
+          gfloat     amplitude)
+{
+  guint i;
+
+  for (i = 0; i < N_POINTS; i++)
+    {
+      doa[i].angle = 0.0;
+      doa[i].distance = i * sound_velocity / (2.0 * DATA_RATE);
+      doa[i].amplitude = 0.0;
+    }
+
+  doa[TARGET_INDEX].angle = TARGET_ANGLE;
+  doa[TARGET_INDEX].amplitude = amplitude;
+}
+
+/* Функция возвращает значение пикселя, в который должна попасть цель. */
+static gfloat
+target_value (HyScanForwardLookRaster *raster,
+              const gfloat            *image,
+              gdouble                  sound_velocity)
+{
+  gdouble pixel_size = hyscan_forward_look_raster_get_pixel_size (raster);
+  gdouble distance = TARGET_INDEX * sound_velocity / (2.0 * DATA_RATE);
+  gint x, y;
+
+  x = (WIDTH - 1) / 2.0 + distance * sin (TARGET_ANGLE) / pixel_size + 0.5;
+  y = (HEIGHT - 1) - distance * cos (TARGET_ANGLE) / pixel_size + 0.5;
+
+  return image[y * WIDTH + x];
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanForwardLookRaster *raster;
+  HyScanDOA *doa;
+  const gfloat *image;
+  GTimer *timer;
+  guint width, height;
+  gdouble pixel_size;
+  gdouble sum;
+  guint i;
+
+  doa = g_new (HyScanDOA, N_POINTS);
+  raster = hyscan_forward_look_raster_new (WIDTH, HEIGHT);
+
+  /* Без параметров обзора изображение не формируется. */
+  fill_doa (doa, SOUND_VELOCITY, 1.0);
+  if (hyscan_forward_look_raster_render (raster, doa, N_POINTS, NULL, NULL) != NULL)
+    g_error ("render without geometry");
+
+  hyscan_forward_look_raster_set_geometry (raster, ALPHA, DATA_RATE, SOUND_VELOCITY);
+
+  /* Цель должна попасть в рассчитанный пиксель. */
+  g_message ("Target position check");
+  image = hyscan_forward_look_raster_render (raster, doa, N_POINTS, &width, &height);
+  if ((image == NULL) || (width != WIDTH) || (height != HEIGHT))
+    g_error ("render error");
+
+  if (target_value (raster, image, SOUND_VELOCITY) != 1.0)
+    g_error ("target position error");
+
+  for (i = 0, sum = 0.0; i < WIDTH * HEIGHT; i++)
+    sum += image[i];
+  if (sum != 1.0)
+    g_error ("image contains extra targets");
+
+  pixel_size = hyscan_forward_look_raster_get_pixel_size (raster);
+
+  /* Послесвечение: предыдущий кадр затухает, а не стирается. */
+  g_message ("Persistence check");
+  hyscan_forward_look_raster_set_persistence (raster, 0.5);
+  fill_doa (doa, SOUND_VELOCITY, 0.0);
+  image = hyscan_forward_look_raster_render (raster, doa, N_POINTS, NULL, NULL);
+  if (fabs (target_value (raster, image, SOUND_VELOCITY) - 0.5) > 1e-6)
+    g_error ("persistence error");
+
+  fill_doa (doa, SOUND_VELOCITY, 0.25);
+  image = hyscan_forward_look_raster_render (raster, doa, N_POINTS, NULL, NULL);
+  if (fabs (target_value (raster, image, SOUND_VELOCITY) - 0.25) > 1e-6)
+    g_error ("persistence maximum error");
+
+  /* Смена геометрии сбрасывает изображение и меняет масштаб. */
+  g_message ("Geometry change check");
+  hyscan_forward_look_raster_set_geometry (raster, ALPHA, DATA_RATE, 2.0 * SOUND_VELOCITY);
+  fill_doa (doa, 2.0 * SOUND_VELOCITY, 1.0);
+  image = hyscan_forward_look_raster_render (raster, doa, N_POINTS, NULL, NULL);
+  if (fabs (hyscan_forward_look_raster_get_pixel_size (raster) - 2.0 * pixel_size) > 1e-9)
+    g_error ("pixel size error");
+  if (target_value (raster, image, 2.0 * SOUND_VELOCITY) != 1.0)
+    g_error ("target position error after geometry change");
+
+  /* Возврат к предыдущей геометрии. */
+  hyscan_forward_look_raster_set_geometry (raster, ALPHA, DATA_RATE, SOUND_VELOCITY);
+  fill_doa (doa, SOUND_VELOCITY, 1.0);
+  image = hyscan_forward_look_raster_render (raster, doa, N_POINTS, NULL, NULL);
+  if (hyscan_forward_look_raster_get_pixel_size (raster) != pixel_size)
+    g_error ("cached geometry error");
+  if (target_value (raster, image, SOUND_VELOCITY) != 1.0)
+    g_error ("target position error with cached geometry");
+
+  /* Скорость формирования кадров. */
+  for (i = 0; i < N_POINTS; i++)
+    {
+      doa[i].angle = ALPHA * (2.0 * g_random_double () - 1.0);
+      doa[i].amplitude = g_random_double ();
+    }
+
+  timer = g_timer_new ();
+  for (i = 0; i < 1000; i++)
+    hyscan_forward_look_raster_render (raster, doa, N_POINTS, NULL, NULL);
+  g_message ("Render time %.3f ms per frame", g_timer_elapsed (timer, NULL));
+  g_timer_destroy (timer);
+
+  g_object_unref (raster);
+  g_free (doa);
+
+  g_message ("All done");
+
+  return 0;
+}
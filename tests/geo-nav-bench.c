@@ -0,0 +1,538 @@
+/* Тест производительности пересчета координат и обработки навигационных данных.
+ *
+ * Программа формирует синтетический галс заданной длины и измеряет время
+ * пересчета координат HyScanGeo (поточечного, пакетного и в локальной
+ * проекции), пересчета между СК, разбора NMEA-сообщений и запросов глубины
+ * HyScanDepthometer. Результаты выводятся в формате JSON: для каждого теста
+ * число операций, время одной операции в наносекундах, число операций в
+ * секунду и число выделений памяти на операцию. Число выделений памяти
+ * подсчитывается только при сборке с glibc, иначе выводится null.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <hyscan-geo.h>
+#include <hyscan-nmea-data.h>
+#include <hyscan-nav-store.h>
+#include <hyscan-depthometer.h>
+#include <hyscan-data-writer.h>
+#include "hyscan-nmea-gen.h"
+#include <string.h>
+#include <math.h>
+#include <glib/gprintf.h>
+
+#define SENSOR_NAME    "sensor"
+#define SENSOR_CHANNEL 1
+#define START_TIME     1e10
+#define TIME_INCREMENT 1e5
+#define MAX_SENTENCES  64
+
+/* Подсчет выделений памяти: функции malloc, calloc, realloc и функции
+ * выделения выровненной памяти программы замещают библиотечные для всего
+ * процесса, включая GLib. Выровненная память выделяется через
+ * __libc_memalign, так как glibc не экспортирует внутренние варианты
+ * posix_memalign и aligned_alloc. Устаревшие valloc и pvalloc не
+ * учитываются. */
+#if defined (__GLIBC__) && !defined (G_OS_WIN32)
+#define BENCH_COUNT_ALLOCS
+
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t n,
+                             size_t size);
+extern void *__libc_realloc (void  *ptr,
+                             size_t size);
+extern void *__libc_memalign (size_t alignment,
+                              size_t size);
+
+static volatile gint bench_n_allocs = 0;
+
+void *
+malloc (size_t size)
+{
+  g_atomic_int_inc (&bench_n_allocs);
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t n,
+        size_t size)
+{
+  g_atomic_int_inc (&bench_n_allocs);
+  return __libc_calloc (n, size);
+}
+
+void *
+realloc (void  *ptr,
+         size_t size)
+{
+  g_atomic_int_inc (&bench_n_allocs);
+  return __libc_realloc (ptr, size);
+}
+
+void *
+memalign (size_t alignment,
+          size_t size)
+{
+  g_atomic_int_inc (&bench_n_allocs);
+  return __libc_memalign (alignment, size);
+}
+
+void *
+aligned_alloc (size_t alignment,
+               size_t size)
+{
+  g_atomic_int_inc (&bench_n_allocs);
+  return __libc_memalign (alignment, size);
+}
+
+int
+posix_memalign (void   **ptr,
+                size_t   alignment,
+                size_t   size)
+{
+  void *mem;
+
+  /* Выравнивание должно быть степенью двойки, кратной размеру указателя. */
+  if ((alignment % sizeof (void *) != 0) || ((alignment & (alignment - 1)) != 0) || (alignment == 0))
+    return EINVAL;
+
+  g_atomic_int_inc (&bench_n_allocs);
+  mem = __libc_memalign (alignment, size);
+  if (mem == NULL)
+    return ENOMEM;
+
+  *ptr = mem;
+  return 0;
+}
+#endif
+
+typedef struct
+{
+  GTimer                      *timer;
+  gint                         n_allocs;
+  GString                     *json;
+  gboolean                     first;
+} Bench;
+
+void    bench_start      (Bench        *bench);
+void    bench_stop       (Bench        *bench,
+                          const gchar  *name,
+                          guint64       n_ops);
+
+gchar  *nmea_record      (gint          i);
+
+void    bench_geo        (Bench        *bench,
+                          gint          n_points);
+void    bench_transform  (Bench        *bench,
+                          gint          n_points);
+void    bench_nmea       (Bench        *bench,
+                          gint          n_points);
+void    bench_nav        (Bench        *bench,
+                          HyScanDB     *db,
+                          const gchar  *name,
+                          gint          n_points);
+
+int
+main (int argc, char **argv)
+{
+  GError                 *error;
+  gchar                  *db_uri = "file://./";
+  gchar                  *output = NULL;
+  gchar                  *name = "bench";
+  HyScanDB               *db;
+
+  HyScanBuffer           *buffer;
+  HyScanDataWriter       *writer;
+  HyScanAntennaOffset     offset = {0};
+
+  Bench bench;
+  gint n_points = 100000;
+  gint64 time;
+  gint i;
+
+  /* Парсим аргументы. */
+  {
+    gchar **args;
+    guint args_len;
+    error = NULL;
+    GOptionContext *context;
+    GOptionEntry entries[] = {
+      {"points", 'n', 0, G_OPTION_ARG_INT, &n_points, "Track length and number of points (default 100000);", NULL},
+      {"output", 'o', 0, G_OPTION_ARG_STRING, &output, "Write JSON results to file instead of stdout;", NULL},
+      {NULL}
+    };
+
+#ifdef G_OS_WIN32
+    args = g_win32_get_command_line ();
+#else
+    args = g_strdupv (argv);
+#endif
+    context = g_option_context_new ("<db-uri>");
+    g_option_context_set_help_enabled (context, TRUE);
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, TRUE);
+    if (!g_option_context_parse_strv (context, &args, &error))
+      {
+        g_print ("%s\n", error->message);
+        return -1;
+      }
+
+    args_len = g_strv_length (args);
+    if (args_len == 2)
+      {
+        db_uri = g_strdup (args[1]);
+      }
+    else if (args_len > 2 || n_points < 2)
+      {
+        g_print ("%s", g_option_context_get_help (context, FALSE, NULL));
+        return 0;
+      }
+
+    g_option_context_free (context);
+
+    g_strfreev (args);
+  }
+
+  db = hyscan_db_new (db_uri);
+  if (db == NULL)
+    g_error ("can't open db");
+
+  /* Синтетический галс. */
+  writer = hyscan_data_writer_new ();
+  hyscan_data_writer_set_db (writer, db);
+
+  if (!hyscan_data_writer_start (writer, name, name, HYSCAN_TRACK_SURVEY, NULL, -1))
+    g_error ("can't start write");
+
+  hyscan_data_writer_sensor_set_offset (writer, SENSOR_NAME, &offset);
+
+  buffer = hyscan_buffer_new ();
+  for (i = 0, time = START_TIME; i < n_points; i++, time += TIME_INCREMENT)
+    {
+      gchar *data = nmea_record (i);
+
+      hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+      hyscan_data_writer_sensor_add_data (writer, SENSOR_NAME, HYSCAN_SOURCE_NMEA,
+                                          SENSOR_CHANNEL, time, buffer);
+      g_free (data);
+    }
+
+  /* Тесты. */
+  bench.timer = g_timer_new ();
+  bench.json = g_string_new (NULL);
+  bench.first = TRUE;
+
+  g_string_append_printf (bench.json, "{\n  \"points\": %d,\n  \"benchmarks\": [", n_points);
+
+  bench_geo (&bench, n_points);
+  bench_transform (&bench, n_points);
+  bench_nmea (&bench, n_points);
+  bench_nav (&bench, db, name, n_points);
+
+  g_string_append (bench.json, "\n  ]\n}\n");
+
+  if (output != NULL)
+    {
+      if (!g_file_set_contents (output, bench.json->str, bench.json->len, &error))
+        g_error ("can't write results: %s", error->message);
+    }
+  else
+    {
+      g_printf ("%s", bench.json->str);
+    }
+
+  hyscan_db_project_remove (db, name);
+
+  g_string_free (bench.json, TRUE);
+  g_timer_destroy (bench.timer);
+  g_clear_object (&writer);
+  g_clear_object (&buffer);
+  g_clear_object (&db);
+
+  return 0;
+}
+
+/* Функция начинает измерение. */
+void
+bench_start (Bench *bench)
+{
+#ifdef BENCH_COUNT_ALLOCS
+  bench->n_allocs = g_atomic_int_get (&bench_n_allocs);
+#endif
+  g_timer_start (bench->timer);
+}
+
+/* Функция завершает измерение и добавляет результат в JSON. */
+void
+bench_stop (Bench       *bench,
+            const gchar *name,
+            guint64      n_ops)
+{
+  gdouble elapsed = g_timer_elapsed (bench->timer, NULL);
+  gchar ns_per_op[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar ops_per_s[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar allocs_per_op[G_ASCII_DTOSTR_BUF_SIZE];
+
+#ifdef BENCH_COUNT_ALLOCS
+  gint n_allocs = g_atomic_int_get (&bench_n_allocs) - bench->n_allocs;
+
+  g_ascii_formatd (allocs_per_op, sizeof (allocs_per_op), "%.3f", (gdouble) n_allocs / n_ops);
+#else
+  g_strlcpy (allocs_per_op, "null", sizeof (allocs_per_op));
+#endif
+
+  /* Числа форматируются без учета локали. */
+  g_ascii_formatd (ns_per_op, sizeof (ns_per_op), "%.2f", 1e9 * elapsed / n_ops);
+  g_ascii_formatd (ops_per_s, sizeof (ops_per_s), "%.0f", (elapsed > 0.0) ? n_ops / elapsed : 0.0);
+
+  g_string_append_printf (bench->json,
+                          "%s\n    {\"name\": \"%s\", \"ops\": %" G_GUINT64_FORMAT ", "
+                          "\"ns_per_op\": %s, \"ops_per_s\": %s, \"allocs_per_op\": %s}",
+                          bench->first ? "" : ",", name, n_ops, ns_per_op, ops_per_s, allocs_per_op);
+  bench->first = FALSE;
+}
+
+/* Пересчет геодезических координат в топоцентрические и обратно. */
+void
+bench_geo (Bench *bench,
+           gint   n_points)
+{
+  HyScanGeoGeodetic origin = {55.0, 38.0, 0.0};
+  HyScanGeo *geo;
+  gdouble *lat, *lon, *h, *x, *y, *z;
+  gint i;
+
+  geo = hyscan_geo_new (origin, HYSCAN_GEO_ELLIPSOID_WGS84);
+
+  lat = g_new (gdouble, n_points);
+  lon = g_new (gdouble, n_points);
+  h = g_new (gdouble, n_points);
+  x = g_new (gdouble, n_points);
+  y = g_new (gdouble, n_points);
+  z = g_new (gdouble, n_points);
+
+  /* Точки в пределах 10 км от начала координат. */
+  for (i = 0; i < n_points; i++)
+    {
+      lat[i] = origin.lat + 0.09 * sin (i * 0.001);
+      lon[i] = origin.lon + 0.15 * cos (i * 0.0007);
+      h[i] = -10.0 - i % 100;
+    }
+
+  bench_start (bench);
+  for (i = 0; i < n_points; i++)
+    {
+      HyScanGeoGeodetic src = {lat[i], lon[i], h[i]};
+      HyScanGeoCartesian3D dst;
+
+      hyscan_geo_geo2topo (geo, &dst, src);
+      x[i] = dst.x;
+      y[i] = dst.y;
+      z[i] = dst.z;
+    }
+  bench_stop (bench, "geo.geo2topo", n_points);
+
+  bench_start (bench);
+  hyscan_geo_geo2topo_array (geo, lat, lon, h, x, y, z, n_points);
+  bench_stop (bench, "geo.geo2topo_array", n_points);
+
+  bench_start (bench);
+  for (i = 0; i < n_points; i++)
+    {
+      HyScanGeoCartesian3D src = {x[i], y[i], z[i]};
+      HyScanGeoGeodetic dst;
+
+      hyscan_geo_topo2geo (geo, &dst, src);
+    }
+  bench_stop (bench, "geo.topo2geo", n_points);
+
+  bench_start (bench);
+  hyscan_geo_topo2geo_array (geo, x, y, z, lat, lon, h, n_points);
+  bench_stop (bench, "geo.topo2geo_array", n_points);
+
+  bench_start (bench);
+  hyscan_geo_topoXY2geo_array (geo, x, y, h, lat, lon, n_points, 2);
+  bench_stop (bench, "geo.topoXY2geo_array", n_points);
+
+  /* Локальная проекция. */
+  hyscan_geo_set_fast_local (geo, TRUE);
+
+  bench_start (bench);
+  hyscan_geo_geo2topo_array (geo, lat, lon, h, x, y, z, n_points);
+  bench_stop (bench, "geo.geo2topo_array_fast_local", n_points);
+
+  bench_start (bench);
+  hyscan_geo_topo2geo_array (geo, x, y, z, lat, lon, h, n_points);
+  bench_stop (bench, "geo.topo2geo_array_fast_local", n_points);
+
+  g_object_unref (geo);
+  g_free (lat);
+  g_free (lon);
+  g_free (h);
+  g_free (x);
+  g_free (y);
+  g_free (z);
+}
+
+/* Пересчет координат между СК. */
+void
+bench_transform (Bench *bench,
+                 gint   n_points)
+{
+  HyScanGeoTransform *transform;
+  gdouble *lat, *lon, *h;
+  gint i;
+
+  lat = g_new (gdouble, n_points);
+  lon = g_new (gdouble, n_points);
+  h = g_new (gdouble, n_points);
+
+  for (i = 0; i < n_points; i++)
+    {
+      lat[i] = 55.0 + 0.09 * sin (i * 0.001);
+      lon[i] = 38.0 + 0.15 * cos (i * 0.0007);
+      h[i] = 0.0;
+    }
+
+  bench_start (bench);
+  for (i = 0; i < n_points; i++)
+    {
+      HyScanGeoGeodetic src = {lat[i], lon[i], h[i]}, dst;
+
+      hyscan_geo_cs_transform (&dst, src, HYSCAN_GEO_CS_SK42, HYSCAN_GEO_CS_WGS84);
+    }
+  bench_stop (bench, "transform.cs_transform", n_points);
+
+  transform = hyscan_geo_transform_new (HYSCAN_GEO_CS_SK42, HYSCAN_GEO_CS_WGS84);
+
+  bench_start (bench);
+  hyscan_geo_transform_array (transform, lat, lon, h, lat, lon, h, n_points);
+  bench_stop (bench, "transform.transform_array", n_points);
+
+  hyscan_geo_transform_unref (transform);
+  g_free (lat);
+  g_free (lon);
+  g_free (h);
+}
+
+/* Разбор NMEA-сообщений в памяти. */
+void
+bench_nmea (Bench *bench,
+            gint   n_points)
+{
+  HyScanNmeaSpan sentences[MAX_SENTENCES];
+  HyScanNmeaDataType types[MAX_SENTENCES];
+  GString *data = g_string_new (NULL);
+  guint32 position = 0;
+  guint64 n_sentences = 0;
+  gint i;
+
+  for (i = 0; i < n_points; i++)
+    {
+      gchar *record = nmea_record (i);
+
+      g_string_append (data, record);
+      g_free (record);
+    }
+
+  bench_start (bench);
+  while (position < data->len)
+    {
+      guint n = hyscan_nmea_data_check_sentences (data->str, data->len, &position,
+                                                  sentences, types, MAX_SENTENCES);
+      if (n == 0)
+        break;
+
+      n_sentences += n;
+    }
+  bench_stop (bench, "nmea.check_sentences", MAX (n_sentences, 1));
+
+  g_string_free (data, TRUE);
+}
+
+/* Разбор галса и запросы глубины. */
+void
+bench_nav (Bench       *bench,
+           HyScanDB    *db,
+           const gchar *name,
+           gint         n_points)
+{
+  HyScanNavStore *store;
+  HyScanDepthometer *meter;
+  HyScanDepthProfile *profile;
+  gint64 *times;
+  gdouble *depths;
+  gint i;
+
+  bench_start (bench);
+  store = hyscan_nav_store_new (db, name, name, SENSOR_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  bench_stop (bench, "nav.store_decode", n_points);
+
+  if (store == NULL)
+    g_error ("Object creation failure");
+
+  meter = hyscan_depthometer_new (HYSCAN_NAV_DATA (store));
+
+  /* Моменты времени в записях и между ними в случайном порядке. */
+  times = g_new (gint64, n_points);
+  depths = g_new (gdouble, n_points);
+  for (i = 0; i < n_points; i++)
+    times[i] = START_TIME + g_random_int_range (0, n_points - 1) * TIME_INCREMENT + TIME_INCREMENT / 2 * (i % 2);
+
+  bench_start (bench);
+  for (i = 0; i < n_points; i++)
+    depths[i] = hyscan_depthometer_get (meter, times[i]);
+  bench_stop (bench, "depthometer.get_random", n_points);
+
+  for (i = 0; i < n_points; i++)
+    times[i] = START_TIME + i * TIME_INCREMENT;
+
+  bench_start (bench);
+  hyscan_depthometer_get_many (meter, times, n_points, depths);
+  bench_stop (bench, "depthometer.get_many", n_points);
+
+  hyscan_depthometer_set_filter (meter, HYSCAN_DEPTHOMETER_FILTER_HAMPEL);
+
+  bench_start (bench);
+  hyscan_depthometer_get_many (meter, times, n_points, depths);
+  bench_stop (bench, "depthometer.get_many_hampel", n_points);
+
+  bench_start (bench);
+  profile = hyscan_depthometer_get_profile (meter);
+  bench_stop (bench, "depthometer.profile_build", n_points);
+
+  if (profile == NULL)
+    g_error ("Depth profile failure");
+
+  bench_start (bench);
+  for (i = 0; i < n_points; i++)
+    depths[i] = hyscan_depth_profile_get (profile, times[n_points - 1 - i]);
+  bench_stop (bench, "depthometer.profile_get", n_points);
+
+  hyscan_depth_profile_unref (profile);
+  g_object_unref (meter);
+  g_object_unref (store);
+  g_free (times);
+  g_free (depths);
+}
+
+/* Функция формирует запись с сообщениями RMC, DPT и HDT. */
+gchar *
+nmea_record (gint i)
+{
+  gchar *rmc, *dpt, *hdt, *record;
+
+  /* Галс на север со скоростью 5 узлов и глубиной от 10 до 30 метров. */
+  rmc = hyscan_nmea_gen_sentence ("GPRMC,120000.000,A,55%02d.%04d,N,03800.0000,E,5.0,0.0,010120,,",
+                                  (i / 10000) % 60, i % 10000);
+  dpt = hyscan_nmea_gen_sentence ("SDDPT,%.1f,0.0", 20.0 + 10.0 * sin (i * 0.01));
+  hdt = hyscan_nmea_gen_sentence ("HEHDT,%d.0,T", i % 360);
+
+  record = g_strconcat (rmc, dpt, hdt, NULL);
+
+  g_free (rmc);
+  g_free (dpt);
+  g_free (hdt);
+
+  return record;
+}
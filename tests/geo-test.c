@@ -12,13 +12,33 @@
 #define KRED "\x1b[31;22m"
 #define KNRM "\x1b[0m"
 
+#define N_BATCH_POINTS  1000000       /* Число точек в тесте производительности. */
+#define N_LOCAL_POINTS  3600          /* Число точек в тесте локальной проекции. */
+#define MAX_BATCH_ERROR 1e-9          /* Допустимое расхождение пакетного и поточечного пересчета. */
+#define MAX_LOCAL_ERROR 0.05          /* Допустимая погрешность локальной проекции в 10 км от начала, м. */
+#define MAX_REF_ANGLE   1e-9          /* Допустимое расхождение с эталонными значениями, градусы. */
+#define MAX_REF_HEIGHT  1e-5          /* Допустимое расхождение с эталонными значениями, м. */
+#define MAX_ECEF_ERROR  1e-8          /* Допустимая погрешность пересчета ECEF->геодезические->ECEF, м. */
+
 /**
  * Тест класса HyScanGeo.
- * Состоит из двух частей:
+ * Состоит из шести частей:
  *  - тест перевода из топоцентрической в геодезическую и обратно;
- *  - тест перевода между геодезическими СК.
+ *  - тест перевода из геоцентрической в геодезическую и обратно на высотах от -11 до +50 км;
+ *  - тест перевода между геодезическими СК;
+ *  - тест пакетного пересчета: сравнение с поточечным и производительность;
+ *  - тест быстрой локальной проекции;
+ *  - тест пакетного пересчета между СК.
  */
 
+void     check_ecef      (HyScanGeo         *geo);
+void     check_batch     (HyScanGeo         *geo,
+                          HyScanGeoGeodetic *input,
+                          gint               num_of_points);
+void     check_fast_local (HyScanGeo        *geo);
+void     check_transform  (HyScanGeoGeodetic *input,
+                           gint               num_of_points);
+
 int main (void)
 {
   HyScanGeo *geo;
@@ -142,7 +162,447 @@ int main (void)
       g_print (KYLW "%i: %f %f %f\n" KNRM, i, buf1[i].lat, buf1[i].lon, buf1[i].h);
     }
 
+  check_ecef (geo);
+  check_batch (geo, input, num_of_points);
+  check_fast_local (geo);
+  check_transform (input, num_of_points);
+
   g_object_unref (geo);
 
   return 0;
 }
+
+/* Функция проверяет пересчет геоцентрических координат в геодезические и
+ * обратно. Топоцентрические координаты связаны с геоцентрическими поворотом
+ * и сдвигом, поэтому цепочка topo->geo->topo включает ECEF->geo->ECEF. Высоты
+ * охватывают диапазон от наибольшей глубины океана до стратосферы, широты -
+ * полюса и экватор. */
+void
+check_ecef (HyScanGeo *geo)
+{
+  gdouble lats[] = { -90.0, -89.9999, -60.0, -1e-7, 0.0, 30.0, 55.5, 89.9999, 90.0 };
+  gdouble lons[] = { -180.0, -90.0, 0.0, 38.0, 135.0, 179.9999 };
+  gdouble heights[] = { -11000.0, -5000.0, -100.0, 0.0, 100.0, 10000.0, 50000.0 };
+  gdouble max_error = 0.0;
+  guint i, j, k;
+
+  g_print ("\nGeocentric to geodetic transformation test\nECEF->WGS-84->ECEF\n");
+
+  for (i = 0; i < G_N_ELEMENTS (lats); i++)
+    for (j = 0; j < G_N_ELEMENTS (lons); j++)
+      for (k = 0; k < G_N_ELEMENTS (heights); k++)
+        {
+          HyScanGeoGeodetic src = {lats[i], lons[j], heights[k]}, geod;
+          HyScanGeoCartesian3D topo, topo2;
+          gdouble error;
+
+          if (!hyscan_geo_geo2topo (geo, &topo, src) ||
+              !hyscan_geo_topo2geo (geo, &geod, topo) ||
+              !hyscan_geo_geo2topo (geo, &topo2, geod))
+            {
+              g_error ("ECEF round trip failure at %f %f %f", src.lat, src.lon, src.h);
+            }
+
+          error = sqrt ((topo2.x - topo.x) * (topo2.x - topo.x) +
+                        (topo2.y - topo.y) * (topo2.y - topo.y) +
+                        (topo2.z - topo.z) * (topo2.z - topo.z));
+          error = MAX (error, fabs (geod.h - src.h));
+
+          if (error > MAX_ECEF_ERROR)
+            g_error ("ECEF round trip error %g m at %f %f %f", error, src.lat, src.lon, src.h);
+
+          max_error = MAX (max_error, error);
+        }
+
+  g_print ("Maximum round trip error %g m\n", max_error);
+}
+
+/* Функция сравнивает пакетный пересчет с поточечным и измеряет производительность. */
+void
+check_batch (HyScanGeo         *geo,
+             HyScanGeoGeodetic *input,
+             gint               num_of_points)
+{
+  gdouble *lat, *lon, *h, *x, *y, *z, *lat2, *lon2, *h2;
+  GTimer *timer = g_timer_new ();
+  gdouble scalar_time, batch_time;
+  gint i;
+
+  lat = g_new (gdouble, N_BATCH_POINTS);
+  lon = g_new (gdouble, N_BATCH_POINTS);
+  h = g_new (gdouble, N_BATCH_POINTS);
+  x = g_new (gdouble, N_BATCH_POINTS);
+  y = g_new (gdouble, N_BATCH_POINTS);
+  z = g_new (gdouble, N_BATCH_POINTS);
+  lat2 = g_new (gdouble, N_BATCH_POINTS);
+  lon2 = g_new (gdouble, N_BATCH_POINTS);
+  h2 = g_new (gdouble, N_BATCH_POINTS);
+
+  /* Точки вокруг исходного набора. */
+  for (i = 0; i < N_BATCH_POINTS; i++)
+    {
+      lat[i] = input[i % num_of_points].lat + 1e-7 * (i / num_of_points);
+      lon[i] = input[i % num_of_points].lon - 1e-7 * (i / num_of_points);
+      h[i] = input[i % num_of_points].h;
+    }
+
+  g_print ("\nBatch transformation test\n");
+
+  /* Точность: пакетный пересчет совпадает с поточечным. */
+  if (hyscan_geo_geo2topo_array (geo, lat, lon, h, x, y, z, N_BATCH_POINTS) != N_BATCH_POINTS)
+    g_error ("geo2topo batch failure");
+  if (hyscan_geo_topo2geo_array (geo, x, y, z, lat2, lon2, h2, N_BATCH_POINTS) != N_BATCH_POINTS)
+    g_error ("topo2geo batch failure");
+
+  for (i = 0; i < N_BATCH_POINTS; i += 997)
+    {
+      HyScanGeoGeodetic src = {lat[i], lon[i], h[i]}, dst;
+      HyScanGeoCartesian3D topo;
+      HyScanGeoCartesian2D topoXY;
+
+      hyscan_geo_geo2topo (geo, &topo, src);
+      if (fabs (topo.x - x[i]) > MAX_BATCH_ERROR ||
+          fabs (topo.y - y[i]) > MAX_BATCH_ERROR ||
+          fabs (topo.z - z[i]) > MAX_BATCH_ERROR)
+        {
+          g_error ("geo2topo batch mismatch at %d", i);
+        }
+
+      hyscan_geo_topo2geo (geo, &dst, topo);
+      if (fabs (dst.lat - lat2[i]) > MAX_BATCH_ERROR ||
+          fabs (dst.lon - lon2[i]) > MAX_BATCH_ERROR ||
+          fabs (dst.h - h2[i]) > MAX_BATCH_ERROR)
+        {
+          g_error ("topo2geo batch mismatch at %d", i);
+        }
+
+      hyscan_geo_geo2topoXY (geo, &topoXY, src);
+      hyscan_geo_geo2topoXY_array (geo, &lat[i], &lon[i], &h[i], &x[i], &y[i], 1);
+      if (fabs (topoXY.x - x[i]) > MAX_BATCH_ERROR || fabs (topoXY.y - y[i]) > MAX_BATCH_ERROR)
+        g_error ("geo2topoXY batch mismatch at %d", i);
+
+      hyscan_geo_topoXY2geo (geo, &dst, topoXY, h[i], 2);
+      hyscan_geo_topoXY2geo_array (geo, &x[i], &y[i], &h[i], &lat2[i], &lon2[i], 1, 2);
+      if (fabs (dst.lat - lat2[i]) > MAX_BATCH_ERROR || fabs (dst.lon - lon2[i]) > MAX_BATCH_ERROR)
+        g_error ("topoXY2geo batch mismatch at %d", i);
+    }
+
+  /* Точки вне допустимого диапазона пропускаются. */
+  {
+    gdouble bad_lat[2] = {lat[0], 91.0}, bad_lon[2] = {lon[0], lon[0]};
+
+    if (hyscan_geo_geo2topoXY_array (geo, bad_lat, bad_lon, NULL, x, y, 2) != 1 || !isnan (x[1]))
+      g_error ("Out of range batch point is not rejected");
+  }
+
+  g_print ("Batch results match single point results\n");
+
+  /* Производительность. */
+  g_timer_start (timer);
+  for (i = 0; i < N_BATCH_POINTS; i++)
+    {
+      HyScanGeoGeodetic src = {lat[i], lon[i], h[i]};
+      HyScanGeoCartesian3D topo;
+
+      hyscan_geo_geo2topo (geo, &topo, src);
+      x[i] = topo.x;
+      y[i] = topo.y;
+      z[i] = topo.z;
+    }
+  scalar_time = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  hyscan_geo_geo2topo_array (geo, lat, lon, h, x, y, z, N_BATCH_POINTS);
+  batch_time = g_timer_elapsed (timer, NULL);
+
+  g_print ("geo2topo: single %.0f ops/s, batch %.0f ops/s\n",
+           N_BATCH_POINTS / scalar_time, N_BATCH_POINTS / batch_time);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_BATCH_POINTS; i++)
+    {
+      HyScanGeoCartesian3D src = {x[i], y[i], z[i]};
+      HyScanGeoGeodetic dst;
+
+      hyscan_geo_topo2geo (geo, &dst, src);
+      lat2[i] = dst.lat;
+      lon2[i] = dst.lon;
+      h2[i] = dst.h;
+    }
+  scalar_time = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  hyscan_geo_topo2geo_array (geo, x, y, z, lat2, lon2, h2, N_BATCH_POINTS);
+  batch_time = g_timer_elapsed (timer, NULL);
+
+  g_print ("topo2geo: single %.0f ops/s, batch %.0f ops/s\n",
+           N_BATCH_POINTS / scalar_time, N_BATCH_POINTS / batch_time);
+
+  g_timer_destroy (timer);
+  g_free (lat);
+  g_free (lon);
+  g_free (h);
+  g_free (x);
+  g_free (y);
+  g_free (z);
+  g_free (lat2);
+  g_free (lon2);
+  g_free (h2);
+}
+
+/* Функция проверяет погрешность быстрой локальной проекции и измеряет производительность. */
+void
+check_fast_local (HyScanGeo *geo)
+{
+  GTimer *timer = g_timer_new ();
+  gdouble *lat, *lon, *h, *x, *y;
+  HyScanGeoCartesian2D *scalarXY;
+  gdouble max_error = 0.0;
+  gdouble exact_time = 0.0, fast_time = 0.0;
+  gint i;
+
+  g_print ("\nFast local projection test\n");
+
+  lat = g_new (gdouble, N_LOCAL_POINTS);
+  lon = g_new (gdouble, N_LOCAL_POINTS);
+  h = g_new (gdouble, N_LOCAL_POINTS);
+  x = g_new (gdouble, N_LOCAL_POINTS);
+  y = g_new (gdouble, N_LOCAL_POINTS);
+  scalarXY = g_new (HyScanGeoCartesian2D, N_LOCAL_POINTS);
+
+  /* Точки на окружностях радиусом до 10 км на разной высоте. */
+  for (i = 0; i < N_LOCAL_POINTS; i++)
+    {
+      HyScanGeoCartesian3D topo, exact, fast;
+      HyScanGeoCartesian2D topoXY;
+      HyScanGeoGeodetic geod, fast_geod;
+      gdouble radius = 1000.0 * (1 + i % 10);
+      gdouble angle = G_PI * i / 1800.0;
+
+      topo.x = radius * cos (angle);
+      topo.y = radius * sin (angle);
+      topo.z = 100.0 * (i % 3 - 1);
+
+      /* Точный пересчет. */
+      hyscan_geo_set_fast_local (geo, FALSE);
+      hyscan_geo_topo2geo (geo, &geod, topo);
+
+      /* Прямой пересчет в быстром режиме. */
+      hyscan_geo_set_fast_local (geo, TRUE);
+      hyscan_geo_geo2topo (geo, &fast, geod);
+      max_error = MAX (max_error, sqrt ((fast.x - topo.x) * (fast.x - topo.x) +
+                                        (fast.y - topo.y) * (fast.y - topo.y) +
+                                        (fast.z - topo.z) * (fast.z - topo.z)));
+
+      /* Пересчет в плоскость XOY в быстром режиме совпадает с пространственным. */
+      if (!hyscan_geo_geo2topoXY (geo, &scalarXY[i], geod))
+        g_error ("Fast local geo2topoXY failure");
+      if ((scalarXY[i].x != fast.x) || (scalarXY[i].y != fast.y))
+        g_error ("Fast local geo2topoXY mismatch at %d", i);
+
+      lat[i] = geod.lat;
+      lon[i] = geod.lon;
+      h[i] = geod.h;
+
+      /* Обратный пересчет в быстром режиме, погрешность в метрах. */
+      hyscan_geo_topo2geo (geo, &fast_geod, topo);
+      hyscan_geo_set_fast_local (geo, FALSE);
+      hyscan_geo_geo2topo (geo, &exact, fast_geod);
+      max_error = MAX (max_error, sqrt ((exact.x - topo.x) * (exact.x - topo.x) +
+                                        (exact.y - topo.y) * (exact.y - topo.y) +
+                                        (exact.z - topo.z) * (exact.z - topo.z)));
+
+      /* Пересчет X, Y при известной высоте. */
+      hyscan_geo_set_fast_local (geo, TRUE);
+      topoXY.x = topo.x;
+      topoXY.y = topo.y;
+      hyscan_geo_topoXY2geo (geo, &fast_geod, topoXY, geod.h, 0);
+      hyscan_geo_set_fast_local (geo, FALSE);
+      hyscan_geo_geo2topo (geo, &exact, fast_geod);
+      max_error = MAX (max_error, hypot (exact.x - topo.x, exact.y - topo.y));
+    }
+
+  g_print ("Max error within 10 km: %f m\n", max_error);
+  if (max_error > MAX_LOCAL_ERROR)
+    g_error ("Fast local projection error is too large");
+
+  /* Пакетный пересчет в быстром режиме совпадает с поточечным. */
+  hyscan_geo_set_fast_local (geo, TRUE);
+  if (hyscan_geo_geo2topoXY_array (geo, lat, lon, h, x, y, N_LOCAL_POINTS) != N_LOCAL_POINTS)
+    g_error ("Fast local geo2topoXY array failure");
+
+  for (i = 0; i < N_LOCAL_POINTS; i++)
+    {
+      if (fabs (x[i] - scalarXY[i].x) > MAX_BATCH_ERROR || fabs (y[i] - scalarXY[i].y) > MAX_BATCH_ERROR)
+        g_error ("Fast local geo2topoXY array mismatch at %d", i);
+    }
+
+  g_free (lat);
+  g_free (lon);
+  g_free (h);
+  g_free (x);
+  g_free (y);
+  g_free (scalarXY);
+
+  /* Производительность обратного пересчета. */
+  for (i = 0; i < 2; i++)
+    {
+      HyScanGeoCartesian3D topo = {0.0, 0.0, 0.0};
+      HyScanGeoGeodetic geod;
+      gint j;
+
+      hyscan_geo_set_fast_local (geo, i == 1);
+
+      g_timer_start (timer);
+      for (j = 0; j < N_BATCH_POINTS; j++)
+        {
+          topo.x = j % 10000;
+          topo.y = j / 100;
+          hyscan_geo_topo2geo (geo, &geod, topo);
+        }
+
+      if (i == 0)
+        exact_time = g_timer_elapsed (timer, NULL);
+      else
+        fast_time = g_timer_elapsed (timer, NULL);
+    }
+
+  g_print ("topo2geo: exact %.0f ops/s, fast local %.0f ops/s\n",
+           N_BATCH_POINTS / exact_time, N_BATCH_POINTS / fast_time);
+
+  hyscan_geo_set_fast_local (geo, FALSE);
+  g_timer_destroy (timer);
+}
+
+/* Функция сравнивает пакетный пересчет между СК с поточечным и измеряет производительность. */
+void
+check_transform (HyScanGeoGeodetic *input,
+                 gint               num_of_points)
+{
+  /* Точки input в СК-42, пересчитанные в WGS-84. */
+  const HyScanGeoGeodetic reference[] =
+    {
+      {55.585605207119, 38.425917798643, 3.375774669},
+      {55.576246514804, 38.974368762332, 2.796206144},
+      {55.439155505873, 38.254103471300, 3.854512199},
+      {55.765162293684, 38.341976501895, 4.223007015},
+      {55.212340901621, 38.780349499261, 4.345915833},
+      {55.919072439422, 38.297409110302, 6.715670354},
+      {55.899400834939, 38.432519298760, 9.744794459},
+      {55.139574485762, 38.533728465607, 15.836603170},
+      {55.614581492474, 38.097535739896, 29.289621941},
+      {55.943245181424, 38.919477590425, 53.959941228},
+      {55.900753716157, 38.023331449557, 106.248553144},
+      {55.507576035976, 38.838977386625, 207.545713870},
+      {55.912934500008, 38.596524531697, 412.746983701},
+      {55.792252348548, 38.406653924678, 822.549841774},
+      {55.476910410909, 38.994563831949, 1640.945626598},
+      {55.535118380110, 38.557311913018, 3279.900498674}
+    };
+  HyScanGeoTransform *transform;
+  HyScanGeoEllipsoidParam el_in, el_out;
+  HyScanGeoDatumParam datum;
+  gdouble *lat, *lon, *h, *lat2, *lon2, *h2;
+  GTimer *timer = g_timer_new ();
+  gdouble scalar_time, batch_time;
+  gint i;
+
+  g_print ("\nBatch coordinate system transformation test\nSK-42->WGS-84\n");
+
+  transform = hyscan_geo_transform_new (HYSCAN_GEO_CS_SK42, HYSCAN_GEO_CS_WGS84);
+  if (transform == NULL)
+    g_error ("Transform creation failure");
+
+  if (hyscan_geo_transform_new (HYSCAN_GEO_CS_INVALID, HYSCAN_GEO_CS_WGS84) != NULL)
+    g_error ("Invalid transform is created");
+
+  lat = g_new (gdouble, N_BATCH_POINTS);
+  lon = g_new (gdouble, N_BATCH_POINTS);
+  h = g_new (gdouble, N_BATCH_POINTS);
+  lat2 = g_new (gdouble, N_BATCH_POINTS);
+  lon2 = g_new (gdouble, N_BATCH_POINTS);
+  h2 = g_new (gdouble, N_BATCH_POINTS);
+
+  for (i = 0; i < N_BATCH_POINTS; i++)
+    {
+      lat[i] = input[i % num_of_points].lat + 1e-7 * (i / num_of_points);
+      lon[i] = input[i % num_of_points].lon - 1e-7 * (i / num_of_points);
+      h[i] = input[i % num_of_points].h;
+    }
+
+  if (hyscan_geo_transform_array (transform, lat, lon, h, lat2, lon2, h2, N_BATCH_POINTS) != N_BATCH_POINTS)
+    g_error ("Batch transform failure");
+
+  /* Сравниваем с пересчетом без кэширования параметров. */
+  hyscan_geo_init_ellipsoid (&el_in, HYSCAN_GEO_ELLIPSOID_KRASSOVSKY);
+  hyscan_geo_init_ellipsoid (&el_out, HYSCAN_GEO_ELLIPSOID_WGS84);
+  datum = hyscan_geo_get_datum_params (HYSCAN_GEO_CS_SK42, HYSCAN_GEO_CS_WGS84);
+
+  for (i = 0; i < N_BATCH_POINTS; i += 997)
+    {
+      HyScanGeoGeodetic src = {lat[i], lon[i], h[i]}, dst, cached;
+
+      hyscan_geo_cs_transform_user (&dst, src, el_in, el_out, datum);
+      hyscan_geo_cs_transform (&cached, src, HYSCAN_GEO_CS_SK42, HYSCAN_GEO_CS_WGS84);
+
+      if (fabs (dst.lat - lat2[i]) > MAX_BATCH_ERROR ||
+          fabs (dst.lon - lon2[i]) > MAX_BATCH_ERROR ||
+          fabs (dst.h - h2[i]) > MAX_BATCH_ERROR)
+        {
+          g_error ("Batch transform mismatch at %d", i);
+        }
+
+      if (fabs (dst.lat - cached.lat) > MAX_BATCH_ERROR ||
+          fabs (dst.lon - cached.lon) > MAX_BATCH_ERROR ||
+          fabs (dst.h - cached.h) > MAX_BATCH_ERROR)
+        {
+          g_error ("Cached transform mismatch at %d", i);
+        }
+    }
+
+  g_print ("Batch results match single point results\n");
+
+  /* Сравниваем с эталонными значениями, полученными исходной реализацией
+   * преобразования Гельмерта с пересчетом параметров при каждом вызове. */
+  for (i = 0; i < num_of_points && i < (gint) G_N_ELEMENTS (reference); i++)
+    {
+      HyScanGeoGeodetic dst;
+
+      if (!hyscan_geo_transform_point (transform, &dst, input[i]) ||
+          fabs (dst.lat - reference[i].lat) > MAX_REF_ANGLE ||
+          fabs (dst.lon - reference[i].lon) > MAX_REF_ANGLE ||
+          fabs (dst.h - reference[i].h) > MAX_REF_HEIGHT)
+        {
+          g_error ("Reference transform mismatch at %d: %.10f %.10f %.6f",
+                   i, dst.lat, dst.lon, dst.h);
+        }
+    }
+
+  g_print ("Results match reference values\n");
+
+  /* Производительность. */
+  g_timer_start (timer);
+  for (i = 0; i < N_BATCH_POINTS; i++)
+    {
+      HyScanGeoGeodetic src = {lat[i], lon[i], h[i]}, dst;
+
+      hyscan_geo_cs_transform (&dst, src, HYSCAN_GEO_CS_SK42, HYSCAN_GEO_CS_WGS84);
+    }
+  scalar_time = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  hyscan_geo_transform_array (transform, lat, lon, h, lat2, lon2, h2, N_BATCH_POINTS);
+  batch_time = g_timer_elapsed (timer, NULL);
+
+  g_print ("SK-42->WGS-84: single %.0f ops/s, batch %.0f ops/s\n",
+           N_BATCH_POINTS / scalar_time, N_BATCH_POINTS / batch_time);
+
+  hyscan_geo_transform_unref (transform);
+  g_timer_destroy (timer);
+  g_free (lat);
+  g_free (lon);
+  g_free (h);
+  g_free (lat2);
+  g_free (lon2);
+  g_free (h2);
+}
@@ -42,6 +42,9 @@
  * Тестовые данные представляют собой отражение от целей по всей дистанции
  * приёма с изменением направления от крайнего левого до крайнего правого.
  *
+ * Данные могут записываться парой каналов или сокращённым потоком, в
+ * котором первый канал содержит амплитуду и разность фаз, а второй только
+ * параметры антенны.
  */
 
 #include "hyscan-fl-gen.h"
@@ -61,6 +64,8 @@ struct _HyScanFLGenPrivate
 
   HyScanBuffer                *values1;
   HyScanBuffer                *values2;
+
+  gboolean                     reduced;
 };
 
 static void    hyscan_fl_gen_object_finalize           (GObject               *object);
@@ -126,12 +131,25 @@ hyscan_fl_gen_set_info (HyScanFLGen            *fl_gen,
   fl_gen->priv->info2 = *info;
 
   fl_gen->priv->info1.data_type = HYSCAN_DATA_COMPLEX_FLOAT;
-  fl_gen->priv->info2.data_type = HYSCAN_DATA_COMPLEX_FLOAT;
+  fl_gen->priv->info2.data_type = fl_gen->priv->reduced ? HYSCAN_DATA_AMPLITUDE_FLOAT32LE :
+                                                          HYSCAN_DATA_COMPLEX_FLOAT;
 
   fl_gen->priv->info1.antenna_hoffset = 0.0;
   fl_gen->priv->info2.antenna_hoffset = 0.01;
 }
 
+/* Функция включает запись сокращённого потока данных. */
+void
+hyscan_fl_gen_set_reduced (HyScanFLGen *fl_gen,
+                           gboolean     reduced)
+{
+  g_return_if_fail (HYSCAN_IS_FL_GEN (fl_gen));
+
+  fl_gen->priv->reduced = reduced;
+  fl_gen->priv->info2.data_type = reduced ? HYSCAN_DATA_AMPLITUDE_FLOAT32LE :
+                                            HYSCAN_DATA_COMPLEX_FLOAT;
+}
+
 /* Функция задаёт проект и галс в который ведётся запись. */
 gboolean
 hyscan_fl_gen_set_track (HyScanFLGen *fl_gen,
@@ -207,6 +225,14 @@ hyscan_fl_gen_generate (HyScanFLGen *fl_gen,
       raw_values2[i].im = sin (phase);
     }
 
+  /* В сокращённом потоке амплитуда первого канала равна единице, поэтому
+   * его данные совпадают с данными второго канала исходной пары. */
+  if (priv->reduced)
+    {
+      return hyscan_data_writer_acoustic_add_data (priv->writer, HYSCAN_SOURCE_FORWARD_LOOK, 1,
+                                                   FALSE, time, priv->values2);
+    }
+
   status = hyscan_data_writer_acoustic_add_data (priv->writer, HYSCAN_SOURCE_FORWARD_LOOK, 1,
                                                  FALSE, time, priv->values1);
   if (!status)
@@ -72,6 +72,9 @@ void                   hyscan_fl_gen_set_offset        (HyScanFLGen
 void                   hyscan_fl_gen_set_info          (HyScanFLGen                   *fl_gen,
                                                         HyScanAcousticDataInfo        *info);
 
+void                   hyscan_fl_gen_set_reduced       (HyScanFLGen                   *fl_gen,
+                                                        gboolean                       reduced);
+
 gboolean               hyscan_fl_gen_set_track         (HyScanFLGen                   *fl_gen,
                                                         HyScanDB                      *db,
                                                         const gchar                   *project_name,
@@ -0,0 +1,77 @@
+/* hyscan-nmea-gen.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-nmea-gen
+ * @Short_description: формирование тестовых NMEA-сообщений
+ * @Title: HyScanNMEAGen
+ *
+ * Функция hyscan_nmea_gen_sentence() формирует NMEA-сообщение по телу,
+ * заданному в формате printf: добавляет '$', контрольную сумму и символы
+ * конца строки. Записи из нескольких сообщений составляются объединением
+ * строк, например функцией g_strconcat().
+ */
+
+#include "hyscan-nmea-gen.h"
+
+/**
+ * hyscan_nmea_gen_sentence:
+ * @format: формат тела сообщения без '$' и контрольной суммы
+ * @...: аргументы формата
+ *
+ * Функция формирует NMEA-сообщение вида "$тело*XX\r\n".
+ *
+ * Returns: сообщение. Для удаления #g_free.
+ */
+gchar *
+hyscan_nmea_gen_sentence (const gchar *format,
+                          ...)
+{
+  gchar *body, *sentence;
+  const gchar *ch;
+  guint checksum = 0;
+  va_list args;
+
+  va_start (args, format);
+  body = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  for (ch = body; *ch != '\0'; ch++)
+    checksum ^= (guchar) *ch;
+
+  sentence = g_strdup_printf ("$%s*%02X\r\n", body, checksum);
+  g_free (body);
+
+  return sentence;
+}
@@ -0,0 +1,435 @@
+#include <hyscan-nav-store.h>
+#include <hyscan-nav-interp.h>
+#include <hyscan-data-writer.h>
+#include <hyscan-cached.h>
+#include "hyscan-nmea-gen.h"
+#include <string.h>
+#include <math.h>
+#include <glib/gprintf.h>
+
+#define SENSOR_NAME    "sensor"
+#define SENSOR_CHANNEL 1
+#define START_TIME     1e10
+#define TIME_INCREMENT 1e6
+#define STEP_CHANNEL   2
+#define STEP_SAMPLES   64
+
+gchar  *nmea_record    (gint              i);
+gdouble step_depth     (gint              i);
+void    write_steps    (HyScanDataWriter *writer,
+                        gint              from,
+                        gint              to);
+void    check_store    (HyScanNavStore   *store,
+                        gint              samples);
+void    check_steps    (HyScanDataWriter *writer,
+                        HyScanDB         *db,
+                        const gchar      *name);
+void    check_interp   (HyScanDataWriter *writer,
+                        HyScanDB         *db,
+                        const gchar      *name,
+                        gint              samples);
+
+int
+main (int argc, char **argv)
+{
+  gchar                  *db_uri = "file://./";
+  gchar                  *name = "test";
+  HyScanDB               *db;
+  HyScanCache            *cache;
+
+  HyScanBuffer           *buffer;
+  HyScanDataWriter       *writer;
+  HyScanAntennaOffset     offset = {0};
+
+  HyScanNavStore *store;
+  HyScanNavStore *cached;
+  gint64 time;
+  gint i;
+
+  gint samples = 1000;
+  GTimer *timer = g_timer_new ();
+  gdouble time_decode, time_cached;
+
+  if (argc == 2)
+    db_uri = argv[1];
+
+  cache = HYSCAN_CACHE (hyscan_cached_new (512));
+  db = hyscan_db_new (db_uri);
+  if (db == NULL)
+    g_error ("can't open db");
+
+  writer = hyscan_data_writer_new ();
+  hyscan_data_writer_set_db (writer, db);
+
+  if (!hyscan_data_writer_start (writer, name, name, HYSCAN_TRACK_SURVEY, NULL, -1))
+    g_error ("can't start write");
+
+  hyscan_data_writer_sensor_set_offset (writer, SENSOR_NAME, &offset);
+
+  /* Каждая запись: RMC, DPT и HDT. В каждой десятой записи RMC недостоверно. */
+  buffer = hyscan_buffer_new ();
+  for (i = 0, time = START_TIME; i < samples; i++, time += TIME_INCREMENT)
+    {
+      gchar *data = nmea_record (i);
+
+      hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+      hyscan_data_writer_sensor_add_data (writer, SENSOR_NAME, HYSCAN_SOURCE_NMEA,
+                                          SENSOR_CHANNEL, time, buffer);
+      g_free (data);
+    }
+
+  /* Разбор без кэша. */
+  store = hyscan_nav_store_new (db, name, name, SENSOR_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  if (store == NULL)
+    g_error ("Object creation failure");
+
+  hyscan_nav_data_set_cache (HYSCAN_NAV_DATA (store), cache);
+
+  g_timer_start (timer);
+  check_store (store, samples);
+  time_decode = g_timer_elapsed (timer, NULL);
+
+  /* Запись в канал продолжается, поэтому данные сохраняются в кэше только
+   * при явном разборе. Второй объект получает декодированные данные из кэша. */
+  if (!hyscan_nav_store_update (store))
+    g_error ("Update failure");
+
+  cached = hyscan_nav_store_new (db, name, name, SENSOR_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  hyscan_nav_data_set_cache (HYSCAN_NAV_DATA (cached), cache);
+
+  g_timer_start (timer);
+  check_store (cached, samples);
+  time_cached = g_timer_elapsed (timer, NULL);
+
+  if (g_strcmp0 (hyscan_nav_data_get_token (HYSCAN_NAV_DATA (store)),
+                 hyscan_nav_data_get_token (HYSCAN_NAV_DATA (cached))) != 0)
+    {
+      g_error ("Token mismatch");
+    }
+
+  check_interp (writer, db, name, samples);
+
+  /* Дозапись данных в галс. */
+  {
+    gchar *data = nmea_record (samples);
+    guint32 n;
+
+    hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+    hyscan_data_writer_sensor_add_data (writer, SENSOR_NAME, HYSCAN_SOURCE_NMEA,
+                                        SENSOR_CHANNEL, time, buffer);
+    g_free (data);
+
+    n = hyscan_nav_store_get_column (store, HYSCAN_NAV_STORE_DEPTH, NULL, NULL);
+    if (n != (guint32) samples + 1)
+      g_error ("Incremental update failure: %u values", n);
+  }
+
+  hyscan_db_project_remove (db, name);
+
+  g_clear_object (&store);
+  g_clear_object (&cached);
+  g_clear_object (&writer);
+  g_clear_object (&buffer);
+  g_clear_object (&cache);
+  g_clear_object (&db);
+  g_timer_destroy (timer);
+
+  g_printf ("%i records decoded in %f seconds, loaded from cache in %f seconds\n",
+            samples, time_decode, time_cached);
+
+  g_printf ("Test passed.\n");
+  return 0;
+}
+
+/* Функция проверяет все столбцы и интерфейс HyScanNavData. */
+void
+check_store (HyScanNavStore *store,
+             gint            samples)
+{
+  HyScanNavData *ndata = HYSCAN_NAV_DATA (store);
+  const gint64 *times;
+  const gdouble *values;
+  guint32 lindex, rindex;
+  guint32 first, last;
+  gint64 ltime, rtime;
+  gdouble value;
+  guint32 n;
+  gint i, k;
+
+  n = hyscan_nav_store_get_column (store, HYSCAN_NAV_STORE_DEPTH, &times, &values);
+  if (n != (guint32) samples)
+    g_error ("Depth column size mismatch: %u", n);
+
+  for (i = 0; i < samples; i++)
+    {
+      if ((times[i] != START_TIME + i * TIME_INCREMENT) || (values[i] != 10.0 + i))
+        g_error ("Depth mismatch at %d", i);
+    }
+
+  n = hyscan_nav_store_get_column (store, HYSCAN_NAV_STORE_HEADING, NULL, &values);
+  if ((n != (guint32) samples) || (values[samples - 1] != (samples - 1) % 360))
+    g_error ("Heading column mismatch");
+
+  /* Недостоверные RMC пропускаются. */
+  n = hyscan_nav_store_get_column (store, HYSCAN_NAV_STORE_LAT, &times, &values);
+  if (n != (guint32) (samples - (samples + 9) / 10))
+    g_error ("Latitude column size mismatch: %u", n);
+
+  for (i = 1, k = 0; i < samples; i++)
+    {
+      if (i % 10 == 0)
+        continue;
+
+      if ((times[k] != START_TIME + i * TIME_INCREMENT) ||
+          (fabs (values[k] - (-(55.0 + (i % 60) / 60.0))) > 1e-9))
+        {
+          g_error ("Latitude mismatch at %d", i);
+        }
+
+      k++;
+    }
+
+  n = hyscan_nav_store_get_column (store, HYSCAN_NAV_STORE_SPEED, NULL, &values);
+  if (fabs (values[0] - 1852.0 / 3600.0) > 1e-9)
+    g_error ("Speed mismatch");
+
+  /* Интерфейс HyScanNavData. */
+  if (!hyscan_nav_data_get_range (ndata, &first, &last) ||
+      (first != 0) || (last != (guint32) samples - 1))
+    {
+      g_error ("Range mismatch");
+    }
+
+  k = samples / 2;
+  if ((hyscan_nav_data_find_data (ndata, START_TIME + k * TIME_INCREMENT + 1,
+                                  &lindex, &rindex, &ltime, &rtime) != HYSCAN_DB_FIND_OK) ||
+      (lindex != (guint32) k) || (rindex != (guint32) k + 1) ||
+      (ltime != START_TIME + k * TIME_INCREMENT))
+    {
+      g_error ("Find failure");
+    }
+
+  if ((hyscan_nav_data_find_data (ndata, START_TIME + k * TIME_INCREMENT,
+                                  &lindex, &rindex, NULL, NULL) != HYSCAN_DB_FIND_OK) ||
+      (lindex != (guint32) k) || (rindex != (guint32) k))
+    {
+      g_error ("Exact find failure");
+    }
+
+  if (hyscan_nav_data_find_data (ndata, START_TIME - 1, NULL, NULL, NULL, NULL) != HYSCAN_DB_FIND_LESS)
+    g_error ("Find less failure");
+
+  if (!hyscan_nav_data_get (ndata, k, NULL, &value) || (value != 10.0 + k))
+    g_error ("Get failure");
+}
+
+/* Функция проверяет интерполяцию глубины и курса. */
+void
+check_interp (HyScanDataWriter *writer,
+              HyScanDB         *db,
+              const gchar      *name,
+              gint              samples)
+{
+  HyScanNavStore *depth, *heading;
+  HyScanNavInterp *cubic, *angular;
+  gint64 *times;
+  gdouble *values;
+  gint n_times = 4 * (samples - 1);
+  gint i;
+
+  depth = hyscan_nav_store_new (db, name, name, SENSOR_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  heading = hyscan_nav_store_new (db, name, name, SENSOR_CHANNEL, HYSCAN_NAV_STORE_HEADING);
+
+  /* Глубина линейно растёт - кубическая интерполяция должна быть точной. */
+  cubic = hyscan_nav_interp_new (HYSCAN_NAV_DATA (depth), HYSCAN_NAV_INTERP_CUBIC, FALSE);
+
+  times = g_new (gint64, n_times + 1);
+  values = g_new (gdouble, n_times + 1);
+
+  for (i = 0; i <= n_times; i++)
+    times[i] = START_TIME + i * (TIME_INCREMENT / 4);
+
+  if (hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (cubic), times, n_times + 1, values) != (guint) n_times + 1)
+    g_error ("Interpolation count mismatch");
+
+  for (i = 0; i <= n_times; i++)
+    {
+      if (fabs (values[i] - (10.0 + i / 4.0)) > 1e-6)
+        g_error ("Cubic interpolation mismatch at %d: %f", i, values[i]);
+    }
+
+  /* Вне диапазона данных значение не определено. */
+  times[0] = START_TIME - 1;
+  if ((hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (cubic), times, 1, values) != 0) || !isnan (values[0]))
+    g_error ("Out of range interpolation failure");
+
+  /* Курс переходит через 0 между записями 359 и 360. */
+  angular = hyscan_nav_interp_new (HYSCAN_NAV_DATA (heading), HYSCAN_NAV_INTERP_LINEAR, TRUE);
+  if (samples > 360)
+    {
+      gdouble expected[] = { 359.0, 359.25, 359.5, 359.75, 0.0 };
+      gdouble value;
+
+      if (!hyscan_nav_interp_get_value (angular, START_TIME + 359.5 * TIME_INCREMENT, &value) ||
+          (fabs (value - 359.5) > 1e-6))
+        {
+          g_error ("Heading wrap-around failure");
+        }
+
+      /* Линейная интерполяция самого столбца курса. */
+      for (i = 0; i < (gint) G_N_ELEMENTS (expected); i++)
+        times[i] = START_TIME + 359 * TIME_INCREMENT + i * (TIME_INCREMENT / 4);
+
+      if (hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (heading), times,
+                                        G_N_ELEMENTS (expected), values) != G_N_ELEMENTS (expected))
+        {
+          g_error ("Heading interpolation count mismatch");
+        }
+
+      for (i = 0; i < (gint) G_N_ELEMENTS (expected); i++)
+        {
+          if (fabs (values[i] - expected[i]) > 1e-6)
+            g_error ("Heading store wrap-around failure at %d: %f", i, values[i]);
+        }
+
+      /* Развёрнутый курс растёт линейно - кубическая интерполяция точна
+       * и при переходе через 0. */
+      g_object_unref (angular);
+      angular = hyscan_nav_interp_new (HYSCAN_NAV_DATA (heading), HYSCAN_NAV_INTERP_CUBIC, TRUE);
+
+      if (hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (angular), times,
+                                        G_N_ELEMENTS (expected), values) != G_N_ELEMENTS (expected))
+        {
+          g_error ("Cubic heading interpolation count mismatch");
+        }
+
+      for (i = 0; i < (gint) G_N_ELEMENTS (expected); i++)
+        {
+          if (fabs (values[i] - expected[i]) > 1e-6)
+            g_error ("Cubic heading wrap-around failure at %d: %f", i, values[i]);
+        }
+    }
+
+  g_free (times);
+  g_free (values);
+
+  check_steps (writer, db, name);
+
+  g_object_unref (cubic);
+  g_object_unref (angular);
+  g_object_unref (depth);
+  g_object_unref (heading);
+}
+
+/* Функция проверяет кубическую интерполяцию ступенчатой глубины: значения
+ * не выходят за пределы соседних записей, а коэффициенты, вычисленные по
+ * частям при дозаписи данных, совпадают с вычисленными за один раз. */
+void
+check_steps (HyScanDataWriter *writer,
+             HyScanDB         *db,
+             const gchar      *name)
+{
+  HyScanNavStore *store, *full_store;
+  HyScanNavInterp *incremental, *full;
+  gint64 times[4 * (STEP_SAMPLES - 1) + 1];
+  gdouble values[4 * (STEP_SAMPLES - 1) + 1];
+  gdouble full_values[4 * (STEP_SAMPLES - 1) + 1];
+  gint n_times = 4 * (STEP_SAMPLES - 1) + 1;
+  gint n_half = 4 * (STEP_SAMPLES / 2 - 1) + 1;
+  gint i;
+
+  for (i = 0; i < n_times; i++)
+    times[i] = START_TIME + i * (TIME_INCREMENT / 4);
+
+  /* Первая половина данных. */
+  write_steps (writer, 0, STEP_SAMPLES / 2);
+
+  store = hyscan_nav_store_new (db, name, name, STEP_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  if (store == NULL)
+    g_error ("Step store creation failure");
+
+  incremental = hyscan_nav_interp_new (HYSCAN_NAV_DATA (store), HYSCAN_NAV_INTERP_CUBIC, FALSE);
+  if (hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (incremental), times, n_half, values) != (guint) n_half)
+    g_error ("Step interpolation count mismatch");
+
+  /* Дозапись второй половины и пересчёт только новых отрезков. */
+  write_steps (writer, STEP_SAMPLES / 2, STEP_SAMPLES);
+
+  if (hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (incremental), times, n_times, values) != (guint) n_times)
+    g_error ("Incremental interpolation count mismatch");
+
+  full_store = hyscan_nav_store_new (db, name, name, STEP_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  full = hyscan_nav_interp_new (HYSCAN_NAV_DATA (full_store), HYSCAN_NAV_INTERP_CUBIC, FALSE);
+  if (hyscan_nav_data_get_at_times (HYSCAN_NAV_DATA (full), times, n_times, full_values) != (guint) n_times)
+    g_error ("Full interpolation count mismatch");
+
+  for (i = 0; i < n_times; i++)
+    {
+      gdouble v0 = step_depth (i / 4);
+      gdouble v1 = step_depth (MIN (i / 4 + 1, STEP_SAMPLES - 1));
+
+      if (fabs (values[i] - full_values[i]) > 1e-9)
+        g_error ("Incremental interpolation mismatch at %d: %f, %f", i, values[i], full_values[i]);
+
+      if ((values[i] < MIN (v0, v1) - 1e-9) || (values[i] > MAX (v0, v1) + 1e-9))
+        g_error ("Cubic interpolation overshoot at %d: %f", i, values[i]);
+    }
+
+  g_object_unref (incremental);
+  g_object_unref (full);
+  g_object_unref (store);
+  g_object_unref (full_store);
+}
+
+/* Ступенчатая глубина: площадки по три записи, чередующиеся подъёмы и
+ * спуски разной высоты. */
+gdouble
+step_depth (gint i)
+{
+  gdouble levels[] = { 10.0, 20.0, 12.0, 12.5, 30.0, 5.0 };
+
+  return levels[(i / 3) % G_N_ELEMENTS (levels)];
+}
+
+/* Функция записывает ступенчатую глубину с from по to - 1 запись. */
+void
+write_steps (HyScanDataWriter *writer,
+             gint              from,
+             gint              to)
+{
+  HyScanBuffer *buffer = hyscan_buffer_new ();
+  gint i;
+
+  for (i = from; i < to; i++)
+    {
+      gchar *data = hyscan_nmea_gen_sentence ("SDDPT,%.1f,0.0", step_depth (i));
+
+      hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+      hyscan_data_writer_sensor_add_data (writer, SENSOR_NAME, HYSCAN_SOURCE_NMEA,
+                                          STEP_CHANNEL, START_TIME + i * TIME_INCREMENT, buffer);
+      g_free (data);
+    }
+
+  g_object_unref (buffer);
+}
+
+/* Функция формирует запись с сообщениями RMC, DPT и HDT. */
+gchar *
+nmea_record (gint i)
+{
+  gchar *rmc, *dpt, *hdt, *record;
+
+  /* Широта 55 градусов (i % 60) минут южной широты, скорость 1 узел. */
+  rmc = hyscan_nmea_gen_sentence ("GPRMC,120000.000,%c,55%02d.0000,S,03800.0000,E,1.0,90.0,010120,,",
+                                  (i % 10 == 0) ? 'V' : 'A', i % 60);
+  dpt = hyscan_nmea_gen_sentence ("SDDPT,%d.0,0.0", 10 + i);
+  hdt = hyscan_nmea_gen_sentence ("HEHDT,%d.0,T", i % 360);
+
+  record = g_strconcat (rmc, dpt, hdt, NULL);
+
+  g_free (rmc);
+  g_free (dpt);
+  g_free (hdt);
+
+  return record;
+}
@@ -36,6 +36,8 @@ main (int argc, char **argv)
   gint readouts = 100;
   GTimer *timer = g_timer_new ();
   gdouble time_with_cache, time_without_cache;
+  gdouble time_split, time_spans;
+  guint n_sentences = 0;
 
   /* Парсим аргументы. */
   {
@@ -180,6 +182,66 @@ main (int argc, char **argv)
     }
   time_with_cache = g_timer_elapsed (timer, NULL);
 
+  /* Индекс сообщений по типам. */
+  {
+    const gchar *sentence;
+    gchar *expected;
+    guint32 lentry, rentry;
+    guint32 length;
+    gint64 ltime, rtime;
+    guint k = samples / 2;
+
+    if (hyscan_nmea_data_index_type (nmea, HYSCAN_NMEA_DATA_DPT) != (guint32) samples)
+      g_error ("DPT index size mismatch");
+    if (hyscan_nmea_data_index_type (nmea, HYSCAN_NMEA_DATA_RMC) != 0)
+      g_error ("RMC index size mismatch");
+
+    if ((hyscan_nmea_data_find_type (nmea, HYSCAN_NMEA_DATA_DPT, START_TIME + k * TIME_INCREMENT + 1,
+                                     &lentry, &rentry, &ltime, &rtime) != HYSCAN_DB_FIND_OK) ||
+        (lentry != k) || (rentry != k + 1))
+      {
+        g_error ("DPT index find failure");
+      }
+
+    if (hyscan_nmea_data_find_type (nmea, HYSCAN_NMEA_DATA_DPT, START_TIME - 1,
+                                    NULL, NULL, NULL, NULL) != HYSCAN_DB_FIND_LESS)
+      {
+        g_error ("DPT index find failure");
+      }
+
+    sentence = hyscan_nmea_data_get_type_sentence (nmea, HYSCAN_NMEA_DATA_DPT, k, &length, NULL);
+    expected = nmea_generator ("DPT", k);
+    if ((sentence == NULL) || (length != strlen (expected)) || (strncmp (sentence, expected, length) != 0))
+      g_error ("DPT index sentence mismatch");
+
+    g_free (expected);
+  }
+
+  /* Дозапись данных дополняет индекс, а явно построенный индекс
+   * используется другим объектом через кэш. */
+  {
+    HyScanNMEAData *second;
+    gchar *data = nmea_generator ("DPT", samples);
+
+    hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+    hyscan_data_writer_sensor_add_data (writer, SENSOR_NAME, HYSCAN_SOURCE_NMEA,
+                                        SENSOR_CHANNEL, time, buffer);
+    g_free (data);
+
+    if (hyscan_nmea_data_index_type (nmea, HYSCAN_NMEA_DATA_DPT) != (guint32) samples + 1)
+      g_error ("DPT index append failure");
+
+    if (!hyscan_nmea_data_build_index (nmea))
+      g_error ("Index build failure");
+
+    second = hyscan_nmea_data_new_sensor (db, name, name, SENSOR_NAME);
+    hyscan_nmea_data_set_cache (second, cache);
+    if (hyscan_nmea_data_index_type (second, HYSCAN_NMEA_DATA_DPT) != (guint32) samples + 1)
+      g_error ("Cached DPT index size mismatch");
+
+    g_object_unref (second);
+  }
+
   /* Функция hyscan_nmea_data_check_sentence. */
   {
     gchar *data;
@@ -200,6 +262,49 @@ main (int argc, char **argv)
     g_free (data);
   }
 
+  /* Функция hyscan_nmea_data_check_sentences. */
+  {
+    const gchar *prefixes[] = { "DPT", "GGA", "RMC", "HDT", "VTG", "ZDA", "GLL", "GSV" };
+    HyScanNmeaDataType expected[] = { HYSCAN_NMEA_DATA_DPT, HYSCAN_NMEA_DATA_GGA,
+                                      HYSCAN_NMEA_DATA_RMC, HYSCAN_NMEA_DATA_HDT,
+                                      HYSCAN_NMEA_DATA_VTG, HYSCAN_NMEA_DATA_ZDA,
+                                      HYSCAN_NMEA_DATA_GLL, HYSCAN_NMEA_DATA_ANY,
+                                      HYSCAN_NMEA_DATA_INVALID };
+    HyScanNmeaSpan spans[4];
+    HyScanNmeaDataType types[4];
+    GString *batch = g_string_new (NULL);
+    guint32 position = 0;
+    guint n_checked = 0;
+    guint n;
+
+    for (i = 0; i < (gint) G_N_ELEMENTS (prefixes); i++)
+      {
+        gchar *data = nmea_generator ((gchar *) prefixes[i], i);
+
+        g_string_append (batch, data);
+        g_string_append (batch, "\r\n");
+        g_free (data);
+      }
+
+    /* Сообщение с испорченной контрольной суммой. */
+    g_string_append (batch, "$GPDPT,1.0,0.0*00\r\n");
+
+    while ((n = hyscan_nmea_data_check_sentences (batch->str, batch->len, &position,
+                                                  spans, types, G_N_ELEMENTS (spans))) > 0)
+      {
+        for (j = 0; j < (gint) n; j++, n_checked++)
+          {
+            if ((n_checked >= G_N_ELEMENTS (expected)) || (types[j] != expected[n_checked]))
+              g_error ("Batch check failure at sentence %u", n_checked);
+          }
+      }
+
+    if (n_checked != G_N_ELEMENTS (expected))
+      g_error ("Batch check count mismatch");
+
+    g_string_free (batch, TRUE);
+  }
+
   /* Функция hyscan_nmea_data_split_sentence. */
   {
     gchar *data;
@@ -239,9 +344,142 @@ main (int argc, char **argv)
       }
 
     g_strfreev (res);
+
+    /* Те же сообщения через hyscan_nmea_data_next_sentence. */
+    {
+      HyScanNmeaSpan span, field;
+      guint32 position = 0;
+      guint32 field_pos;
+
+      for (i = 0; hyscan_nmea_data_next_sentence (data, len, &position, &span); i++)
+        {
+          if ((i >= 5) || (span.length != strlen (samples[i])) ||
+              (strncmp (span.data, samples[i], span.length) != 0))
+            {
+              g_error ("Sentence span %d mismatch", i);
+            }
+        }
+
+      if (i != 5)
+        g_error ("Sentence span count mismatch");
+
+      /* Поля первого сообщения. */
+      position = 0;
+      hyscan_nmea_data_next_sentence (data, len, &position, &span);
+      for (field_pos = 0, j = 0; hyscan_nmea_data_next_field (&span, &field_pos, &field); j++)
+        {
+          if ((j == 0) && (strncmp (field.data, "GPRMC", field.length) != 0))
+            g_error ("Address field mismatch");
+          if ((j == 11) && (strncmp (field.data, "W", field.length) != 0))
+            g_error ("Last field mismatch");
+        }
+
+      if (j != 12)
+        g_error ("Field count mismatch: %d", j);
+    }
+
+    g_free (data);
+  }
+
+  /* Обрезанное сообщение без контрольной суммы не должно поглощать
+   * следующее за ним корректное сообщение. */
+  {
+    const gchar *truncated = "$GPDPT,1.0,0.0";
+    HyScanNmeaSpan span;
+    guint32 position = 0;
+    gchar *valid;
+    gchar *data;
+    gchar **res;
+    guint32 len;
+
+    valid = nmea_generator ("DPT", 1);
+    data = g_strdup_printf ("%s%s\r\n", truncated, valid);
+    len = strlen (data);
+
+    if (!hyscan_nmea_data_next_sentence (data, len, &position, &span) ||
+        (span.length != strlen (truncated)) ||
+        (hyscan_nmea_data_check_span (&span) != HYSCAN_NMEA_DATA_INVALID))
+      {
+        g_error ("Truncated sentence span mismatch");
+      }
+
+    if (!hyscan_nmea_data_next_sentence (data, len, &position, &span) ||
+        (span.length != strlen (valid)) ||
+        (strncmp (span.data, valid, span.length) != 0) ||
+        (hyscan_nmea_data_check_span (&span) != HYSCAN_NMEA_DATA_DPT))
+      {
+        g_error ("Sentence after truncated one is lost");
+      }
+
+    if (hyscan_nmea_data_next_sentence (data, len, &position, &span))
+      g_error ("Extra sentence after truncated one");
+
+    res = hyscan_nmea_data_split_sentence (data, len);
+    if ((g_strv_length (res) != 2) || (g_strcmp0 (res[1], valid) != 0))
+      g_error ("Split of truncated sentence failure");
+
+    g_strfreev (res);
+    g_free (valid);
     g_free (data);
   }
 
+  /* Разбор синтетического галса: hyscan_nmea_data_split_sentence + g_strsplit
+   * против hyscan_nmea_data_next_sentence + hyscan_nmea_data_next_field. */
+  {
+    GString *track = g_string_new (NULL);
+    guint n_fields_split = 0;
+    guint n_fields_spans = 0;
+    gchar **res;
+
+    for (i = 0; i < 10 * samples; i++)
+      {
+        gchar *data = nmea_generator ((i % 2) ? "RMC,131548.000,A,5533.1654,N,03806.2259,E" : "GGA,131548.000,1,19", i);
+
+        g_string_append (track, data);
+        g_string_append (track, "\r\n");
+        g_free (data);
+      }
+
+    g_timer_start (timer);
+
+    res = hyscan_nmea_data_split_sentence (track->str, track->len);
+    for (i = 0; res[i] != NULL; i++)
+      {
+        gchar **fields = g_strsplit (res[i], ",", -1);
+
+        n_fields_split += g_strv_length (fields);
+        g_strfreev (fields);
+      }
+    g_strfreev (res);
+
+    time_split = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+
+    {
+      HyScanNmeaSpan span, field;
+      guint32 position = 0;
+
+      while (hyscan_nmea_data_next_sentence (track->str, track->len, &position, &span))
+        {
+          guint32 field_pos = 0;
+
+          while (hyscan_nmea_data_next_field (&span, &field_pos, &field))
+            n_fields_spans++;
+
+          n_sentences++;
+        }
+    }
+
+    time_spans = g_timer_elapsed (timer, NULL);
+
+    if ((n_sentences != 10 * (guint) samples) || (n_fields_split != n_fields_spans))
+      g_error ("Tokenizer mismatch: %u sentences, %u vs %u fields",
+               n_sentences, n_fields_split, n_fields_spans);
+
+    g_string_free (track, TRUE);
+  }
+
   hyscan_db_project_remove (db, name);
 
   g_clear_object (&db);
@@ -256,6 +494,8 @@ main (int argc, char **argv)
             time_without_cache, time_without_cache / (readouts * samples));
   g_printf ("%f seconds (%f per sample) with cache\n",
             time_with_cache, time_with_cache / (readouts * samples));
+  g_printf ("%u sentences tokenized in %f seconds with split_sentence, %f seconds with spans\n",
+            n_sentences, time_split, time_spans);
 
   g_printf ("Test passed.\n");
   return 0;
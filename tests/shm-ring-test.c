@@ -0,0 +1,326 @@
+/* shm-ring-test.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-shm-ring.h>
+
+#define N_SLOTS        16                    /* Число ячеек буфера. */
+#define N_POINTS       1024                  /* Число точек в строке. */
+#define N_LINES        100                   /* Число строк для тестирования. */
+#define N_READERS      4                     /* Число потоков чтения. */
+
+static gchar    *ring_name;                  /* Название буфера. */
+static gboolean  writer_done;                /* Признак завершения записи. */
+
+static void              fill_line           (HyScanBuffer   *buffer,
+                                              guint32         index);
+static gboolean          check_line          (const gfloat   *data,
+                                              guint32         n_points);
+static void              test_sequential     (void);
+static gpointer          reader_thread       (gpointer        data);
+static void              test_concurrent     (void);
+static void              test_reuse          (void);
+
+/* Функция заполняет строку данных. Все точки строки содержат её номер. */
+static void
+fill_line (HyScanBuffer *buffer,
+           guint32       index)
+{
+  gfloat *data;
+  guint32 i;
+
+  hyscan_buffer_set_float (buffer, NULL, N_POINTS);
+  data = hyscan_buffer_get_float (buffer, NULL);
+
+  for (i = 0; i < N_POINTS; i++)
+    data[i] = index;
+}
+
+/* Функция проверяет целостность строки данных. */
+static gboolean
+check_line (const gfloat *data,
+            guint32       n_points)
+{
+  guint32 i;
+
+  for (i = 1; i < n_points; i++)
+    if (data[i] != data[0])
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Тест последовательной записи и чтения, в том числе после перезаписи. */
+static void
+test_sequential (void)
+{
+  HyScanShmRing *writer;
+  HyScanShmRing *reader;
+  HyScanBuffer *buffer;
+  HyScanShmRingLine line;
+  guint32 head;
+  guint32 i;
+
+  writer = hyscan_shm_ring_create (ring_name, N_SLOTS - 1, N_POINTS * sizeof (gfloat));
+  g_assert_nonnull (writer);
+  g_assert_cmpuint (hyscan_shm_ring_get_n_slots (writer), ==, N_SLOTS);
+
+  reader = hyscan_shm_ring_open (ring_name);
+  g_assert_nonnull (reader);
+  g_assert_cmpuint (hyscan_shm_ring_get_n_slots (reader), ==, N_SLOTS);
+  g_assert_cmpuint (hyscan_shm_ring_get_slot_size (reader), ==, N_POINTS * sizeof (gfloat));
+
+  /* Читатель не может писать в буфер. */
+  buffer = hyscan_buffer_new ();
+  fill_line (buffer, 0);
+  g_assert_false (hyscan_shm_ring_write (reader, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1, 0, 1.0, buffer));
+
+  /* Пустой буфер. Пустые ячейки не совпадают ни с одним номером строки. */
+  g_assert_cmpuint (hyscan_shm_ring_get_head (reader), ==, 0);
+  for (i = 0; i < 2 * N_SLOTS; i++)
+    {
+      g_assert_false (hyscan_shm_ring_peek (reader, i, &line));
+      g_assert_false (hyscan_shm_ring_peek (reader, G_MAXUINT32 - i, &line));
+    }
+
+  for (i = 0; i < N_LINES; i++)
+    {
+      fill_line (buffer, i);
+      g_assert_true (hyscan_shm_ring_write (writer, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1,
+                                            1000 * i, 10000.0, buffer));
+    }
+
+  head = hyscan_shm_ring_get_head (reader);
+  g_assert_cmpuint (head, ==, N_LINES);
+
+  /* Перезаписанные строки недоступны. */
+  for (i = 0; i < head - N_SLOTS; i++)
+    g_assert_false (hyscan_shm_ring_peek (reader, i, &line));
+
+  /* Последние строки доступны без копирования. */
+  for (i = head - N_SLOTS; i < head; i++)
+    {
+      const gfloat *data;
+
+      g_assert_true (hyscan_shm_ring_peek (reader, i, &line));
+
+      data = line.data;
+      g_assert_cmpint (line.source, ==, HYSCAN_SOURCE_SIDE_SCAN_PORT);
+      g_assert_cmpuint (line.channel, ==, 1);
+      g_assert_cmpint (line.time, ==, 1000 * i);
+      g_assert_cmpint (line.data_type, ==, HYSCAN_DATA_FLOAT);
+      g_assert_cmpfloat (line.data_rate, ==, 10000.0);
+      g_assert_cmpuint (line.size, ==, N_POINTS * sizeof (gfloat));
+      g_assert_cmpfloat (data[0], ==, i);
+      g_assert_true (check_line (data, N_POINTS));
+      g_assert_true (hyscan_shm_ring_check (reader, i));
+    }
+
+  /* Ещё не записанная строка. */
+  g_assert_false (hyscan_shm_ring_peek (reader, head, &line));
+
+  /* После записи новой строки самая старая становится недоступной. */
+  g_assert_true (hyscan_shm_ring_peek (reader, head - N_SLOTS, &line));
+  fill_line (buffer, head);
+  hyscan_shm_ring_write (writer, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1, 1000 * head, 10000.0, buffer);
+  g_assert_false (hyscan_shm_ring_check (reader, head - N_SLOTS));
+
+  /* Слишком большая строка не записывается. */
+  hyscan_buffer_set_float (buffer, NULL, N_POINTS + 1);
+  g_assert_false (hyscan_shm_ring_write (writer, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1, 0, 1.0, buffer));
+
+  g_object_unref (buffer);
+  g_object_unref (reader);
+  g_object_unref (writer);
+
+  /* После удаления записывающей стороны буфер удаляется из системы. */
+  g_assert_null (hyscan_shm_ring_open (ring_name));
+}
+
+/* Поток чтения данных. */
+static gpointer
+reader_thread (gpointer data)
+{
+  HyScanShmRing *reader;
+  HyScanBuffer *buffer;
+  guint32 seq = 0;
+  guint n_read = 0;
+
+  reader = hyscan_shm_ring_open (ring_name);
+  g_assert_nonnull (reader);
+
+  buffer = hyscan_buffer_new ();
+
+  while (TRUE)
+    {
+      HyScanShmRingLine line;
+      gboolean done = g_atomic_int_get (&writer_done);
+      guint32 head = hyscan_shm_ring_get_head (reader);
+
+      /* Пропускаем перезаписанные строки. */
+      if (head - seq > N_SLOTS)
+        seq = head - N_SLOTS;
+
+      for (; seq != head; seq++)
+        {
+          if (!hyscan_shm_ring_read (reader, seq, &line, buffer))
+            continue;
+
+          g_assert_true (check_line (line.data, line.size / sizeof (gfloat)));
+          g_assert_cmpint (line.time, ==, 1000 * (gint64)((const gfloat *)line.data)[0]);
+          n_read += 1;
+        }
+
+      if (done)
+        break;
+
+      g_usleep (100);
+    }
+
+  g_object_unref (buffer);
+  g_object_unref (reader);
+
+  return GUINT_TO_POINTER (n_read);
+}
+
+/* Тест одновременной записи и чтения несколькими читателями. */
+static void
+test_concurrent (void)
+{
+  HyScanShmRing *writer;
+  HyScanBuffer *buffer;
+  GThread *readers[N_READERS];
+  guint32 i;
+
+  writer = hyscan_shm_ring_create (ring_name, N_SLOTS, N_POINTS * sizeof (gfloat));
+  g_assert_nonnull (writer);
+
+  writer_done = FALSE;
+  for (i = 0; i < N_READERS; i++)
+    readers[i] = g_thread_new ("shm-reader", reader_thread, NULL);
+
+  buffer = hyscan_buffer_new ();
+  for (i = 0; i < 100 * N_LINES; i++)
+    {
+      fill_line (buffer, i);
+      hyscan_shm_ring_write (writer, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1, 1000 * i, 10000.0, buffer);
+
+      if ((i % N_SLOTS) == 0)
+        g_usleep (50);
+    }
+
+  g_atomic_int_set (&writer_done, TRUE);
+
+  for (i = 0; i < N_READERS; i++)
+    {
+      guint n_read = GPOINTER_TO_UINT (g_thread_join (readers[i]));
+
+      g_message ("Reader %d: %d lines", i, n_read);
+      g_assert_cmpuint (n_read, >, 0);
+    }
+
+  g_object_unref (buffer);
+  g_object_unref (writer);
+}
+
+/* Тест повторного использования существующего буфера. */
+static void
+test_reuse (void)
+{
+  HyScanShmRing *writer1;
+  HyScanShmRing *writer2;
+  HyScanShmRing *reader;
+  HyScanBuffer *buffer;
+  HyScanShmRingLine line;
+  guint32 i;
+
+  writer1 = hyscan_shm_ring_create (ring_name, N_SLOTS, N_POINTS * sizeof (gfloat));
+  g_assert_nonnull (writer1);
+
+  buffer = hyscan_buffer_new ();
+  for (i = 0; i < N_SLOTS / 2; i++)
+    {
+      fill_line (buffer, i);
+      hyscan_shm_ring_write (writer1, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1, 1000 * i, 10000.0, buffer);
+    }
+
+  reader = hyscan_shm_ring_open (ring_name);
+  g_assert_nonnull (reader);
+
+  /* Буфер с другими размерами не создаётся, существующий не удаляется. */
+  g_assert_null (hyscan_shm_ring_create (ring_name, N_SLOTS, 2 * N_POINTS * sizeof (gfloat)));
+  g_assert_null (hyscan_shm_ring_create (ring_name, 2 * N_SLOTS, N_POINTS * sizeof (gfloat)));
+
+  /* Буфер с теми же размерами используется повторно, нумерация строк
+   * продолжается, ранее записанные строки остаются доступными. */
+  writer2 = hyscan_shm_ring_create (ring_name, N_SLOTS, N_POINTS * sizeof (gfloat));
+  g_assert_nonnull (writer2);
+  g_assert_cmpuint (hyscan_shm_ring_get_head (writer2), ==, N_SLOTS / 2);
+
+  fill_line (buffer, N_SLOTS / 2);
+  g_assert_true (hyscan_shm_ring_write (writer2, HYSCAN_SOURCE_SIDE_SCAN_PORT, 1,
+                                        1000 * (N_SLOTS / 2), 10000.0, buffer));
+  g_assert_cmpuint (hyscan_shm_ring_get_head (reader), ==, N_SLOTS / 2 + 1);
+
+  for (i = 0; i <= N_SLOTS / 2; i++)
+    {
+      g_assert_true (hyscan_shm_ring_read (reader, i, &line, buffer));
+      g_assert_cmpfloat (((const gfloat *)line.data)[0], ==, i);
+      g_assert_cmpint (line.time, ==, 1000 * i);
+    }
+
+  g_object_unref (buffer);
+  g_object_unref (reader);
+  g_object_unref (writer2);
+  g_object_unref (writer1);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  ring_name = g_strdup_printf ("hyscan-shm-ring-test-%08x", g_random_int ());
+
+  g_message ("Test sequential access");
+  test_sequential ();
+
+  g_message ("Test concurrent access");
+  test_concurrent ();
+
+  g_message ("Test ring reuse");
+  test_reuse ();
+
+  g_free (ring_name);
+
+  return 0;
+}
@@ -0,0 +1,521 @@
+/* track-player-test.c
+ *
+ * Copyright 2019 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanCore library.
+ *
+ * HyScanCore is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanCore is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanCore имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanCore на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-track-player.h>
+#include <hyscan-nav-store.h>
+#include <hyscan-acoustic-data.h>
+#include <hyscan-data-writer.h>
+#include "hyscan-nmea-gen.h"
+
+#include <string.h>
+
+#define PROJECT_NAME           "test"
+#define TRACK_NAME             "track-player"
+#define SENSOR_NAME            "sensor"
+#define SENSOR_CHANNEL         1
+#define START_TIME             G_GINT64_CONSTANT (10000000000)
+#define DEPTH_BASE             10
+#define END_DELAY              0.5
+#define SONAR_SOURCE           HYSCAN_SOURCE_SIDE_SCAN_STARBOARD
+#define SONAR_CHANNEL          1
+#define SONAR_POINTS           32
+#define SONAR_BURST            1000
+#define PLAYER_MAX_LINES       256             /* Лимит строк источника за период в проигрывателе. */
+
+enum {
+  CONTROL_RANGE_TEST,
+  CONTROL_PLAY_TEST,
+  CONTROL_END_TEST,
+  CONTROL_REWIND_PLAY_TEST,
+  CONTROL_SOURCE_TEST,
+  CONTROL_AMPLITUDE_TEST,
+  CONTROL_LAST
+};
+
+gchar                         *db_uri = NULL;
+guint                          n_lines = 50;
+guint                          n_fps = 30;
+guint                          n_rate = 10;
+gdouble                        play_speed = 10.0;
+
+HyScanDB                      *db;
+HyScanTrackPlayer             *player;
+HyScanNavStore                *depth;
+HyScanNavStore                *depth2;
+HyScanAcousticData            *sonar;
+
+GMainLoop                     *loop;
+GTimer                        *timer;
+GTimer                        *line_timer;
+
+gboolean                       range_checked = FALSE;
+gint                           direction = 1;
+gint64                         last_index[3] = { -1, -1, -1 };
+gint64                         last_time = G_MININT64;
+guint                          n_received[3] = { 0, 0, 0 };
+
+/* Функция возвращает метку времени строки. */
+gint64
+line_time (guint32 index)
+{
+  return START_TIME + index * (G_USEC_PER_SEC / n_rate);
+}
+
+/* Функция возвращает сдвиг времени проигрывателя за один период. */
+gint64
+play_step (void)
+{
+  return play_speed * (G_USEC_PER_SEC / CLAMP (n_fps, 1, 100));
+}
+
+/* Функция возвращает метку времени строки гидролокатора. Первые SONAR_BURST
+ * строк записаны с интервалом в одну микросекунду и попадают в первый же
+ * период воспроизведения. Остальные строки записаны с тем же темпом, что и
+ * глубина, после паузы в несколько периодов. */
+gint64
+sonar_time (guint32 index)
+{
+  if (index < SONAR_BURST)
+    return START_TIME + index;
+
+  return line_time (index - SONAR_BURST) + 2 * play_step ();
+}
+
+/* Функция возвращает амплитуду строки гидролокатора. */
+gfloat
+sonar_value (guint32 index)
+{
+  return (index % 256) / 256.0;
+}
+
+/* Функция сбрасывает состояние проверки перед воспроизведением. */
+void
+lines_reset (gint    new_direction,
+             gint64  index)
+{
+  direction = new_direction;
+  last_index[0] = index;
+  last_index[1] = last_index[2] = -1;
+  last_time = (direction > 0) ? G_MININT64 : G_MAXINT64;
+  n_received[0] = n_received[1] = n_received[2] = 0;
+  g_timer_start (line_timer);
+}
+
+/* Функция тестирования. */
+gboolean
+control_test (gpointer user_data)
+{
+  static guint test_step = CONTROL_RANGE_TEST;
+  static guint source_id = G_MAXUINT;
+  static gboolean end_seek = FALSE;
+
+  /* Проверка таймаута. */
+  if (g_timer_elapsed (timer, NULL) > 2.0)
+    g_error ("timeout at test %d", test_step);
+
+  /* Проверка диапазона времени данных. */
+  if (test_step == CONTROL_RANGE_TEST)
+    {
+      if (!range_checked)
+        return TRUE;
+
+      g_message ("Play test");
+
+      lines_reset (1, -1);
+      hyscan_track_player_play (player, play_speed);
+      test_step += 1;
+    }
+
+  /* Прямое воспроизведение до конца данных. */
+  else if (test_step == CONTROL_PLAY_TEST)
+    {
+      if (last_index[0] != n_lines - 1)
+        return TRUE;
+
+      if (n_received[0] != n_lines)
+        g_error ("play lines count mismatch %d", n_received[0]);
+
+      g_message ("End of data test");
+      test_step += 1;
+    }
+
+  /* После окончания данных проигрыватель должен встать на паузу: строки
+   * больше не отправляются, в том числе после перемотки. */
+  else if (test_step == CONTROL_END_TEST)
+    {
+      if (g_timer_elapsed (line_timer, NULL) < END_DELAY)
+        return TRUE;
+
+      if (n_received[0] != n_lines)
+        g_error ("lines after end of data");
+
+      if (!end_seek)
+        {
+          hyscan_track_player_seek (player, line_time (n_lines / 2));
+          g_timer_start (line_timer);
+          end_seek = TRUE;
+          return TRUE;
+        }
+
+      g_message ("Rewind play test");
+
+      /* Обратное воспроизведение с позиции перемотки, включая строку
+       * в этой позиции. */
+      lines_reset (-1, n_lines / 2 + 1);
+      hyscan_track_player_play (player, -play_speed);
+      test_step += 1;
+    }
+
+  /* Обратное воспроизведение до начала данных. */
+  else if (test_step == CONTROL_REWIND_PLAY_TEST)
+    {
+      if (last_index[0] != 0)
+        return TRUE;
+
+      if (n_received[0] != n_lines / 2 + 1)
+        g_error ("rewind lines count mismatch %d", n_received[0]);
+
+      g_message ("Source change test");
+
+      lines_reset (1, -1);
+      hyscan_track_player_play (player, play_speed);
+      test_step += 1;
+    }
+
+  /* Добавление источника во время воспроизведения не должно приводить к
+   * пропуску строк уже воспроизводимого источника. */
+  else if (test_step == CONTROL_SOURCE_TEST)
+    {
+      if ((source_id == G_MAXUINT) && (last_index[0] >= n_lines / 2))
+        {
+          source_id = hyscan_track_player_add_nav_data (player, HYSCAN_NAV_DATA (depth2));
+          g_clear_object (&depth2);
+        }
+
+      if (last_index[0] != n_lines - 1)
+        return TRUE;
+
+      if (n_received[0] != n_lines)
+        g_error ("source change lines count mismatch %d", n_received[0]);
+      if ((n_received[1] == 0) || (last_index[1] != n_lines - 1))
+        g_error ("new source lines missing");
+
+      g_message ("Amplitude test");
+
+      /* Воспроизведение акустических данных с начала. */
+      hyscan_track_player_clear (player);
+      if (hyscan_track_player_add_amplitude (player, HYSCAN_AMPLITUDE (sonar)) != 2)
+        g_error ("source id mismatch");
+      g_clear_object (&sonar);
+
+      lines_reset (1, -1);
+      hyscan_track_player_seek (player, START_TIME);
+      hyscan_track_player_play (player, play_speed);
+      test_step += 1;
+    }
+
+  /* Из строк, попавших в один период, отправляются только первые
+   * PLAYER_MAX_LINES, а следующие периоды воспроизводятся без пропусков. */
+  else if (test_step == CONTROL_AMPLITUDE_TEST)
+    {
+      if (last_index[2] != SONAR_BURST + n_lines - 1)
+        return TRUE;
+
+      if (n_received[2] != PLAYER_MAX_LINES + n_lines)
+        g_error ("amplitude lines count mismatch %d", n_received[2]);
+      if (n_received[0] + n_received[1] != 0)
+        g_error ("lines of removed sources");
+
+      test_step += 1;
+    }
+
+  /* Завершение тестирования. */
+  else
+    {
+      g_main_loop_quit (loop);
+    }
+
+  g_timer_start (timer);
+
+  return TRUE;
+}
+
+/* Функция проверки диапазона времени данных. */
+void
+range_check (HyScanTrackPlayer *player,
+             gint64             min_time,
+             gint64             max_time,
+             gpointer           user_data)
+{
+  if ((min_time == line_time (0)) && (max_time == line_time (n_lines - 1)))
+    range_checked = TRUE;
+}
+
+/* Функция проверки строк данных. Строки каждого источника должны идти
+ * подряд, без пропусков, в порядке воспроизведения. */
+void
+lines_check (HyScanTrackPlayer     *player,
+             HyScanTrackPlayerLine *lines,
+             guint                  n_batch,
+             gpointer               user_data)
+{
+  guint i;
+
+  for (i = 0; i < n_batch; i++)
+    {
+      HyScanTrackPlayerLine *line = &lines[i];
+      gint64 next_index;
+
+      if (line->source > 2)
+        g_error ("unknown source %d", line->source);
+
+      /* Акустические данные. */
+      if (line->source == 2)
+        {
+          guint j;
+
+          if ((line->time != sonar_time (line->index)) ||
+              (line->amplitude == NULL) || (line->n_points != SONAR_POINTS) || line->noise)
+            {
+              g_error ("sonar line %d data mismatch", line->index);
+            }
+
+          for (j = 0; j < line->n_points; j++)
+            {
+              if (ABS (line->amplitude[j] - sonar_value (line->index)) > 1e-4)
+                g_error ("sonar line %d amplitude mismatch", line->index);
+            }
+        }
+
+      /* Навигационные данные. */
+      else if ((line->time != line_time (line->index)) ||
+               (line->value != DEPTH_BASE + line->index))
+        {
+          g_error ("line %d data mismatch", line->index);
+        }
+
+      if ((direction > 0) ? (line->time < last_time) : (line->time > last_time))
+        g_error ("line %d order mismatch", line->index);
+
+      /* Строки гидролокатора сверх лимита пропускаются. */
+      next_index = last_index[line->source] + direction;
+      if ((line->source == 2) && (next_index == PLAYER_MAX_LINES))
+        next_index = SONAR_BURST;
+
+      if ((last_index[line->source] >= 0) && (line->index != next_index))
+        {
+          g_error ("source %d line %d follows line %" G_GINT64_FORMAT,
+                   line->source, line->index, last_index[line->source]);
+        }
+
+      last_index[line->source] = line->index;
+      last_time = line->time;
+      n_received[line->source] += 1;
+    }
+
+  g_timer_start (line_timer);
+}
+
+int main( int argc, char **argv )
+{
+  HyScanDataWriter *writer;
+  HyScanBuffer *buffer;
+  HyScanAntennaOffset offset = { 0 };
+  guint i;
+
+  {
+    gchar **args;
+    GError *error = NULL;
+    GOptionContext *context;
+    GOptionEntry entries[] =
+      {
+        { "lines", 'l', 0, G_OPTION_ARG_INT, &n_lines, "Number of lines", NULL },
+        { "fps", 'f', 0, G_OPTION_ARG_INT, &n_fps, "FPS rate", NULL },
+        { "rate", 'r', 0, G_OPTION_ARG_INT, &n_rate, "Data rate", NULL },
+        { "speed", 's', 0, G_OPTION_ARG_DOUBLE, &play_speed, "Play speed", NULL },
+        { NULL }
+      };
+
+#ifdef G_OS_WIN32
+    args = g_win32_get_command_line ();
+#else
+    args = g_strdupv (argv);
+#endif
+
+    context = g_option_context_new ("<db-uri>");
+    g_option_context_set_help_enabled (context, TRUE);
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, FALSE);
+    if (!g_option_context_parse_strv (context, &args, &error))
+      {
+        g_print ("%s\n", error->message);
+        return -1;
+      }
+
+    if (g_strv_length (args) != 2)
+      {
+        g_print ("%s", g_option_context_get_help (context, FALSE, NULL));
+        return 0;
+      }
+
+    g_option_context_free (context);
+
+    db_uri = g_strdup (args[1]);
+    g_strfreev (args);
+  }
+
+  if ((n_lines < 4) || (n_rate == 0) || (play_speed <= 0.0))
+    g_error ("wrong test parameters");
+
+  /* Открываем базу данных. */
+  db = hyscan_db_new (db_uri);
+  if (db == NULL)
+    g_error ("can't open db at: %s", db_uri);
+
+  /* Записываем глубину. */
+  writer = hyscan_data_writer_new ();
+  hyscan_data_writer_set_db (writer, db);
+  if (!hyscan_data_writer_start (writer, PROJECT_NAME, TRACK_NAME, HYSCAN_TRACK_SURVEY, NULL, -1))
+    g_error ("can't start track %s", TRACK_NAME);
+
+  hyscan_data_writer_sensor_set_offset (writer, SENSOR_NAME, &offset);
+
+  buffer = hyscan_buffer_new ();
+  for (i = 0; i < n_lines; i++)
+    {
+      gchar *data = hyscan_nmea_gen_sentence ("SDDPT,%d.0,0.0", DEPTH_BASE + i);
+
+      hyscan_buffer_wrap (buffer, HYSCAN_DATA_BLOB, data, strlen (data));
+      if (!hyscan_data_writer_sensor_add_data (writer, SENSOR_NAME, HYSCAN_SOURCE_NMEA,
+                                               SENSOR_CHANNEL, line_time (i), buffer))
+        {
+          g_error ("can't add data");
+        }
+
+      g_free (data);
+    }
+
+  /* Записываем данные гидролокатора. */
+  {
+    HyScanAcousticDataInfo info = { 0 };
+    HyScanBuffer *values = hyscan_buffer_new ();
+    gfloat *data;
+    guint32 n_points;
+
+    info.data_type = HYSCAN_DATA_FLOAT32LE;
+    info.data_rate = 150000.0;
+    info.signal_frequency = 100000.0;
+    info.signal_bandwidth = 10000.0;
+    info.signal_heterodyne = 100000.0;
+    info.antenna_vaperture = 40.0;
+    info.antenna_haperture = 2.0;
+    info.antenna_frequency = 100000.0;
+    info.antenna_bandwidth = 10000.0;
+    info.adc_vref = 1.0;
+
+    hyscan_data_writer_sonar_set_offset (writer, SONAR_SOURCE, &offset);
+    if (!hyscan_data_writer_acoustic_create (writer, SONAR_SOURCE, SONAR_CHANNEL, NULL, NULL, &info))
+      g_error ("can't create sonar channel");
+
+    for (i = 0; i < SONAR_BURST + n_lines; i++)
+      {
+        guint j;
+
+        n_points = SONAR_POINTS;
+        hyscan_buffer_set_float (values, NULL, n_points);
+        data = hyscan_buffer_get_float (values, &n_points);
+        for (j = 0; j < n_points; j++)
+          data[j] = sonar_value (i);
+
+        if (!hyscan_buffer_export (values, buffer, HYSCAN_DATA_FLOAT32LE))
+          g_error ("can't export sonar data");
+
+        if (!hyscan_data_writer_acoustic_add_data (writer, SONAR_SOURCE, SONAR_CHANNEL, FALSE,
+                                                   sonar_time (i), buffer))
+          {
+            g_error ("can't add sonar data");
+          }
+      }
+
+    g_object_unref (values);
+  }
+
+  hyscan_data_writer_stop (writer);
+
+  /* Источники данных. Второй источник добавляется во время воспроизведения. */
+  depth = hyscan_nav_store_new (db, PROJECT_NAME, TRACK_NAME, SENSOR_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  depth2 = hyscan_nav_store_new (db, PROJECT_NAME, TRACK_NAME, SENSOR_CHANNEL, HYSCAN_NAV_STORE_DEPTH);
+  sonar = hyscan_acoustic_data_new (db, NULL, PROJECT_NAME, TRACK_NAME, SONAR_SOURCE, SONAR_CHANNEL, FALSE);
+  if ((depth == NULL) || (depth2 == NULL) || (sonar == NULL))
+    g_error ("can't open track %s", TRACK_NAME);
+
+  /* Проигрыватель. */
+  player = hyscan_track_player_new ();
+  hyscan_track_player_set_fps (player, n_fps);
+  if (hyscan_track_player_add_nav_data (player, HYSCAN_NAV_DATA (depth)) != 0)
+    g_error ("source id mismatch");
+
+  /* Объекты источников используются только проигрывателем. */
+  g_clear_object (&depth);
+
+  g_signal_connect (player, "range", G_CALLBACK (range_check), NULL);
+  g_signal_connect (player, "lines", G_CALLBACK (lines_check), NULL);
+  g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 10, control_test, NULL, NULL);
+
+  loop = g_main_loop_new (NULL, TRUE);
+  timer = g_timer_new ();
+  line_timer = g_timer_new ();
+
+  g_main_loop_run (loop);
+
+  g_message ("All done");
+
+  g_clear_object (&player);
+  g_clear_object (&depth2);
+  g_clear_object (&sonar);
+
+  hyscan_db_project_remove (db, PROJECT_NAME);
+
+  g_clear_object (&writer);
+  g_clear_object (&buffer);
+  g_clear_object (&db);
+
+  g_timer_destroy (timer);
+  g_timer_destroy (line_timer);
+  g_main_loop_unref (loop);
+
+  g_free (db_uri);
+
+  return 0;
+}